@@ -0,0 +1,468 @@
+#!/usr/bin/env python
+
+#
+# traci-mockd.py -- scriptable stand-in for a SUMO TraCI server
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+#
+
+"""
+Answers the TraCI commands used by TraCIScenarioManager, so that it can be
+run (and its throughput measured) without SUMO being installed.
+
+Vehicles are either generated (--vehicles) or read from a script file
+(--script). A script file contains snapshots of the vehicles, one vehicle
+per line; lines with the same time belong to the same snapshot:
+
+# comment
+boundary <x1> <y1> <x2> <y2>
+<time ms> <vehicle id> <x> <y> <road id> <speed> <angle> [<lane id> <lane position>]
+
+Advancing the simulation to time t makes the last snapshot at or before t
+the current one: vehicles that are in it but not in the previous one have
+departed, vehicles that are no longer in it have arrived. The route of a
+vehicle ("!<vehicle id>") consists of the roads it is on in the snapshots.
+
+Set commands are acknowledged but have no effect. Each connection is served
+by a fresh simulation starting at --begin; statistics are printed when the
+client closes the connection.
+"""
+
+import sys
+import socket
+import struct
+import time
+import logging
+from optparse import OptionParser
+
+CMD_GETVERSION = 0x00
+CMD_SIMSTEP2 = 0x02
+CMD_CLOSE = 0x7F
+CMD_GET_VEHICLE_VARIABLE = 0xa4
+RESPONSE_GET_VEHICLE_VARIABLE = 0xb4
+CMD_GET_ROUTE_VARIABLE = 0xa6
+RESPONSE_GET_ROUTE_VARIABLE = 0xb6
+CMD_GET_SIM_VARIABLE = 0xab
+RESPONSE_GET_SIM_VARIABLE = 0xbb
+CMD_SUBSCRIBE_VEHICLE_VARIABLE = 0xd4
+RESPONSE_SUBSCRIBE_VEHICLE_VARIABLE = 0xe4
+CMD_SUBSCRIBE_SIM_VARIABLE = 0xdb
+RESPONSE_SUBSCRIBE_SIM_VARIABLE = 0xeb
+
+POSITION_2D = 0x01
+TYPE_BOUNDINGBOX = 0x05
+TYPE_INTEGER = 0x09
+TYPE_DOUBLE = 0x0B
+TYPE_STRING = 0x0C
+TYPE_STRINGLIST = 0x0E
+
+RTYPE_OK = 0x00
+RTYPE_NOTIMPLEMENTED = 0x01
+RTYPE_ERR = 0xFF
+
+ID_LIST = 0x00
+LANE_EDGE_ID = 0x31
+VAR_SPEED = 0x40
+VAR_POSITION = 0x42
+VAR_ANGLE = 0x43
+VAR_ROAD_ID = 0x50
+VAR_LANE_ID = 0x51
+VAR_ROUTE_ID = 0x53
+VAR_EDGES = 0x54
+VAR_LANEPOSITION = 0x56
+VAR_SIGNALS = 0x5b
+VAR_TIME_STEP = 0x70
+VAR_DEPARTED_VEHICLES_IDS = 0x74
+VAR_ARRIVED_VEHICLES_IDS = 0x7a
+VAR_NET_BOUNDING_BOX = 0x7c
+
+_API_VERSION = 3
+
+
+class Vehicle:
+    def __init__(self, x, y, road, speed, angle, lane=None, lanepos=0.0):
+        self.x = x
+        self.y = y
+        self.road = road
+        self.speed = speed
+        self.angle = angle
+        self.lane = lane if lane is not None else road + "_0"
+        self.lanepos = lanepos
+        self.route = [road]
+
+
+class Scenario:
+    """
+    Provides the vehicles of each time step.
+    """
+
+    def __init__(self):
+        self.boundary = (0.0, 0.0, 1000.0, 1000.0)
+
+    def vehicles_at(self, t):
+        raise NotImplementedError
+
+
+class ScriptScenario(Scenario):
+    def __init__(self, filename):
+        Scenario.__init__(self)
+        self.snapshots = []  # (time, {id: Vehicle}), ordered by time
+        for lineno, line in enumerate(open(filename)):
+            fields = line.split()
+            if not fields or fields[0].startswith("#"):
+                continue
+            if fields[0] == "boundary":
+                self.boundary = tuple(float(f) for f in fields[1:5])
+                continue
+            if len(fields) not in (7, 9):
+                raise ValueError("%s:%d: expected 7 or 9 fields" % (filename, lineno + 1))
+            t = int(fields[0])
+            vehicle = Vehicle(float(fields[2]), float(fields[3]), fields[4], float(fields[5]), float(fields[6]))
+            if len(fields) == 9:
+                vehicle.lane = fields[7]
+                vehicle.lanepos = float(fields[8])
+            if not self.snapshots or self.snapshots[-1][0] != t:
+                if self.snapshots and self.snapshots[-1][0] > t:
+                    raise ValueError("%s:%d: times must not decrease" % (filename, lineno + 1))
+                self.snapshots.append((t, {}))
+            self.snapshots[-1][1][fields[1]] = vehicle
+
+        # routes are shared by all snapshots of a vehicle
+        routes = {}
+        for (snapshot_time, vehicles) in self.snapshots:
+            for (vehicle_id, vehicle) in vehicles.items():
+                route = routes.setdefault(vehicle_id, [])
+                if not route or route[-1] != vehicle.road:
+                    route.append(vehicle.road)
+                vehicle.route = route
+
+    def vehicles_at(self, t):
+        current = {}
+        for (snapshot_time, vehicles) in self.snapshots:
+            if snapshot_time > t:
+                break
+            current = vehicles
+        return current
+
+
+class GeneratedScenario(Scenario):
+    """
+    Vehicles driving east on parallel roads; vehicle i departs at
+    (i mod spread) seconds and arrives after lifetime seconds.
+    """
+
+    def __init__(self, count, lifetime, spread):
+        Scenario.__init__(self)
+        self.boundary = (0.0, 0.0, 10000.0, 7000.0)
+        self.count = count
+        self.lifetime = lifetime * 1000
+        self.spread = spread
+
+    def vehicles_at(self, t):
+        vehicles = {}
+        for i in range(self.count):
+            depart = (i % self.spread) * 1000
+            if t < depart or t >= depart + self.lifetime:
+                continue
+            speed = 10.0 + i % 5
+            x = (speed * (t - depart) / 1000.0) % self.boundary[2]
+            y = 10.0 + (i * 7) % (self.boundary[3] - 20.0)
+            road = "road%d" % (i % 100)
+            vehicles["veh%d" % i] = Vehicle(x, y, road, speed, 90.0, road + "_0", x)
+        return vehicles
+
+
+class Buffer:
+    """
+    Reads and writes values in TraCI byte order.
+    """
+
+    def __init__(self, data=b""):
+        self.data = data
+        self.pos = 0
+
+    def eof(self):
+        return self.pos >= len(self.data)
+
+    def read(self, fmt):
+        values = struct.unpack_from(fmt, self.data, self.pos)
+        self.pos += struct.calcsize(fmt)
+        return values[0] if len(values) == 1 else values
+
+    def read_string(self):
+        length = self.read("!i")
+        s = self.data[self.pos:self.pos + length].decode("latin-1")
+        self.pos += length
+        return s
+
+
+def pack_string(s):
+    s = s.encode("latin-1")
+    return struct.pack("!i", len(s)) + s
+
+
+def pack_string_list(l):
+    return struct.pack("!i", len(l)) + b"".join(pack_string(s) for s in l)
+
+
+def pack_command(command_id, content):
+    if len(content) + 2 <= 255:
+        return struct.pack("!BB", len(content) + 2, command_id) + content
+    return struct.pack("!BiB", 0, len(content) + 6, command_id) + content
+
+
+def pack_status(command_id, result, description=""):
+    return pack_command(command_id, struct.pack("!B", result) + pack_string(description))
+
+
+class TraCIError(Exception):
+    pass
+
+
+def pack_subscription_result(response_id, object_id, variables):
+    content = pack_string(object_id) + struct.pack("!B", len(variables)) + b"".join(variables)
+    # subscription results always use the extended length field
+    return struct.pack("!BiB", 0, len(content) + 6, response_id) + content
+
+
+class Simulation:
+    """
+    State of one client connection.
+    """
+
+    def __init__(self, scenario, begin):
+        self.scenario = scenario
+        self.time = begin
+        self.vehicles = {}
+        self.departed = []
+        self.arrived = []
+        self.subscriptions = []  # (command id, object id, variables), in order of subscription
+        self.commands = 0
+        self.messages = 0
+        self.steps = 0
+
+    def step(self, target):
+        self.time = max(self.time, target)
+        vehicles = self.scenario.vehicles_at(self.time)
+        self.departed = sorted(v for v in vehicles if v not in self.vehicles)
+        self.arrived = sorted(v for v in self.vehicles if v not in vehicles)
+        self.vehicles = vehicles
+        # subscriptions of vehicles that left the simulation end, as in SUMO
+        self.subscriptions = [s for s in self.subscriptions if s[0] != CMD_SUBSCRIBE_VEHICLE_VARIABLE or s[1] == "" or s[1] in vehicles]
+        self.steps += 1
+
+    def sim_variable(self, variable):
+        if variable == VAR_TIME_STEP:
+            return struct.pack("!BBBi", variable, RTYPE_OK, TYPE_INTEGER, self.time)
+        if variable == VAR_DEPARTED_VEHICLES_IDS:
+            return struct.pack("!BBB", variable, RTYPE_OK, TYPE_STRINGLIST) + pack_string_list(self.departed)
+        if variable == VAR_ARRIVED_VEHICLES_IDS:
+            return struct.pack("!BBB", variable, RTYPE_OK, TYPE_STRINGLIST) + pack_string_list(self.arrived)
+        return struct.pack("!BBB", variable, RTYPE_ERR, TYPE_STRING) + pack_string("unsupported variable")
+
+    def vehicle_value(self, object_id, variable):
+        """
+        Returns the type and value of a vehicle variable.
+        """
+        if object_id == "" and variable == ID_LIST:
+            return struct.pack("!B", TYPE_STRINGLIST) + pack_string_list(sorted(self.vehicles))
+        v = self.vehicles.get(object_id)
+        if v is None:
+            raise TraCIError("unknown vehicle")
+        if variable == VAR_POSITION:
+            return struct.pack("!Bdd", POSITION_2D, v.x, v.y)
+        if variable in (VAR_ROAD_ID, LANE_EDGE_ID):
+            return struct.pack("!B", TYPE_STRING) + pack_string(v.road)
+        if variable == VAR_LANE_ID:
+            return struct.pack("!B", TYPE_STRING) + pack_string(v.lane)
+        if variable == VAR_ROUTE_ID:
+            return struct.pack("!B", TYPE_STRING) + pack_string("!" + object_id)
+        if variable == VAR_EDGES:
+            return struct.pack("!B", TYPE_STRINGLIST) + pack_string_list(v.route)
+        if variable in (VAR_SPEED, VAR_ANGLE, VAR_LANEPOSITION):
+            value = {VAR_SPEED: v.speed, VAR_ANGLE: v.angle, VAR_LANEPOSITION: v.lanepos}[variable]
+            return struct.pack("!Bd", TYPE_DOUBLE, value)
+        if variable == VAR_SIGNALS:
+            return struct.pack("!Bi", TYPE_INTEGER, 0)
+        raise TraCIError("unsupported variable")
+
+    def route_value(self, object_id, variable):
+        """
+        Returns the type and value of a route variable.
+        """
+        v = self.vehicles.get(object_id[1:]) if object_id.startswith("!") else None
+        if v is None:
+            raise TraCIError("unknown route")
+        if variable == VAR_EDGES:
+            return struct.pack("!B", TYPE_STRINGLIST) + pack_string_list(v.route)
+        raise TraCIError("unsupported variable")
+
+    def vehicle_variable(self, object_id, variable):
+        try:
+            return struct.pack("!BB", variable, RTYPE_OK) + self.vehicle_value(object_id, variable)
+        except TraCIError as e:
+            return struct.pack("!BBB", variable, RTYPE_ERR, TYPE_STRING) + pack_string(str(e))
+
+    def subscription_result(self, command_id, object_id, variables):
+        if command_id == CMD_SUBSCRIBE_SIM_VARIABLE:
+            return pack_subscription_result(RESPONSE_SUBSCRIBE_SIM_VARIABLE, object_id, [self.sim_variable(v) for v in variables])
+        return pack_subscription_result(RESPONSE_SUBSCRIBE_VEHICLE_VARIABLE, object_id, [self.vehicle_variable(object_id, v) for v in variables])
+
+    def execute(self, command_id, buf):
+        """
+        Executes one command, returns its response and whether the
+        connection is to be closed.
+        """
+        self.commands += 1
+        if command_id == CMD_GETVERSION:
+            return pack_status(command_id, RTYPE_OK) + pack_command(command_id, struct.pack("!i", _API_VERSION) + pack_string("traci-mockd")), False
+
+        if command_id == CMD_SIMSTEP2:
+            self.step(buf.read("!i"))
+            results = [self.subscription_result(*s) for s in self.subscriptions]
+            return pack_status(command_id, RTYPE_OK) + struct.pack("!i", len(results)) + b"".join(results), False
+
+        if command_id == CMD_GET_SIM_VARIABLE:
+            variable = buf.read("!B")
+            object_id = buf.read_string()
+            if variable != VAR_NET_BOUNDING_BOX:
+                return pack_status(command_id, RTYPE_NOTIMPLEMENTED, "unsupported variable"), False
+            content = struct.pack("!B", variable) + pack_string(object_id) + struct.pack("!Bdddd", TYPE_BOUNDINGBOX, *self.scenario.boundary)
+            return pack_status(command_id, RTYPE_OK) + pack_command(RESPONSE_GET_SIM_VARIABLE, content), False
+
+        if command_id in (CMD_GET_VEHICLE_VARIABLE, CMD_GET_ROUTE_VARIABLE):
+            variable = buf.read("!B")
+            object_id = buf.read_string()
+            try:
+                if command_id == CMD_GET_VEHICLE_VARIABLE:
+                    response_id, value = RESPONSE_GET_VEHICLE_VARIABLE, self.vehicle_value(object_id, variable)
+                else:
+                    response_id, value = RESPONSE_GET_ROUTE_VARIABLE, self.route_value(object_id, variable)
+            except TraCIError as e:
+                return pack_status(command_id, RTYPE_ERR, "%s %s" % (e, object_id)), False
+            content = struct.pack("!B", variable) + pack_string(object_id) + value
+            return pack_status(command_id, RTYPE_OK) + pack_command(response_id, content), False
+
+        if command_id in (CMD_SUBSCRIBE_SIM_VARIABLE, CMD_SUBSCRIBE_VEHICLE_VARIABLE):
+            buf.read("!i")  # begin time
+            buf.read("!i")  # end time
+            object_id = buf.read_string()
+            count = buf.read("!B")
+            variables = [buf.read("!B") for i in range(count)]
+            self.subscriptions = [s for s in self.subscriptions if s[:2] != (command_id, object_id)]
+            if count == 0:
+                return pack_status(command_id, RTYPE_OK), False
+            if command_id == CMD_SUBSCRIBE_VEHICLE_VARIABLE and object_id != "" and object_id not in self.vehicles:
+                return pack_status(command_id, RTYPE_ERR, "unknown vehicle " + object_id), False
+            self.subscriptions.append((command_id, object_id, variables))
+            return pack_status(command_id, RTYPE_OK) + self.subscription_result(command_id, object_id, variables), False
+
+        if 0xc0 <= command_id <= 0xcf:
+            # set commands are accepted and ignored
+            return pack_status(command_id, RTYPE_OK), False
+
+        if command_id == CMD_CLOSE:
+            return pack_status(command_id, RTYPE_OK), True
+
+        return pack_status(command_id, RTYPE_NOTIMPLEMENTED, "not supported by traci-mockd"), False
+
+
+def recv_exactly(conn, length):
+    data = b""
+    while len(data) < length:
+        chunk = conn.recv(length - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return data
+
+
+def serve(conn, scenario, options):
+    sim = Simulation(scenario, options.begin)
+    start = time.time()
+    while True:
+        header = recv_exactly(conn, 4)
+        if header is None:
+            break
+        length = struct.unpack("!i", header)[0]
+        buf = Buffer(recv_exactly(conn, length - 4))
+        sim.messages += 1
+
+        response = b""
+        close = False
+        while not buf.eof():
+            # commands of a message are executed in order, their responses are sent in one message
+            command_start = buf.pos
+            command_length = buf.read("!B")
+            if command_length == 0:
+                command_length = buf.read("!i")
+            command_id = buf.read("!B")
+            command = Buffer(buf.data[:command_start + command_length])
+            command.pos = buf.pos
+            buf.pos = command_start + command_length
+            logging.debug("command 0x%02x" % command_id)
+            result, close = sim.execute(command_id, command)
+            response += result
+            if close:
+                break
+
+        conn.sendall(struct.pack("!i", len(response) + 4) + response)
+        if close:
+            break
+
+    elapsed = time.time() - start
+    logging.info("%d messages, %d commands, %d steps in %.3fs (%.1f commands/s)" % (sim.messages, sim.commands, sim.steps, elapsed, sim.commands / max(elapsed, 1e-9)))
+
+
+def main():
+    parser = OptionParser(description="Scriptable stand-in for a SUMO TraCI server.")
+    parser.add_option("-p", "--port", dest="port", type="int", default=8888, help="listen for connections on PORT [default: %default]", metavar="PORT")
+    parser.add_option("-b", "--bind", dest="bind", default="127.0.0.1", help="bind to ADDRESS [default: %default]", metavar="ADDRESS")
+    parser.add_option("-s", "--script", dest="script", help="read vehicle snapshots from FILE", metavar="FILE")
+    parser.add_option("-n", "--vehicles", dest="vehicles", type="int", default=100, help="number of generated vehicles, if no script is given [default: %default]")
+    parser.add_option("-l", "--lifetime", dest="lifetime", type="int", default=100, help="seconds a generated vehicle stays in the simulation [default: %default]")
+    parser.add_option("-d", "--spread", dest="spread", type="int", default=10, help="generated vehicles depart during the first SPREAD seconds [default: %default]", metavar="SPREAD")
+    parser.add_option("--begin", dest="begin", type="int", default=0, help="simulation time in ms when a client connects [default: %default]")
+    parser.add_option("-1", "--single", dest="single", action="store_true", default=False, help="exit after the first connection")
+    parser.add_option("-v", "--verbose", dest="verbose", action="count", default=0, help="increase verbosity")
+    (options, args) = parser.parse_args()
+
+    logging.basicConfig(level=[logging.WARNING, logging.INFO, logging.DEBUG][min(options.verbose, 2)], format="%(message)s")
+
+    if options.script:
+        scenario = ScriptScenario(options.script)
+    else:
+        scenario = GeneratedScenario(options.vehicles, options.lifetime, max(options.spread, 1))
+
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind((options.bind, options.port))
+    server.listen(1)
+    logging.info("listening on %s:%d" % (options.bind, options.port))
+
+    while True:
+        conn, addr = server.accept()
+        conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        logging.info("connection from %s:%d" % addr)
+        try:
+            serve(conn, scenario, options)
+        finally:
+            conn.close()
+        if options.single:
+            break
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,43 @@
+#!/usr/bin/python
+
+#
+# Creates the BGP configurations of the example: AS 100 (router A) originates
+# numPrefixes /24 prefixes from 20.0.0.0 up, for several values of numPrefixes.
+#
+# Usage: ./makeconfig.py   (writes BGPConfig_<numPrefixes>.xml)
+#
+
+numPrefixesValues = [10000, 100000]
+
+for numPrefixes in numPrefixesValues:
+    configFile = open("BGPConfig_%i.xml" % numPrefixes, "w")
+    configFile.write("<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n")
+    configFile.write("<BGPConfig xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\"\n")
+    configFile.write("              xsi:schemaLocation=\"BGP.xsd\">\n\n")
+    configFile.write("    <TimerParams>\n")
+    configFile.write("        <connectRetryTime> 120 </connectRetryTime>\n")
+    configFile.write("        <holdTime> 180 </holdTime>\n")
+    configFile.write("        <keepAliveTime> 60 </keepAliveTime>\n")
+    configFile.write("        <startDelay> 1 </startDelay>\n")
+    configFile.write("    </TimerParams>\n\n")
+    configFile.write("    <AS id=\"100\">\n")
+    configFile.write("        <Router interAddr=\"10.0.1.1\"/> <!--router A-->\n")
+    for i in range(0, numPrefixes):
+        configFile.write("        <Network Address=\"%i.%i.%i.0\" Netmask=\"255.255.255.0\"/>\n" % (20 + i // 65536, (i // 256) % 256, i % 256))
+    configFile.write("    </AS>\n\n")
+    configFile.write("    <AS id=\"200\">\n")
+    configFile.write("        <Router interAddr=\"10.0.1.2\"/> <!--router B-->\n")
+    configFile.write("    </AS>\n\n")
+    configFile.write("    <AS id=\"300\">\n")
+    configFile.write("        <Router interAddr=\"10.0.2.2\"/> <!--router C-->\n")
+    configFile.write("    </AS>\n\n")
+    configFile.write("    <Session id=\"1\">\n")
+    configFile.write("        <Router exterAddr=\"10.0.1.1\"/>\n")
+    configFile.write("        <Router exterAddr=\"10.0.1.2\"/>\n")
+    configFile.write("    </Session>\n\n")
+    configFile.write("    <Session id=\"2\">\n")
+    configFile.write("        <Router exterAddr=\"10.0.2.1\"/>\n")
+    configFile.write("        <Router exterAddr=\"10.0.2.2\"/>\n")
+    configFile.write("    </Session>\n\n")
+    configFile.write("</BGPConfig>\n")
+    configFile.close()
@@ -0,0 +1,28 @@
+#!/usr/bin/python
+
+#
+# Creates the filter files of the ClassifierBenchmark config: the filters of
+# filters.xml, preceded by numFilters filters for other destinations (which
+# match no packet of the example), for several values of numFilters.
+#
+# Usage: ./makefilters.py   (writes benchmark/filters_<numFilters>.xml)
+#
+
+import os
+
+numFiltersValues = [0, 1000, 10000]
+
+if not os.path.isdir("benchmark"):
+    os.mkdir("benchmark")
+
+source = open("filters.xml").read()
+start = source.index("<filters>") + len("<filters>")
+for numFilters in numFiltersValues:
+    filterFile = open("benchmark/filters_%i.xml" % numFilters, "w")
+    filterFile.write(source[:start] + "\n")
+    for i in range(0, numFilters):
+        # /24 prefixes of 172.16.0.0/12 with various ports
+        filterFile.write("  <filter destAddress=\"172.%i.%i.0\" destPrefixLength=\"24\" protocol=\"udp\" destPort=\"%i\" gate=\"%i\"/>\n"
+                         % (16 + i // 256 % 16, i % 256, 1000 + i % 5000, i % 3))
+    filterFile.write(source[start:].lstrip("\n"))
+    filterFile.close()
@@ -0,0 +1,37 @@
+#!/usr/bin/python
+
+#
+# Creates the LIB files of the LabelSwitchingBenchmark config: the LSR*_lib.xml
+# files of the example, each preceded by numLsps LIB entries of other LSPs
+# (which carry no traffic), for several values of numLsps.
+#
+# Usage: ./makelibs.py   (writes benchmark/LSR*_lib_<numLsps>.xml)
+#
+
+import os
+
+lsrs = [1, 2, 3, 4, 5, 7]
+numLspsValues = [0, 1000, 10000]
+firstLabel = 10000  # above the labels of the example
+numInterfaces = 3
+
+if not os.path.isdir("benchmark"):
+    os.mkdir("benchmark")
+
+for lsr in lsrs:
+    source = open("LSR%i_lib.xml" % lsr).read()
+    start = source.index("<libtable>") + len("<libtable>")
+    for numLsps in numLspsValues:
+        libFile = open("benchmark/LSR%i_lib_%i.xml" % (lsr, numLsps), "w")
+        libFile.write(source[:start] + "\n")
+        for i in range(0, numLsps):
+            libFile.write("\t<libentry>\n")
+            libFile.write("\t\t<inLabel>%i</inLabel>\n" % (firstLabel + i))
+            libFile.write("\t\t<inInterface>ppp%i</inInterface>\n" % (i % numInterfaces))
+            libFile.write("\t\t<outInterface>ppp%i</outInterface>\n" % ((i + 1) % numInterfaces))
+            libFile.write("\t\t<outLabel>\n")
+            libFile.write("\t\t\t<op code=\"swap\" value=\"%i\"/>\n" % (firstLabel + numLsps + i))
+            libFile.write("\t\t</outLabel>\n")
+            libFile.write("\t</libentry>\n")
+        libFile.write(source[start:].lstrip("\n"))
+        libFile.close()
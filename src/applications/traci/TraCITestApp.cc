@@ -22,6 +22,7 @@
 #include "ModuleAccess.h"
 #include "NodeStatus.h"
 #include <cmath>
+#include <algorithm>
 
 Define_Module(TraCITestApp);
 
@@ -221,5 +222,18 @@ void TraCITestApp::handlePositionUpdate() {
             assertTrue("(commandAddVehicle) vehicle driving at speed", traci2->getSpeed() > 25);
         }
     }
+
+    if (testNumber == testCounter++) {
+        if (t == 2 || t == 20) {
+            TraCIScenarioManager* manager = traci->getManager();
+            std::string nodeId = traci->getExternalId();
+            assertEqual("(commandGetEdgeId) edge is the subscribed road", manager->commandGetEdgeId(nodeId), roadId);
+            std::list<std::string> plannedEdges = manager->commandGetPlannedEdgeIds(nodeId);
+            assertTrue("(commandGetPlannedEdgeIds) road is on the planned route", std::find(plannedEdges.begin(), plannedEdges.end(), roadId) != plannedEdges.end());
+            assertTrue("(commandGetRouteEdgeIds) route has the planned edges", manager->commandGetRouteEdgeIds(manager->commandGetRouteId(nodeId)) == plannedEdges);
+            assertTrue("(commandGetLaneId) lane is on the road", manager->commandGetLaneId(nodeId).compare(0, roadId.size() + 1, roadId + "_") == 0);
+            assertTrue("(commandGetLanePosition) position is on the lane", manager->commandGetLanePosition(nodeId) >= 0);
+        }
+    }
 }
 
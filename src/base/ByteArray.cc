@@ -13,25 +13,135 @@
 // See the GNU Lesser General Public License for more details.
 //
 
+#include <algorithm>
+
 #include "ByteArray.h"
 
 
-void ByteArray::setDataFromBuffer(const void *ptr, unsigned int length)
+ByteArray& ByteArray::operator=(const ByteArray& other)
+{
+    if (this == &other)
+        return *this;
+    ByteArray_Base::operator=(other);
+    releaseChunks();
+    shareChunks(other);
+    return *this;
+}
+
+void ByteArray::shareChunks(const ByteArray& other)
+{
+    chunks = other.chunks;
+    dataLength = other.dataLength;
+    for (ChunkVector::iterator it = chunks.begin(); it != chunks.end(); ++it)
+        it->buffer->refCount++;
+}
+
+void ByteArray::releaseChunks()
+{
+    for (ChunkVector::iterator it = chunks.begin(); it != chunks.end(); ++it)
+        if (--it->buffer->refCount == 0)
+            delete it->buffer;
+    chunks.clear();
+    dataLength = 0;
+}
+
+void ByteArray::addChunk(Buffer *buffer, unsigned int offset, unsigned int length)
+{
+    dataLength += length;
+    if (!chunks.empty())
+    {
+        // rejoin adjacent slices of the same buffer, e.g. after split and merge
+        Chunk& last = chunks.back();
+        if (last.buffer == buffer && last.offset + last.length == offset)
+        {
+            last.length += length;
+            buffer->refCount--;
+            return;
+        }
+    }
+    Chunk chunk;
+    chunk.buffer = buffer;
+    chunk.offset = offset;
+    chunk.length = length;
+    chunks.push_back(chunk);
+}
+
+void ByteArray::makeWritable()
+{
+    if (chunks.empty() || (chunks.size() == 1 && chunks[0].buffer->refCount == 1))
+        return;
+    unsigned int length = dataLength;
+    char *data = new char[length];
+    copyDataToBuffer(data, length);
+    releaseChunks();
+    addChunk(new Buffer(data), 0, length);
+}
+
+void ByteArray::setDataArraySize(unsigned int size)
 {
-    if (length != data_arraysize)
+    if (size == dataLength)
+        return;
+    char *data = size ? new char[size] : NULL;
+    unsigned int copied = copyDataToBuffer(data, size);
+    if (copied < size)
+        memset(data + copied, 0, size - copied);
+    assignBuffer(data, size);
+}
+
+char ByteArray::getData(unsigned int k) const
+{
+    if (k >= dataLength)
+        throw cRuntimeError("Array of size %d indexed by %d", dataLength, k);
+    for (ChunkVector::const_iterator it = chunks.begin(); ; ++it)
     {
-        delete [] data_var;
-        data_var = length ? new char[length] : NULL;
-        data_arraysize = length;
+        if (k < it->length)
+            return it->buffer->data[it->offset + k];
+        k -= it->length;
     }
+}
+
+void ByteArray::setData(unsigned int k, char data)
+{
+    if (k >= dataLength)
+        throw cRuntimeError("Array of size %d indexed by %d", dataLength, k);
+    makeWritable();
+    Chunk& chunk = chunks[0];
+    chunk.buffer->data[chunk.offset + k] = data;
+}
+
+void ByteArray::parsimPack(cCommBuffer *b)
+{
+    makeWritable();
+    b->pack(dataLength);
+    if (dataLength)
+        b->pack(chunks[0].buffer->data + chunks[0].offset, dataLength);
+}
+
+void ByteArray::parsimUnpack(cCommBuffer *b)
+{
+    unsigned int length;
+    b->unpack(length);
+    char *data = length ? new char[length] : NULL;
     if (length)
-        memcpy(data_var, ptr, length);
+        b->unpack(data, length);
+    assignBuffer(data, length);
+}
+
+void ByteArray::setDataFromBuffer(const void *ptr, unsigned int length)
+{
+    char *data = length ? new char[length] : NULL;
+    if (length)
+        memcpy(data, ptr, length);
+    assignBuffer(data, length);
 }
 
 void ByteArray::setDataFromByteArray(const ByteArray& other, unsigned int srcOffs, unsigned int length)
 {
-    ASSERT(srcOffs+length <= other.data_arraysize);
-    setDataFromBuffer(other.data_var+srcOffs, length);
+    ASSERT(srcOffs+length <= other.dataLength);
+    ByteArray slice;
+    slice.addDataFromByteArray(other, srcOffs, length);
+    releaseChunks();
+    shareChunks(slice);
 }
 
 void ByteArray::addDataFromBuffer(const void *ptr, unsigned int length)
@@ -39,49 +149,106 @@ void ByteArray::addDataFromBuffer(const void *ptr, unsigned int length)
     if (0 == length)
         return;
 
-    unsigned int nlength = data_arraysize + length;
-    char *ndata_var = new char[nlength];
-    if (data_arraysize)
-        memcpy(ndata_var, data_var, data_arraysize);
-    memcpy(ndata_var + data_arraysize, ptr, length);
-    delete [] data_var;
-    data_var = ndata_var;
-    data_arraysize = nlength;
+    char *data = new char[length];
+    memcpy(data, ptr, length);
+    addChunk(new Buffer(data), 0, length);
+}
+
+void ByteArray::addDataFromByteArray(const ByteArray& other, unsigned int srcOffs, unsigned int length)
+{
+    ASSERT(srcOffs+length <= other.dataLength);
+    if (this == &other)
+    {
+        ByteArray copy(other);
+        addDataFromByteArray(copy, srcOffs, length);
+        return;
+    }
+    for (ChunkVector::const_iterator it = other.chunks.begin(); length > 0; ++it)
+    {
+        if (srcOffs >= it->length)
+        {
+            srcOffs -= it->length;
+            continue;
+        }
+        unsigned int sliceLength = std::min(it->length - srcOffs, length);
+        it->buffer->refCount++;
+        addChunk(it->buffer, it->offset + srcOffs, sliceLength);
+        length -= sliceLength;
+        srcOffs = 0;
+    }
 }
 
 unsigned int ByteArray::copyDataToBuffer(void *ptr, unsigned int length, unsigned int srcOffs) const
 {
-    if (srcOffs >= data_arraysize)
+    if (srcOffs >= dataLength)
         return 0;
 
-    if (srcOffs + length > data_arraysize)
-        length = data_arraysize - srcOffs;
-    memcpy(ptr, data_var+srcOffs, length);
+    if (srcOffs + length > dataLength)
+        length = dataLength - srcOffs;
+    char *dest = (char *)ptr;
+    unsigned int copied = 0;
+    for (ChunkVector::const_iterator it = chunks.begin(); copied < length; ++it)
+    {
+        if (srcOffs >= it->length)
+        {
+            srcOffs -= it->length;
+            continue;
+        }
+        unsigned int sliceLength = std::min(it->length - srcOffs, length - copied);
+        memcpy(dest + copied, it->buffer->data + it->offset + srcOffs, sliceLength);
+        copied += sliceLength;
+        srcOffs = 0;
+    }
     return length;
 }
 
 void ByteArray::assignBuffer(void *ptr, unsigned int length)
 {
-    delete [] data_var;
-    data_var = (char *)ptr;
-    data_arraysize = length;
+    releaseChunks();
+    if (length)
+        addChunk(new Buffer((char *)ptr), 0, length);
+    else
+        delete [] (char *)ptr;
 }
 
 void ByteArray::truncateData(unsigned int truncleft, unsigned int truncright)
 {
-    ASSERT(data_arraysize >= (truncleft + truncright));
+    ASSERT(dataLength >= (truncleft + truncright));
+
+    // drop the slices (or their parts) at the beginning...
+    unsigned int numDropped = 0;
+    while (truncleft > 0)
+    {
+        Chunk& chunk = chunks[numDropped];
+        if (truncleft < chunk.length)
+        {
+            chunk.offset += truncleft;
+            chunk.length -= truncleft;
+            dataLength -= truncleft;
+            break;
+        }
+        truncleft -= chunk.length;
+        dataLength -= chunk.length;
+        if (--chunk.buffer->refCount == 0)
+            delete chunk.buffer;
+        numDropped++;
+    }
+    chunks.erase(chunks.begin(), chunks.begin() + numDropped);
 
-    if ((truncleft || truncright))
+    // ...and at the end
+    while (truncright > 0)
     {
-        unsigned int nlength = data_arraysize - (truncleft + truncright);
-        char *ndata_var = NULL;
-        if (nlength)
+        Chunk& chunk = chunks.back();
+        if (truncright < chunk.length)
         {
-            ndata_var = new char[nlength];
-            memcpy(ndata_var, data_var+truncleft, nlength);
+            chunk.length -= truncright;
+            dataLength -= truncright;
+            break;
         }
-        delete [] data_var;
-        data_var = ndata_var;
-        data_arraysize = nlength;
+        truncright -= chunk.length;
+        dataLength -= chunk.length;
+        if (--chunk.buffer->refCount == 0)
+            delete chunk.buffer;
+        chunks.pop_back();
     }
 }
@@ -16,34 +16,87 @@
 #ifndef __INET_BYTEARRAY_H
 #define __INET_BYTEARRAY_H
 
+#include <vector>
+
 #include "ByteArray_m.h"
 
 /**
  * Class that carries raw bytes.
+ *
+ * The bytes are stored as a list of slices (chunks) of reference counted
+ * buffers, so copying, slicing (setDataFromByteArray(), truncateData())
+ * and concatenating (addDataFromByteArray()) ByteArrays do not copy the
+ * bytes themselves. Buffers are copied only when a shared content is
+ * modified through setData() or setDataArraySize().
  */
 class ByteArray : public ByteArray_Base
 {
+  protected:
+    struct Buffer
+    {
+        char *data;             // allocated by new char[]
+        unsigned int refCount;  // number of chunks referring to the buffer
+        Buffer(char *data) : data(data), refCount(1) {}
+        ~Buffer() { delete [] data; }
+    };
+    struct Chunk
+    {
+        Buffer *buffer;
+        unsigned int offset;
+        unsigned int length;
+    };
+    typedef std::vector<Chunk> ChunkVector;
+
+    ChunkVector chunks;
+    unsigned int dataLength;    // sum of the chunk lengths
+
+  private:
+    void shareChunks(const ByteArray& other);
+    void releaseChunks();
+
+  protected:
+    /** Appends a slice of buffer; the caller passes one reference of buffer to this object */
+    void addChunk(Buffer *buffer, unsigned int offset, unsigned int length);
+
+    /** Makes the content a single buffer not shared with other ByteArrays */
+    void makeWritable();
+
   public:
     /**
      * Constructor
      */
-    ByteArray() : ByteArray_Base() {}
+    ByteArray() : ByteArray_Base(), dataLength(0) {}
 
     /**
-     * Copy constructor
+     * Copy constructor; the bytes are shared, not copied
      */
-    ByteArray(const ByteArray& other) : ByteArray_Base(other) { }
+    ByteArray(const ByteArray& other) : ByteArray_Base(other) { shareChunks(other); }
 
     /**
-     * operator =
+     * Destructor
      */
-    ByteArray& operator=(const ByteArray& other) {ByteArray_Base::operator=(other); return *this;}
+    virtual ~ByteArray() { releaseChunks(); }
+
+    /**
+     * operator =; the bytes are shared, not copied
+     */
+    ByteArray& operator=(const ByteArray& other);
 
     /**
      * Creates and returns an exact copy of this object.
      */
     virtual ByteArray *dup() const {return new ByteArray(*this);}
 
+    /** @name Redefined accessors of the generated class */
+    //@{
+    virtual void setDataArraySize(unsigned int size);
+    virtual unsigned int getDataArraySize() const { return dataLength; }
+    virtual char getData(unsigned int k) const;
+    virtual void setData(unsigned int k, char data);
+    virtual void parsimPack(cCommBuffer *b);
+    virtual void parsimUnpack(cCommBuffer *b);
+    //@}
+
     /**
      * Copy data from buffer
      * @param ptr: pointer to buffer
@@ -52,7 +105,7 @@ class ByteArray : public ByteArray_Base
     virtual void setDataFromBuffer(const void *ptr, unsigned int length);
 
     /**
-     * Copy data from other ByteArray
+     * Set data to a slice of other ByteArray, without copying the bytes
      * @param other: reference to other ByteArray
      * @param offset: skipped first bytes from other
      * @param length: length of data
@@ -66,6 +119,14 @@ class ByteArray : public ByteArray_Base
      */
     virtual void addDataFromBuffer(const void *ptr, unsigned int length);
 
+    /**
+     * Add a slice of other ByteArray to the end of existing content, without copying the bytes
+     * @param other: reference to other ByteArray
+     * @param offset: skipped first bytes from other
+     * @param length: length of data
+     */
+    virtual void addDataFromByteArray(const ByteArray& other, unsigned int offset, unsigned int length);
+
     /**
      * Copy data content to buffer
      * @param ptr: pointer to output buffer
@@ -89,6 +150,11 @@ class ByteArray : public ByteArray_Base
      * Generate assert when not have enough bytes for truncation
      */
     virtual void truncateData(unsigned int truncleft, unsigned int truncright = 0);
+
+    /**
+     * Returns the number of buffer slices the content consists of.
+     */
+    unsigned int getNumChunks() const { return chunks.size(); }
 };
 
 #endif //  __INET_BYTEARRAY_H
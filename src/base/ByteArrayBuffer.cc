@@ -12,6 +12,8 @@
 // See the GNU Lesser General Public License for more details.
 //
 
+#include <algorithm>
+
 #include "ByteArrayBuffer.h"
 
 ByteArrayBuffer::ByteArrayBuffer()
@@ -70,6 +72,27 @@ unsigned int ByteArrayBuffer::getBytesToBuffer(void* bufferP, unsigned int buffe
     return copiedBytes;
 }
 
+unsigned int ByteArrayBuffer::getBytesToByteArray(ByteArray& byteArrayP, unsigned int lengthP, unsigned int srcOffsP) const
+{
+    unsigned int copiedBytes = 0;
+    DataList::const_iterator i;
+
+    for (i = this->dataListM.begin(); (copiedBytes < lengthP) && (i != dataListM.end()); ++i)
+    {
+        unsigned int sliceLength = i->getDataArraySize();
+        if (srcOffsP >= sliceLength)
+        {
+            srcOffsP -= sliceLength;
+            continue;
+        }
+        unsigned int cbytes = std::min(sliceLength - srcOffsP, lengthP - copiedBytes);
+        byteArrayP.addDataFromByteArray(*i, srcOffsP, cbytes);
+        copiedBytes += cbytes;
+        srcOffsP = 0;
+    }
+    return copiedBytes;
+}
+
 unsigned int ByteArrayBuffer::popBytesToBuffer(void* bufferP, unsigned int bufferLengthP)
 {
     return drop(getBytesToBuffer(bufferP, bufferLengthP));
@@ -61,6 +61,15 @@ class ByteArrayBuffer : public cObject
      */
     virtual unsigned int getBytesToBuffer(void* bufferP, unsigned int bufferLengthP, unsigned int srcOffsP = 0) const;
 
+    /**
+     * Append bytes to a ByteArray; the bytes are shared, not copied
+     * @param byteArrayP: output ByteArray
+     * @param lengthP: count of bytes to append
+     * @param srcOffsP: source offset
+     * @return count of appended bytes
+     */
+    virtual unsigned int getBytesToByteArray(ByteArray& byteArrayP, unsigned int lengthP, unsigned int srcOffsP = 0) const;
+
     /**
      * Move bytes to an external buffer
      * @param bufferP: pointer to output buffer
@@ -46,10 +46,37 @@ std::ostream& operator<<(std::ostream& os, const NotificationBoard::NotifiableVe
     return os;
 }
 
+std::ostream& operator<<(std::ostream& os, const NotificationBoard::CategoryEntry& e)
+{
+    unsigned int numFiltered = 0;
+    for (NotificationBoard::FilteredClientMap::const_iterator it = e.filteredClients.begin(); it != e.filteredClients.end(); ++it)
+        numFiltered += it->second.size();
+    os << "fired=" << e.numFired << " delivered=" << e.numDelivered;
+    if (numFiltered > 0)
+        os << " filtered=" << numFiltered;
+    os << " " << e.clients;
+    return os;
+}
+
 
 void NotificationBoard::initialize()
 {
-    WATCH_MAP(clientMap);
+    WATCH_VECTOR(categories);
+}
+
+void NotificationBoard::finish()
+{
+    if (!par("recordStatistics").boolValue())
+        return;
+    for (unsigned int i = 0; i < categories.size(); i++)
+    {
+        const CategoryEntry& entry = categories[i];
+        if (entry.numFired == 0)
+            continue;
+        const char *name = notificationCategoryName(i);
+        recordScalar(opp_stringf("%s notifications fired", name).c_str(), entry.numFired);
+        recordScalar(opp_stringf("%s notifications delivered", name).c_str(), entry.numDelivered);
+    }
 }
 
 void NotificationBoard::handleMessage(cMessage *msg)
@@ -58,12 +85,22 @@ void NotificationBoard::handleMessage(cMessage *msg)
 }
 
 
-void NotificationBoard::subscribe(INotifiable *client, int category)
+NotificationBoard::CategoryEntry& NotificationBoard::getCategoryEntry(int category)
+{
+    if (category < 0)
+        throw cRuntimeError("Invalid notification category %d", category);
+    if (category >= (int)categories.size())
+        categories.resize(category + 1);
+    return categories[category];
+}
+
+void NotificationBoard::subscribe(INotifiable *client, int category, const cObject *source)
 {
     Enter_Method("subscribe(%s)", notificationCategoryName(category));
 
-    // find or create entry for this category
-    NotifiableVector& clients = clientMap[category];
+    // find or create entry for this category (and source)
+    CategoryEntry& entry = getCategoryEntry(category);
+    NotifiableVector& clients = source ? entry.filteredClients[source] : entry.clients;
 
     // add client if not already there
     if (std::find(clients.begin(), clients.end(), client) == clients.end())
@@ -72,38 +109,74 @@ void NotificationBoard::subscribe(INotifiable *client, int category)
     fireChangeNotification(NF_SUBSCRIBERLIST_CHANGED, NULL);
 }
 
-void NotificationBoard::unsubscribe(INotifiable *client, int category)
+void NotificationBoard::unsubscribe(INotifiable *client, int category, const cObject *source)
 {
     Enter_Method("unsubscribe(%s)", notificationCategoryName(category));
 
     // find (or create) entry for this category
-    NotifiableVector& clients = clientMap[category];
+    CategoryEntry& entry = getCategoryEntry(category);
 
     // remove client if there
-    NotifiableVector::iterator it = std::find(clients.begin(), clients.end(), client);
-    if (it!=clients.end())
-        clients.erase(it);
+    if (!source)
+    {
+        NotifiableVector& clients = entry.clients;
+        NotifiableVector::iterator it = std::find(clients.begin(), clients.end(), client);
+        if (it != clients.end())
+            clients.erase(it);
+    }
+    else
+    {
+        FilteredClientMap::iterator mapIt = entry.filteredClients.find(source);
+        if (mapIt != entry.filteredClients.end())
+        {
+            NotifiableVector& clients = mapIt->second;
+            NotifiableVector::iterator it = std::find(clients.begin(), clients.end(), client);
+            if (it != clients.end())
+                clients.erase(it);
+            if (clients.empty())
+                entry.filteredClients.erase(mapIt);
+        }
+    }
 
     fireChangeNotification(NF_SUBSCRIBERLIST_CHANGED, NULL);
 }
 
 bool NotificationBoard::hasSubscribers(int category)
 {
-    ClientMap::iterator it = clientMap.find(category);
-    return it!=clientMap.end() && !it->second.empty();
+    if (category < 0 || category >= (int)categories.size())
+        return false;
+    const CategoryEntry& entry = categories[category];
+    return !entry.clients.empty() || !entry.filteredClients.empty();
 }
 
-void NotificationBoard::fireChangeNotification(int category, const cObject *details)
+void NotificationBoard::fireChangeNotification(int category, const cObject *details, const cObject *source)
 {
     Enter_Method("fireChangeNotification(%s, %s)", notificationCategoryName(category),
-                 details?details->info().c_str() : "n/a");
+                 details && ev.isGUI() ? details->info().c_str() : "n/a");
 
-    ClientMap::iterator it = clientMap.find(category);
-    if (it==clientMap.end())
+    if (category < 0 || category >= (int)categories.size())
         return;
-    NotifiableVector& clients = it->second;
-    for (NotifiableVector::iterator j=clients.begin(); j!=clients.end(); j++)
-        (*j)->receiveChangeNotification(category, details);
-}
+    categories[category].numFired++;
 
+    // clients may (un)subscribe during the calls, which may reallocate the
+    // vectors: index them again in each iteration
+    for (unsigned int i = 0; i < categories[category].clients.size(); i++)
+    {
+        categories[category].numDelivered++;
+        categories[category].clients[i]->receiveChangeNotification(category, details);
+    }
 
+    if (!source)
+        source = details;
+    if (!source || categories[category].filteredClients.empty())
+        return;
+    for (unsigned int i = 0; ; i++)
+    {
+        FilteredClientMap& filteredClients = categories[category].filteredClients;
+        FilteredClientMap::iterator it = filteredClients.find(source);
+        if (it == filteredClients.end() || i >= it->second.size())
+            break;
+        categories[category].numDelivered++;
+        it->second[i]->receiveChangeNotification(category, details);
+    }
+}
@@ -70,6 +70,17 @@
  * };
  * </pre>
  *
+ * Clients interested in notifications about one object only (e.g. state
+ * changes of one InterfaceEntry) may pass that object to subscribe(); they
+ * will only be called for notifications fired with that object as source
+ * (see fireChangeNotification()). Filtered subscriptions are looked up by
+ * the source, so they cost nothing for notifications about other objects.
+ *
+ * Subscriptions are stored in a table indexed directly by category. The
+ * number of notifications fired and delivered is counted per category;
+ * these counters can be inspected in the GUI, and recorded as scalars
+ * if the recordStatistics parameter is set.
+ *
  * Obtaining a pointer to the NotificationBoard module of that host/router:
  *
  * <pre>
@@ -87,11 +98,21 @@ class INET_API NotificationBoard : public cSimpleModule
 {
   public: // should be protected
     typedef std::vector<INotifiable *> NotifiableVector;
-    typedef std::map<int, NotifiableVector> ClientMap;
+    typedef std::map<const cObject *, NotifiableVector> FilteredClientMap;
+    struct CategoryEntry
+    {
+        NotifiableVector clients;         // receive all notifications of the category
+        FilteredClientMap filteredClients; // receive notifications of one source object only
+        unsigned long numFired;
+        unsigned long numDelivered;
+        CategoryEntry() : numFired(0), numDelivered(0) {}
+    };
+    typedef std::vector<CategoryEntry> CategoryVector;
     friend std::ostream& operator<<(std::ostream&, const NotifiableVector&); // doesn't work in MSVC 6.0
+    friend std::ostream& operator<<(std::ostream&, const CategoryEntry&);
 
   protected:
-    ClientMap clientMap;
+    CategoryVector categories;  // indexed by category
 
   protected:
     /**
@@ -104,18 +125,30 @@ class INET_API NotificationBoard : public cSimpleModule
      */
     virtual void handleMessage(cMessage *msg);
 
+    /**
+     * Records the notification counters, if enabled.
+     */
+    virtual void finish();
+
+    /**
+     * Returns the entry of the category, creating it if needed.
+     */
+    CategoryEntry& getCategoryEntry(int category);
+
   public:
     /** @name Methods for consumers of change notifications */
     //@{
     /**
-     * Subscribe to changes of the given category
+     * Subscribe to changes of the given category. If source is not NULL,
+     * the client only receives the notifications fired about that object.
      */
-    virtual void subscribe(INotifiable *client, int category);
+    virtual void subscribe(INotifiable *client, int category, const cObject *source = NULL);
 
     /**
-     * Unsubscribe from changes of the given category
+     * Unsubscribe from changes of the given category. The source must be
+     * the same as the one passed to subscribe().
      */
-    virtual void unsubscribe(INotifiable *client, int category);
+    virtual void unsubscribe(INotifiable *client, int category, const cObject *source = NULL);
 
     /**
      * Returns true if any client has subscribed to the given category.
@@ -135,8 +168,12 @@ class INET_API NotificationBoard : public cSimpleModule
      * taken place. The optional details object may carry more specific
      * information about the change (e.g. exact location, specific attribute
      * that changed, old value, new value, etc).
+     *
+     * The source is the object the notification is about; it selects the
+     * filtered subscribers to be notified. It defaults to details, which is
+     * appropriate when details is the changed object itself.
      */
-    virtual void fireChangeNotification(int category, const cObject *details = NULL);
+    virtual void fireChangeNotification(int category, const cObject *details = NULL, const cObject *source = NULL);
     //@}
 };
 
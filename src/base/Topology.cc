@@ -19,7 +19,6 @@
 #include <string.h>
 #include <stdarg.h>
 #include <deque>
-#include <list>
 #include <algorithm>
 #include <sstream>
 #include "Topology.h"
@@ -235,6 +234,8 @@ void Topology::extractFromNetwork(bool (*predicate)(cModule *,void *), void *dat
             link->destNode->inLinks.push_back(link);
         }
     }
+
+    updateNodeIndices(0);
 }
 
 int Topology::addNode(Node *node)
@@ -243,14 +244,17 @@ int Topology::addNode(Node *node)
     {
         // elements without module ID are stored at the end
         nodes.push_back(node);
-        return nodes.size() - 1;
+        node->index = nodes.size() - 1;
+        return node->index;
     }
     else
     {
         // must find an insertion point because nodes[] is ordered by module ID
         std::vector<Node*>::iterator it = std::lower_bound(nodes.begin(), nodes.end(), node, lessByModuleId);
         it = nodes.insert(it, node);
-        return it - nodes.begin();
+        int index = it - nodes.begin();
+        updateNodeIndices(index);
+        return index;
     }
 }
 
@@ -275,11 +279,18 @@ void Topology::deleteNode(Node *node)
     // remove from nodes[]
     std::vector<Node*>::iterator it = find(nodes, node);
     ASSERT(it != nodes.end());
-    nodes.erase(it);
+    it = nodes.erase(it);
+    updateNodeIndices(it - nodes.begin());
 
     delete node;
 }
 
+void Topology::updateNodeIndices(int from)
+{
+    for (int i=from; i<(int)nodes.size(); i++)
+        nodes[i]->index = i;
+}
+
 void Topology::addLink(Link *link, Node *srcNode, Node *destNode)
 {
     // remove from graph if it's already in
@@ -364,18 +375,40 @@ Topology::Node *Topology::getNodeFor(cModule *mod)
 
 void Topology::calculateUnweightedSingleShortestPathsTo(Node *_target)
 {
-    // multiple paths not supported :-(
+    PathInfoVector paths;
+    calculateUnweightedSingleShortestPathsTo(_target, paths);
+    target = _target;
+    storePathsInNodes(paths);
+}
 
-    if (!_target)
-        throw cRuntimeError(this,"..ShortestPathTo(): target node is NULL");
+void Topology::calculateWeightedSingleShortestPathsTo(Node *_target)
+{
+    PathInfoVector paths;
+    calculateWeightedSingleShortestPathsTo(_target, paths);
     target = _target;
+    storePathsInNodes(paths);
+}
 
+void Topology::storePathsInNodes(const PathInfoVector& paths)
+{
     for (int i=0; i<(int)nodes.size(); i++)
     {
-       nodes[i]->dist = INFINITY;
-       nodes[i]->outPath = NULL;
+        nodes[i]->dist = paths[i].dist;
+        nodes[i]->outPath = paths[i].outPath;
     }
-    target->dist = 0;
+}
+
+void Topology::calculateUnweightedSingleShortestPathsTo(Node *target, PathInfoVector& paths) const
+{
+    // multiple paths not supported :-(
+
+    if (!target)
+        throw cRuntimeError(this,"..ShortestPathTo(): target node is NULL");
+    if (target->index < 0 || target->index >= (int)nodes.size() || nodes[target->index] != target)
+        throw cRuntimeError(this,"..ShortestPathTo(): target node is not in the topology");
+
+    paths.assign(nodes.size(), PathInfo());
+    paths[target->index].dist = 0;
 
     std::deque<Node*> q;
 
@@ -385,6 +418,7 @@ void Topology::calculateUnweightedSingleShortestPathsTo(Node *_target)
     {
        Node *v = q.front();
        q.pop_front();
+       double vdist = paths[v->index].dist;
 
        // for each w adjacent to v...
        for (int i=0; i<(int)v->inLinks.size(); i++)
@@ -396,71 +430,148 @@ void Topology::calculateUnweightedSingleShortestPathsTo(Node *_target)
            if (!w->enabled)
                continue;
 
-           if (w->dist == INFINITY)
+           PathInfo& wpath = paths[w->index];
+           if (wpath.dist == INFINITY)
            {
-               w->dist = v->dist + 1;
-               w->outPath = v->inLinks[i];
+               wpath.dist = vdist + 1;
+               wpath.outPath = v->inLinks[i];
                q.push_back(w);
            }
        }
     }
 }
 
-void Topology::calculateWeightedSingleShortestPathsTo(Node *_target)
+/**
+ * Priority queue of node indices for Dijkstra's algorithm: a binary heap
+ * that knows the position of each node, so a node's key can be decreased
+ * in O(log n). Nodes with equal distance come out in the order they were
+ * inserted (or last decreased), the same as in a sorted list where new
+ * entries are inserted after the equal ones.
+ */
+class TopologyPathHeap
 {
-    if (!_target)
-        throw cRuntimeError(this,"..ShortestPathTo(): target node is NULL");
-    target = _target;
+  protected:
+    struct Item
+    {
+        double dist;
+        unsigned long seq;  // insertion order
+        int node;
+    };
+    std::vector<Item> items;
+    std::vector<int> positions;  // position of each node in items, -1 if not in the heap
+    unsigned long nextSeq;
+
+  protected:
+    static bool less(const Item& a, const Item& b) { return a.dist < b.dist || (a.dist == b.dist && a.seq < b.seq); }
+    void place(int pos, const Item& item) { items[pos] = item; positions[item.node] = pos; }
+
+    void siftUp(int pos, Item item)
+    {
+        while (pos > 0 && less(item, items[(pos - 1) / 2]))
+        {
+            place(pos, items[(pos - 1) / 2]);
+            pos = (pos - 1) / 2;
+        }
+        place(pos, item);
+    }
 
-    // clean path infos
-    for (int i=0; i<(int)nodes.size(); i++)
+    void siftDown(int pos, Item item)
     {
-       nodes[i]->dist = INFINITY;
-       nodes[i]->outPath = NULL;
+        int size = items.size();
+        while (true)
+        {
+            int child = 2 * pos + 1;
+            if (child >= size)
+                break;
+            if (child + 1 < size && less(items[child + 1], items[child]))
+                child++;
+            if (!less(items[child], item))
+                break;
+            place(pos, items[child]);
+            pos = child;
+        }
+        place(pos, item);
     }
 
-    target->dist = 0;
+  public:
+    TopologyPathHeap(int numNodes) : positions(numNodes, -1), nextSeq(0) {}
 
-    std::list<Node*> q;
+    bool empty() const { return items.empty(); }
 
-    q.push_back(target);
+    /** Inserts the node, or moves it if it is already in the heap; dist may only decrease */
+    void push(int node, double dist)
+    {
+        Item item;
+        item.dist = dist;
+        item.seq = nextSeq++;
+        item.node = node;
+        int pos = positions[node];
+        if (pos == -1)
+        {
+            pos = items.size();
+            items.push_back(item);
+        }
+        siftUp(pos, item);
+    }
+
+    /** Removes and returns the node with the smallest distance */
+    int pop()
+    {
+        int node = items[0].node;
+        positions[node] = -1;
+        Item last = items.back();
+        items.pop_back();
+        if (!items.empty())
+            siftDown(0, last);
+        return node;
+    }
+};
+
+void Topology::calculateWeightedSingleShortestPathsTo(Node *target, PathInfoVector& paths) const
+{
+    if (!target)
+        throw cRuntimeError(this,"..ShortestPathTo(): target node is NULL");
+    if (target->index < 0 || target->index >= (int)nodes.size() || nodes[target->index] != target)
+        throw cRuntimeError(this,"..ShortestPathTo(): target node is not in the topology");
+
+    // clean path infos
+    paths.assign(nodes.size(), PathInfo());
+    paths[target->index].dist = 0;
+
+    TopologyPathHeap q(nodes.size());
+
+    q.push(target->index, 0);
 
     while (!q.empty())
     {
-        Node *dest = q.front();
-        q.pop_front();
+        Node *dest = nodes[q.pop()];
+        double destDist = paths[dest->index].dist;
 
         ASSERT(dest->getWeight() >= 0.0);
 
         // for each w adjacent to v...
-        for (int i=0; i < dest->getNumInLinks(); i++)
+        for (int i=0; i < (int)dest->inLinks.size(); i++)
         {
-            if (!(dest->getLinkIn(i)->isEnabled()))
+            Link *link = dest->inLinks[i];
+            if (!link->enabled)
                 continue;
 
-            Node *src = dest->getLinkIn(i)->getRemoteNode();
-            if (!src->isEnabled())
+            Node *src = link->srcNode;
+            if (!src->enabled)
                 continue;
 
-            double linkWeight = dest->getLinkIn(i)->getWeight();
+            double linkWeight = link->weight;
             ASSERT(linkWeight > 0.0);
 
-            double newdist = dest->dist + linkWeight;
+            double newdist = destDist + linkWeight;
             if (dest != target)
                 newdist += dest->getWeight();  // dest is not the target, uses weight of dest node as price of routing (infinity means dest node doesn't route between interfaces)
-            if (newdist != INFINITY && src->dist > newdist)  // it's a valid shorter path from src to target node
+            PathInfo& srcPath = paths[src->index];
+            if (newdist != INFINITY && srcPath.dist > newdist)  // it's a valid shorter path from src to target node
             {
-                if (src->dist != INFINITY)
-                    q.remove(src);   // src is in the queue
-                src->dist = newdist;
-                src->outPath = dest->inLinks[i];
-
-                // insert src node to ordered list
-                std::list<Node*>::iterator it;
-                for (it = q.begin(); it != q.end(); ++it)
-                    if ((*it)->dist > newdist)
-                        break;
-                q.insert(it, src);
+                srcPath.dist = newdist;
+                srcPath.outPath = link;
+                q.push(src->index, newdist);  // moves src if it is already in the queue
             }
         }
     }
@@ -71,6 +71,7 @@ class INET_API Topology : public cOwnedObject
 
       protected:
         int moduleId;
+        int index;  // position in the nodes[] vector of the topology
         double weight;
         bool enabled;
         std::vector<Link*> inLinks;
@@ -84,7 +85,7 @@ class INET_API Topology : public cOwnedObject
         /**
          * Constructor
          */
-        Node(int moduleId=-1) {this->moduleId=moduleId; weight=0; enabled=true; dist=INFINITY; outPath=NULL;}
+        Node(int moduleId=-1) {this->moduleId=moduleId; index=-1; weight=0; enabled=true; dist=INFINITY; outPath=NULL;}
         virtual ~Node() {}
 
         /** @name Node attributes: weight, enabled state, correspondence to modules. */
@@ -95,6 +96,12 @@ class INET_API Topology : public cOwnedObject
          */
         int getModuleId() const  {return moduleId;}
 
+        /**
+         * Returns the index of this node in the topology, i.e. getNode(getIndex())
+         * returns this node. Indices change when nodes are added or deleted.
+         */
+        int getIndex() const  {return index;}
+
         /**
          * Returns the pointer to the network module to which this node corresponds.
          */
@@ -318,6 +325,21 @@ class INET_API Topology : public cOwnedObject
         cGate *getLocalGate() const  {return srcNode->getModule()->gate(srcGateId);}
     };
 
+    /**
+     * Result of the shortest path finder methods that store their results
+     * in a vector indexed by node index instead of in the nodes: the
+     * distance to the target node and the first link on the path.
+     */
+    struct PathInfo
+    {
+        double dist;
+        Link *outPath;
+        PathInfo() : dist(INFINITY), outPath(NULL) {}
+        int getNumPaths() const  {return outPath?1:0;}
+        LinkOut *getPath(int) const  {return (LinkOut *)outPath;}
+    };
+    typedef std::vector<PathInfo> PathInfoVector;
+
     /**
      * Base class for selector objects used in extract...() methods of Topology.
      * Redefine the matches() method to return whether the given module
@@ -340,6 +362,8 @@ class INET_API Topology : public cOwnedObject
 
     void unlinkFromSourceNode(Link *link);
     void unlinkFromDestNode(Link *link);
+    void updateNodeIndices(int from);
+    void storePathsInNodes(const PathInfoVector& paths);
 
   public:
     /** @name Constructors, destructor, assignment */
@@ -560,6 +584,23 @@ class INET_API Topology : public cOwnedObject
      */
     void calculateWeightedSingleShortestPathsTo(Node *target);
 
+    /**
+     * Same as calculateUnweightedSingleShortestPathsTo(Node *), but the paths
+     * are stored in the given vector (indexed by node index) instead of in
+     * the nodes. As the topology is not modified, several threads may call
+     * it at the same time, with different vectors.
+     */
+    void calculateUnweightedSingleShortestPathsTo(Node *target, PathInfoVector& paths) const;
+
+    /**
+     * Same as calculateWeightedSingleShortestPathsTo(Node *), but the paths
+     * are stored in the given vector (indexed by node index) instead of in
+     * the nodes. As the topology is not modified, several threads may call
+     * it at the same time, with different vectors. The priority queue is an
+     * indexed binary heap, so the cost is O((n+e) log n).
+     */
+    void calculateWeightedSingleShortestPathsTo(Node *target, PathInfoVector& paths) const;
+
     /**
      * Returns the node that was passed to the most recently called
      * shortest path finding function.
@@ -3,6 +3,23 @@
 
 
 #include "EtherFrame_m.h"
+#include "ObjectPool.h"
+
+/**
+ * Represents an Ethernet II frame. More info in the EtherFrame.msg file
+ * (and the documentation generated from it).
+ */
+class INET_API EthernetIIFrame : public EthernetIIFrame_Base
+{
+  public:
+    EthernetIIFrame(const char *name = NULL, int kind = 0) : EthernetIIFrame_Base(name, kind) {}
+    EthernetIIFrame(const EthernetIIFrame& other) : EthernetIIFrame_Base(other) {}
+    EthernetIIFrame& operator=(const EthernetIIFrame& other) {EthernetIIFrame_Base::operator=(other); return *this;}
+
+    virtual EthernetIIFrame *dup() const {return new EthernetIIFrame(*this);}
+
+    INET_POOLED_ALLOCATION(EthernetIIFrame);
+};
 
 
 #endif // __INET_ETHERFRAME_H_
@@ -14,24 +14,26 @@
 // along with this program.  If not, see http://www.gnu.org/licenses/.
 // 
 
-#include <map>
 #include "MACAddressTable.h"
 
 #define MAX_LINE 100
+#define INITIAL_NUM_SLOTS 64
 
 Define_Module(MACAddressTable);
 
 std::ostream& operator<<(std::ostream& os, const MACAddressTable::AddressEntry& entry)
 {
-    os << "{VID=" << entry.vid << ", port=" << entry.portno << ", insertionTime=" << entry.insertionTime << "}";
+    if (entry.portno == -1)
+        os << "{unused}";
+    else
+        os << "{VID=" << entry.vid << ", address=" << entry.address << ", port=" << entry.portno << ", insertionTime=" << entry.insertionTime << "}";
     return os;
 }
 
-MACAddressTable::MACAddressTable()
+MACAddressTable::MACAddressTable() : table(INITIAL_NUM_SLOTS)
 {
-    addressTable = new AddressTable();
-    // Set addressTable for VLAN ID 0
-    vlanAddressTable[0] = addressTable;
+    numEntries = 0;
+    freeList = agingHead = agingTail = -1;
 }
 
 void MACAddressTable::initialize()
@@ -44,8 +46,8 @@ void MACAddressTable::initialize()
     if (addressTableFile && *addressTableFile)
         readAddressTable(addressTableFile);
 
-    AddressTable& addressTable = *this->addressTable; // magic to hide the '*' from the name of the watch below
-    WATCH_MAP(addressTable);
+    WATCH(numEntries);
+    WATCH_VECTOR(entries);
 }
 
 /**
@@ -79,22 +81,88 @@ void MACAddressTable::handleMessage(cMessage *)
     throw cRuntimeError("This module doesn't process messages");
 }
 
-/*
- * getTableForVid
- * Returns a MAC Address Table for a specified VLAN ID
- * or NULL pointer if it is not found
- */
+int MACAddressTable::findSlot(const MACAddress& address, unsigned int vid) const
+{
+    uint64 key = makeKey(address, vid);
+    return table.findSlot(hashKey(key), MatchesKey(key));
+}
+
+int MACAddressTable::insertEntry(const MACAddress& address, unsigned int vid, int portno, simtime_t insertionTime)
+{
+    int index;
+    if (freeList != -1)
+    {
+        index = freeList;
+        freeList = entries[index].next;
+    }
+    else
+    {
+        index = entries.size();
+        entries.push_back(AddressEntry());
+    }
+    AddressEntry& entry = entries[index];
+    entry.vid = vid;
+    entry.portno = portno;
+    entry.insertionTime = insertionTime;
+    entry.address = address;
+    linkAgingList(index);
+    table.insert(EntryRef(makeKey(address, vid), index));
+    numEntries++;
+    return index;
+}
+
+void MACAddressTable::removeSlot(int slot)
+{
+    int index = table.at(slot).entry;
+    unlinkAgingList(index);
+    AddressEntry& entry = entries[index];
+    entry.portno = -1;
+    entry.prev = -1;
+    entry.next = freeList;
+    freeList = index;
+    numEntries--;
+    table.removeSlot(slot);
+}
+
+void MACAddressTable::linkAgingList(int index)
+{
+    // entries are normally inserted with the current time, i.e. at the tail;
+    // only preloaded entries may have to be placed further ahead
+    AddressEntry& entry = entries[index];
+    int prev = agingTail;
+    while (prev != -1 && entries[prev].insertionTime > entry.insertionTime)
+        prev = entries[prev].prev;
+    int next = (prev == -1) ? agingHead : entries[prev].next;
+    entry.prev = prev;
+    entry.next = next;
+    if (prev == -1)
+        agingHead = index;
+    else
+        entries[prev].next = index;
+    if (next == -1)
+        agingTail = index;
+    else
+        entries[next].prev = index;
+}
+
+void MACAddressTable::unlinkAgingList(int index)
+{
+    AddressEntry& entry = entries[index];
+    if (entry.prev == -1)
+        agingHead = entry.next;
+    else
+        entries[entry.prev].next = entry.next;
+    if (entry.next == -1)
+        agingTail = entry.prev;
+    else
+        entries[entry.next].prev = entry.prev;
+}
 
-MACAddressTable::AddressTable * MACAddressTable::getTableForVid(unsigned int vid)
+void MACAddressTable::refreshEntry(int index, simtime_t insertionTime)
 {
-    if (vid == 0)
-        return addressTable;
-
-    MACAddressTable::VlanAddressTable::iterator iter;
-    iter = vlanAddressTable.find(vid);
-    if (iter != vlanAddressTable.end())
-        return iter->second;
-    return NULL;
+    unlinkAgingList(index);
+    entries[index].insertionTime = insertionTime;
+    linkAgingList(index);
 }
 
 /*
@@ -107,26 +175,22 @@ int MACAddressTable::getPortForAddress(MACAddress& address, unsigned int vid)
 {
     Enter_Method("MACAddressTable::getPortForAddress()");
 
-    AddressTable * table = getTableForVid(vid);
-    // VLAN ID vid does not exist
-    if (table == NULL)
-        return -1;
-
-    AddressTable::iterator iter = table->find(address);
+    int slot = findSlot(address, vid);
 
-    if (iter == table->end())
+    if (slot == -1)
     {
         // not found
         return -1;
     }
-    if (iter->second.insertionTime + agingTime <= simTime())
+    AddressEntry& entry = entries[table.at(slot).entry];
+    if (isAged(entry))
     {
         // don't use (and throw out) aged entries
-        EV<< "Ignoring and deleting aged entry: "<< iter->first << " --> port" << iter->second.portno << "\n";
-        table->erase(iter);
+        EV<< "Ignoring and deleting aged entry: "<< entry.address << " --> port" << entry.portno << "\n";
+        removeSlot(slot);
         return -1;
     }
-    return iter->second.portno;
+    return entry.portno;
 }
 
 /*
@@ -140,40 +204,24 @@ bool MACAddressTable::updateTableWithAddress(int portno, MACAddress& address, un
     if (address.isBroadcast())
         return false;
 
-    AddressTable::iterator iter;
-    AddressTable * table = getTableForVid(vid);
-
-    if (table == NULL)
-    {
-        // MAC Address Table does not exist for VLAN ID vid, so we create it
-        table = new AddressTable();
-
-        // set 'the addressTable' to VLAN ID 0
-        if (vid == 0)
-            addressTable = table;
-
-        vlanAddressTable[vid] = table;
-        iter = table->end();
-    }
-    else
-        iter = table->find(address);
+    int slot = findSlot(address, vid);
 
-    if (iter == table->end())
+    if (slot == -1)
     {
         removeAgedEntriesIfNeeded();
 
         // Add entry to table
         EV<< "Adding entry to Address Table: "<< address << " --> port" << portno << "\n";
-        (*table)[address] = AddressEntry(vid,portno,simTime());
+        insertEntry(address, vid, portno, simTime());
         return false;
     }
     else
     {
         // Update existing entry
         EV << "Updating entry in Address Table: "<< address << " --> port" << portno << "\n";
-        AddressEntry& entry = iter->second;
-        entry.insertionTime = simTime();
-        entry.portno = portno;
+        int index = table.at(slot).entry;
+        entries[index].portno = portno;
+        refreshEntry(index, simTime());
     }
     return true;
 }
@@ -185,16 +233,12 @@ bool MACAddressTable::updateTableWithAddress(int portno, MACAddress& address, un
 void MACAddressTable::flush(int portno)
 {
     Enter_Method("MACAddressTable::flush():  Clearing gate %d cache", portno);
-    for (VlanAddressTable::iterator i = vlanAddressTable.begin(); i != vlanAddressTable.end(); i++)
+    for (int index = agingHead; index != -1;)
     {
-        AddressTable * table = i->second;
-        for (AddressTable::iterator j = table->begin(); j != table->end();)
-        {
-            AddressTable::iterator cur = j++;
-            if (cur->second.portno == portno)
-                table->erase(cur);
-        }
-
+        int cur = index;
+        index = entries[index].next; // cur will be unlinked by removeEntry()
+        if (entries[cur].portno == portno)
+            removeEntry(cur);
     }
 }
 /*
@@ -205,62 +249,46 @@ void MACAddressTable::printState()
 {
     EV<< endl << "MAC Address Table" << endl;
     EV << "VLAN ID    MAC    Port    Inserted" << endl;
-    for (VlanAddressTable::iterator i = vlanAddressTable.begin(); i != vlanAddressTable.end(); i++)
+    for (int index = agingHead; index != -1; index = entries[index].next)
     {
-        AddressTable * table = i->second;
-        for (AddressTable::iterator j = table->begin(); j != table->end(); j++)
-        EV << j->second.vid << "   " << j->first << "   " << j->second.portno << "   " << j->second.insertionTime << endl;
+        const AddressEntry& entry = entries[index];
+        EV << entry.vid << "   " << entry.address << "   " << entry.portno << "   " << entry.insertionTime << endl;
     }
 
 }
 
 void MACAddressTable::copyTable(int portA, int portB)
 {
-    for (VlanAddressTable::iterator i = vlanAddressTable.begin(); i != vlanAddressTable.end(); i++)
-    {
-        AddressTable * table = i->second;
-        for (AddressTable::iterator j = table->begin(); j != table->end(); j++)
-            if (j->second.portno == portA)
-                j->second.portno = portB;
-    }
+    for (int index = agingHead; index != -1; index = entries[index].next)
+        if (entries[index].portno == portA)
+            entries[index].portno = portB;
 }
 
 void MACAddressTable::removeAgedEntriesFromVlan(unsigned int vid)
 {
-    AddressTable * table = getTableForVid(vid);
-    if (table == NULL)
-        return;
-    // TODO: this part could be factored out
-    for (AddressTable::iterator iter = table->begin(); iter != table->end();)
+    // aged entries form a prefix of the aging list
+    for (int index = agingHead; index != -1 && isAged(entries[index]);)
     {
-        AddressTable::iterator cur = iter++; // iter will get invalidated after erase()
-        AddressEntry& entry = cur->second;
-        if (entry.insertionTime + agingTime <= simTime())
+        int cur = index;
+        index = entries[index].next; // cur will be unlinked by removeEntry()
+        AddressEntry& entry = entries[cur];
+        if (entry.vid == vid)
         {
             EV<< "Removing aged entry from Address Table: " <<
-            cur->first << " --> port" << cur->second.portno << "\n";
-            table->erase(cur);
+            entry.address << " --> port" << entry.portno << "\n";
+            removeEntry(cur);
         }
     }
 }
 
 void MACAddressTable::removeAgedEntriesFromAllVlans()
 {
-    for (VlanAddressTable::iterator i = vlanAddressTable.begin(); i != vlanAddressTable.end(); i++)
+    while (agingHead != -1 && isAged(entries[agingHead]))
     {
-        AddressTable * table = i->second;
-        // TODO: this part could be factored out
-        for (AddressTable::iterator j = table->begin(); j != table->end();)
-        {
-            AddressTable::iterator cur = j++; // iter will get invalidated after erase()
-            AddressEntry& entry = cur->second;
-            if (entry.insertionTime + agingTime <= simTime())
-            {
-                EV<< "Removing aged entry from Address Table: " <<
-                cur->first << " --> port" << cur->second.portno << "\n";
-                table->erase(cur);
-            }
-        }
+        AddressEntry& entry = entries[agingHead];
+        EV<< "Removing aged entry from Address Table: " <<
+        entry.address << " --> port" << entry.portno << "\n";
+        removeEntry(agingHead);
     }
 }
 
@@ -316,17 +344,18 @@ void MACAddressTable::readAddressTable(const char* fileName)
             error("line %d invalid in address table file `%s'", lineno, fileName);
 
         // Create an entry with address and portno and insert into table
-        AddressEntry entry(atoi(vlanID), atoi(portno), 0);
-        AddressTable * table = getTableForVid(entry.vid);
-
-        if(table == NULL)
+        MACAddress address(hexaddress);
+        unsigned int vid = atoi(vlanID);
+        int slot = findSlot(address, vid);
+        if (slot == -1)
+            insertEntry(address, vid, atoi(portno), 0);
+        else
         {
-            table = new AddressTable();
-            vlanAddressTable[entry.vid] = table;
+            int index = table.at(slot).entry;
+            entries[index].portno = atoi(portno);
+            refreshEntry(index, 0);
         }
 
-        (*table)[MACAddress(hexaddress)] = entry;
-
         // Garbage collection before next iteration
         delete [] line;
     }
@@ -335,17 +364,14 @@ void MACAddressTable::readAddressTable(const char* fileName)
 
 void MACAddressTable::clearTable()
 {
-    for (VlanAddressTable::iterator iter = vlanAddressTable.begin(); iter != vlanAddressTable.end(); iter++)
-        delete iter->second;
-
-    vlanAddressTable.clear();
-    addressTable = NULL;
+    entries.clear();
+    table.clear();
+    numEntries = 0;
+    freeList = agingHead = agingTail = -1;
 }
 
 MACAddressTable::~MACAddressTable()
 {
-    for (VlanAddressTable::iterator iter = vlanAddressTable.begin(); iter != vlanAddressTable.end(); iter++)
-        delete iter->second;
 }
 void MACAddressTable::setAgingTime(simtime_t agingTime)
 {
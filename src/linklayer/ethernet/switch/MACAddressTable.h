@@ -17,11 +17,20 @@
 #ifndef __INET_MACADDRESSTABLE_H_
 #define __INET_MACADDRESSTABLE_H_
 
+#include <vector>
+
 #include "MACAddress.h"
 #include "IMACAddressTable.h"
+#include "OpenHashTable.h"
 
 /**
  * This module handles the mapping between ports and MAC addresses. See the NED definition for details.
+ *
+ * Entries of all VLANs are indexed by a single OpenHashTable keyed by
+ * (VLAN ID, MAC address), so lookups and updates take constant time regardless
+ * of the number of learned addresses. Entries are also chained into a list
+ * ordered by insertion time: refreshed entries are moved to its tail, aged
+ * entries are always found at its head, so aging out an entry is O(1) too.
  */
 class MACAddressTable : public cSimpleModule, public IMACAddressTable
 {
@@ -29,37 +38,75 @@ class MACAddressTable : public cSimpleModule, public IMACAddressTable
         struct AddressEntry
         {
                 unsigned int vid;           // VLAN ID
-                int portno;                 // Input port
+                int portno;                 // Input port, -1 for unused entries
                 simtime_t insertionTime;    // Arrival time of Lookup Address Table entry
-                AddressEntry() : vid(0) { }
-                AddressEntry(unsigned int vid, int portno, simtime_t insertionTime) :
-                        vid(vid), portno(portno), insertionTime(insertionTime) { }
+                MACAddress address;
+                int prev, next;             // neighbours in the aging list (next also links the free list)
+                AddressEntry() : vid(0), portno(-1), prev(-1), next(-1) { }
         };
         friend std::ostream& operator<<(std::ostream& os, const AddressEntry& entry);
 
-        struct MAC_compare
+        struct EntryRef
         {
-            bool operator()(const MACAddress& u1, const MACAddress& u2) const {return u1.compareTo(u2) < 0;}
+                uint64 key;                 // see makeKey()
+                int entry;                  // index into entries
+                EntryRef() : key(0), entry(-1) { }
+                EntryRef(uint64 key, int entry) : key(key), entry(entry) { }
         };
 
+        struct EntryRefHash
+        {
+                unsigned int operator()(const EntryRef& ref) const { return hashKey(ref.key); }
+        };
 
-        typedef std::map<MACAddress, AddressEntry, MAC_compare> AddressTable;
-        typedef std::map<unsigned int, AddressTable*> VlanAddressTable;
+        struct MatchesKey
+        {
+                uint64 key;
+                MatchesKey(uint64 key) : key(key) { }
+                bool operator()(const EntryRef& ref) const { return ref.key == key; }
+        };
 
         simtime_t agingTime;                // Max idle time for address table entries
         simtime_t lastPurge;                // Time of the last call of removeAgedEntriesFromAllVlans()
-        AddressTable * addressTable;        // VLAN-unaware address lookup (vid = 0)
-        VlanAddressTable vlanAddressTable;  // VLAN-aware address lookup
+        std::vector<AddressEntry> entries;  // entry storage, indices are stable
+        OpenHashTable<EntryRef, EntryRefHash> table;  // index of the used entries
+        int numEntries;                     // number of used entries
+        int freeList;                       // first unused entry, or -1
+        int agingHead;                      // oldest entry, or -1
+        int agingTail;                      // most recently inserted or refreshed entry, or -1
 
     protected:
 
         virtual void initialize();
         virtual void handleMessage(cMessage *msg);
 
+        static uint64 makeKey(const MACAddress& address, unsigned int vid) { return address.getInt() | ((uint64)vid << 48); }
+        static unsigned int hashKey(uint64 key) { return (unsigned int)mixHash(key); }
+
+        /**
+         * Returns the table slot that refers to the entry of the address, or -1.
+         */
+        int findSlot(const MACAddress& address, unsigned int vid) const;
+
+        /**
+         * Creates a new entry (the address must not be in the table yet) and returns its index.
+         */
+        int insertEntry(const MACAddress& address, unsigned int vid, int portno, simtime_t insertionTime);
+
         /**
-         * @brief Returns a MAC Address Table for a specified VLAN ID
+         * Deletes the entry referred to by the given table slot.
          */
-        AddressTable * getTableForVid(unsigned int vid);
+        void removeSlot(int slot);
+        void removeEntry(int index) { removeSlot(findSlot(entries[index].address, entries[index].vid)); }
+
+        /**
+         * Sets the insertion time of the entry and moves it to its place in the aging list.
+         */
+        void refreshEntry(int index, simtime_t insertionTime);
+
+        void linkAgingList(int index);
+        void unlinkAgingList(int index);
+        bool isAged(const AddressEntry& entry) const { return entry.insertionTime + agingTime <= simTime(); }
 
     public:
 
@@ -120,7 +167,7 @@ class MACAddressTable : public cSimpleModule, public IMACAddressTable
         virtual void readAddressTable(const char * fileName);
 
         /**
-         * For lifecycle: clears all entries from the vlanAddressTable.
+         * For lifecycle: clears all entries from the address table.
          */
         virtual void clearTable();
 
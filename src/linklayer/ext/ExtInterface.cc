@@ -31,9 +31,14 @@
 #include "InterfaceEntry.h"
 #include "InterfaceTable.h"
 #include "InterfaceTableAccess.h"
+#include "IPv4InterfaceData.h"
 #include "IPv4Serializer.h"
 #include "opp_utils.h"
 
+#include <headers/ethernet.h>
+
+#define ARP_PACKET_BYTES 28
+
 
 Define_Module(ExtInterface);
 
@@ -45,7 +50,25 @@ void ExtInterface::initialize(int stage)
     // subscribe at scheduler for external messages
     if (stage == 0)
     {
-        if (dynamic_cast<cSocketRTScheduler *>(simulation.getScheduler()) != NULL)
+        rtScheduler = NULL;
+        ethScheduler = NULL;
+        ethInterfaceId = -1;
+        if (dynamic_cast<cEthernetRTScheduler *>(simulation.getScheduler()) != NULL)
+        {
+            ethScheduler = check_and_cast<cEthernetRTScheduler *>(simulation.getScheduler());
+            device = par("device");
+            const char *filter = par("filterString");
+            ethInterfaceId = ethScheduler->setInterfaceModule(this, device, filter, par("tap").boolValue());
+
+            const char *addressString = par("address");
+            if (!strcmp(addressString, "auto"))
+                address = MACAddress::generateAutoAddress();
+            else
+                address.setAddress(addressString);
+            peerAddress.setBroadcast();
+            connected = true;
+        }
+        else if (dynamic_cast<cSocketRTScheduler *>(simulation.getScheduler()) != NULL)
         {
             rtScheduler = check_and_cast<cSocketRTScheduler *>(simulation.getScheduler());
             //device = ev.config()->getAsString("Capture", "device", "lo0");
@@ -90,6 +113,8 @@ InterfaceEntry *ExtInterface::createInterfaceEntry()
     e->setName(OPP_Global::stripnonalnum(getFullName()).c_str());
 
     e->setMtu(par("mtu"));
+    if (ethScheduler)
+        e->setMACAddress(address);
     e->setMulticast(true);
     e->setPointToPoint(true);
 
@@ -104,7 +129,12 @@ void ExtInterface::handleMessage(cMessage *msg)
         return;
     }
 
-    if (dynamic_cast<ExtFrame *>(msg) != NULL)
+    if (dynamic_cast<ExtFrame *>(msg) != NULL && ethScheduler)
+    {
+        // incoming Ethernet frame from wire
+        handleFrameFromWire(check_and_cast<ExtFrame *>(msg));
+    }
+    else if (dynamic_cast<ExtFrame *>(msg) != NULL)
     {
         // incoming real packet from wire (captured by pcap)
         uint32 packetLength;
@@ -142,7 +172,19 @@ void ExtInterface::handleMessage(cMessage *msg)
             return;
         }
 
-        if (connected)
+        if (connected && ethScheduler)
+        {
+            EV << "Delivering an IPv4 packet from "
+               << ipPacket->getSrcAddress()
+               << " to "
+               << ipPacket->getDestAddress()
+               << " and length of "
+               << ipPacket->getByteLength()
+               << " bytes to " << peerAddress << ".\n";
+            sendFrameToWire(ipPacket);
+            numSent++;
+        }
+        else if (connected)
         {
             struct sockaddr_in addr;
             addr.sin_family = AF_INET;
@@ -173,6 +215,99 @@ void ExtInterface::handleMessage(cMessage *msg)
         updateDisplayString();
 }
 
+void ExtInterface::handleFrameFromWire(ExtFrame *frame)
+{
+    uint32 frameLength = frame->getDataArraySize();
+    if (frameLength < ETHER_HDR_LEN || frameLength > sizeof(buffer))
+    {
+        EV << "Dropping frame with invalid length " << frameLength << ".\n";
+        numDropped++;
+        return;
+    }
+    for (uint32 i=0; i < frameLength; i++)
+        buffer[i] = frame->getData(i);
+
+    struct ether_header *ethernetHeader = (struct ether_header *)buffer;
+    MACAddress dest, src;
+    dest.setAddressBytes(ethernetHeader->ether_dhost);
+    src.setAddressBytes(ethernetHeader->ether_shost);
+    if (dest != address && !dest.isMulticast())
+        return;  // not for us (isMulticast() includes broadcast)
+
+    switch (ntohs(ethernetHeader->ether_type))
+    {
+        case ETHERTYPE_ARP:
+            handleArpRequest(buffer + ETHER_HDR_LEN, frameLength - ETHER_HDR_LEN);
+            break;
+
+        case ETHERTYPE_IP:
+        {
+            peerAddress = src;
+            IPv4Datagram *ipPacket = new IPv4Datagram("ip-from-wire");
+            IPv4Serializer().parse(buffer + ETHER_HDR_LEN, frameLength - ETHER_HDR_LEN, ipPacket);
+            EV << "Delivering an IPv4 packet from "
+               << ipPacket->getSrcAddress()
+               << " to "
+               << ipPacket->getDestAddress()
+               << " and length of "
+               << ipPacket->getByteLength()
+               << " bytes to IPv4 layer.\n";
+            send(ipPacket, "upperLayerOut");
+            numRcvd++;
+            break;
+        }
+
+        default:
+            EV << "Ignoring frame with EtherType " << ntohs(ethernetHeader->ether_type) << ".\n";
+            break;
+    }
+}
+
+void ExtInterface::handleArpRequest(const uint8 *arp, uint32 length)
+{
+    // answer requests for our own IPv4 address, so that the host can send
+    // to us, or route through us; the IPv4 layer itself does not do ARP
+    // on this (point-to-point) interface
+    if (length < ARP_PACKET_BYTES)
+        return;
+    bool isIPv4EthernetRequest = arp[0] == 0 && arp[1] == 1 && arp[2] == 0x08 && arp[3] == 0x00
+            && arp[4] == 6 && arp[5] == 4 && arp[6] == 0 && arp[7] == 1;
+    if (!isIPv4EthernetRequest)
+        return;
+    IPv4Address target(arp[24], arp[25], arp[26], arp[27]);
+    IPv4InterfaceData *ipv4Data = interfaceEntry ? interfaceEntry->ipv4Data() : NULL;
+    if (!ipv4Data || target != ipv4Data->getIPAddress())
+        return;
+
+    uint8 reply[ETHER_MIN_LEN - ETHER_CRC_LEN];
+    memset(reply, 0, sizeof(reply));
+    struct ether_header *ethernetHeader = (struct ether_header *)reply;
+    memcpy(ethernetHeader->ether_dhost, arp + 8, ETHER_ADDR_LEN);
+    address.getAddressBytes(ethernetHeader->ether_shost);
+    ethernetHeader->ether_type = htons(ETHERTYPE_ARP);
+
+    uint8 *arpReply = reply + ETHER_HDR_LEN;
+    memcpy(arpReply, arp, 6);                      // hardware and protocol type and length
+    arpReply[7] = 2;                               // reply
+    address.getAddressBytes(arpReply + 8);         // sender: us
+    memcpy(arpReply + 14, arp + 24, 4);
+    memcpy(arpReply + 18, arp + 8, 10);            // target: the requester
+    ethScheduler->sendFrame(ethInterfaceId, reply, sizeof(reply));
+
+    peerAddress.setAddressBytes((unsigned char *)arp + 8);
+    EV << "Answered ARP request for " << target << " from " << peerAddress << ".\n";
+}
+
+void ExtInterface::sendFrameToWire(IPv4Datagram *ipPacket)
+{
+    struct ether_header *ethernetHeader = (struct ether_header *)buffer;
+    peerAddress.getAddressBytes(ethernetHeader->ether_dhost);
+    address.getAddressBytes(ethernetHeader->ether_shost);
+    ethernetHeader->ether_type = htons(ETHERTYPE_IP);
+    int32 packetLength = IPv4Serializer().serialize(ipPacket, buffer + ETHER_HDR_LEN, sizeof(buffer) - ETHER_HDR_LEN);
+    ethScheduler->sendFrame(ethInterfaceId, buffer, ETHER_HDR_LEN + packetLength);
+}
+
 void ExtInterface::displayBusy()
 {
     getDisplayString().setTagArg("i", 1, "yellow");
@@ -30,10 +30,13 @@
 
 #include "MACBase.h"
 #include "ExtFrame_m.h"
+#include "MACAddress.h"
 #include "cSocketRTScheduler.h"
+#include "cEthernetRTScheduler.h"
 
 // Forward declarations:
 class InterfaceEntry;
+class IPv4Datagram;
 
 
 /**
@@ -41,7 +44,8 @@ class InterfaceEntry;
  * on the host running the simulation. Suitable for hardware-in-the-loop
  * simulations.
  *
- * Requires cSocketRTScheduler to be configured as scheduler in omnetpp.ini.
+ * Requires cSocketRTScheduler or cEthernetRTScheduler to be configured as
+ * scheduler in omnetpp.ini.
  *
  * See NED file for more details.
  */
@@ -60,7 +64,17 @@ class ExtInterface : public MACBase
     // access to real network interface via Scheduler class:
     cSocketRTScheduler *rtScheduler;
 
+    // Ethernet-level access via cEthernetRTScheduler
+    cEthernetRTScheduler *ethScheduler;
+    int ethInterfaceId;
+    MACAddress address;       // our MAC address
+    MACAddress peerAddress;   // learned from incoming frames, broadcast until then
+
   protected:
+    void handleFrameFromWire(ExtFrame *frame);
+    void handleArpRequest(const uint8 *arp, uint32 length);
+    void sendFrameToWire(IPv4Datagram *ipPacket);
+
     void displayBusy();
     void displayIdle();
     void updateDisplayString();
@@ -0,0 +1,539 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+
+#include "cEthernetRTScheduler.h"
+
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <linux/if_tun.h>
+#include <sys/poll.h>
+#include <sys/timerfd.h>
+#ifdef HAVE_PCAP
+// prevent pcap.h to redefine int8_t,... types
+#include "bsdint.h"
+#define HAVE_U_INT8_T
+#define HAVE_U_INT16_T
+#define HAVE_U_INT32_T
+#define HAVE_U_INT64_T
+#include <pcap.h>
+#endif
+#endif
+
+#define MAX_WAIT_USEC 10000  /* longest wait without calling ev.idle() */
+#define TIMER_EVENT_ID 0xffffffffu  /* epoll data of the timerfd, interfaces use their index */
+#define SOCKET_BUFFER_SIZE (8 * 1024 * 1024)
+
+Register_GlobalConfigOption(CFGID_ETHERNETRTSCHEDULER_BATCH_SIZE, "ethernetrtscheduler-batch-size", CFG_INT, "32", "cEthernetRTScheduler: the maximum number of frames received or sent with one system call");
+
+Register_Class(cEthernetRTScheduler);
+
+
+cEthernetRTScheduler::cEthernetRTScheduler() : cScheduler()
+{
+    batchSize = 0;
+    epollFd = -1;
+    timerFd = -1;
+}
+
+cEthernetRTScheduler::~cEthernetRTScheduler()
+{
+}
+
+void cEthernetRTScheduler::startRun()
+{
+    gettimeofday(&baseTime, NULL);
+
+#ifdef __linux__
+    batchSize = ev.getConfig()->getAsInt(CFGID_ETHERNETRTSCHEDULER_BATCH_SIZE);
+    if (batchSize < 1)
+        throw cRuntimeError("cEthernetRTScheduler: ethernetrtscheduler-batch-size must be positive");
+    rxBuffer.resize(batchSize * MAX_FRAME_SIZE);
+    rxLengths.resize(batchSize);
+    rxMessages.resize(batchSize);
+    rxIovecs.resize(batchSize);
+    rxAddresses.resize(batchSize);
+    txMessages.resize(batchSize);
+    txIovecs.resize(batchSize);
+    for (int i = 0; i < batchSize; i++)
+    {
+        rxIovecs[i].iov_base = &rxBuffer[i * MAX_FRAME_SIZE];
+        rxIovecs[i].iov_len = MAX_FRAME_SIZE;
+    }
+    epollFd = epoll_create(16);
+    if (epollFd < 0)
+        throw cRuntimeError("cEthernetRTScheduler: Cannot create epoll instance: %s", strerror(errno));
+
+    // epoll_wait() only takes timeouts in milliseconds; deadlines are set on a timerfd instead
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    if (timerFd < 0)
+        throw cRuntimeError("cEthernetRTScheduler: Cannot create timerfd: %s", strerror(errno));
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u32 = TIMER_EVENT_ID;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &event) < 0)
+        throw cRuntimeError("cEthernetRTScheduler: Cannot add timerfd to epoll instance: %s", strerror(errno));
+#else
+    throw cRuntimeError("cEthernetRTScheduler: only supported on Linux");
+#endif
+}
+
+void cEthernetRTScheduler::endRun()
+{
+#ifdef __linux__
+    flushAll();
+    for (unsigned int i = 0; i < interfaces.size(); i++)
+    {
+        Interface& ifc = interfaces[i];
+        EV << ifc.module->getFullPath() << ": Received Frames: " << ifc.numReceived << " in " << ifc.numReceiveCalls << " calls"
+           << ", Sent Frames: " << ifc.numSent << " in " << ifc.numSendCalls << " calls"
+           << ", Send Errors: " << ifc.numSendErrors << ".\n";
+        close(ifc.fd);
+    }
+    interfaces.clear();
+    rxBuffer.clear();
+    if (timerFd >= 0)
+        close(timerFd);
+    timerFd = -1;
+    if (epollFd >= 0)
+        close(epollFd);
+    epollFd = -1;
+#endif
+}
+
+void cEthernetRTScheduler::executionResumed()
+{
+    gettimeofday(&baseTime, NULL);
+    baseTime = timeval_substract(baseTime, sim->getSimTime().dbl());
+}
+
+int cEthernetRTScheduler::setInterfaceModule(cModule *mod, const char *dev, const char *filter, bool tap)
+{
+#ifdef __linux__
+    if (!mod || !dev || !filter)
+        throw cRuntimeError("cEthernetRTScheduler::setInterfaceModule(): arguments must be non-NULL");
+
+    Interface ifc;
+    ifc.module = mod;
+    ifc.device = dev;
+    ifc.tap = tap;
+    if (tap)
+        openTap(ifc, filter);
+    else
+        openPacketSocket(ifc, filter);
+
+    if (fcntl(ifc.fd, F_SETFL, fcntl(ifc.fd, F_GETFL) | O_NONBLOCK) < 0)
+        throw cRuntimeError("cEthernetRTScheduler::setInterfaceModule(): Cannot put %s into non-blocking mode: %s", dev, strerror(errno));
+
+    int id = interfaces.size();
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u32 = id;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, ifc.fd, &event) < 0)
+        throw cRuntimeError("cEthernetRTScheduler::setInterfaceModule(): Cannot add %s to epoll instance: %s", dev, strerror(errno));
+
+    interfaces.push_back(ifc);
+    interfaces.back().txBuffer.resize(batchSize * MAX_FRAME_SIZE);
+    interfaces.back().txLengths.reserve(batchSize);
+
+    EV << "Opened " << (tap ? "TAP device " : "packet socket on ") << dev << " with filter " << filter << ".\n";
+    return id;
+#else
+    throw cRuntimeError("cEthernetRTScheduler::setInterfaceModule(): only supported on Linux");
+#endif
+}
+
+#ifdef __linux__
+
+void cEthernetRTScheduler::openPacketSocket(Interface& ifc, const char *filter)
+{
+    // protocol 0: don't receive anything until the filter is attached and the socket is bound
+    ifc.fd = socket(AF_PACKET, SOCK_RAW, 0);
+    if (ifc.fd < 0)
+        throw cRuntimeError("cEthernetRTScheduler: Root privileges needed");
+
+    unsigned int ifindex = if_nametoindex(ifc.device.c_str());
+    if (ifindex == 0)
+        throw cRuntimeError("cEthernetRTScheduler::setInterfaceModule(): No such interface: %s", ifc.device.c_str());
+
+    attachFilter(ifc, filter);
+
+    // room for bursts that arrive while the simulation is busy
+    int bufferSize = SOCKET_BUFFER_SIZE;
+    if (setsockopt(ifc.fd, SOL_SOCKET, SO_RCVBUFFORCE, &bufferSize, sizeof(bufferSize)) < 0)
+        setsockopt(ifc.fd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+    if (setsockopt(ifc.fd, SOL_SOCKET, SO_SNDBUFFORCE, &bufferSize, sizeof(bufferSize)) < 0)
+        setsockopt(ifc.fd, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+
+#ifdef PACKET_IGNORE_OUTGOING
+    // not supported before Linux 4.20; outgoing frames are also skipped in receiveBatch()
+    int on = 1;
+    setsockopt(ifc.fd, SOL_PACKET, PACKET_IGNORE_OUTGOING, &on, sizeof(on));
+#endif
+
+    struct sockaddr_ll addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_ALL);
+    addr.sll_ifindex = ifindex;
+    if (bind(ifc.fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+        throw cRuntimeError("cEthernetRTScheduler::setInterfaceModule(): Cannot bind packet socket to %s: %s", ifc.device.c_str(), strerror(errno));
+}
+
+void cEthernetRTScheduler::openTap(Interface& ifc, const char *filter)
+{
+    ifc.fd = open("/dev/net/tun", O_RDWR);
+    if (ifc.fd < 0)
+        throw cRuntimeError("cEthernetRTScheduler: Cannot open /dev/net/tun: %s", strerror(errno));
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+    strncpy(ifr.ifr_name, ifc.device.c_str(), IFNAMSIZ - 1);
+    if (ioctl(ifc.fd, TUNSETIFF, &ifr) < 0)
+        throw cRuntimeError("cEthernetRTScheduler::setInterfaceModule(): Cannot attach to TAP device %s: %s", ifc.device.c_str(), strerror(errno));
+
+    attachFilter(ifc, filter);
+}
+
+void cEthernetRTScheduler::attachFilter(Interface& ifc, const char *filter)
+{
+    if (!*filter)
+        return;
+#ifdef HAVE_PCAP
+    struct bpf_program fcode;
+    if (pcap_compile_nopcap(MAX_FRAME_SIZE, DLT_EN10MB, &fcode, (char *)filter, 1, 0) < 0)
+        throw cRuntimeError("cEthernetRTScheduler::setInterfaceModule(): Cannot compile filter: %s", filter);
+    struct sock_fprog prog;
+    prog.len = fcode.bf_len;
+    prog.filter = (struct sock_filter *)fcode.bf_insns;
+    int result = ifc.tap ? ioctl(ifc.fd, TUNATTACHFILTER, &prog) : setsockopt(ifc.fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog));
+    int error = errno;
+    pcap_freecode(&fcode);
+    if (result < 0)
+        throw cRuntimeError("cEthernetRTScheduler::setInterfaceModule(): Cannot attach filter to %s: %s", ifc.device.c_str(), strerror(error));
+#else
+    EV << "cEthernetRTScheduler::setInterfaceModule(): code was compiled without pcap support, ignoring filter " << filter << "\n";
+#endif
+}
+
+int cEthernetRTScheduler::receiveBatch(Interface& ifc)
+{
+    int n = 0;
+    if (ifc.tap)
+    {
+        // a TAP device delivers one frame per read() call
+        for ( ; n < batchSize; n++)
+        {
+            ssize_t length = read(ifc.fd, &rxBuffer[n * MAX_FRAME_SIZE], MAX_FRAME_SIZE);
+            if (length < 0)
+            {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                    throw cRuntimeError("cEthernetRTScheduler: Cannot read from %s: %s", ifc.device.c_str(), strerror(errno));
+                break;
+            }
+            ifc.numReceiveCalls++;
+            rxLengths[n] = length;
+        }
+    }
+    else
+    {
+        for (int i = 0; i < batchSize; i++)
+        {
+            memset(&rxMessages[i], 0, sizeof(rxMessages[i]));
+            rxMessages[i].msg_hdr.msg_name = &rxAddresses[i];
+            rxMessages[i].msg_hdr.msg_namelen = sizeof(rxAddresses[i]);
+            rxMessages[i].msg_hdr.msg_iov = &rxIovecs[i];
+            rxMessages[i].msg_hdr.msg_iovlen = 1;
+        }
+        n = recvmmsg(ifc.fd, &rxMessages[0], batchSize, MSG_DONTWAIT, NULL);
+        if (n < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                throw cRuntimeError("cEthernetRTScheduler: Cannot receive from %s: %s", ifc.device.c_str(), strerror(errno));
+            return 0;
+        }
+        ifc.numReceiveCalls++;
+        for (int i = 0; i < n; i++)
+        {
+            // skip our own frames, and truncated ones
+            bool skip = rxAddresses[i].sll_pkttype == PACKET_OUTGOING || (rxMessages[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+            rxLengths[i] = skip ? 0 : rxMessages[i].msg_len;
+        }
+    }
+    if (n == 0)
+        return 0;
+
+    // all frames of the batch get the same arrival time
+    timeval curTime;
+    gettimeofday(&curTime, NULL);
+    curTime = timeval_substract(curTime, baseTime);
+    simtime_t t = curTime.tv_sec + curTime.tv_usec*1e-6;
+    if (t < sim->getSimTime())
+        t = sim->getSimTime();
+
+    int numDelivered = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (rxLengths[i] == 0)
+            continue;
+        deliverFrame(ifc, &rxBuffer[i * MAX_FRAME_SIZE], rxLengths[i], t);
+        numDelivered++;
+    }
+    return numDelivered;
+}
+
+void cEthernetRTScheduler::flush(Interface& ifc)
+{
+    int count = ifc.txLengths.size();
+    int done = 0;
+    if (ifc.tap)
+    {
+        // a TAP device takes one frame per write() call
+        while (done < count)
+        {
+            ssize_t sent = write(ifc.fd, &ifc.txBuffer[done * MAX_FRAME_SIZE], ifc.txLengths[done]);
+            ifc.numSendCalls++;
+            if (sent < 0 && (errno == EINTR || ((errno == EAGAIN || errno == EWOULDBLOCK) && waitUntilWritable(ifc))))
+                continue;
+            if (sent == (ssize_t)ifc.txLengths[done])
+                ifc.numSent++;
+            else
+            {
+                ifc.numSendErrors++;
+                EV << "Sending of a frame on " << ifc.device << " FAILED! (" << strerror(errno) << ").\n";
+            }
+            done++;
+        }
+    }
+    else
+    {
+        for (int i = 0; i < count; i++)
+        {
+            txIovecs[i].iov_base = &ifc.txBuffer[i * MAX_FRAME_SIZE];
+            txIovecs[i].iov_len = ifc.txLengths[i];
+            memset(&txMessages[i], 0, sizeof(txMessages[i]));
+            txMessages[i].msg_hdr.msg_iov = &txIovecs[i];
+            txMessages[i].msg_hdr.msg_iovlen = 1;
+        }
+        while (done < count)
+        {
+            // sendmmsg() only fails if the first frame could not be sent
+            int sent = sendmmsg(ifc.fd, &txMessages[done], count - done, 0);
+            ifc.numSendCalls++;
+            if (sent < 0 && (errno == EINTR || ((errno == EAGAIN || errno == EWOULDBLOCK) && waitUntilWritable(ifc))))
+                continue;
+            if (sent > 0)
+            {
+                ifc.numSent += sent;
+                done += sent;
+            }
+            else
+            {
+                ifc.numSendErrors++;
+                EV << "Sending of a frame on " << ifc.device << " FAILED! (" << strerror(errno) << ").\n";
+                done++;
+            }
+        }
+    }
+    ifc.txLengths.clear();
+}
+
+bool cEthernetRTScheduler::waitUntilWritable(Interface& ifc)
+{
+    struct pollfd pfd;
+    pfd.fd = ifc.fd;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    return poll(&pfd, 1, MAX_WAIT_USEC / 1000) > 0;
+}
+
+bool cEthernetRTScheduler::receiveWithTimeout(long usec)
+{
+    flushAll();
+
+    // arm the timer with the deadline (this also resets an earlier, unread expiration);
+    // a zero timeout only polls the interfaces
+    if (usec > 0)
+    {
+        struct itimerspec deadline;
+        memset(&deadline, 0, sizeof(deadline));
+        deadline.it_value.tv_sec = usec / 1000000;
+        deadline.it_value.tv_nsec = (usec % 1000000) * 1000;
+        if (timerfd_settime(timerFd, 0, &deadline, NULL) < 0)
+            throw cRuntimeError("cEthernetRTScheduler: timerfd_settime() failed: %s", strerror(errno));
+    }
+
+    struct epoll_event events[16];
+    int n = epoll_wait(epollFd, events, 16, usec > 0 ? -1 : 0);
+    if (n < 0)
+    {
+        if (errno == EINTR)
+            return false;
+        throw cRuntimeError("cEthernetRTScheduler: epoll_wait() failed: %s", strerror(errno));
+    }
+    bool found = false;
+    for (int i = 0; i < n; i++)
+    {
+        if (events[i].data.u32 == TIMER_EVENT_ID)
+        {
+            uint64 expirations;
+            if (read(timerFd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN)
+                throw cRuntimeError("cEthernetRTScheduler: Cannot read timerfd: %s", strerror(errno));
+        }
+        else if (receiveBatch(interfaces[events[i].data.u32]) > 0)
+            found = true;
+    }
+    return found;
+}
+
+#else
+
+void cEthernetRTScheduler::openPacketSocket(Interface& ifc, const char *filter) {}
+void cEthernetRTScheduler::openTap(Interface& ifc, const char *filter) {}
+void cEthernetRTScheduler::attachFilter(Interface& ifc, const char *filter) {}
+int cEthernetRTScheduler::receiveBatch(Interface& ifc) { return 0; }
+void cEthernetRTScheduler::flush(Interface& ifc) {}
+bool cEthernetRTScheduler::waitUntilWritable(Interface& ifc) { return false; }
+bool cEthernetRTScheduler::receiveWithTimeout(long usec) { return false; }
+
+#endif
+
+void cEthernetRTScheduler::deliverFrame(Interface& ifc, const uint8 *buf, uint32 length, simtime_t t)
+{
+    // put the frame from wire into data[] array of ExtFrame
+    ExtFrame *notificationMsg = new ExtFrame("rtEvent");
+    notificationMsg->setDataArraySize(length);
+    for (uint32 i = 0; i < length; i++)
+        notificationMsg->setData(i, buf[i]);
+
+    // signalize new incoming frame to the interface via cMessage
+    notificationMsg->setArrival(ifc.module, -1, t);
+    sim->msgQueue.insert(notificationMsg);
+    ifc.numReceived++;
+}
+
+void cEthernetRTScheduler::flushAll()
+{
+    for (unsigned int i = 0; i < interfaces.size(); i++)
+        if (!interfaces[i].txLengths.empty())
+            flush(interfaces[i]);
+}
+
+void cEthernetRTScheduler::sendFrame(int interfaceId, const uint8 *buf, uint32 numBytes)
+{
+    if (interfaceId < 0 || interfaceId >= (int)interfaces.size())
+        throw cRuntimeError("cEthernetRTScheduler::sendFrame(): invalid interface id %d", interfaceId);
+    if (numBytes > (uint32)MAX_FRAME_SIZE)
+        throw cRuntimeError("cEthernetRTScheduler::sendFrame(): frame too long (%u bytes)", numBytes);
+
+    Interface& ifc = interfaces[interfaceId];
+    memcpy(&ifc.txBuffer[ifc.txLengths.size() * MAX_FRAME_SIZE], buf, numBytes);
+    ifc.txLengths.push_back(numBytes);
+    if ((int)ifc.txLengths.size() == batchSize)
+        flush(ifc);
+}
+
+int cEthernetRTScheduler::receiveUntil(const timeval& targetTime)
+{
+    // wait until targetTime, in chunks of at most MAX_WAIT_USEC
+    // in order to keep UI responsiveness by invoking ev.idle()
+    timeval curTime;
+    gettimeofday(&curTime, NULL);
+    while (timeval_greater(targetTime, curTime))
+    {
+        timeval diffTime = timeval_substract(targetTime, curTime);
+        long usec = diffTime.tv_sec > 0 ? MAX_WAIT_USEC : std::min((long)diffTime.tv_usec, (long)MAX_WAIT_USEC);
+        if (receiveWithTimeout(usec))
+            return 1;
+        if (ev.idle())
+            return -1;
+        gettimeofday(&curTime, NULL);
+    }
+    return 0;
+}
+
+#if OMNETPP_VERSION >= 0x0500
+cEvent *cEthernetRTScheduler::guessNextEvent()
+{
+    return sim->msgQueue.peekFirst();
+}
+cEvent *cEthernetRTScheduler::takeNextEvent()
+#else
+cMessage *cEthernetRTScheduler::getNextEvent()
+#define cEvent cMessage
+#endif
+{
+    timeval targetTime, curTime, diffTime;
+
+    // calculate target time
+    cEvent *event = sim->msgQueue.peekFirst();
+    if (!event)
+    {
+        targetTime.tv_sec = LONG_MAX;
+        targetTime.tv_usec = 0;
+    }
+    else
+    {
+        simtime_t eventSimtime = event->getArrivalTime();
+        targetTime = timeval_add(baseTime, eventSimtime.dbl());
+
+        // frames sent at the current simulation time go out together
+        if (eventSimtime > sim->getSimTime())
+            flushAll();
+    }
+
+    gettimeofday(&curTime, NULL);
+    if (timeval_greater(targetTime, curTime))
+    {
+        int32 status = receiveUntil(targetTime);
+        if (status == -1)
+            return NULL; // interrupted by user
+        if (status == 1)
+            event = sim->msgQueue.peekFirst(); // received something
+    }
+    else
+    {
+        // we're behind -- customized versions of this class may
+        // alert if we're too much behind, whatever that means
+        diffTime = timeval_substract(curTime, targetTime);
+        EV << "We are behind: " << diffTime.tv_sec + diffTime.tv_usec * 1e-6 << " seconds\n";
+    }
+    cEvent *tmp = sim->msgQueue.removeFirst();
+    ASSERT(tmp == event);
+    return event;
+}
+#undef cEvent
+
+#if OMNETPP_VERSION >= 0x0500
+void cEthernetRTScheduler::putBackEvent(cEvent *event)
+{
+    sim->msgQueue.putBackFirst(event);
+}
+#endif
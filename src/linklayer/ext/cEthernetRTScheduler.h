@@ -0,0 +1,173 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __CETHERNETRTSCHEDULER_H__
+#define __CETHERNETRTSCHEDULER_H__
+
+#include <platdep/timeutil.h>
+#include "INETDefs.h"
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <linux/if_packet.h>
+#endif
+
+#include "ExtFrame_m.h"
+
+/**
+ * Real-time scheduler that exchanges complete Ethernet frames with the host,
+ * either through an AF_PACKET socket bound to an existing interface (e.g.
+ * one end of a veth pair, or a physical NIC) or through a TAP device.
+ *
+ * Unlike cSocketRTScheduler, which reads one packet per select() wakeup via
+ * pcap and sends one IPv4 packet per sendto() on a raw IP socket, this
+ * scheduler waits with epoll (with a timerfd for the deadline, so waiting
+ * has microsecond resolution), receives up to "ethernetrtscheduler-batch-size"
+ * frames per recvmmsg() call, and collects outgoing frames and sends them with
+ * one sendmmsg() call per batch. Outgoing frames are flushed when the batch
+ * is full, before the scheduler waits for the wall clock, and before the
+ * simulation time advances, so frames sent at the same simulation time go
+ * out together.
+ *
+ * TAP devices do not support the mmsg calls; for them, all pending frames
+ * are read on each wakeup and written one by one.
+ *
+ * Received frames are delivered to the interface module as ExtFrame messages
+ * containing the whole Ethernet frame. Only available on Linux.
+ */
+class cEthernetRTScheduler : public cScheduler
+{
+    protected:
+        struct Interface
+        {
+            cModule *module;
+            std::string device;
+            bool tap;
+            int fd;
+            std::vector<uint8> txBuffer;     // batchSize slots of MAX_FRAME_SIZE bytes
+            std::vector<uint32> txLengths;   // lengths of the queued frames
+
+            // statistics
+            unsigned long numReceived;
+            unsigned long numReceiveCalls;
+            unsigned long numSent;
+            unsigned long numSendCalls;
+            unsigned long numSendErrors;
+
+            Interface() : module(NULL), tap(false), fd(-1), numReceived(0), numReceiveCalls(0),
+                numSent(0), numSendCalls(0), numSendErrors(0) {}
+        };
+
+        std::vector<Interface> interfaces;
+        std::vector<uint8> rxBuffer;   // batchSize slots of MAX_FRAME_SIZE bytes
+        std::vector<uint32> rxLengths; // lengths of the received frames, 0 for skipped ones
+#ifdef __linux__
+        // argument arrays of recvmmsg() and sendmmsg()
+        std::vector<struct mmsghdr> rxMessages;
+        std::vector<struct iovec> rxIovecs;
+        std::vector<struct sockaddr_ll> rxAddresses;
+        std::vector<struct mmsghdr> txMessages;
+        std::vector<struct iovec> txIovecs;
+#endif
+        int batchSize;
+        int epollFd;
+        int timerFd;   // in the epoll set, armed with the deadline of receiveWithTimeout()
+        timeval baseTime;
+
+        virtual bool receiveWithTimeout(long usec);
+        virtual int receiveUntil(const timeval& targetTime);
+        virtual int receiveBatch(Interface& ifc);
+        virtual void deliverFrame(Interface& ifc, const uint8 *buf, uint32 length, simtime_t t);
+        virtual void flush(Interface& ifc);
+        virtual bool waitUntilWritable(Interface& ifc);
+        virtual void flushAll();
+        virtual void openPacketSocket(Interface& ifc, const char *filter);
+        virtual void openTap(Interface& ifc, const char *filter);
+        virtual void attachFilter(Interface& ifc, const char *filter);
+
+    public:
+        /** Largest frame that can be received or sent */
+        static const int MAX_FRAME_SIZE = 65536;
+
+        /**
+         * Constructor.
+         */
+        cEthernetRTScheduler();
+
+        /**
+         * Destructor.
+         */
+        virtual ~cEthernetRTScheduler();
+
+        /**
+         * Called at the beginning of a simulation run.
+         */
+        virtual void startRun();
+
+        /**
+         * Called at the end of a simulation run.
+         */
+        virtual void endRun();
+
+        /**
+         * Recalculates "base time" from current wall clock time.
+         */
+        virtual void executionResumed();
+
+        /**
+         * To be called from the module which wishes to exchange frames with
+         * the given device. The method must be called from the module's
+         * initialize() function. If tap is true, the TAP device of the given
+         * name is attached to (or created); otherwise an AF_PACKET socket is
+         * bound to the existing interface. If the code was compiled with
+         * pcap support, a non-empty filter is compiled and attached to the
+         * socket or TAP device in the kernel. Returns the id to be passed
+         * to sendFrame().
+         */
+        int setInterfaceModule(cModule *mod, const char *dev, const char *filter, bool tap);
+
+#if OMNETPP_VERSION >= 0x0500
+        /**
+         * Returns the first event in the Future Event Set.
+         */
+        virtual cEvent *guessNextEvent();
+
+        /**
+         * Scheduler function -- it comes from the cScheduler interface.
+         */
+        virtual cEvent *takeNextEvent();
+
+        /**
+         * Scheduler function -- it comes from the cScheduler interface.
+         */
+        virtual void putBackEvent(cEvent *event);
+#else
+        /**
+         * Scheduler function -- it comes from cScheduler interface.
+         */
+        virtual cMessage *getNextEvent();
+#endif
+
+        /**
+         * Queues an Ethernet frame (without FCS) for sending on the given
+         * interface. The frame is copied, so the buffer can be reused.
+         */
+        void sendFrame(int interfaceId, const uint8 *buf, uint32 numBytes);
+};
+
+#endif
+
@@ -0,0 +1,41 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef __INET_IEEE80211FRAME_H
+#define __INET_IEEE80211FRAME_H
+
+#include "Ieee80211Frame_m.h"
+#include "ObjectPool.h"
+
+/**
+ * Represents an 802.11 data frame with SNAP header. More info in the
+ * Ieee80211Frame.msg file (and the documentation generated from it).
+ */
+class INET_API Ieee80211DataFrameWithSNAP : public Ieee80211DataFrameWithSNAP_Base
+{
+  public:
+    Ieee80211DataFrameWithSNAP(const char *name = NULL, int kind = 0) : Ieee80211DataFrameWithSNAP_Base(name, kind) {}
+    Ieee80211DataFrameWithSNAP(const Ieee80211DataFrameWithSNAP& other) : Ieee80211DataFrameWithSNAP_Base(other) {}
+    Ieee80211DataFrameWithSNAP& operator=(const Ieee80211DataFrameWithSNAP& other) {Ieee80211DataFrameWithSNAP_Base::operator=(other); return *this;}
+
+    virtual Ieee80211DataFrameWithSNAP *dup() const {return new Ieee80211DataFrameWithSNAP(*this);}
+
+    INET_POOLED_ALLOCATION(Ieee80211DataFrameWithSNAP);
+};
+
+#endif
@@ -28,7 +28,7 @@
 #include "WifiMode.h"
 #include "WirelessMacBase.h"
 #include "IPassiveQueue.h"
-#include "Ieee80211Frame_m.h"
+#include "Ieee80211Frame.h"
 #include "Ieee80211Consts.h"
 #include "NotificationBoard.h"
 #include "RadioState.h"
@@ -20,7 +20,7 @@
 #include "INETDefs.h"
 
 #include "Ieee80211eClassifier.h"
-#include "Ieee80211Frame_m.h"
+#include "Ieee80211Frame.h"
 #ifdef WITH_IPv4
   #include "IPv4Datagram.h"
   #include "ICMPMessage_m.h"
@@ -30,7 +30,7 @@
   #include "ICMPv6Message_m.h"
 #endif
 #ifdef WITH_UDP
-  #include "UDPPacket_m.h"
+  #include "UDPPacket.h"
 #endif
 #ifdef WITH_TCP_COMMON
   #include "TCPSegment.h"
@@ -0,0 +1,64 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include <algorithm>
+
+#include "Ieee80211BeaconRegistry.h"
+
+#include "Ieee80211MgmtAP.h"
+
+
+Ieee80211BeaconRegistry *Ieee80211BeaconRegistry::inst;
+
+Ieee80211BeaconRegistry *Ieee80211BeaconRegistry::getInstance()
+{
+    if (!inst)
+        inst = new Ieee80211BeaconRegistry;
+    return inst;
+}
+
+void Ieee80211BeaconRegistry::deleteInstance()
+{
+    if (inst)
+    {
+        delete inst;
+        inst = NULL;
+    }
+}
+
+void Ieee80211BeaconRegistry::registerAP(Ieee80211MgmtAP *ap)
+{
+    if (std::find(aps.begin(), aps.end(), ap) == aps.end())
+        aps.push_back(ap);
+}
+
+void Ieee80211BeaconRegistry::unregisterAP(Ieee80211MgmtAP *ap)
+{
+    std::vector<Ieee80211MgmtAP *>::iterator it = std::find(aps.begin(), aps.end(), ap);
+    if (it != aps.end())
+        aps.erase(it);
+}
+
+Ieee80211MgmtAP *Ieee80211BeaconRegistry::findAP(const MACAddress& address) const
+{
+    for (int i = 0; i < (int)aps.size(); i++)
+        if (aps[i]->getAddress() == address)
+            return aps[i];
+    return NULL;
+}
+
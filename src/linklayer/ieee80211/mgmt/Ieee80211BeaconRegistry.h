@@ -0,0 +1,81 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef __INET_IEEE80211BEACONREGISTRY_H
+#define __INET_IEEE80211BEACONREGISTRY_H
+
+#include <vector>
+
+#include "INETDefs.h"
+
+#include "MACAddress.h"
+
+class Ieee80211MgmtAP;
+
+
+/**
+ * Singleton registry of the access points whose beacons are not (or not
+ * only) sent as frames. Such APs (see the beaconMode parameter of
+ * Ieee80211MgmtAP) register themselves while they are operational, and
+ * Ieee80211MgmtSTA takes its scan results from here, computing the received
+ * power from its own radio model instead of receiving beacons.
+ *
+ * The registry only stores pointers; the beacon parameters (SSID, channel,
+ * beacon interval, supported rates) are always read from the AP module,
+ * so they are never out of date.
+ */
+class INET_API Ieee80211BeaconRegistry
+{
+  protected:
+    std::vector<Ieee80211MgmtAP *> aps;
+    static Ieee80211BeaconRegistry *inst;
+    Ieee80211BeaconRegistry() {}
+    virtual ~Ieee80211BeaconRegistry() {}
+
+  public:
+    /**
+     * Returns the singleton instance, creating it if needed. Only used by
+     * the APs; the instance is deleted when the last registered AP is.
+     */
+    static Ieee80211BeaconRegistry *getInstance();
+
+    /**
+     * Returns the singleton instance, or NULL if no AP has created it.
+     */
+    static Ieee80211BeaconRegistry *getInstanceIfExists() { return inst; }
+
+    /**
+     * Deletes the singleton instance.
+     */
+    static void deleteInstance();
+
+    /** Adds the AP; does nothing if it is already registered */
+    virtual void registerAP(Ieee80211MgmtAP *ap);
+
+    /** Removes the AP; does nothing if it is not registered */
+    virtual void unregisterAP(Ieee80211MgmtAP *ap);
+
+    /** Returns the registered AP with the given address, or NULL */
+    virtual Ieee80211MgmtAP *findAP(const MACAddress& address) const;
+
+    int getNumAPs() const { return aps.size(); }
+    Ieee80211MgmtAP *getAP(int k) const { return aps[k]; }
+};
+
+#endif
+
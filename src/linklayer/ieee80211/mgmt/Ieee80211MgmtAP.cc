@@ -18,7 +18,7 @@
 
 #include "Ieee80211MgmtAP.h"
 
-#include "Ieee80211Frame_m.h"
+#include "Ieee80211Frame.h"
 #include "Ieee802Ctrl_m.h"
 
 #ifdef WITH_ETHERNET
@@ -26,7 +26,9 @@
 #endif
 
 #include "NotifierConsts.h"
+#include "Radio.h"
 #include "RadioState.h"
+#include "Ieee80211BeaconRegistry.h"
 
 
 Define_Module(Ieee80211MgmtAP);
@@ -41,6 +43,13 @@ static std::ostream& operator<<(std::ostream& os, const Ieee80211MgmtAP::STAInfo
 Ieee80211MgmtAP::~Ieee80211MgmtAP()
 {
     cancelAndDelete(beaconTimer);
+    Ieee80211BeaconRegistry *registry = Ieee80211BeaconRegistry::getInstanceIfExists();
+    if (useBeaconRegistry && registry)
+    {
+        registry->unregisterAP(this);
+        if (registry->getNumAPs() == 0)
+            Ieee80211BeaconRegistry::deleteInstance();
+    }
 }
 
 void Ieee80211MgmtAP::initialize(int stage)
@@ -56,11 +65,18 @@ void Ieee80211MgmtAP::initialize(int stage)
         if (numAuthSteps!=2 && numAuthSteps!=4)
             error("parameter 'numAuthSteps' (number of frames exchanged during authentication) must be 2 or 4, not %d", numAuthSteps);
         channelNumber = -1;  // value will arrive from physical layer in receiveChangeNotification()
+        const char *beaconMode = par("beaconMode");
+        if (strcmp(beaconMode, "frames") && strcmp(beaconMode, "registry") && strcmp(beaconMode, "both"))
+            error("invalid beaconMode parameter value: '%s'", beaconMode);
+        sendBeaconFrames = strcmp(beaconMode, "registry") != 0;
+        useBeaconRegistry = strcmp(beaconMode, "frames") != 0;
+        numBeaconsNotSent = 0;
         WATCH(ssid);
         WATCH(channelNumber);
         WATCH(beaconInterval);
         WATCH(numAuthSteps);
         WATCH_MAP(staList);
+        WATCH(numBeaconsNotSent);
 
         //TBD fill in supportedRates
 
@@ -72,9 +88,32 @@ void Ieee80211MgmtAP::initialize(int stage)
         beaconTimer = new cMessage("beaconTimer");
     }
     else if (stage == 1)
+    {
+        if (useBeaconRegistry)
+        {
+            radio = dynamic_cast<Radio *>(getParentModule()->getSubmodule("radio"));
+            if (!radio)
+                error("beaconMode '%s' requires a radio derived from Radio, next to this submodule and called 'radio'", par("beaconMode").stringValue());
+        }
+        if (isOperational)
+        {
+            if (sendBeaconFrames)
+                scheduleAt(simTime()+uniform(0, beaconInterval), beaconTimer);
+            else
+                beaconsNotSentSince = simTime();
+            if (useBeaconRegistry)
+                Ieee80211BeaconRegistry::getInstance()->registerAP(this);
+        }
+    }
+}
+
+void Ieee80211MgmtAP::finish()
+{
+    if (!sendBeaconFrames)
     {
         if (isOperational)
-            scheduleAt(simTime()+uniform(0, beaconInterval), beaconTimer);
+            countBeaconsNotSent();
+        recordScalar("beacons not sent", numBeaconsNotSent);
     }
 }
 
@@ -156,6 +195,13 @@ void Ieee80211MgmtAP::sendBeacon()
     sendOrEnqueue(frame);
 }
 
+void Ieee80211MgmtAP::countBeaconsNotSent()
+{
+    long n = (long)((simTime() - beaconsNotSentSince) / beaconInterval);
+    numBeaconsNotSent += n;
+    beaconsNotSentSince += n * beaconInterval;
+}
+
 void Ieee80211MgmtAP::handleDataFrame(Ieee80211DataFrame *frame)
 {
     // check toDS bit
@@ -435,12 +481,21 @@ void Ieee80211MgmtAP::sendDisAssocNotification(const MACAddress &addr)
 void Ieee80211MgmtAP::start()
 {
     Ieee80211MgmtAPBase::start();
-    scheduleAt(simTime()+uniform(0, beaconInterval), beaconTimer);
+    if (sendBeaconFrames)
+        scheduleAt(simTime()+uniform(0, beaconInterval), beaconTimer);
+    else
+        beaconsNotSentSince = simTime();
+    if (useBeaconRegistry)
+        Ieee80211BeaconRegistry::getInstance()->registerAP(this);
 }
 
 void Ieee80211MgmtAP::stop()
 {
     cancelEvent(beaconTimer);
+    if (useBeaconRegistry && Ieee80211BeaconRegistry::getInstanceIfExists())
+        Ieee80211BeaconRegistry::getInstanceIfExists()->unregisterAP(this);
+    if (!sendBeaconFrames)
+        countBeaconsNotSent();
     staList.clear();
     Ieee80211MgmtAPBase::stop();
 }
@@ -25,6 +25,8 @@
 #include "Ieee80211MgmtAPBase.h"
 #include "NotificationBoard.h"
 
+class Radio;
+
 
 /**
  * Used in 802.11 infrastructure mode: handles management frames for
@@ -73,18 +75,37 @@ class INET_API Ieee80211MgmtAP : public Ieee80211MgmtAPBase
     simtime_t beaconInterval;
     int numAuthSteps;
     Ieee80211SupportedRatesElement supportedRates;
+    bool sendBeaconFrames;  // whether beacons are sent as frames
+    bool useBeaconRegistry; // whether the AP is in Ieee80211BeaconRegistry while operational
+    Radio *radio;           // used by STAs to calculate the received power when using the registry
 
     // state
     STAList staList; ///< list of STAs
     cMessage *beaconTimer;
 
+    // statistics
+    long numBeaconsNotSent;       // beacons replaced by the registry
+    simtime_t beaconsNotSentSince; // start of the current operational period without beacon frames
+
   public:
-    Ieee80211MgmtAP() :  nb(NULL), beaconTimer(NULL) {}
+    Ieee80211MgmtAP() :  nb(NULL), sendBeaconFrames(true), useBeaconRegistry(false), radio(NULL), beaconTimer(NULL) {}
     virtual ~Ieee80211MgmtAP();
 
+    /** @name Beacon parameters, used by Ieee80211MgmtSTA via Ieee80211BeaconRegistry */
+    //@{
+    const MACAddress& getAddress() const { return myAddress; }
+    const std::string& getSSID() const { return ssid; }
+    int getChannelNumber() const { return channelNumber; }
+    simtime_t getBeaconInterval() const { return beaconInterval; }
+    const Ieee80211SupportedRatesElement& getSupportedRates() const { return supportedRates; }
+    Radio *getRadio() const { return radio; }
+    bool isSendingBeaconFrames() const { return sendBeaconFrames; }
+    //@}
+
   protected:
     virtual int numInitStages() const { return 2; }
     virtual void initialize(int);
+    virtual void finish();
 
     /** Implements abstract Ieee80211MgmtBase method */
     virtual void handleTimer(cMessage *msg);
@@ -107,6 +128,9 @@ class INET_API Ieee80211MgmtAP : public Ieee80211MgmtAPBase
     /** Utility function: creates and sends a beacon frame */
     virtual void sendBeacon();
 
+    /** Counts the beacons that were not sent as frames since the AP became operational */
+    virtual void countBeaconsNotSent();
+
     /** @name Processing of different frame types */
     //@{
     virtual void handleDataFrame(Ieee80211DataFrame *frame);
@@ -26,6 +26,9 @@
 #include "Radio80211aControlInfo_m.h"
 #include "InterfaceTableAccess.h"
 #include "opp_utils.h"
+#include "Radio.h"
+#include "Ieee80211MgmtAP.h"
+#include "Ieee80211BeaconRegistry.h"
 
 //TBD supportedRates!
 //TBD use command msg kinds?
@@ -116,6 +119,7 @@ void Ieee80211MgmtSTA::initialize(int stage)
         IChannelControl *cc = ChannelAccess::getChannelControl();
         numChannels = cc->getNumChannels();
         nb->subscribe(this, NF_LINK_FULL_PROMISCUOUS);
+        radio = dynamic_cast<Radio *>(getParentModule()->getSubmodule("radio"));
 
         IInterfaceTable *ift = InterfaceTableAccess().getIfExists();
         if (ift)
@@ -181,8 +185,13 @@ void Ieee80211MgmtSTA::handleTimer(cMessage *msg)
     }
     else if (msg->getKind()==MK_BEACON_TIMEOUT)
     {
-        // missed a few consecutive beacons
-        beaconLost();
+        // an AP without beacon frames is only lost if it left the registry or is out of range
+        Ieee80211BeaconRegistry *registry = Ieee80211BeaconRegistry::getInstanceIfExists();
+        Ieee80211MgmtAP *ap = registry ? registry->findAP(assocAP.address) : NULL;
+        if (ap && !ap->isSendingBeaconFrames() && ap->getChannelNumber()==assocAP.channel && getRegisteredAPRxPower(ap)>=0)
+            scheduleAt(simTime()+MAX_BEACONS_MISSED*assocAP.beaconInterval, msg);
+        else
+            beaconLost(); // missed a few consecutive beacons
     }
     else
     {
@@ -436,6 +445,10 @@ void Ieee80211MgmtSTA::processScanCommand(Ieee80211Prim_ScanRequest *ctrl)
 
 bool Ieee80211MgmtSTA::scanNextChannel()
 {
+    // APs in the beacon registry are found at the end of listening, like their beacons
+    if (scanning.currentChannelIndex>=0)
+        storeRegisteredAPs(scanning.channelList[scanning.currentChannelIndex]);
+
     // if we're already at the last channel, we're through
     if (scanning.currentChannelIndex==(int)scanning.channelList.size()-1)
     {
@@ -876,3 +889,37 @@ void Ieee80211MgmtSTA::storeAPInfo(const MACAddress& address, const Ieee80211Bea
     //ap->rxPower = ...
 }
 
+void Ieee80211MgmtSTA::storeRegisteredAPs(int channel)
+{
+    Ieee80211BeaconRegistry *registry = Ieee80211BeaconRegistry::getInstanceIfExists();
+    if (!registry)
+        return;
+    for (int i=0; i<registry->getNumAPs(); i++)
+    {
+        Ieee80211MgmtAP *registeredAP = registry->getAP(i);
+        if (registeredAP->getChannelNumber()!=channel)
+            continue;
+        double rxPower = getRegisteredAPRxPower(registeredAP);
+        if (rxPower<0)
+            continue;
+
+        EV << "AP address=" << registeredAP->getAddress() << " found in beacon registry, SNR="
+           << 10*log10(rxPower/radio->getThermalNoise()) << "dB\n";
+        Ieee80211BeaconFrameBody body;
+        body.setSSID(registeredAP->getSSID().c_str());
+        body.setSupportedRates(registeredAP->getSupportedRates());
+        body.setBeaconInterval(registeredAP->getBeaconInterval());
+        body.setChannelNumber(channel);
+        storeAPInfo(registeredAP->getAddress(), body);
+        lookupAP(registeredAP->getAddress())->rxPower = rxPower;
+    }
+}
+
+double Ieee80211MgmtSTA::getRegisteredAPRxPower(Ieee80211MgmtAP *ap)
+{
+    if (!radio)
+        error("APs in the beacon registry require a radio derived from Radio, next to this submodule and called 'radio'");
+    double rxPower = radio->calculateReceivedPowerFrom(ap->getRadio());
+    return rxPower<radio->getSensitivity() ? -1 : rxPower;
+}
+
@@ -25,6 +25,9 @@
 #include "Ieee80211Primitives_m.h"
 #include "IInterfaceTable.h"
 
+class Ieee80211MgmtAP;
+class Radio;
+
 
 /**
  * Used in 802.11 infrastructure mode: handles management frames for
@@ -88,6 +91,7 @@ class INET_API Ieee80211MgmtSTA : public Ieee80211MgmtBase
     IInterfaceTable *interfaceTable;
     NotificationBoard *nb;
     InterfaceEntry *myIface;
+    Radio *radio; // NULL if the radio is not derived from Radio; needed for APs in the beacon registry
 
     // number of channels in ChannelControl -- used if we're told to scan "all" channels
     int numChannels;
@@ -107,7 +111,7 @@ class INET_API Ieee80211MgmtSTA : public Ieee80211MgmtBase
     AssociatedAPInfo assocAP;
 
   public:
-    Ieee80211MgmtSTA() : interfaceTable(NULL), nb(NULL), myIface(NULL), numChannels(-1), isScanning(false), isAssociated(false), assocTimeoutMsg(NULL) {}
+    Ieee80211MgmtSTA() : interfaceTable(NULL), nb(NULL), myIface(NULL), radio(NULL), numChannels(-1), isScanning(false), isAssociated(false), assocTimeoutMsg(NULL) {}
 
   protected:
     virtual int numInitStages() const { return 2; }
@@ -146,6 +150,12 @@ class INET_API Ieee80211MgmtSTA : public Ieee80211MgmtBase
     /** Stores AP info received in a beacon or probe response */
     virtual void storeAPInfo(const MACAddress& address, const Ieee80211BeaconFrameBody& body);
 
+    /** Stores AP info of the APs in the beacon registry that operate on the given channel and can be received */
+    virtual void storeRegisteredAPs(int channel);
+
+    /** Returns the power at which the beacons of a registered AP would be received, or -1 if they could not be received */
+    virtual double getRegisteredAPRxPower(Ieee80211MgmtAP *ap);
+
     /** Switches to the next channel to scan; returns true if done (there wasn't any more channel to scan). */
     virtual bool scanNextChannel();
 
@@ -23,6 +23,7 @@
 #include "FWMath.h"
 #include "yans-error-rate-model.h"
 #include "nist-error-rate-model.h"
+#include "Ieee80211DataRate.h"
 #define NS3CALMODE
 
 
@@ -32,7 +33,10 @@ Ieee80211RadioModel::~Ieee80211RadioModel()
 {
     if (parseTable)
         delete parseTable;
-    delete errorModel;
+    if (errorModelTable)
+        TabulatedErrorRateModel::releaseSharedInstance(errorModelTable);
+    else
+        delete errorModel;
 }
 
 
@@ -59,7 +63,22 @@ void Ieee80211RadioModel::initializeFrom(cModule *radioModule)
     else
         phyOpMode = 'g';
 
-    if (strcmp("YansModel", radioModule->par("errorModel").stringValue())==0)
+    errorModelTable = NULL;
+    if (radioModule->par("errorModelTable").boolValue())
+    {
+        // the tables are shared by all radios with the same error model and grid
+        errorModelTable = TabulatedErrorRateModel::getSharedInstance(radioModule->par("errorModel").stringValue(),
+                radioModule->par("errorModelTableMinSnr").doubleValue(), radioModule->par("errorModelTableMaxSnr").doubleValue(),
+                radioModule->par("errorModelTableResolution").doubleValue());
+        errorModel = errorModelTable;
+        for (int i = Ieee80211Descriptor::getMinIdx(phyOpMode); i <= Ieee80211Descriptor::getMaxIdx(phyOpMode); i++)
+        {
+            ModulationType modeBody = Ieee80211Descriptor::getDescriptor(i).modulationType;
+            errorModelTable->addMode(modeBody);
+            errorModelTable->addMode(WifiModulationType::getPlcpHeaderMode(modeBody, wifiPreamble));
+        }
+    }
+    else if (strcmp("YansModel", radioModule->par("errorModel").stringValue())==0)
         errorModel = new YansErrorRateModel();
     else if (strcmp("NistModel", radioModule->par("errorModel").stringValue())==0)
         errorModel = new NistErrorRateModel();
@@ -131,14 +150,11 @@ double Ieee80211RadioModel::calculateDuration(AirFrame *airframe)
 
 PhyIndication Ieee80211RadioModel::isReceivedCorrectly(AirFrame *airframe, const SnrList& receivedList)
 {
-    // calculate snirMin
-    double snirMin = receivedList.begin()->snr;
-    for (SnrList::const_iterator iter = receivedList.begin(); iter != receivedList.end(); iter++)
-        if (iter->snr < snirMin)
-            snirMin = iter->snr;
+    double snirMin = receivedList.getMinSnr();
 
-    cPacket *frame = airframe->getEncapsulatedPacket();
-    EV << "packet (" << frame->getClassName() << ")" << frame->getName() << " (" << frame->info() << ") snrMin=" << snirMin << endl;
+    // note: getEncapsulatedPacket() would give this receiver a private copy of the
+    // frame, which is shared by all receivers until it is decapsulated
+    EV << "packet " << airframe->getName() << " snrMin=" << snirMin << endl;
 
     if (i%1000==0)
     {
@@ -153,7 +169,7 @@ PhyIndication Ieee80211RadioModel::isReceivedCorrectly(AirFrame *airframe, const
         EV << "COLLISION! Packet got lost. Noise only\n";
         return COLLISION;
     }
-    else if (isPacketOK(snirMin, frame->getBitLength(), airframe->getBitrate()))
+    else if (isPacketOK(snirMin, airframe->getBitLength(), airframe->getBitrate()))
     {
         EV << "packet was received correctly, it is now handed to upper layer...\n";
         return FRAMEOK;
@@ -23,6 +23,7 @@
 #include "IRadioModel.h"
 #include "BerParseFile.h"
 #include "IErrorModel.h"
+#include "tabulated-error-rate-model.h"
 #include "WifiPreambleType.h"
 
 /**
@@ -47,6 +48,7 @@ class INET_API Ieee80211RadioModel : public IRadioModel
 
     double PHY_HEADER_LENGTH;
     IErrorModel * errorModel;
+    TabulatedErrorRateModel *errorModelTable; // same as errorModel if the shared tables are used, NULL otherwise
     WifiPreamble wifiPreamble;
     bool  autoHeaderSize;
 
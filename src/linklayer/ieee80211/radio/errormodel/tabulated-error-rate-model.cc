@@ -0,0 +1,146 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include <math.h>
+#include <string.h>
+
+#include "tabulated-error-rate-model.h"
+#include "yans-error-rate-model.h"
+#include "nist-error-rate-model.h"
+
+TabulatedErrorRateModel::InstanceMap TabulatedErrorRateModel::instances;
+
+TabulatedErrorRateModel::ModeKey::ModeKey(const ModulationType& mode)
+{
+    modulationClass = mode.getModulationClass();
+    constellationSize = mode.getConstellationSize();
+    codeRate = mode.getCodeRate();
+    dataRate = mode.getDataRate();
+    bandwidth = mode.getBandwidth();
+}
+
+bool TabulatedErrorRateModel::ModeKey::operator<(const ModeKey& other) const
+{
+    if (modulationClass != other.modulationClass)
+        return modulationClass < other.modulationClass;
+    if (constellationSize != other.constellationSize)
+        return constellationSize < other.constellationSize;
+    if (codeRate != other.codeRate)
+        return codeRate < other.codeRate;
+    if (dataRate != other.dataRate)
+        return dataRate < other.dataRate;
+    return bandwidth < other.bandwidth;
+}
+
+TabulatedErrorRateModel::TabulatedErrorRateModel(IErrorModel *model, double minSnr, double maxSnr, double resolution)
+{
+    if (resolution <= 0 || minSnr >= maxSnr)
+        throw cRuntimeError("TabulatedErrorRateModel: invalid SNR grid [%gdB, %gdB], resolution %gdB", minSnr, maxSnr, resolution);
+    this->model = model;
+    this->minSnr = minSnr;
+    this->maxSnr = maxSnr;
+    this->resolution = resolution;
+    referenceCount = 0;
+}
+
+TabulatedErrorRateModel::~TabulatedErrorRateModel()
+{
+    delete model;
+}
+
+void TabulatedErrorRateModel::addMode(const ModulationType& mode)
+{
+    getTable(mode);
+}
+
+const TabulatedErrorRateModel::Table& TabulatedErrorRateModel::getTable(const ModulationType& mode) const
+{
+    ModeKey key(mode);
+    TableMap::iterator it = tables.find(key);
+    if (it != tables.end())
+        return it->second;
+
+    Table& table = tables[key];
+    int size = (int)ceil((maxSnr - minSnr) / resolution) + 1;
+    table.resize(size);
+    for (int i = 0; i < size; i++)
+    {
+        double snr = pow(10.0, (minSnr + i * resolution) / 10);
+        double successRate = model->GetChunkSuccessRate(mode, snr, 1);
+        if (successRate >= 1)
+            table[i] = -HUGE_VAL;  // the bit is always received
+        else if (successRate <= 0)
+            table[i] = HUGE_VAL;  // never received
+        else
+            table[i] = log(-log(successRate));
+    }
+    return table;
+}
+
+double TabulatedErrorRateModel::GetChunkSuccessRate(ModulationType mode, double snr, uint32_t nbits) const
+{
+    if (nbits == 0)
+        return 1;
+    double snrDb = 10 * log10(snr);
+    double position = (snrDb - minSnr) / resolution;
+    const Table& table = getTable(mode);
+    if (!(position >= 0) || position >= table.size() - 1)
+        return model->GetChunkSuccessRate(mode, snr, nbits);
+
+    int i = (int)position;
+    double a = table[i];
+    double b = table[i + 1];
+    if (a == b && fabs(a) == HUGE_VAL)
+        return a < 0 ? 1 : 0;
+    // next to a grid point where the bit is always (or never) received the model
+    // may be discontinuous (e.g. the DSSS CCK models), do not interpolate there
+    if (fabs(a) == HUGE_VAL || fabs(b) == HUGE_VAL)
+        return model->GetChunkSuccessRate(mode, snr, nbits);
+    double logBitError = a + (b - a) * (position - i);
+    return exp(-(double)nbits * exp(logBitError));
+}
+
+TabulatedErrorRateModel *TabulatedErrorRateModel::getSharedInstance(const char *modelName, double minSnr, double maxSnr, double resolution)
+{
+    std::string key = opp_stringf("%s %g %g %g", modelName, minSnr, maxSnr, resolution);
+    InstanceMap::iterator it = instances.find(key);
+    TabulatedErrorRateModel *instance;
+    if (it != instances.end())
+        instance = it->second;
+    else
+    {
+        IErrorModel *model;
+        if (strcmp(modelName, "YansModel") == 0)
+            model = new YansErrorRateModel();
+        else if (strcmp(modelName, "NistModel") == 0)
+            model = new NistErrorRateModel();
+        else
+            throw cRuntimeError("Error %s model is not valid", modelName);
+        instance = new TabulatedErrorRateModel(model, minSnr, maxSnr, resolution);
+        instance->sharingKey = key;
+        instances[key] = instance;
+    }
+    instance->referenceCount++;
+    return instance;
+}
+
+void TabulatedErrorRateModel::releaseSharedInstance(TabulatedErrorRateModel *instance)
+{
+    if (--instance->referenceCount == 0)
+    {
+        instances.erase(instance->sharingKey);
+        delete instance;
+    }
+}
@@ -0,0 +1,95 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef TABULATED_ERROR_RATE_MODEL_H
+#define TABULATED_ERROR_RATE_MODEL_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "INETDefs.h"
+
+#include "WifiMode.h"
+#include "IErrorModel.h"
+
+/**
+ * Table-driven fast path for an analytic error model (YansErrorRateModel,
+ * NistErrorRateModel).
+ *
+ * All these models compute the chunk success rate as (1-p)^nbits, where the
+ * per-bit error probability p only depends on the mode and the SNR. The table
+ * stores log(-log(1-p)) for each mode on an SNR grid (in dB) of the given
+ * resolution; the success rate of a chunk is then exp(-nbits * (-log(1-p)))
+ * with the value interpolated between the grid points, so the frame length
+ * needs no table dimension. SNR values outside the grid are passed to the
+ * analytic model.
+ *
+ * Tables are built per mode, at initialization (addMode()) or on the first
+ * query. Instances are shared by all radios using the same model and grid,
+ * see getSharedInstance().
+ */
+class INET_API TabulatedErrorRateModel : public IErrorModel
+{
+  protected:
+    struct ModeKey
+    {
+        int modulationClass;
+        int constellationSize;
+        int codeRate;
+        uint32_t dataRate;
+        uint32_t bandwidth;
+
+        ModeKey(const ModulationType& mode);
+        bool operator<(const ModeKey& other) const;
+    };
+    typedef std::vector<double> Table;  // log(-log(1-p)) at minSnr, minSnr+resolution, ... (dB)
+    typedef std::map<ModeKey, Table> TableMap;
+
+    IErrorModel *model;
+    double minSnr;      // dB
+    double maxSnr;      // dB
+    double resolution;  // dB
+    mutable TableMap tables;
+
+    // sharing
+    std::string sharingKey;
+    int referenceCount;
+    typedef std::map<std::string, TabulatedErrorRateModel *> InstanceMap;
+    static InstanceMap instances;
+
+  protected:
+    const Table& getTable(const ModulationType& mode) const;
+
+  public:
+    /** The model is owned by this object; SNR values are in dB */
+    TabulatedErrorRateModel(IErrorModel *model, double minSnr, double maxSnr, double resolution);
+    virtual ~TabulatedErrorRateModel();
+
+    /** Precomputes the table of the mode */
+    void addMode(const ModulationType& mode);
+
+    virtual double GetChunkSuccessRate(ModulationType mode, double snr, uint32_t nbits) const;
+
+    /**
+     * Returns the table of the given analytic model ("YansModel" or "NistModel")
+     * and grid, creating it if no radio uses it yet. Must be paired with
+     * releaseSharedInstance().
+     */
+    static TabulatedErrorRateModel *getSharedInstance(const char *modelName, double minSnr, double maxSnr, double resolution);
+    static void releaseSharedInstance(TabulatedErrorRateModel *instance);
+};
+
+#endif /* TABULATED_ERROR_RATE_MODEL_H */
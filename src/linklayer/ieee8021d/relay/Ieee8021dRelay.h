@@ -21,7 +21,7 @@
 #include "INETDefs.h"
 #include "InterfaceTable.h"
 #include "IMACAddressTable.h"
-#include "EtherFrame_m.h"
+#include "EtherFrame.h"
 #include "NodeOperations.h"
 #include "NodeStatus.h"
 #include "Ieee8021dBPDU_m.h"
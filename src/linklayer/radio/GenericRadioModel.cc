@@ -62,11 +62,7 @@ double GenericRadioModel::calculateDuration(AirFrame *airframe)
 
 PhyIndication GenericRadioModel::isReceivedCorrectly(AirFrame *airframe, const SnrList& receivedList)
 {
-    // calculate snirMin
-    double snirMin = receivedList.begin()->snr;
-    for (SnrList::const_iterator iter = receivedList.begin(); iter != receivedList.end(); iter++)
-        if (iter->snr < snirMin)
-            snirMin = iter->snr;
+    double snirMin = receivedList.getMinSnr();
 
     if (snirMin <= snirThreshold)
     {
@@ -80,7 +80,7 @@ void Radio::initialize(int stage)
         carrierFrequency = par("carrierFrequency");
 
         // initialize noiseLevel
-        noiseLevel = thermalNoise;
+        resetNoiseLevel();
         std::string noiseModel =  par("NoiseGenerator").stdstringValue();
         if (noiseModel!="")
         {
@@ -103,6 +103,7 @@ void Radio::initialize(int stage)
         // statistics
         numGivenUp = 0;
         numReceivedCorrectly = 0;
+        numFramesEvaluated = 0;
 
         // Initialize radio state. If thermal noise is already to high, radio
         // state has to be initialized as RECV
@@ -111,6 +112,7 @@ void Radio::initialize(int stage)
             rs.setState(RadioState::RECV);
 
         WATCH(noiseLevel);
+        WATCH(numFramesEvaluated);
         WATCH(rs);
 
         obstacles = ObstacleControlAccess().getIfExists();
@@ -210,6 +212,9 @@ void Radio::initialize(int stage)
 
 void Radio::finish()
 {
+    recordScalar("framesEvaluated", numFramesEvaluated);
+    if (simTime() > 0)
+        recordScalar("framesEvaluatedPerSecond", numFramesEvaluated / SIMTIME_DBL(simTime()));
 }
 
 Radio::~Radio()
@@ -369,7 +374,11 @@ AirFrame *Radio::encapsulatePacket(cPacket *frame)
 
 void Radio::sendUp(AirFrame *airframe)
 {
+    // the encapsulated frame is shared by all receivers of the transmission
+    // (see ChannelControl::sendToChannel()); decapsulate() gives us our own copy
     cPacket *frame = airframe->decapsulate();
+    if (airframe->getKind() != FRAMEOK)
+        frame->setKind(airframe->getKind());
     Radio80211aControlInfo * cinfo = new Radio80211aControlInfo;
     if (radioModel->haveTestFrame())
     {
@@ -441,7 +450,7 @@ void Radio::handleUpperMsg(AirFrame *airframe)
         // clear the snr list
         snrInfo.sList.clear();
         // add the receive power to the noise level
-        noiseLevel += snrInfo.rcvdPower;
+        addNoise(snrInfo.rcvdPower);
     }
 
     // now we are done with all the exception handling and can take care
@@ -579,6 +588,49 @@ void Radio::handleSelfMsg(cMessage *msg)
 }
 
 
+double Radio::calculateReceivedPower(const AirFrame *airframe, const Coord& receiverPos, bool concurrently)
+{
+    double frequency = carrierFrequency;
+    if (airframe->getCarrierFrequency()>0.0)
+        frequency = airframe->getCarrierFrequency();
+    return calculateReceivedPower(airframe->getPSend(), frequency, airframe->getSenderPos(), receiverPos, concurrently);
+}
+
+double Radio::calculateReceivedPower(double pSend, double frequency, const Coord& senderPos, const Coord& receiverPos, bool concurrently)
+{
+    // calculate distance
+    double distance = receiverPos.distance(senderPos);
+    if (distance<MIN_DISTANCE)
+        distance = MIN_DISTANCE;
+
+    // calculate receive power
+    double rcvdPower = receptionModel->calculateReceivedPower(pSend, frequency, distance);
+    if (obstacles && distance > MIN_DISTANCE)
+    {
+        if (concurrently)
+            rcvdPower = obstacles->calculateReceivedPowerConcurrently(rcvdPower, carrierFrequency, senderPos, 0, receiverPos, 0);
+        else
+            rcvdPower = obstacles->calculateReceivedPower(rcvdPower, carrierFrequency, senderPos, 0, receiverPos, 0);
+    }
+    return rcvdPower;
+}
+
+double Radio::calculateReceivedPowerFrom(const Radio *transmitter)
+{
+    return calculateReceivedPower(transmitter->transmitterPower, transmitter->carrierFrequency,
+            transmitter->getRadioPosition(), getRadioPosition(), false);
+}
+
+bool Radio::canCalculateReceivedPowerConcurrently(const AirFrame *airframe)
+{
+    return receptionModel->isThreadSafe();
+}
+
+double Radio::calculateReceivedPowerConcurrently(const AirFrame *airframe, const Coord& receiverPos)
+{
+    return calculateReceivedPower(airframe, receiverPos, true);
+}
+
 /**
  * This function is called right after a packet arrived, i.e. right
  * before it is buffered for 'transmission time'.
@@ -604,26 +656,12 @@ void Radio::handleSelfMsg(cMessage *msg)
  */
 void Radio::handleLowerMsgStart(AirFrame* airframe)
 {
-    // Calculate the receive power of the message
-
-    // calculate distance
-    const Coord& framePos = airframe->getSenderPos();
-    double distance = getRadioPosition().distance(framePos);
-
-    // calculate receive power
-    double frequency = carrierFrequency;
-    if (airframe && airframe->getCarrierFrequency()>0.0)
-        frequency = airframe->getCarrierFrequency();
-
-    if (distance<MIN_DISTANCE)
-        distance = MIN_DISTANCE;
-
-    double rcvdPower = receptionModel->calculateReceivedPower(airframe->getPSend(), frequency, distance);
-    if (obstacles && distance > MIN_DISTANCE)
-        rcvdPower = obstacles->calculateReceivedPower(rcvdPower, carrierFrequency, framePos, 0, getRadioPosition(), 0);
+    // Calculate the receive power of the message, unless ChannelControl already did it
+    double rcvdPower = airframe->getPowRecPrecomputed() ? airframe->getPowRec() : calculateReceivedPower(airframe, getRadioPosition(), false);
     airframe->setPowRec(rcvdPower);
     // store the receive power in the recvBuff
     recvBuff[airframe] = rcvdPower;
+    numFramesEvaluated++;
     updateSensitivity(airframe->getBitrate());
 
     // if receive power is bigger than sensitivity and if not sending
@@ -636,10 +674,9 @@ void Radio::handleLowerMsgStart(AirFrame* airframe)
         EV << "receiving frame " << airframe->getName() << endl;
 
         // Put frame and related SnrList in receive buffer
-        SnrList snrList;
         snrInfo.ptr = airframe;
         snrInfo.rcvdPower = rcvdPower;
-        snrInfo.sList = snrList;
+        snrInfo.sList.clear();
 
         // add initial snr value
         addNewSnr();
@@ -656,7 +693,7 @@ void Radio::handleLowerMsgStart(AirFrame* airframe)
     {
         EV << "frame " << airframe->getName() << " is just noise\n";
         //add receive power to the noise level
-        noiseLevel += rcvdPower;
+        addNoise(rcvdPower);
 
         // if a message is being received add a new snr value
         if (snrInfo.ptr != NULL)
@@ -695,15 +732,12 @@ void Radio::handleLowerMsgEnd(AirFrame * airframe)
         EV << "reception of frame over, preparing to send packet to upper layer\n";
         // get Packet and list out of the receive buffer:
         SnrList list;
-        list = snrInfo.sList;
+        list.swap(snrInfo.sList);
 
         // delete the pointer to indicate that no message is currently
         // being received and clear the list
 
-        double snirMin = snrInfo.sList.begin()->snr;
-        for (SnrList::const_iterator iter = snrInfo.sList.begin(); iter != snrInfo.sList.end(); iter++)
-            if (iter->snr < snirMin)
-                snirMin = iter->snr;
+        double snirMin = list.getMinSnr();
         snrInfo.ptr = NULL;
         snrInfo.sList.clear();
         airframe->setSnr(10*log10(snirMin)); //ahmed
@@ -719,7 +753,7 @@ void Radio::handleLowerMsgEnd(AirFrame * airframe)
         PhyIndication frameState = radioModel->isReceivedCorrectly(airframe, list);
         if (frameState != FRAMEOK)
         {
-            airframe->getEncapsulatedPacket()->setKind(frameState);
+            airframe->setKind(frameState);  // copied to the frame in sendUp()
             airframe->setName(frameState == COLLISION ? "COLLISION" : "BITERROR");
 
             numGivenUp++;
@@ -741,10 +775,14 @@ void Radio::handleLowerMsgEnd(AirFrame * airframe)
     {
         EV << "reception of noise message over, removing recvdPower from noiseLevel....\n";
         // get the rcvdPower and subtract it from the noiseLevel
-        noiseLevel -= recvBuff[airframe];
+        RecvBuff::iterator it = recvBuff.find(airframe);
+        if (it != recvBuff.end())
+        {
+            addNoise(-it->second);
 
-        // delete message from the recvBuff
-        recvBuff.erase(airframe);
+            // delete message from the recvBuff
+            recvBuff.erase(it);
+        }
 
         // update snr info for message currently being received if any
         if (snrInfo.ptr != NULL)
@@ -757,6 +795,10 @@ void Radio::handleLowerMsgEnd(AirFrame * airframe)
         EV << "message deleted\n";
     }
 
+    // if no noise frames are left, drop the rounding error accumulated while they were on the air
+    if (recvBuff.size() == (snrInfo.ptr != NULL ? 1u : 0u))
+        resetNoiseLevel();
+
     // check the RadioState and update if necessary
     // change to idle if noiseLevel smaller than threshold and state was
     // not idle before
@@ -771,10 +813,27 @@ void Radio::handleLowerMsgEnd(AirFrame * airframe)
 
 void Radio::addNewSnr()
 {
-    SnrListEntry listEntry;     // create a new entry
-    listEntry.time = simTime();
-    listEntry.snr = snrInfo.rcvdPower / (BASE_NOISE_LEVEL);
-    snrInfo.sList.push_back(listEntry);
+    snrInfo.sList.add(simTime(), snrInfo.rcvdPower / (BASE_NOISE_LEVEL));
+}
+
+void Radio::addNoise(double power)
+{
+    // Neumaier's variant of Kahan summation: frames are added and later
+    // subtracted, and plain summation would accumulate drift over long runs
+    double sum = noiseLevelSum + power;
+    if (fabs(noiseLevelSum) >= fabs(power))
+        noiseLevelCompensation += (noiseLevelSum - sum) + power;
+    else
+        noiseLevelCompensation += (power - sum) + noiseLevelSum;
+    noiseLevelSum = sum;
+    noiseLevel = noiseLevelSum + noiseLevelCompensation;
+}
+
+void Radio::resetNoiseLevel()
+{
+    noiseLevelSum = thermalNoise;
+    noiseLevelCompensation = 0;
+    noiseLevel = thermalNoise;
 }
 
 void Radio::changeChannel(int channel)
@@ -799,7 +858,7 @@ void Radio::changeChannel(int channel)
     snrInfo.sList.clear();
 
     // reset the noiseLevel
-    noiseLevel = thermalNoise;
+    resetNoiseLevel();
 
     if (rs.getState()!=RadioState::IDLE)
         rs.setState(RadioState::IDLE); // Force radio to Idle
@@ -1078,6 +1137,7 @@ void Radio::disconnectReceiver()
         delete cancelEvent(endRxTimer);
     }
     recvBuff.clear();
+    resetNoiseLevel();
 
     // clear snr info
     snrInfo.ptr = NULL;
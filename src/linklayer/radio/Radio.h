@@ -28,6 +28,7 @@
 #include "ObstacleControl.h"
 #include "INoiseGenerator.h"
 #include "ILifecycle.h"
+#include "IReceivedPowerCalculator.h"
 
 /**
  * Abstract base class for radio modules. Radio modules deal with the
@@ -54,7 +55,7 @@
  *
  * @author Andras Varga, Levente Meszaros
  */
-class INET_API Radio : public ChannelAccess, public ILifecycle
+class INET_API Radio : public ChannelAccess, public ILifecycle, public IReceivedPowerCalculator
 {
   protected:
     typedef std::map<double,double> SensitivityList; // Sensitivity list
@@ -66,6 +67,25 @@ class INET_API Radio : public ChannelAccess, public ILifecycle
 
     virtual bool handleOperationStage(LifecycleOperation *operation, int stage, IDoneCallback *doneCallback);
 
+    /** @name IReceivedPowerCalculator methods */
+    //@{
+    virtual bool canCalculateReceivedPowerConcurrently(const AirFrame *airframe);
+    virtual double calculateReceivedPowerConcurrently(const AirFrame *airframe, const Coord& receiverPos);
+    //@}
+
+    /**
+     * Returns the power of a frame sent by the given radio, as it would arrive
+     * at this radio (path loss and obstacles, no interference). Used when
+     * beacons are not sent as frames (see Ieee80211BeaconRegistry).
+     */
+    virtual double calculateReceivedPowerFrom(const Radio *transmitter);
+
+    /** Returns the thermal noise in mW */
+    double getThermalNoise() const {return thermalNoise;}
+
+    /** Returns the current sensitivity in mW: weaker frames are not received */
+    double getSensitivity() const {return sensitivity;}
+
   protected:
     virtual void initialize(int stage);
     virtual void finish();
@@ -81,6 +101,15 @@ class INET_API Radio : public ChannelAccess, public ILifecycle
     /** @brief Buffer the frame and update noise levels and snr information */
     virtual void handleLowerMsgStart(AirFrame *airframe);
 
+    /**
+     * Calculates the power of the frame received at receiverPos, using the reception
+     * model and the obstacles. If concurrently is true, only thread-safe calls are made.
+     */
+    virtual double calculateReceivedPower(const AirFrame *airframe, const Coord& receiverPos, bool concurrently);
+
+    /** Calculates the received power from the transmission parameters; see above */
+    virtual double calculateReceivedPower(double pSend, double frequency, const Coord& senderPos, const Coord& receiverPos, bool concurrently);
+
     /** @brief Unbuffer the frame and update noise levels and snr information */
     virtual void handleLowerMsgEnd(AirFrame *airframe);
 
@@ -108,6 +137,12 @@ class INET_API Radio : public ChannelAccess, public ILifecycle
     /** Updates the SNR information of the relevant AirFrame */
     virtual void addNewSnr();
 
+    /** Adds power (may be negative) to the noise level, using compensated summation */
+    virtual void addNoise(double power);
+
+    /** Sets the noise level back to the thermal noise; only valid if no noise frames are being received */
+    virtual void resetNoiseLevel();
+
     /** Create a new AirFrame */
     virtual AirFrame *createAirFrame() {return new AirFrame();}
 
@@ -165,6 +200,7 @@ class INET_API Radio : public ChannelAccess, public ILifecycle
     long numGivenUp;
     long numReceivedCorrectly;
     double lossRate;
+    long numFramesEvaluated;  // frames whose reception (or interference) was evaluated
     //@}
 
     /** Power used to transmit messages */
@@ -221,8 +257,14 @@ class INET_API Radio : public ChannelAccess, public ILifecycle
     /** State: if not -1, we have to switch to that bitrate once we finished transmitting */
     double newBitrate;
 
-    /** State: the current noise level of the channel.*/
+    /**
+     * State: the current noise level of the channel: thermal noise plus the
+     * power of the frames in recvBuff that are not being received.
+     * It is the sum of noiseLevelSum and noiseLevelCompensation, see addNoise().
+     */
     double noiseLevel;
+    double noiseLevelSum;
+    double noiseLevelCompensation;
 
     /**
      * Configuration: The carrier frequency used. It is read from the ChannelControl module.
@@ -20,7 +20,10 @@
 #ifndef SNRLIST_H
 #define SNRLIST_H
 
-#include <list>
+#include <algorithm>
+#include <vector>
+
+#include "INETDefs.h"
 
 /**
  * @brief struct for SNR information
@@ -47,10 +50,65 @@ struct SnrListEntry{
  * Decider. Each SnrListEntry in this list corresponds to one SNR
  * value at a specific time.
  *
+ * The entries are stored contiguously in time order, and the minimum
+ * SNR is maintained as entries are added, so deciders do not need to
+ * rescan the list. The vector is not exposed for modification, so
+ * entries can only be added with add(); copying and swap() carry the
+ * minimum along with the entries.
+ *
  * @ingroup utils
  * @ingroup basicUtils
  * @author Marc Lbbers
  */
-typedef std::list<SnrListEntry> SnrList;
+class SnrList
+{
+  protected:
+    std::vector<SnrListEntry> entries;
+    double minSnr;
+
+  public:
+    typedef std::vector<SnrListEntry>::const_iterator const_iterator;
+
+    SnrList() : minSnr(0) {}
+
+    /** @brief Appends an SNR value; time must not be earlier than that of the last entry */
+    void add(simtime_t time, double snr)
+    {
+        if (entries.empty() || snr < minSnr)
+            minSnr = snr;
+        SnrListEntry entry;
+        entry.time = time;
+        entry.snr = snr;
+        entries.push_back(entry);
+    }
+
+    /** @brief Returns the smallest SNR value in the list; the list must not be empty */
+    double getMinSnr() const
+    {
+        ASSERT(!entries.empty());
+        return minSnr;
+    }
+
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+    const SnrListEntry& operator[](size_t k) const { return entries[k]; }
+    const SnrListEntry& front() const { return entries.front(); }
+    const SnrListEntry& back() const { return entries.back(); }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    /** @brief Exchanges the contents (entries and minimum) of the two lists */
+    void swap(SnrList& other)
+    {
+        entries.swap(other.entries);
+        std::swap(minSnr, other.minSnr);
+    }
+
+    void clear()
+    {
+        entries.clear();
+        minSnr = 0;
+    }
+};
 
 #endif
@@ -40,6 +40,13 @@ class INET_API IReceptionModel : public cObject
      */
     virtual double calculateReceivedPower(double pSend, double carrierFrequency, double distance) = 0;
 
+    /**
+     * Returns true if calculateReceivedPower() is a pure function of its
+     * arguments (e.g. does not draw random numbers), so it may be called
+     * from worker threads, see ChannelControl's numThreads parameter.
+     */
+    virtual bool isThreadSafe() const { return false; }
+
     /**
      * Virtual destructor.
      */
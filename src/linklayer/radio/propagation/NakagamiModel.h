@@ -36,6 +36,7 @@ class INET_API NakagamiModel : public FreeSpaceModel {
      * To be redefined to calculate the received power of a transmission.
      */
     virtual double calculateReceivedPower(double pSend, double carrierFrequency, double distance);
+    virtual bool isThreadSafe() const { return false; }  // draws random numbers
 
     protected:
     double m;
@@ -52,6 +52,7 @@ public:
      * To be redefined to calculate the received power of a transmission.
      */
     virtual double calculateReceivedPower(double pSend, double carrierFrequency, double distance);
+    virtual bool isThreadSafe() const { return false; }  // draws random numbers
 
 };
 
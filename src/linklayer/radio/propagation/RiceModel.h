@@ -51,6 +51,7 @@ class INET_API RiceModel : public FreeSpaceModel {
      * To be redefined to calculate the received power of a transmission.
      */
     virtual double calculateReceivedPower(double pSend, double carrierFrequency, double distance);
+    virtual bool isThreadSafe() const { return false; }  // draws random numbers
     private:
     /** @brief  Ricean K Factor */
     double K;
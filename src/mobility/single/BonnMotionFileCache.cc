@@ -16,17 +16,19 @@
 //
 
 
-#include <fstream>
-#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
 
 #include "BonnMotionFileCache.h"
 
 
 const BonnMotionFile::Line *BonnMotionFile::getLine(int nodeId) const
 {
-    LineList::const_iterator it = lines.begin();
-    for (int i=0; i<nodeId && it!=lines.end(); i++) it++;
-    return (it==lines.end()) ? NULL : &(*it);
+    if (nodeId < 0 || nodeId >= (int)lines.size())
+        return NULL;
+    return &lines[nodeId];
 }
 
 
@@ -48,7 +50,7 @@ void BonnMotionFileCache::deleteInstance()
     }
 }
 
-const BonnMotionFile *BonnMotionFileCache::getFile(const char *filename)
+const BonnMotionFile *BonnMotionFileCache::getFile(const char *filename, bool useCacheFile)
 {
     // if found, return it from cache
     BMFileMap::iterator it = cache.find(std::string(filename));
@@ -57,26 +59,188 @@ const BonnMotionFile *BonnMotionFileCache::getFile(const char *filename)
 
     // load and store in cache
     BonnMotionFile& bmFile = cache[filename];
-    parseFile(filename, bmFile);
+    if (!useCacheFile || !readCacheFile(filename, bmFile))
+    {
+        parseFile(filename, bmFile);
+        if (useCacheFile)
+            writeCacheFile(filename, bmFile);
+    }
     return &bmFile;
 }
 
+void BonnMotionFileCache::makeLines(BonnMotionFile& bmFile, const std::vector<size_t>& lineStarts)
+{
+    // lines point into bmFile.values, so it must not change after this
+    bmFile.lines.clear();
+    bmFile.lines.reserve(lineStarts.size());
+    const double *data = bmFile.values.empty() ? NULL : &bmFile.values[0];
+    for (size_t i = 0; i < lineStarts.size(); i++)
+    {
+        size_t end = i + 1 < lineStarts.size() ? lineStarts[i + 1] : bmFile.values.size();
+        bmFile.lines.push_back(BonnMotionFile::Line(data + lineStarts[i], end - lineStarts[i]));
+    }
+}
+
 void BonnMotionFileCache::parseFile(const char *filename, BonnMotionFile& bmFile)
 {
-    std::ifstream in(filename, std::ios::in);
-    if (in.fail())
+    FILE *f = fopen(filename, "r");
+    if (!f)
         throw cRuntimeError("Cannot open file '%s'", filename);
 
-    std::string line;
-    while (std::getline(in, line))
+    // The file is read in chunks; only complete lines are parsed, the
+    // incomplete last line of a chunk is moved to the front of the buffer.
+    std::vector<size_t> lineStarts;
+    std::vector<char> buffer(65536);
+    size_t length = 0;
+    bool eof = false;
+    while (!eof)
+    {
+        if (length == buffer.size() - 1)
+            buffer.resize(2 * buffer.size());  // line longer than the buffer
+        size_t n = fread(&buffer[length], 1, buffer.size() - 1 - length, f);
+        length += n;
+        eof = n == 0;
+        if (eof && length == 0)
+            break;
+        buffer[length] = '\0';
+
+        char *end = eof ? &buffer[length] : strrchr(&buffer[0], '\n');
+        if (!end)
+            continue;  // no complete line yet
+        *end = '\0';
+        for (char *line = &buffer[0]; line <= end; )
+        {
+            char *eol = strchr(line, '\n');
+            if (!eol)
+                eol = end;
+            *eol = '\0';
+
+            // the numbers of the line, up to the first non-number (as operator>> would do)
+            lineStarts.push_back(bmFile.values.size());
+            char *s = line;
+            while (true)
+            {
+                char *next;
+                double d = strtod(s, &next);
+                if (next == s)
+                    break;
+                bmFile.values.push_back(d);
+                s = next;
+            }
+            line = eol + 1;
+        }
+
+        size_t consumed = end - &buffer[0] + 1;
+        if (eof)
+            break;
+        memmove(&buffer[0], &buffer[consumed], length - consumed);
+        length -= consumed;
+    }
+    fclose(f);
+    makeLines(bmFile, lineStarts);
+}
+
+//
+// Cache file layout (native byte order): magic, endianness tag, size and
+// modification time of the trace file, number of lines, number of values,
+// start offset of each line, values.
+//
+static const char cacheMagic[8] = { 'B', 'M', 'C', 'A', 'C', 'H', 'E', '1' };
+static const uint32 cacheEndianTag = 0x01020304;
+
+struct BonnMotionCacheHeader
+{
+    char magic[8];
+    uint32 endianTag;
+    uint32 sizeofDouble;
+    uint64 fileSize;
+    int64 fileModTime;
+    uint64 numLines;
+    uint64 numValues;
+};
+
+static bool fillCacheHeader(const char *filename, BonnMotionCacheHeader& header)
+{
+    struct stat st;
+    if (stat(filename, &st) != 0)
+        return false;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.endianTag = cacheEndianTag;
+    header.sizeofDouble = sizeof(double);
+    header.fileSize = st.st_size;
+    header.fileModTime = st.st_mtime;
+    return true;
+}
+
+bool BonnMotionFileCache::readCacheFile(const char *filename, BonnMotionFile& bmFile)
+{
+    BonnMotionCacheHeader expected, header;
+    if (!fillCacheHeader(filename, expected))
+        return false;
+    std::string cacheFileName = std::string(filename) + ".cache";
+    FILE *f = fopen(cacheFileName.c_str(), "rb");
+    if (!f)
+        return false;
+
+    bool ok = fread(&header, sizeof(header), 1, f) == 1
+            && memcmp(header.magic, expected.magic, sizeof(header.magic)) == 0
+            && header.endianTag == expected.endianTag
+            && header.sizeofDouble == expected.sizeofDouble
+            && header.fileSize == expected.fileSize
+            && header.fileModTime == expected.fileModTime;
+    std::vector<size_t> lineStarts;
+    if (ok)
     {
-        bmFile.lines.push_back(BonnMotionFile::Line());
-        BonnMotionFile::Line& vec = bmFile.lines.back();
+        std::vector<uint64> starts(header.numLines);
+        bmFile.values.resize(header.numValues);
+        ok = (starts.empty() || fread(&starts[0], sizeof(uint64), starts.size(), f) == starts.size())
+                && (bmFile.values.empty() || fread(&bmFile.values[0], sizeof(double), bmFile.values.size(), f) == bmFile.values.size());
+        for (size_t i = 0; ok && i < starts.size(); i++)
+        {
+            ok = starts[i] <= header.numValues && (i == 0 || starts[i] >= starts[i - 1]);
+            lineStarts.push_back(starts[i]);
+        }
+    }
+    fclose(f);
 
-        std::stringstream linestream(line);
-        double d;
-        while (linestream >> d)
-            vec.push_back(d);
+    if (!ok)
+    {
+        EV << "Ignoring outdated or invalid BonnMotion cache file '" << cacheFileName << "'\n";
+        bmFile.values.clear();
+        return false;
+    }
+    makeLines(bmFile, lineStarts);
+    return true;
+}
+
+void BonnMotionFileCache::writeCacheFile(const char *filename, const BonnMotionFile& bmFile)
+{
+    BonnMotionCacheHeader header;
+    if (!fillCacheHeader(filename, header))
+        return;
+    header.numLines = bmFile.lines.size();
+    header.numValues = bmFile.values.size();
+    std::vector<uint64> starts;
+    starts.reserve(bmFile.lines.size());
+    uint64 start = 0;
+    for (size_t i = 0; i < bmFile.lines.size(); i++)
+    {
+        starts.push_back(start);
+        start += bmFile.lines[i].size();
+    }
+
+    std::string cacheFileName = std::string(filename) + ".cache";
+    FILE *f = fopen(cacheFileName.c_str(), "wb");
+    bool ok = f != NULL
+            && fwrite(&header, sizeof(header), 1, f) == 1
+            && (starts.empty() || fwrite(&starts[0], sizeof(uint64), starts.size(), f) == starts.size())
+            && (bmFile.values.empty() || fwrite(&bmFile.values[0], sizeof(double), bmFile.values.size(), f) == bmFile.values.size());
+    if (f && fclose(f) != 0)
+        ok = false;
+    if (!ok)
+    {
+        EV << "Cannot write BonnMotion cache file '" << cacheFileName << "'\n";
+        remove(cacheFileName.c_str());
     }
-    in.close();
 }
@@ -19,7 +19,6 @@
 #ifndef BONN_MOTION_FILE_CACHE_H
 #define BONN_MOTION_FILE_CACHE_H
 
-#include <list>
 #include <vector>
 
 #include "INETDefs.h"
@@ -28,19 +27,31 @@
 class BonnMotionFileCache;
 
 /**
- * Represents a BonnMotion file's contents.
+ * Represents a BonnMotion file's contents. The numbers of all lines are
+ * stored in one contiguous array, a line is a view into it.
  * @see BonnMotionFileCache, BonnMotionMobility
  */
 class INET_API BonnMotionFile
 {
   public:
-    typedef std::vector<double> Line;
+    /** The numbers of one line (i.e. one node) of the file */
+    class INET_API Line
+    {
+      protected:
+        const double *data;
+        int length;
+      public:
+        Line(const double *data, int length) : data(data), length(length) {}
+        int size() const { return length; }
+        double operator[](int i) const { return data[i]; }
+    };
   protected:
     friend class BonnMotionFileCache;
-    typedef std::list<Line> LineList;
-    LineList lines;
+    std::vector<double> values;   // numbers of all lines, in file order
+    std::vector<Line> lines;
   public:
     const Line *getLine(int nodeId) const;
+    int getNumLines() const { return lines.size(); }
 };
 
 
@@ -49,6 +60,11 @@ class INET_API BonnMotionFile
  * BonnMotionMobility.  Needed because otherwise every node would
  * have to open and read the file independently.
  *
+ * A parsed file can optionally be stored in a binary cache file next to it
+ * (with ".cache" appended to the name), which is loaded instead of parsing
+ * the trace again as long as the trace file's size and modification time
+ * are unchanged.
+ *
  * @ingroup mobility
  * @author Andras Varga
  */
@@ -59,6 +75,9 @@ class INET_API BonnMotionFileCache
     BMFileMap cache;
     static BonnMotionFileCache *inst;
     void parseFile(const char *filename, BonnMotionFile& bmFile);
+    void makeLines(BonnMotionFile& bmFile, const std::vector<size_t>& lineStarts);
+    bool readCacheFile(const char *filename, BonnMotionFile& bmFile);
+    void writeCacheFile(const char *filename, const BonnMotionFile& bmFile);
     BonnMotionFileCache() {}
     virtual ~BonnMotionFileCache() {}
 
@@ -74,9 +93,10 @@ class INET_API BonnMotionFileCache
     static void deleteInstance();
 
     /**
-     * Returns the given document.
+     * Returns the given document. If useCacheFile is true, the document is
+     * loaded from (or after parsing, stored into) its binary cache file.
      */
-    virtual const BonnMotionFile *getFile(const char *filename);
+    virtual const BonnMotionFile *getFile(const char *filename, bool useCacheFile = false);
 };
 
 #endif
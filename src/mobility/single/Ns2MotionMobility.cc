@@ -19,7 +19,6 @@
 
 
 #include <fstream>
-#include <sstream>
 #include <string>
 
 #include "Ns2MotionMobility.h"
@@ -37,6 +36,7 @@ Ns2MotionMobility::Ns2MotionMobility()
 {
     vecpos = 0;
     ns2File = NULL;
+    usesFileCache = false;
     nodeId = 0;
     scrollX = 0;
     scrollY = 0;
@@ -44,86 +44,108 @@ Ns2MotionMobility::Ns2MotionMobility()
 
 Ns2MotionMobility::~Ns2MotionMobility()
 {
-    if (ns2File)
-        delete ns2File;
+    if (usesFileCache)
+        Ns2MotionFileCache::releaseInstance();
 }
 
-void Ns2MotionMobility::parseFile(const char *filename)
+
+Ns2MotionFileCache *Ns2MotionFileCache::inst;
+
+Ns2MotionFileCache *Ns2MotionFileCache::getInstance()
+{
+    if (!inst)
+        inst = new Ns2MotionFileCache;
+    inst->numUsers++;
+    return inst;
+}
+
+void Ns2MotionFileCache::releaseInstance()
+{
+    if (inst && --inst->numUsers == 0)
+    {
+        delete inst;
+        inst = NULL;
+    }
+}
+
+const Ns2MotionFile *Ns2MotionFileCache::getFile(const char *filename, int nodeId)
 {
+    FileMap::iterator it = cache.find(std::string(filename));
+    if (it == cache.end())
+    {
+        it = cache.insert(std::make_pair(std::string(filename), NodeMap())).first;
+        parseFile(filename, it->second);
+    }
+    NodeMap::const_iterator nodeIt = it->second.find(nodeId);
+    return nodeIt == it->second.end() ? NULL : &nodeIt->second;
+}
 
+void Ns2MotionFileCache::parseFile(const char *filename, NodeMap& nodes)
+{
     std::ifstream in(filename, std::ios::in);
 
     if (in.fail())
         throw cRuntimeError("Cannot open file '%s'", filename);
-    ns2File->initial[0] = ns2File->initial[1] = ns2File->initial[2] = -1;
     std::string line;
-    std::string subline;
 
     while (std::getline(in, line))
     {
         // '#' line
-        int num_node;
         std::string::size_type found = line.find('#');
         if (found == 0)
             continue;
-        if (found != std::string::npos)
-            subline = line;
-        else
-            subline = line.substr(0, found);
-        found = subline.find("$node_");
+        found = line.find("$node_");
         if (found == std::string::npos)
             continue;
         // Node Id
-        std::string::size_type pos1 = subline.find('(');
-        std::string::size_type pos2 = subline.find(')');
-        if (pos2-pos1>1)
-            num_node = std::atoi(subline.substr(pos1+1, pos2-1).c_str());
-        if (num_node!=nodeId)
+        std::string::size_type pos1 = line.find('(');
+        std::string::size_type pos2 = line.find(')');
+        if (pos1 == std::string::npos || pos2 == std::string::npos || pos2-pos1 <= 1)
             continue;
+        const char *s = line.c_str();
+        Ns2MotionFile& ns2File = nodes[std::atoi(s+pos1+1)];
         // Initial position
-        found = subline.find("set ");
+        found = line.find("set ");
         if (found!=std::string::npos)
         {
             // Initial position
-            found = subline.find("X_");
-            if (found!=std::string::npos)
-            {
-                ns2File->initial[0] = std::atof(subline.substr(found+3, std::string::npos).c_str());
-            }
-            found = subline.find("Y_");
-            if (found!=std::string::npos)
-            {
-                ns2File->initial[1] = std::atof(subline.substr(found+3, std::string::npos).c_str());
-            }
-
-            found = subline.find("Z_");
-            if (found!=std::string::npos)
-            {
-                ns2File->initial[2] = std::atof(subline.substr(found+3, std::string::npos).c_str());
-            }
+            found = line.find("X_");
+            if (found!=std::string::npos && found+3 <= line.size())
+                ns2File.initial[0] = std::atof(s+found+3);
+            found = line.find("Y_");
+            if (found!=std::string::npos && found+3 <= line.size())
+                ns2File.initial[1] = std::atof(s+found+3);
+            found = line.find("Z_");
+            if (found!=std::string::npos && found+3 <= line.size())
+                ns2File.initial[2] = std::atof(s+found+3);
         }
-        found = subline.find("setdest");
+        found = line.find("setdest ");
         if (found!=std::string::npos)
         {
-            ns2File->lines.push_back(Ns2MotionFile::Line());
-            Ns2MotionFile::Line& vec = ns2File->lines.back();
+            Ns2MotionFile::Waypoint waypoint;
             // initial time
-            found = subline.find("at");
-            vec.push_back(std::atof(subline.substr(found+3).c_str()));
-
-            std::string parameters = subline.substr(subline.find("setdest ")+8, std::string::npos);
+            std::string::size_type at = line.find("at");
+            waypoint.time = at+3 <= line.size() ? std::atof(s+at+3) : 0;
 
-            std::stringstream linestream(parameters);
-            double d;
-            while (linestream >> d)
-                vec.push_back(d);
+            // destination and speed; missing numbers are zero
+            double *fields[3] = { &waypoint.x, &waypoint.y, &waypoint.speed };
+            const char *p = s+found+8;
+            for (int i = 0; i < 3; i++)
+            {
+                char *end;
+                *fields[i] = strtod(p, &end);
+                if (end == p)
+                {
+                    for (; i < 3; i++)
+                        *fields[i] = 0;
+                    break;
+                }
+                p = end;
+            }
+            ns2File.waypoints.push_back(waypoint);
         }
     }
     in.close();
-    // exist data?
-    if (ns2File->initial[0]==-1 || ns2File->initial[1]==-1 || ns2File->initial[2]==-1)
-        throw cRuntimeError("node '%d' Error ns2 motion file '%s'", nodeId, filename);
-
 }
 
 void Ns2MotionMobility::initialize(int stage)
@@ -139,8 +161,12 @@ void Ns2MotionMobility::initialize(int stage)
         if (nodeId == -1)
             nodeId = getContainingNode(this)->getIndex();
         const char *fname = par("traceFile");
-        ns2File = new Ns2MotionFile;
-        parseFile(fname);
+        Ns2MotionFileCache *fileCache = Ns2MotionFileCache::getInstance();
+        usesFileCache = true;
+        ns2File = fileCache->getFile(fname, nodeId);
+        // exist data?
+        if (!ns2File || ns2File->initial[0]==-1 || ns2File->initial[1]==-1 || ns2File->initial[2]==-1)
+            throw cRuntimeError("node '%d' Error ns2 motion file '%s'", nodeId, fname);
         vecpos = 0;
         WATCH(nodeId);
     }
@@ -154,28 +180,15 @@ void Ns2MotionMobility::setInitialPosition()
 
 void Ns2MotionMobility::setTargetPosition()
 {
-
-    if (ns2File->lines.size()==0)
-    {
-        stationary = true;
-        return;
-    }
-
-    if (vecpos >= ns2File->lines.size())
-    {
-        stationary = true;
-        return;
-    }
-
-
-    if (ns2File->lines.begin()+vecpos == ns2File->lines.end())
+    const std::vector<Ns2MotionFile::Waypoint>& waypoints = ns2File->waypoints;
+    if (vecpos >= waypoints.size())
     {
         stationary = true;
         return;
     }
 
-    const Ns2MotionFile::Line& vec = ns2File->lines[vecpos];
-    double time = vec[0];
+    const Ns2MotionFile::Waypoint& waypoint = waypoints[vecpos];
+    double time = waypoint.time;
     simtime_t now = simTime();
     // TODO: this code is dubious at best
     if (now < time)
@@ -183,19 +196,22 @@ void Ns2MotionMobility::setTargetPosition()
         nextChange = time;
         targetPosition = lastPosition;
     }
-    else if (vec[3] == 0) // the node is stopped
+    else if (waypoint.speed == 0) // the node is stopped
     {
-        const Ns2MotionFile::Line& vec = ns2File->lines[vecpos+1];
-        double time = vec[0];
-        nextChange = time;
+        if (vecpos + 1 >= waypoints.size())
+        {
+            stationary = true;
+            return;
+        }
+        nextChange = waypoints[vecpos+1].time;
         targetPosition = lastPosition;
         vecpos++;
     }
     else
     {
-        targetPosition.x = vec[1]+scrollX;
-        targetPosition.y = vec[2]+scrollY;
-        double speed = vec[3];
+        targetPosition.x = waypoint.x+scrollX;
+        targetPosition.y = waypoint.y+scrollY;
+        double speed = waypoint.speed;
         double distance = lastPosition.distance(targetPosition);
         double travelTime = distance / speed;
         nextChange = now + travelTime;
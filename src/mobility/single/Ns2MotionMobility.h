@@ -33,20 +33,70 @@
  * @author Alfonso Ariza
  */
 
-class Ns2MotionMobility;
+class Ns2MotionFileCache;
 
 /**
- * Represents a ns2 motion file's contents.
+ * Represents the part of a ns2 motion file that belongs to one node:
+ * its initial position and its setdest commands in file order.
  */
 class INET_API Ns2MotionFile
 {
   public:
-    typedef std::vector<double> Line;
+    /** One setdest command; missing numbers are zero */
+    struct Waypoint
+    {
+        double time;
+        double x;
+        double y;
+        double speed;
+    };
     double initial[3];
+    std::vector<Waypoint> waypoints;
+
+  public:
+    Ns2MotionFile() { initial[0] = initial[1] = initial[2] = -1; }
+};
+
+/**
+ * Singleton object to read and store ns2 motion files. The file is parsed
+ * only once, and split into the Ns2MotionFile objects of the nodes it
+ * contains; otherwise every node would have to parse the whole file.
+ *
+ * The instance is reference counted: each Ns2MotionMobility module acquires
+ * it with getInstance() and releases it with releaseInstance(), and it is
+ * deleted when the last module goes away, so nodes deleted at runtime do
+ * not free the data the other nodes still use.
+ */
+class INET_API Ns2MotionFileCache
+{
   protected:
-    friend class Ns2MotionMobility;
-    typedef std::vector<Line> LineList;
-    LineList lines;
+    typedef std::map<int,Ns2MotionFile> NodeMap;
+    typedef std::map<std::string,NodeMap> FileMap;
+    FileMap cache;
+    int numUsers;
+    static Ns2MotionFileCache *inst;
+    void parseFile(const char *filename, NodeMap& nodes);
+    Ns2MotionFileCache() : numUsers(0) {}
+    virtual ~Ns2MotionFileCache() {}
+
+  public:
+    /**
+     * Returns the singleton instance, and registers one more user of it.
+     * Each call must be paired with a releaseInstance() call.
+     */
+    static Ns2MotionFileCache *getInstance();
+
+    /**
+     * Unregisters a user of the singleton instance, and deletes the instance
+     * when it has no more users.
+     */
+    static void releaseInstance();
+
+    /**
+     * Returns the motion of the given node in the given file, or NULL
+     * if the file does not mention the node.
+     */
+    virtual const Ns2MotionFile *getFile(const char *filename, int nodeId);
 };
 
 class INET_API Ns2MotionMobility : public LineSegmentsMobilityBase
@@ -54,14 +104,13 @@ class INET_API Ns2MotionMobility : public LineSegmentsMobilityBase
   protected:
     // state
     unsigned int vecpos;
-    Ns2MotionFile *ns2File;
+    const Ns2MotionFile *ns2File;
+    bool usesFileCache;
     int nodeId;
     double scrollX;
     double scrollY;
 
   protected:
-    void parseFile(const char *filename);
-
     virtual int numInitStages() const { return 3; }
 
     /** @brief Initializes mobility model parameters.*/
@@ -87,6 +87,9 @@ void IPv4NetworkConfigurator::initialize(int stage)
         addSubnetRoutesParameter = par("addSubnetRoutes");
         addDefaultRoutesParameter = par("addDefaultRoutes");
         optimizeRoutesParameter = par("optimizeRoutes");
+        numThreads = par("numThreads");
+        if (numThreads < 1)
+            throw cRuntimeError("numThreads must be at least 1");
         configuration = par("config");
     }
     else if (stage == 2)
@@ -1735,124 +1738,155 @@ bool IPv4NetworkConfigurator::containsRoute(const std::vector<IPv4Route *>& rout
     return false;
 }
 
+void IPv4NetworkConfigurator::StaticRoutesTask::run(int index)
+{
+    configurator->addStaticRoutes(*topology, sourceNodes[index], logs.empty() ? NULL : &logs[index]);
+}
+
 void IPv4NetworkConfigurator::addStaticRoutes(IPv4Topology& topology)
 {
     // TODO: it should be configurable (via xml?) which nodes need static routes filled in automatically
     // add static routes for all routing tables
+    StaticRoutesTask task;
+    task.configurator = this;
+    task.topology = &topology;
     for (int i = 0; i < topology.getNumNodes(); i++) {
         Node *sourceNode = (Node *)topology.getNode(i);
-        if (!sourceNode->interfaceTable)
-            continue;
+        if (sourceNode->interfaceTable)
+            task.sourceNodes.push_back(sourceNode);
+    }
+    int numSourceNodes = task.sourceNodes.size();
+    if (!ev.isDisabled())
+        task.logs.resize(numSourceNodes);
 
-        // calculate shortest paths from everywhere to sourceNode
-        // we are going to use the paths in reverse direction (assuming all links are bidirectional)
-        topology.calculateUnweightedSingleShortestPathsTo(sourceNode);
+    // the routes of a source node only depend on the (read-only) topology
+    if (numThreads > 1 && numSourceNodes > 1) {
+        ThreadPool threadPool(std::min(numThreads, numSourceNodes));
+        threadPool.runAll(&task, numSourceNodes);
+    }
+    else {
+        for (int i = 0; i < numSourceNodes; i++)
+            task.run(i);
+    }
 
-        // check if adding the default routes would be ok (this is an optimization)
-        if (addDefaultRoutesParameter && sourceNode->interfaceInfos.size() == 1 && sourceNode->interfaceInfos[0]->linkInfo->gatewayInterfaceInfo)
-        {
-          if (sourceNode->interfaceInfos[0]->addDefaultRoute)
-          {
-            InterfaceInfo *sourceInterfaceInfo = sourceNode->interfaceInfos[0];
-            InterfaceEntry *sourceInterfaceEntry = sourceInterfaceInfo->interfaceEntry;
-            InterfaceInfo *gatewayInterfaceInfo = sourceInterfaceInfo->linkInfo->gatewayInterfaceInfo;
-
-            // add a network route for the local network using ARP
-            IPv4Route *route = new IPv4Route();
-            route->setDestination(sourceInterfaceInfo->getAddress().doAnd(sourceInterfaceInfo->getNetmask()));
-            route->setGateway(IPv4Address::UNSPECIFIED_ADDRESS);
-            route->setNetmask(sourceInterfaceInfo->getNetmask());
-            route->setInterface(sourceInterfaceEntry);
-            route->setSourceType(IPv4Route::MANUAL);
-            sourceNode->staticRoutes.push_back(route);
-
-            // add a default route towards the only one gateway
-            route = new IPv4Route();
-            IPv4Address gateway = gatewayInterfaceInfo->getAddress();
-            route->setDestination(IPv4Address::UNSPECIFIED_ADDRESS);
-            route->setNetmask(IPv4Address::UNSPECIFIED_ADDRESS);
-            route->setGateway(gateway);
-            route->setInterface(sourceInterfaceEntry);
-            route->setSourceType(IPv4Route::MANUAL);
-            sourceNode->staticRoutes.push_back(route);
-
-            // skip building and optimizing the whole routing table
-            EV_DEBUG << "Adding default routes to " << sourceNode->getModule()->getFullPath() << ", node has only one (non-loopback) interface\n";
-          }
-        }
-        else
+    for (int i = 0; i < (int)task.logs.size(); i++)
+        for (int j = 0; j < (int)task.logs[i].size(); j++)
+            EV_DEBUG << task.logs[i][j];
+}
+
+void IPv4NetworkConfigurator::addStaticRoutes(IPv4Topology& topology, Node *sourceNode, std::vector<std::string> *log)
+{
+    // calculate shortest paths from everywhere to sourceNode
+    // we are going to use the paths in reverse direction (assuming all links are bidirectional)
+    Topology::PathInfoVector paths;
+    topology.calculateUnweightedSingleShortestPathsTo(sourceNode, paths);
+
+    // check if adding the default routes would be ok (this is an optimization)
+    if (addDefaultRoutesParameter && sourceNode->interfaceInfos.size() == 1 && sourceNode->interfaceInfos[0]->linkInfo->gatewayInterfaceInfo)
+    {
+      if (sourceNode->interfaceInfos[0]->addDefaultRoute)
+      {
+        InterfaceInfo *sourceInterfaceInfo = sourceNode->interfaceInfos[0];
+        InterfaceEntry *sourceInterfaceEntry = sourceInterfaceInfo->interfaceEntry;
+        InterfaceInfo *gatewayInterfaceInfo = sourceInterfaceInfo->linkInfo->gatewayInterfaceInfo;
+
+        // add a network route for the local network using ARP
+        IPv4Route *route = new IPv4Route();
+        route->setDestination(sourceInterfaceInfo->getAddress().doAnd(sourceInterfaceInfo->getNetmask()));
+        route->setGateway(IPv4Address::UNSPECIFIED_ADDRESS);
+        route->setNetmask(sourceInterfaceInfo->getNetmask());
+        route->setInterface(sourceInterfaceEntry);
+        route->setSourceType(IPv4Route::MANUAL);
+        sourceNode->staticRoutes.push_back(route);
+
+        // add a default route towards the only one gateway
+        route = new IPv4Route();
+        IPv4Address gateway = gatewayInterfaceInfo->getAddress();
+        route->setDestination(IPv4Address::UNSPECIFIED_ADDRESS);
+        route->setNetmask(IPv4Address::UNSPECIFIED_ADDRESS);
+        route->setGateway(gateway);
+        route->setInterface(sourceInterfaceEntry);
+        route->setSourceType(IPv4Route::MANUAL);
+        sourceNode->staticRoutes.push_back(route);
+
+        // skip building and optimizing the whole routing table
+        if (log)
+            log->push_back("Adding default routes to " + sourceNode->getModule()->getFullPath() + ", node has only one (non-loopback) interface\n");
+      }
+    }
+    else
+    {
+        // add a route to all destinations in the network
+        for (int j = 0; j < topology.getNumNodes(); j++)
         {
-            // add a route to all destinations in the network
-            for (int j = 0; j < topology.getNumNodes(); j++)
+            // extract destination
+            Node *destinationNode = (Node *)topology.getNode(j);
+            if (sourceNode == destinationNode)
+                continue;
+            if (paths[destinationNode->getIndex()].getNumPaths() == 0)
+                continue;
+            if (!destinationNode->interfaceTable)
+                continue;
+
+            // determine next hop interface
+            // find next hop interface (the last IP interface on the path that is not in the source node)
+            Node *node = destinationNode;
+            Link *link = NULL;
+            InterfaceInfo *nextHopInterfaceInfo = NULL;
+            while (node != sourceNode)
             {
-                // extract destination
-                Node *destinationNode = (Node *)topology.getNode(j);
-                if (sourceNode == destinationNode)
-                    continue;
-                if (destinationNode->getNumPaths() == 0)
-                    continue;
-                if (!destinationNode->interfaceTable)
-                    continue;
-
-                // determine next hop interface
-                // find next hop interface (the last IP interface on the path that is not in the source node)
-                Node *node = destinationNode;
-                Link *link = NULL;
-                InterfaceInfo *nextHopInterfaceInfo = NULL;
-                while (node != sourceNode)
-                {
-                    link = (Link *)node->getPath(0);
-                    if (node->interfaceTable && node != sourceNode && link->sourceInterfaceInfo)
-                        nextHopInterfaceInfo = link->sourceInterfaceInfo;
-                    node = (Node *)node->getPath(0)->getRemoteNode();
-                }
+                link = (Link *)paths[node->getIndex()].getPath(0);
+                if (node->interfaceTable && node != sourceNode && link->sourceInterfaceInfo)
+                    nextHopInterfaceInfo = link->sourceInterfaceInfo;
+                node = (Node *)paths[node->getIndex()].getPath(0)->getRemoteNode();
+            }
 
-                // determine source interface
-                if (link->destinationInterfaceInfo && link->destinationInterfaceInfo->addStaticRoute)
-                {
-                    InterfaceEntry *sourceInterfaceEntry = link->destinationInterfaceInfo->interfaceEntry;
+            // determine source interface
+            if (link->destinationInterfaceInfo && link->destinationInterfaceInfo->addStaticRoute)
+            {
+                InterfaceEntry *sourceInterfaceEntry = link->destinationInterfaceInfo->interfaceEntry;
 
-                    // add the same routes for all destination interfaces (IP packets are accepted from any interface at the destination)
-                    for (int j = 0; j < (int)destinationNode->interfaceInfos.size(); j++)
+                // add the same routes for all destination interfaces (IP packets are accepted from any interface at the destination)
+                for (int j = 0; j < (int)destinationNode->interfaceInfos.size(); j++)
+                {
+                    InterfaceInfo *destinationInterfaceInfo = destinationNode->interfaceInfos[j];
+                    InterfaceEntry *destinationInterfaceEntry = destinationInterfaceInfo->interfaceEntry;
+                    IPv4Address destinationAddress = destinationInterfaceInfo->getAddress();
+                    IPv4Address destinationNetmask = destinationInterfaceInfo->getNetmask();
+                    if (!destinationInterfaceEntry->isLoopback() && !destinationAddress.isUnspecified())
                     {
-                        InterfaceInfo *destinationInterfaceInfo = destinationNode->interfaceInfos[j];
-                        InterfaceEntry *destinationInterfaceEntry = destinationInterfaceInfo->interfaceEntry;
-                        IPv4Address destinationAddress = destinationInterfaceInfo->getAddress();
-                        IPv4Address destinationNetmask = destinationInterfaceInfo->getNetmask();
-                        if (!destinationInterfaceEntry->isLoopback() && !destinationAddress.isUnspecified())
+                        IPv4Route *route = new IPv4Route();
+                        IPv4Address gatewayAddress = nextHopInterfaceInfo->getAddress();
+                        if (addSubnetRoutesParameter && destinationNode->interfaceInfos.size() == 1 && destinationNode->interfaceInfos[0]->linkInfo->gatewayInterfaceInfo
+                                && destinationNode->interfaceInfos[0]->addSubnetRoute)
                         {
-                            IPv4Route *route = new IPv4Route();
-                            IPv4Address gatewayAddress = nextHopInterfaceInfo->getAddress();
-                            if (addSubnetRoutesParameter && destinationNode->interfaceInfos.size() == 1 && destinationNode->interfaceInfos[0]->linkInfo->gatewayInterfaceInfo
-                                    && destinationNode->interfaceInfos[0]->addSubnetRoute)
-                            {
-                                route->setDestination(destinationAddress.doAnd(destinationNetmask));
-                                route->setNetmask(destinationNetmask);
-                            }
-                            else
-                            {
-                                route->setDestination(destinationAddress);
-                                route->setNetmask(IPv4Address::ALLONES_ADDRESS);
-                            }
-                            route->setInterface(sourceInterfaceEntry);
-                            if (gatewayAddress != destinationAddress)
-                                route->setGateway(gatewayAddress);
-                            route->setSourceType(IPv4Route::MANUAL);
-                            if (containsRoute(sourceNode->staticRoutes, route))
-                                delete route;
-                            else {
-                                sourceNode->staticRoutes.push_back(route);
-                                EV_DEBUG << "Adding route " << sourceInterfaceEntry->getFullPath() << " -> " << destinationInterfaceEntry->getFullPath() << " as " << route->info() << endl;
-                            }
+                            route->setDestination(destinationAddress.doAnd(destinationNetmask));
+                            route->setNetmask(destinationNetmask);
+                        }
+                        else
+                        {
+                            route->setDestination(destinationAddress);
+                            route->setNetmask(IPv4Address::ALLONES_ADDRESS);
+                        }
+                        route->setInterface(sourceInterfaceEntry);
+                        if (gatewayAddress != destinationAddress)
+                            route->setGateway(gatewayAddress);
+                        route->setSourceType(IPv4Route::MANUAL);
+                        if (containsRoute(sourceNode->staticRoutes, route))
+                            delete route;
+                        else {
+                            sourceNode->staticRoutes.push_back(route);
+                            if (log)
+                                log->push_back("Adding route " + sourceInterfaceEntry->getFullPath() + " -> " + destinationInterfaceEntry->getFullPath() + " as " + route->info() + "\n");
                         }
                     }
                 }
             }
-
-            // optimize routing table to save memory and increase lookup performance
-            if (optimizeRoutesParameter)
-                optimizeRoutes(sourceNode->staticRoutes);
         }
+
+        // optimize routing table to save memory and increase lookup performance
+        if (optimizeRoutesParameter)
+            optimizeRoutes(sourceNode->staticRoutes);
     }
 }
 
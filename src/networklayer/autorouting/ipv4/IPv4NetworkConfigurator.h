@@ -31,6 +31,7 @@
 #include "IPvXAddressResolver.h"
 #include "IPv4InterfaceData.h"
 #include "PatternMatcher.h"
+#include "ThreadPool.h"
 
 
 /**
@@ -177,6 +178,23 @@ class INET_API IPv4NetworkConfigurator : public cSimpleModule, public IPvXAddres
                 bool matchesAny() { return matchesany; }
         };
 
+        /**
+         * Computes the static routes of the source nodes in parallel; the debug
+         * output of each source node is collected separately and printed in
+         * node order afterwards.
+         */
+        class StaticRoutesTask : public ThreadPool::Task
+        {
+            public:
+                IPv4NetworkConfigurator *configurator;
+                IPv4Topology *topology;
+                std::vector<Node *> sourceNodes;
+                std::vector<std::vector<std::string> > logs;  // per source node, empty if logging is disabled
+
+            public:
+                virtual void run(int index);
+        };
+
         class InterfaceMatcher
         {
             protected:
@@ -200,6 +218,7 @@ class INET_API IPv4NetworkConfigurator : public cSimpleModule, public IPvXAddres
         bool addSubnetRoutesParameter;
         bool addDefaultRoutesParameter;
         bool optimizeRoutesParameter;
+        int numThreads;
         cXMLElement *configuration;
 
         // internal state
@@ -277,6 +296,14 @@ class INET_API IPv4NetworkConfigurator : public cSimpleModule, public IPvXAddres
          */
         virtual void addStaticRoutes(IPv4Topology& topology);
 
+        /**
+         * Adds the static routes of a single source node to its staticRoutes.
+         * Only reads the topology and modifies the source node, so it may run
+         * concurrently for different source nodes. Debug messages are appended
+         * to log unless it is NULL.
+         */
+        virtual void addStaticRoutes(IPv4Topology& topology, Node *sourceNode, std::vector<std::string> *log);
+
         /**
          * Destructively optimizes the given IPv4 routes by merging some of them.
          * The resulting routes might be different in that they will route packets
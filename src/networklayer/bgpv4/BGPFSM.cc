@@ -377,6 +377,8 @@ void Established::entry()
     std::cout << "Established::entry - send an update message" << std::endl;
     BGPSession& session = TopState::box().getModule();
     session._info.sessionEstablished = true;
+    //new session: the peer has to learn all routes again
+    session.clearAdjRIBs();
 
     //if it's an EGP Session, send update messages with all routing information to BGP peer
     //if it's an IGP Session, send update message with only the BGP routes learned by EGP
@@ -409,11 +411,22 @@ void Established::entry()
         }
     }
 
-    std::vector<BGP::RoutingTableEntry*> BGPRoutingTable = session.getBGPRoutingTable();
-    for (std::vector<BGP::RoutingTableEntry*>::iterator it = BGPRoutingTable.begin(); it != BGPRoutingTable.end(); it++)
+    //if it's an EGP Session, also send the prefixes originated by the AS
+    if (session.getType() == BGP::EGP)
     {
-        session.updateSendProcess((*it));
+        const std::vector<BGP::RoutingTableEntry*>& networks = session.getNetworks();
+        for (std::vector<BGP::RoutingTableEntry*>::const_iterator it = networks.begin(); it != networks.end(); it++)
+        {
+            session.updateSendProcess(*it);
+        }
+    }
+
+    const BGP::PrefixTable& BGPRoutingTable = session.getBGPRoutingTable();
+    for (BGP::PrefixTable::const_iterator it = BGPRoutingTable.begin(); it != BGPRoutingTable.end(); it++)
+    {
+        session.updateSendProcess(it->second);
     }
+    session.flushUpdates();
 
     //when all EGP Session is in established state, start IGP Session(s)
     BGP::SessionID nextSession = session.findAndStartNextSession(BGP::EGP);
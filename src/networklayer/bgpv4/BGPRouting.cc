@@ -32,9 +32,14 @@ BGPRouting::~BGPRouting(void)
     {
         (*sessionIterator).second->~BGPSession();
     }
-    _BGPRoutingTable.erase(_BGPRoutingTable.begin(), _BGPRoutingTable.end());
-    _prefixListIN.erase(_prefixListIN.begin(), _prefixListIN.end());
-    _prefixListOUT.erase(_prefixListOUT.begin(), _prefixListOUT.end());
+    _BGPRoutingTable.clear();
+    for (std::vector<BGP::RoutingTableEntry*>::iterator it = _networks.begin(); it != _networks.end(); it++)
+    {
+        delete *it;
+    }
+    _networks.clear();
+    _prefixListIN.clear();
+    _prefixListOUT.clear();
 }
 
 void BGPRouting::initialize(int stage)
@@ -53,11 +58,16 @@ void BGPRouting::initialize(int stage)
         _rt = RoutingTableAccess().get();
         _inft = InterfaceTableAccess().get();
 
+        int maxNLRIPerUpdate = par("maxNLRIPerUpdate");
+        if (maxNLRIPerUpdate < 1)
+            throw cRuntimeError("Invalid maxNLRIPerUpdate parameter value: %d", maxNLRIPerUpdate);
+        _maxNLRIPerUpdate = maxNLRIPerUpdate;
+
         // read BGP configuration
         cXMLElement *bgpConfig = par("bgpConfig").xmlValue();
         loadConfigFromXML(bgpConfig);
         createWatch("myAutonomousSystem", _myAS);
-        WATCH_PTRVECTOR(_BGPRoutingTable);
+        WATCH_PTRMAP(_BGPRoutingTable);
     }
 }
 
@@ -269,38 +279,75 @@ void BGPRouting::processMessage(const BGPUpdateMessage& msg)
     EV << "Processing BGP Update message" << std::endl;
     _BGPSessions[_currSessionId]->getFSM()->UpdateMsgEvent();
 
-    unsigned char               decisionProcessResult;
-    IPv4Address                 netMask(IPv4Address::ALLONES_ADDRESS);
-    BGP::RoutingTableEntry*     entry = new BGP::RoutingTableEntry();
-    const unsigned char         length = msg.getNLRI().length;
-    unsigned int                ASValueCount = msg.getPathAttributeList(0).getAsPath(0).getValue(0).getAsValueArraySize();
-
-    entry->setDestination(msg.getNLRI().prefix);
-    netMask = IPv4Address::makeNetmask(length);
-    entry->setNetmask(netMask);
-    for (unsigned int j=0; j < ASValueCount; j++)
+    if (msg.getNLRIArraySize() == 0)
     {
-        entry->addAS(msg.getPathAttributeList(0).getAsPath(0).getValue(0).getAsValue(j));
+        return;
     }
 
-    decisionProcessResult = asLoopDetection(entry, _myAS);
-
-    if (decisionProcessResult == BGP::ASLOOP_NO_DETECTED)
+    const BGPUpdatePathAttributeList&   content = msg.getPathAttributeList(0);
+    unsigned int                        ASValueCount = content.getAsPath(0).getValue(0).getAsValueArraySize();
+    for (unsigned int i = 0; i < msg.getNLRIArraySize(); i++)
     {
-        // RFC 4271, 9.1.  Decision Process
-        decisionProcessResult = decisionProcess(msg, entry, _currSessionId);
-        //RFC 4271, 9.2.  Update-Send Process
-        if (decisionProcessResult != 0)
+        unsigned char               decisionProcessResult;
+        IPv4Address                 netMask(IPv4Address::ALLONES_ADDRESS);
+        BGP::RoutingTableEntry*     entry = new BGP::RoutingTableEntry();
+        const unsigned char         length = msg.getNLRI(i).length;
+        bool                        isNewInAdjRIBIn = _BGPSessions[_currSessionId]->addToAdjRIBIn(msg.getNLRI(i), content);
+
+        entry->setDestination(msg.getNLRI(i).prefix);
+        netMask = IPv4Address::makeNetmask(length);
+        entry->setNetmask(netMask);
+        for (unsigned int j=0; j < ASValueCount; j++)
+        {
+            entry->addAS(content.getAsPath(0).getValue(0).getAsValue(j));
+        }
+
+        //the peer repeated a route that is already the selected one: the Decision Process would not change anything
+        if (!isNewInAdjRIBIn)
+        {
+            BGP::RoutingTableEntry* selectedEntry = findInTable(_BGPRoutingTable, entry);
+            if (selectedEntry != NULL && selectedEntry->getPathType() == content.getOrigin().getValue() &&
+                selectedEntry->getASCount() == ASValueCount)
+            {
+                unsigned int j = 0;
+                while (j < ASValueCount && selectedEntry->getAS(j) == entry->getAS(j))
+                {
+                    j++;
+                }
+                if (j == ASValueCount)
+                {
+                    delete entry;
+                    continue;
+                }
+            }
+        }
+
+        decisionProcessResult = asLoopDetection(entry, _myAS);
+
+        if (decisionProcessResult == BGP::ASLOOP_NO_DETECTED)
         {
-            updateSendProcess(decisionProcessResult, _currSessionId, entry);
+            // RFC 4271, 9.1.  Decision Process
+            decisionProcessResult = decisionProcess(msg, entry, _currSessionId);
+            //RFC 4271, 9.2.  Update-Send Process
+            if (decisionProcessResult != 0)
+            {
+                updateSendProcess(decisionProcessResult, _currSessionId, entry);
+            }
         }
     }
+
+    //send the UPDATE messages packed by the Update-Send Process
+    for (std::map<BGP::SessionID, BGPSession*>::iterator sessionIt = _BGPSessions.begin();
+        sessionIt != _BGPSessions.end(); sessionIt ++)
+    {
+        (*sessionIt).second->flushUpdates();
+    }
 }
 
 unsigned char BGPRouting::decisionProcess(const BGPUpdateMessage& msg, BGP::RoutingTableEntry* entry, BGP::SessionID sessionIndex)
 {
     //Don't add the route if it exists in PrefixListINTable or in ASListINTable
-    if (isInTable(_prefixListIN, entry) != (unsigned long)-1 || isInASList(_ASListIN, entry))
+    if (findInTable(_prefixListIN, entry) != NULL || isInASList(_ASListIN, entry))
     {
         return 0;
     }
@@ -312,25 +359,25 @@ unsigned char BGPRouting::decisionProcess(const BGPUpdateMessage& msg, BGP::Rout
 
     //if the route already exist in BGP routing table, tieBreakingProcess();
     //(RFC 4271: 9.1.2.2 Breaking Ties)
-    unsigned long BGPindex = isInTable(_BGPRoutingTable, entry);
-    if (BGPindex != (unsigned long)-1)
+    BGP::RoutingTableEntry* oldEntry = findInTable(_BGPRoutingTable, entry);
+    if (oldEntry != NULL)
     {
-        if (tieBreakingProcess(_BGPRoutingTable[BGPindex], entry))
+        if (tieBreakingProcess(oldEntry, entry))
         {
             return 0;
         }
         else
         {
             entry->setInterface(_BGPSessions[sessionIndex]->getLinkIntf());
-            _BGPRoutingTable.push_back(entry);
+            _BGPRoutingTable[BGP::getPrefixKey(entry)] = entry;
             _rt->addRoute(entry);
             return BGP::ROUTE_DESTINATION_CHANGED;
         }
     }
 
     //Don't add the route if it exists in IPv4 routing table except if the msg come from IGP session
-    int indexIP = isInRoutingTable(_rt, entry->getDestination());
-    if (indexIP != -1 && _rt->getRoute(indexIP)->getSourceType() != IPv4Route::BGP )
+    IPv4Route* routeIP = isInRoutingTable(_rt, entry->getDestination());
+    if (routeIP != NULL && routeIP->getSourceType() != IPv4Route::BGP )
     {
         if (_BGPSessions[sessionIndex]->getType() != BGP::IGP )
         {
@@ -339,18 +386,18 @@ unsigned char BGPRouting::decisionProcess(const BGPUpdateMessage& msg, BGP::Rout
         else
         {
             IPv4Route* newEntry = new IPv4Route;
-            newEntry->setDestination(_rt->getRoute(indexIP)->getDestination());
-            newEntry->setNetmask(_rt->getRoute(indexIP)->getNetmask());
-            newEntry->setGateway(_rt->getRoute(indexIP)->getGateway());
-            newEntry->setInterface(_rt->getRoute(indexIP)->getInterface());
+            newEntry->setDestination(routeIP->getDestination());
+            newEntry->setNetmask(routeIP->getNetmask());
+            newEntry->setGateway(routeIP->getGateway());
+            newEntry->setInterface(routeIP->getInterface());
             newEntry->setSourceType(IPv4Route::BGP);
-            _rt->deleteRoute(_rt->getRoute(indexIP));
+            _rt->deleteRoute(routeIP);
             _rt->addRoute(newEntry);
         }
     }
 
     entry->setInterface(_BGPSessions[sessionIndex]->getLinkIntf());
-    _BGPRoutingTable.push_back(entry);
+    _BGPRoutingTable[BGP::getPrefixKey(entry)] = entry;
 
     if (_BGPSessions[sessionIndex]->getType() == BGP::EGP)
     {
@@ -402,11 +449,14 @@ void BGPRouting::updateSendProcess(const unsigned char type, BGP::SessionID sess
     //if it is not the currentSession and if the session is already established
     //SESSION = IGP : send an update message to External BGP Peer (EGP) only
     //if it is not the currentSession and if the session is already established
+    if (findInTable(_prefixListOUT, entry) != NULL || isInASList(_ASListOUT, entry))
+    {
+        return;
+    }
     for (std::map<BGP::SessionID, BGPSession*>::iterator sessionIt = _BGPSessions.begin();
         sessionIt != _BGPSessions.end(); sessionIt ++)
     {
-        if (isInTable(_prefixListOUT, entry) != (unsigned long)-1 || isInASList(_ASListOUT, entry) ||
-            ((*sessionIt).first == sessionIndex && type != BGP::NEW_SESSION_ESTABLISHED ) ||
+        if (((*sessionIt).first == sessionIndex && type != BGP::NEW_SESSION_ESTABLISHED ) ||
             (type == BGP::NEW_SESSION_ESTABLISHED && (*sessionIt).first != sessionIndex ) ||
             !(*sessionIt).second->isEstablished() )
         {
@@ -451,14 +501,7 @@ void BGPRouting::updateSendProcess(const unsigned char type, BGP::SessionID sess
             IPv4Address netMask = entry->getNetmask();
             NLRI.prefix = entry->getDestination().doAnd(netMask);
             NLRI.length = (unsigned char) netMask.getNetmaskLength();
-            {
-                BGPUpdateMessage* updateMsg = new BGPUpdateMessage("BGPUpdate");
-                updateMsg->setPathAttributeListArraySize(1);
-                updateMsg->setPathAttributeList(content);
-                updateMsg->setNLRI(NLRI);
-                (*sessionIt).second->getSocket()->send(updateMsg);
-                (*sessionIt).second->addUpdateMsgSent();
-            }
+            (*sessionIt).second->sendUpdate(NLRI, content);
         }
     }
 }
@@ -578,18 +621,27 @@ std::vector<const char *> BGPRouting::loadASConfig(cXMLElementList& ASConfig)
             entry->setNetmask(IPv4Address((*ASConfigIt)->getAttribute("Netmask")));
             if (nodeName == "DenyRouteIN")
             {
-                _prefixListIN.push_back(entry);
+                _prefixListIN.insert(std::make_pair(BGP::getPrefixKey(entry), entry));
             }
             else if (nodeName == "DenyRouteOUT")
             {
-                _prefixListOUT.push_back(entry);
+                _prefixListOUT.insert(std::make_pair(BGP::getPrefixKey(entry), entry));
             }
             else
             {
-                _prefixListIN.push_back(entry);
-                _prefixListOUT.push_back(entry);
+                _prefixListIN.insert(std::make_pair(BGP::getPrefixKey(entry), entry));
+                _prefixListOUT.insert(std::make_pair(BGP::getPrefixKey(entry), entry));
             }
         }
+        else if (nodeName == "Network")
+        {
+            BGP::RoutingTableEntry* entry = new BGP::RoutingTableEntry();
+            IPv4Address netmask((*ASConfigIt)->getAttribute("Netmask"));
+            entry->setDestination(IPv4Address((*ASConfigIt)->getAttribute("Address")).doAnd(netmask));
+            entry->setNetmask(netmask);
+            entry->addAS(_myAS);
+            _networks.push_back(entry);
+        }
         else if (nodeName == "DenyAS" || nodeName == "DenyASIN" || nodeName == "DenyASOUT")
         {
             BGP::ASID ASCur = atoi((*ASConfigIt)->getNodeValue());
@@ -727,15 +779,16 @@ BGP::SessionID BGPRouting::createSession(BGP::type typeSession, const char* peer
     }
     newSessionId = info.sessionID;
     newSession->setInfo(info);
+    newSession->setMaxNLRIPerUpdate(_maxNLRIPerUpdate);
     _BGPSessions[newSessionId] = newSession;
 
     return newSessionId;
 }
 
 
-BGP::SessionID BGPRouting::findIdFromPeerAddr(std::map<BGP::SessionID, BGPSession*> sessions, IPv4Address peerAddr)
+BGP::SessionID BGPRouting::findIdFromPeerAddr(const std::map<BGP::SessionID, BGPSession*>& sessions, IPv4Address peerAddr)
 {
-    for (std::map<BGP::SessionID, BGPSession*>::iterator sessionIterator = sessions.begin();
+    for (std::map<BGP::SessionID, BGPSession*>::const_iterator sessionIterator = sessions.begin();
         sessionIterator != sessions.end(); sessionIterator ++)
     {
         if ((*sessionIterator).second->getPeerAddr().equals(peerAddr))
@@ -748,32 +801,20 @@ BGP::SessionID BGPRouting::findIdFromPeerAddr(std::map<BGP::SessionID, BGPSessio
 
 /*delete BGP Routing entry, if the route deleted correctly return true, false else*/
 bool BGPRouting::deleteBGPRoutingEntry(BGP::RoutingTableEntry* entry){
-    for (std::vector<BGP::RoutingTableEntry*>::iterator it = _BGPRoutingTable.begin();
-         it != _BGPRoutingTable.end(); it++)
+    BGP::PrefixTable::iterator it = _BGPRoutingTable.find(BGP::getPrefixKey(entry));
+    if (it == _BGPRoutingTable.end())
     {
-        if (((*it)->getDestination().getInt() & (*it)->getNetmask().getInt()) ==
-            (entry->getDestination().getInt() & entry->getNetmask().getInt()))
-        {
-            _BGPRoutingTable.erase(it);
-            _rt->deleteRoute(entry);
-            return true;
-        }
+        return false;
     }
-    return false;
+    _BGPRoutingTable.erase(it);
+    _rt->deleteRoute(entry);
+    return true;
 }
 
-/*return index of the IPv4 table if the route is found, -1 else*/
-int BGPRouting::isInRoutingTable(IRoutingTable* rtTable, IPv4Address addr)
+/*return the most specific route of the IPv4 table that covers the address, NULL if there is none*/
+IPv4Route* BGPRouting::isInRoutingTable(IRoutingTable* rtTable, IPv4Address addr)
 {
-    for (int i = 0; i < rtTable->getNumRoutes(); i++)
-    {
-        const IPv4Route* entry = rtTable->getRoute(i);
-        if (IPv4Address::maskedAddrAreEqual(addr, entry->getDestination(), entry->getNetmask()))
-        {
-            return i;
-        }
-    }
-    return -1;
+    return rtTable->findBestMatchingRoute(addr);
 }
 
 int BGPRouting::isInInterfaceTable(IInterfaceTable* ifTable, IPv4Address addr)
@@ -788,9 +829,9 @@ int BGPRouting::isInInterfaceTable(IInterfaceTable* ifTable, IPv4Address addr)
     return -1;
 }
 
-BGP::SessionID BGPRouting::findIdFromSocketConnId(std::map<BGP::SessionID, BGPSession*> sessions, int connId)
+BGP::SessionID BGPRouting::findIdFromSocketConnId(const std::map<BGP::SessionID, BGPSession*>& sessions, int connId)
 {
-    for (std::map<BGP::SessionID, BGPSession*>::iterator sessionIterator = sessions.begin();
+    for (std::map<BGP::SessionID, BGPSession*>::const_iterator sessionIterator = sessions.begin();
         sessionIterator != sessions.end(); sessionIterator ++)
     {
         TCPSocket* socket = (*sessionIterator).second->getSocket();
@@ -802,25 +843,17 @@ BGP::SessionID BGPRouting::findIdFromSocketConnId(std::map<BGP::SessionID, BGPSe
     return -1;
 }
 
-/*return index of the table if the route is found, -1 else*/
-unsigned long BGPRouting::isInTable(std::vector<BGP::RoutingTableEntry*> rtTable, BGP::RoutingTableEntry* entry)
+/*return the entry of the table with the same prefix if the route is found, NULL else*/
+BGP::RoutingTableEntry* BGPRouting::findInTable(const BGP::PrefixTable& rtTable, BGP::RoutingTableEntry* entry)
 {
-    for (unsigned long i = 0; i < rtTable.size(); i++)
-    {
-        BGP::RoutingTableEntry* entryCur = rtTable[i];
-        if ((entry->getDestination().getInt() & entry->getNetmask().getInt()) ==
-            (entryCur->getDestination().getInt() & entryCur->getNetmask().getInt()))
-        {
-            return i;
-        }
-    }
-    return -1;
+    BGP::PrefixTable::const_iterator it = rtTable.find(BGP::getPrefixKey(entry));
+    return it != rtTable.end() ? it->second : NULL;
 }
 
 /*return true if the AS is found, false else*/
-bool BGPRouting::isInASList(std::vector<BGP::ASID> ASList, BGP::RoutingTableEntry* entry)
+bool BGPRouting::isInASList(const std::vector<BGP::ASID>& ASList, BGP::RoutingTableEntry* entry)
 {
-    for (std::vector<BGP::ASID>::iterator it = ASList.begin(); it != ASList.end(); it++)
+    for (std::vector<BGP::ASID>::const_iterator it = ASList.begin(); it != ASList.end(); it++)
     {
         for (unsigned int i = 0; i < entry->getASCount(); i++)
         {
@@ -41,7 +41,7 @@ class INET_API BGPRouting : public cSimpleModule, public ILifecycle, public TCPS
 {
 public:
     BGPRouting()
-        : _myAS(0), _inft(0), _rt(0) {}
+        : _myAS(0), _maxNLRIPerUpdate(1), _inft(0), _rt(0) {}
 
     virtual ~BGPRouting();
 
@@ -66,7 +66,8 @@ protected:
     cMessage*       getCancelEvent(cMessage* msg)               { return cancelEvent(msg);}
     cGate*          getGate(const char* gateName)               { return gate(gateName);}
     IRoutingTable*  getIPRoutingTable()                         { return _rt;}
-    std::vector<BGP::RoutingTableEntry*> getBGPRoutingTable()   { return _BGPRoutingTable;}
+    const BGP::PrefixTable& getBGPRoutingTable()                { return _BGPRoutingTable;}
+    const std::vector<BGP::RoutingTableEntry*>& getNetworks()   { return _networks;}
     /**
      * \brief active listenSocket for a given session (used by BGPFSM)
      */
@@ -114,8 +115,8 @@ private:
     bool tieBreakingProcess(BGP::RoutingTableEntry* oldEntry, BGP::RoutingTableEntry* entry);
 
     BGP::SessionID createSession(BGP::type typeSession, const char* peerAddr);
-    bool isInASList(std::vector<BGP::ASID> ASList, BGP::RoutingTableEntry* entry);
-    unsigned long   isInTable(std::vector<BGP::RoutingTableEntry*> rtTable, BGP::RoutingTableEntry* entry);
+    bool isInASList(const std::vector<BGP::ASID>& ASList, BGP::RoutingTableEntry* entry);
+    BGP::RoutingTableEntry* findInTable(const BGP::PrefixTable& rtTable, BGP::RoutingTableEntry* entry);
 
     std::vector<const char *> loadASConfig(cXMLElementList& ASConfig);
     void loadSessionConfig(cXMLElementList& sessionList, simtime_t* delayTab);
@@ -124,21 +125,23 @@ private:
     bool ospfExist(IRoutingTable* rtTable);
     void loadTimerConfig(cXMLElementList& timerConfig, simtime_t* delayTab);
     unsigned char asLoopDetection(BGP::RoutingTableEntry* entry, BGP::ASID myAS);
-    BGP::SessionID findIdFromPeerAddr(std::map<BGP::SessionID, BGPSession*> sessions, IPv4Address peerAddr);
-    int isInRoutingTable(IRoutingTable* rtTable, IPv4Address addr);
+    BGP::SessionID findIdFromPeerAddr(const std::map<BGP::SessionID, BGPSession*>& sessions, IPv4Address peerAddr);
+    IPv4Route* isInRoutingTable(IRoutingTable* rtTable, IPv4Address addr);
     int isInInterfaceTable(IInterfaceTable* rtTable, IPv4Address addr);
-    BGP::SessionID findIdFromSocketConnId(std::map<BGP::SessionID, BGPSession*> sessions, int connId);
+    BGP::SessionID findIdFromSocketConnId(const std::map<BGP::SessionID, BGPSession*>& sessions, int connId);
     unsigned int calculateStartDelay(int rtListSize, unsigned char rtPosition, unsigned char rtPeerPosition);
 
     TCPSocketMap                            _socketMap;
     BGP::ASID                               _myAS;
     BGP::SessionID                          _currSessionId;
+    unsigned int                            _maxNLRIPerUpdate;  // max. number of prefixes packed into one UPDATE message
 
     IInterfaceTable*                        _inft;
     IRoutingTable*                          _rt;                // The IP routing table
-    std::vector<BGP::RoutingTableEntry*>    _BGPRoutingTable;   // The BGP routing table
-    std::vector<BGP::RoutingTableEntry*>    _prefixListIN;
-    std::vector<BGP::RoutingTableEntry*>    _prefixListOUT;
+    BGP::PrefixTable                        _BGPRoutingTable;   // The BGP routing table (Loc-RIB)
+    BGP::PrefixTable                        _prefixListIN;
+    BGP::PrefixTable                        _prefixListOUT;
+    std::vector<BGP::RoutingTableEntry*>    _networks;          // prefixes originated by the AS (Network elements)
     std::vector<BGP::ASID>                  _ASListIN;
     std::vector<BGP::ASID>                  _ASListOUT;
     std::map<BGP::SessionID, BGPSession*>   _BGPSessions;
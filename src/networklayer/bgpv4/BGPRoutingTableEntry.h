@@ -18,6 +18,8 @@
 #ifndef __INET_BGPROUTINGTABLEENTRY_H
 #define __INET_BGPROUTINGTABLEENTRY_H
 
+#include <map>
+
 #include "RoutingTable.h"
 #include "BGPCommon.h"
 
@@ -46,6 +48,22 @@ public:
     std::vector<ASID>       _ASList;
 };
 
+/**
+ * Routes indexed by their prefix key, see getPrefixKey(). Used for the
+ * Loc-RIB and the prefix filter lists.
+ */
+typedef std::map<uint32, RoutingTableEntry*> PrefixTable;
+
+/**
+ * Returns the destination masked with the netmask of the route: routes of
+ * the BGP tables are identified by this value (the prefix length is not part
+ * of the key).
+ */
+inline uint32 getPrefixKey(const IPv4Route* entry)
+{
+    return entry->getDestination().getInt() & entry->getNetmask().getInt();
+}
+
 } // namespace BGP
 
 inline BGP::RoutingTableEntry::RoutingTableEntry(void) :
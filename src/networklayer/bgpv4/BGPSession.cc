@@ -15,10 +15,69 @@
 // along with this program; if not, see <http://www.gnu.org/licenses/>.
 //
 
+#include <algorithm>
+
 #include "BGPSession.h"
 #include "BGPRouting.h"
 #include "BGPFSM.h"
 
+static uint32 getNLRIKey(const BGPUpdateNLRI& NLRI)
+{
+    return NLRI.prefix.getInt() & IPv4Address::makeNetmask(NLRI.length).getInt();
+}
+
+static bool isSamePathAttributeList(const BGPUpdatePathAttributeList& a, const BGPUpdatePathAttributeList& b)
+{
+    if (a.getOrigin().getValue() != b.getOrigin().getValue() ||
+        a.getNextHop().getValue() != b.getNextHop().getValue() ||
+        a.getAsPathArraySize() != b.getAsPathArraySize() ||
+        a.getLocalPrefArraySize() != b.getLocalPrefArraySize() ||
+        a.getAtomicAggregateArraySize() != b.getAtomicAggregateArraySize())
+    {
+        return false;
+    }
+    for (unsigned int i = 0; i < a.getAsPathArraySize(); i++)
+    {
+        const BGPUpdatePathAttributesASPath& pathA = a.getAsPath(i);
+        const BGPUpdatePathAttributesASPath& pathB = b.getAsPath(i);
+        if (pathA.getValueArraySize() != pathB.getValueArraySize())
+        {
+            return false;
+        }
+        for (unsigned int j = 0; j < pathA.getValueArraySize(); j++)
+        {
+            const BGPASPathSegment& segmentA = pathA.getValue(j);
+            const BGPASPathSegment& segmentB = pathB.getValue(j);
+            if (segmentA.getType() != segmentB.getType() || segmentA.getAsValueArraySize() != segmentB.getAsValueArraySize())
+            {
+                return false;
+            }
+            for (unsigned int k = 0; k < segmentA.getAsValueArraySize(); k++)
+            {
+                if (segmentA.getAsValue(k) != segmentB.getAsValue(k))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    for (unsigned int i = 0; i < a.getLocalPrefArraySize(); i++)
+    {
+        if (a.getLocalPref(i).getValue() != b.getLocalPref(i).getValue())
+        {
+            return false;
+        }
+    }
+    for (unsigned int i = 0; i < a.getAtomicAggregateArraySize(); i++)
+    {
+        if (a.getAtomicAggregate(i).getValue() != b.getAtomicAggregate(i).getValue())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 BGPSession::BGPSession(BGPRouting& _bgpRouting)
     : _bgpRouting(_bgpRouting), _ptrStartEvent(0), _connectRetryCounter(0)
     , _connectRetryTime(BGP_RETRY_TIME), _ptrConnectRetryTimer(0)
@@ -26,6 +85,7 @@ BGPSession::BGPSession(BGPRouting& _bgpRouting)
     , _keepAliveTime(BGP_KEEP_ALIVE), _ptrKeepAliveTimer(0)
     , _openMsgSent(0), _openMsgRcv(0), _keepAliveMsgSent(0)
     , _keepAliveMsgRcv(0), _updateMsgSent(0), _updateMsgRcv(0)
+    , _maxNLRIPerUpdate(1), _pendingUpdate(0), _pendingNLRICapacity(0)
 {
     _box = new BGPFSM::TopState::Box(*this);
     _fsm = new Macho::Machine<BGPFSM::TopState>(_box);
@@ -38,6 +98,7 @@ BGPSession::~BGPSession()
     _bgpRouting.getCancelAndDelete(_ptrStartEvent);
     _bgpRouting.getCancelAndDelete(_ptrHoldTimer);
     _bgpRouting.getCancelAndDelete(_ptrKeepAliveTimer);
+    delete _pendingUpdate;
     _info.socket->~TCPSocket();
     _info.socketListen->~TCPSocket();
 }
@@ -146,3 +207,66 @@ void BGPSession::getStatistics(unsigned int* statTab)
     statTab[5] += _updateMsgRcv;
 }
 
+bool BGPSession::addToAdjRIBIn(const BGPUpdateNLRI& NLRI, const BGPUpdatePathAttributeList& content)
+{
+    std::pair<AdjRIB::iterator, bool> result = _adjRIBIn.insert(std::make_pair(getNLRIKey(NLRI), content));
+    if (!result.second)
+    {
+        if (isSamePathAttributeList(result.first->second, content))
+        {
+            return false;
+        }
+        result.first->second = content;
+    }
+    return true;
+}
+
+void BGPSession::sendUpdate(const BGPUpdateNLRI& NLRI, const BGPUpdatePathAttributeList& content)
+{
+    std::pair<AdjRIB::iterator, bool> result = _adjRIBOut.insert(std::make_pair(getNLRIKey(NLRI), content));
+    if (!result.second)
+    {
+        if (isSamePathAttributeList(result.first->second, content))
+        {
+            return;
+        }
+        result.first->second = content;
+    }
+
+    if (_pendingUpdate != 0 && !isSamePathAttributeList(_pendingUpdate->getPathAttributeList(0), content))
+    {
+        flushUpdates();
+    }
+    if (_pendingUpdate == 0)
+    {
+        _pendingUpdate = new BGPUpdateMessage("BGPUpdate");
+        _pendingUpdate->setPathAttributeList(content);
+        _pendingNLRICapacity = std::min(_maxNLRIPerUpdate, (unsigned int)(BGP_MAX_MESSAGE_OCTETS - _pendingUpdate->getByteLength()) / 5);
+        if (_pendingNLRICapacity == 0)
+        {
+            _pendingNLRICapacity = 1;
+        }
+    }
+    _pendingNLRI.push_back(NLRI);
+    if (_pendingNLRI.size() >= _pendingNLRICapacity)
+    {
+        flushUpdates();
+    }
+}
+
+void BGPSession::flushUpdates()
+{
+    if (_pendingUpdate == 0)
+    {
+        return;
+    }
+    _pendingUpdate->setNLRIArraySize(_pendingNLRI.size());
+    for (unsigned int i = 0; i < _pendingNLRI.size(); i++)
+    {
+        _pendingUpdate->setNLRI(i, _pendingNLRI[i]);
+    }
+    _info.socket->send(_pendingUpdate);
+    _updateMsgSent ++;
+    _pendingUpdate = 0;
+    _pendingNLRI.clear();
+}
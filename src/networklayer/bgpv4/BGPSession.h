@@ -18,6 +18,7 @@
 #ifndef __INET_BGPSESSION_H
 #define __INET_BGPSESSION_H
 
+#include <map>
 #include <vector>
 
 #include "INETDefs.h"
@@ -62,15 +63,48 @@ public:
     TCPSocket*      getSocket()                                 { return _info.socket;}
     TCPSocket*      getSocketListen()                           { return _info.socketListen;}
     IRoutingTable*  getIPRoutingTable()                         { return _bgpRouting.getIPRoutingTable();}
-    std::vector<BGP::RoutingTableEntry*> getBGPRoutingTable()   { return _bgpRouting.getBGPRoutingTable();}
+    const BGP::PrefixTable& getBGPRoutingTable()                { return _bgpRouting.getBGPRoutingTable();}
+    const std::vector<BGP::RoutingTableEntry*>& getNetworks()   { return _bgpRouting.getNetworks();}
     Macho::Machine<BGPFSM::TopState>&    getFSM()               { return *_fsm;}
     bool checkExternalRoute(const IPv4Route* ospfRoute)           { return _bgpRouting.checkExternalRoute(ospfRoute);}
     void updateSendProcess(BGP::RoutingTableEntry* entry)       { return _bgpRouting.updateSendProcess(BGP::NEW_SESSION_ESTABLISHED, _info.sessionID, entry);}
 
+    //Adj-RIB-In, Adj-RIB-Out and UPDATE message packing:
+    void            setMaxNLRIPerUpdate(unsigned int max)       { _maxNLRIPerUpdate = max;}
+    /**
+     * \brief store the route received from the peer in the Adj-RIB-In
+     *
+     * \return false if the peer has already advertised the prefix with the same path attributes, true else
+     */
+    bool            addToAdjRIBIn(const BGPUpdateNLRI& NLRI, const BGPUpdatePathAttributeList& content);
+    /**
+     * \brief advertise the route to the peer and store it in the Adj-RIB-Out
+     *
+     * Routes already advertised with the same path attributes are not sent again.
+     * Consecutive routes with the same path attributes are packed into one UPDATE
+     * message (up to maxNLRIPerUpdate prefixes and the maximum BGP message size),
+     * which is sent when it is full or when flushUpdates() is called.
+     */
+    void            sendUpdate(const BGPUpdateNLRI& NLRI, const BGPUpdatePathAttributeList& content);
+    void            flushUpdates();
+    void            clearAdjRIBs()                              { _adjRIBIn.clear(); _adjRIBOut.clear();}
+
 private:
     BGP::SessionInfo    _info;
     BGPRouting&         _bgpRouting;
 
+    //Adj-RIB-In and Adj-RIB-Out: path attributes of the routes received from and advertised to the peer,
+    //indexed by the masked prefix
+    typedef std::map<uint32, BGPUpdatePathAttributeList> AdjRIB;
+    AdjRIB              _adjRIBIn;
+    AdjRIB              _adjRIBOut;
+
+    //UPDATE message being packed
+    unsigned int                _maxNLRIPerUpdate;
+    BGPUpdateMessage*           _pendingUpdate;
+    std::vector<BGPUpdateNLRI>  _pendingNLRI;
+    unsigned int                _pendingNLRICapacity;
+
     static const int    BGP_RETRY_TIME = 120;
     static const int    BGP_HOLD_TIME = 180;
     static const int    BGP_KEEP_ALIVE = 60; // 1/3 of BGP_HOLD_TIME
@@ -344,7 +344,8 @@ void InterfaceTable::interfaceChanged(int category, const InterfaceEntryChangeDe
 {
     Enter_Method_Silent();
 
-    nb->fireChangeNotification(category, details);
+    // the interface is the source, so clients may subscribe to one interface only
+    nb->fireChangeNotification(category, details, details->getInterfaceEntry());
 
     if (ev.isGUI() && par("displayAddresses").boolValue())
         updateLinkDisplayString(details->getInterfaceEntry());
@@ -21,6 +21,8 @@
 #include "IPv4Datagram.h"
 #endif
 
+Define_ObjectPool(IPv4ControlInfo);
+
 IPv4ControlInfo::~IPv4ControlInfo()
 {
     clean();
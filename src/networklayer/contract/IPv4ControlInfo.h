@@ -19,6 +19,7 @@
 #define __INET_IPv4CONTROLINFO_H
 
 #include "IPv4ControlInfo_m.h"
+#include "ObjectPool.h"
 
 class IPv4Datagram;
 
@@ -42,6 +43,7 @@ class INET_API IPv4ControlInfo : public IPv4ControlInfo_Base
     IPv4ControlInfo(const IPv4ControlInfo& other) : IPv4ControlInfo_Base(other) { dgram = NULL; copy(other); }
     IPv4ControlInfo& operator=(const IPv4ControlInfo& other);
     virtual IPv4ControlInfo *dup() const {return new IPv4ControlInfo(*this);}
+    INET_POOLED_ALLOCATION(IPv4ControlInfo);
 
     /**
      * Returns bits 0-5 of the Type of Service field, a value in the 0..63 range
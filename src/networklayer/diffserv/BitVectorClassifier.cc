@@ -0,0 +1,154 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+
+#include "BitVectorClassifier.h"
+
+
+BitVectorClassifier::Rule::Rule()
+{
+    for (int i = 0; i < NUM_FIELDS; i++)
+        restricted[i] = false;
+}
+
+void BitVectorClassifier::Rule::addRange(Field field, int64 min, int64 max)
+{
+    restricted[field] = true;
+    if (min <= max)
+    {
+        Range range;
+        range.min = min;
+        range.max = max;
+        ranges[field].push_back(range);
+    }
+}
+
+BitVectorClassifier::BitVectorClassifier()
+{
+    built = false;
+    numWords = 0;
+}
+
+void BitVectorClassifier::clear()
+{
+    rules.clear();
+    for (int i = 0; i < NUM_FIELDS; i++)
+    {
+        tables[i].intervalStarts.clear();
+        tables[i].bits.clear();
+    }
+    built = false;
+    numWords = 0;
+}
+
+void BitVectorClassifier::addRule(const Rule& rule)
+{
+    rules.push_back(rule);
+    built = false;
+}
+
+void BitVectorClassifier::build()
+{
+    numWords = (rules.size() + 63) / 64;
+    for (int i = 0; i < NUM_FIELDS; i++)
+        buildTable((Field)i);
+    built = true;
+}
+
+void BitVectorClassifier::buildTable(Field field)
+{
+    FieldTable& table = tables[field];
+    std::vector<int64>& starts = table.intervalStarts;
+
+    // cut the value space at the boundaries of the ranges; values below the
+    // first boundary belong to no interval: only unrestricted rules accept them
+    starts.clear();
+    for (std::vector<Rule>::const_iterator it = rules.begin(); it != rules.end(); ++it)
+    {
+        for (std::vector<Rule::Range>::const_iterator r = it->ranges[field].begin(); r != it->ranges[field].end(); ++r)
+        {
+            starts.push_back(r->min);
+            starts.push_back(r->max + 1);
+        }
+    }
+    std::sort(starts.begin(), starts.end());
+    starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+
+    // interval 0 is the one below the first boundary, interval i+1 starts at starts[i]
+    int numIntervals = starts.size() + 1;
+    table.bits.assign((size_t)numIntervals * numWords, 0);
+    for (int ruleIndex = 0; ruleIndex < (int)rules.size(); ruleIndex++)
+    {
+        const Rule& rule = rules[ruleIndex];
+        uint64 mask = (uint64)1 << (ruleIndex % 64);
+        int word = ruleIndex / 64;
+        if (!rule.restricted[field])
+        {
+            for (int i = 0; i < numIntervals; i++)
+                table.bits[i * numWords + word] |= mask;
+            continue;
+        }
+        for (std::vector<Rule::Range>::const_iterator r = rule.ranges[field].begin(); r != rule.ranges[field].end(); ++r)
+        {
+            int from = std::lower_bound(starts.begin(), starts.end(), r->min) - starts.begin() + 1;
+            int to = std::lower_bound(starts.begin(), starts.end(), r->max + 1) - starts.begin() + 1;
+            for (int i = from; i < to; i++)
+                table.bits[i * numWords + word] |= mask;
+        }
+    }
+}
+
+int BitVectorClassifier::lookup(const int64 values[NUM_FIELDS]) const
+{
+    if (!built)
+        throw cRuntimeError("BitVectorClassifier: lookup() called before build()");
+    if (numWords == 0)
+        return -1;
+
+    const uint64 *vectors[NUM_FIELDS];
+    for (int i = 0; i < NUM_FIELDS; i++)
+    {
+        const std::vector<int64>& starts = tables[i].intervalStarts;
+        int interval = std::upper_bound(starts.begin(), starts.end(), values[i]) - starts.begin();
+        vectors[i] = &tables[i].bits[interval * numWords];
+    }
+
+    for (int word = 0; word < numWords; word++)
+    {
+        uint64 bits = vectors[0][word];
+        for (int i = 1; i < NUM_FIELDS && bits != 0; i++)
+            bits &= vectors[i][word];
+        if (bits != 0)
+        {
+            int bit = 0;
+            while ((bits & 0xffff) == 0)
+            {
+                bits >>= 16;
+                bit += 16;
+            }
+            while ((bits & 1) == 0)
+            {
+                bits >>= 1;
+                bit++;
+            }
+            return word * 64 + bit;
+        }
+    }
+    return -1;
+}
+
@@ -0,0 +1,106 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_BITVECTORCLASSIFIER_H
+#define __INET_BITVECTORCLASSIFIER_H
+
+#include <vector>
+
+#include "INETDefs.h"
+
+
+/**
+ * Multi-field packet classifier using the bit vector scheme of Lakshman and
+ * Stiliadis. Used by MultiFieldClassifier to find the first matching filter
+ * without testing the filters one by one.
+ *
+ * Each rule restricts some of the fields to a set of value ranges. When the
+ * rule set is built, the value space of every field is cut into elementary
+ * intervals at the range boundaries, and each interval stores a bit vector
+ * of the rules that accept the values in it. A lookup does one binary search
+ * per field and ANDs the bit vectors; the lowest set bit of the result is the
+ * first matching rule in insertion order, i.e. the result is the same as a
+ * linear first-match scan of the rules.
+ *
+ * Memory is O(fields * rules^2 / 64) words, which is fine for the few
+ * thousand filters used in practice.
+ */
+class INET_API BitVectorClassifier
+{
+  public:
+    /** Fields of the classified packets, values are given as int64 */
+    enum Field { SRC_ADDRESS, DEST_ADDRESS, PROTOCOL, TOS, SRC_PORT, DEST_PORT, NUM_FIELDS };
+
+    /** Describes which values of each field a rule accepts */
+    class INET_API Rule
+    {
+      protected:
+        friend class BitVectorClassifier;
+        struct Range { int64 min, max; };
+        bool restricted[NUM_FIELDS];
+        std::vector<Range> ranges[NUM_FIELDS];
+
+      public:
+        /** Creates a rule that accepts any packet */
+        Rule();
+
+        /**
+         * Restricts the field to the union of the ranges given by calls of this
+         * method; min > max restricts it to the empty set (the rule never matches).
+         */
+        void addRange(Field field, int64 min, int64 max);
+    };
+
+  protected:
+    struct FieldTable
+    {
+        std::vector<int64> intervalStarts;  // ascending; interval i is [intervalStarts[i], intervalStarts[i+1])
+        std::vector<uint64> bits;           // numWords words for each interval
+    };
+
+    std::vector<Rule> rules;
+    bool built;
+    int numWords;
+    FieldTable tables[NUM_FIELDS];
+
+  protected:
+    void buildTable(Field field);
+
+  public:
+    BitVectorClassifier();
+
+    /** Removes all rules */
+    void clear();
+
+    /** Appends a rule; its index is the number of rules added before */
+    void addRule(const Rule& rule);
+
+    /** Returns the number of rules */
+    int getNumRules() const { return rules.size(); }
+
+    /** Computes the lookup tables; must be called after the last addRule() */
+    void build();
+
+    /**
+     * Returns the index of the first rule accepting the given field values
+     * (indexed by Field), or -1 if there is none.
+     */
+    int lookup(const int64 values[NUM_FIELDS]) const;
+};
+
+#endif  // __INET_BITVECTORCLASSIFIER_H
+
@@ -41,6 +41,31 @@
 
 using namespace DiffservUtil;
 
+#if defined(WITH_IPv4) || defined(WITH_IPv6)
+// sets the ports of a UDP packet or TCP segment, or -1 for other packets
+static void getTransportPorts(cPacket *packet, int& srcPort, int& destPort)
+{
+    srcPort = destPort = -1;
+#ifdef WITH_UDP
+    UDPPacket *udpPacket = dynamic_cast<UDPPacket*>(packet);
+    if (udpPacket)
+    {
+        srcPort = udpPacket->getSourcePort();
+        destPort = udpPacket->getDestinationPort();
+        return;
+    }
+#endif
+#ifdef WITH_TCP_COMMON
+    TCPSegment *tcpSegment = dynamic_cast<TCPSegment*>(packet);
+    if (tcpSegment)
+    {
+        srcPort = tcpSegment->getSrcPort();
+        destPort = tcpSegment->getDestPort();
+    }
+#endif
+}
+#endif
+
 #ifdef WITH_IPv4
 bool MultiFieldClassifier::Filter::matches(IPv4Datagram *datagram)
 {
@@ -54,25 +79,8 @@ bool MultiFieldClassifier::Filter::matches(IPv4Datagram *datagram)
         return false;
     if (srcPortMin >= 0 || destPortMin >= 0)
     {
-        int srcPort = -1, destPort = -1;
-        cPacket *packet = datagram->getEncapsulatedPacket();
-#ifdef WITH_UDP
-        UDPPacket *udpPacket = dynamic_cast<UDPPacket*>(packet);
-        if (udpPacket)
-        {
-            srcPort = udpPacket->getSourcePort();
-            destPort = udpPacket->getDestinationPort();
-        }
-#endif
-#ifdef WITH_TCP_COMMON
-        TCPSegment *tcpSegment = dynamic_cast<TCPSegment*>(packet);
-        if (tcpSegment)
-        {
-            srcPort = tcpSegment->getSrcPort();
-            destPort = tcpSegment->getDestPort();
-        }
-#endif
-
+        int srcPort, destPort;
+        getTransportPorts(datagram->getEncapsulatedPacket(), srcPort, destPort);
         if (srcPortMin >= 0 && (srcPort < srcPortMin || srcPort > srcPortMax))
             return false;
         if (destPortMin >= 0 && (destPort < destPortMin || destPort > destPortMax))
@@ -96,25 +104,8 @@ bool MultiFieldClassifier::Filter::matches(IPv6Datagram *datagram)
         return false;
     if (srcPortMin >= 0 || destPortMin >= 0)
     {
-        int srcPort = -1, destPort = -1;
-        cPacket *packet = datagram->getEncapsulatedPacket();
-#ifdef WITH_UDP
-        UDPPacket *udpPacket = dynamic_cast<UDPPacket*>(packet);
-        if (udpPacket)
-        {
-            srcPort = udpPacket->getSourcePort();
-            destPort = udpPacket->getDestinationPort();
-        }
-#endif
-#ifdef WITH_TCP_COMMON
-        TCPSegment *tcpSegment = dynamic_cast<TCPSegment*>(packet);
-        if (tcpSegment)
-        {
-            srcPort = tcpSegment->getSrcPort();
-            destPort = tcpSegment->getDestPort();
-        }
-#endif
-
+        int srcPort, destPort;
+        getTransportPorts(datagram->getEncapsulatedPacket(), srcPort, destPort);
         if (srcPortMin >= 0 && (srcPort < srcPortMin || srcPort > srcPortMax))
             return false;
         if (destPortMin >= 0 && (destPort < destPortMin || destPort > destPortMax))
@@ -146,6 +137,9 @@ void MultiFieldClassifier::initialize(int stage)
     {
         cXMLElement *config = par("filters").xmlValue();
         configureFilters(config);
+#ifdef WITH_IPv4
+        buildIPv4Classifier();
+#endif
     }
 }
 
@@ -177,12 +171,7 @@ int MultiFieldClassifier::classifyPacket(cPacket *packet)
 #ifdef WITH_IPv4
         IPv4Datagram *ipv4Datagram = dynamic_cast<IPv4Datagram*>(packet);
         if (ipv4Datagram)
-        {
-            for (std::vector<Filter>::iterator it = filters.begin(); it != filters.end(); ++it)
-                if (it->matches(ipv4Datagram))
-                    return it->gateIndex;
-            return -1;
-        }
+            return classifyIPv4Datagram(ipv4Datagram);
 #endif
 #ifdef WITH_IPv6
         IPv6Datagram *ipv6Datagram = dynamic_cast<IPv6Datagram *>(packet);
@@ -199,6 +188,88 @@ int MultiFieldClassifier::classifyPacket(cPacket *packet)
     return -1;
 }
 
+#ifdef WITH_IPv4
+int MultiFieldClassifier::classifyIPv4Datagram(IPv4Datagram *datagram)
+{
+    int64 values[BitVectorClassifier::NUM_FIELDS];
+    values[BitVectorClassifier::SRC_ADDRESS] = datagram->getSrcAddress().getInt();
+    values[BitVectorClassifier::DEST_ADDRESS] = datagram->getDestAddress().getInt();
+    values[BitVectorClassifier::PROTOCOL] = datagram->getTransportProtocol();
+    values[BitVectorClassifier::TOS] = datagram->getTypeOfService();
+    int srcPort = -1, destPort = -1;
+    if (hasPortFilters)
+        getTransportPorts(datagram->getEncapsulatedPacket(), srcPort, destPort);
+    values[BitVectorClassifier::SRC_PORT] = srcPort;
+    values[BitVectorClassifier::DEST_PORT] = destPort;
+
+    int index = ipv4Classifier.lookup(values);
+    return index >= 0 ? filters[index].gateIndex : -1;
+}
+
+void MultiFieldClassifier::buildIPv4Classifier()
+{
+    ipv4Classifier.clear();
+    hasPortFilters = false;
+    for (std::vector<Filter>::const_iterator it = filters.begin(); it != filters.end(); ++it)
+    {
+        BitVectorClassifier::Rule rule;
+        if (it->srcPrefixLength > 0)
+        {
+            if (it->srcAddr.isIPv6())
+                rule.addRange(BitVectorClassifier::SRC_ADDRESS, 1, 0);   // never matches IPv4
+            else
+            {
+                uint32 mask = IPv4Address::makeNetmask(it->srcPrefixLength).getInt();
+                uint32 prefix = it->srcAddr.get4().getInt() & mask;
+                rule.addRange(BitVectorClassifier::SRC_ADDRESS, prefix, prefix | ~mask);
+            }
+        }
+        if (it->destPrefixLength > 0)
+        {
+            if (it->destAddr.isIPv6())
+                rule.addRange(BitVectorClassifier::DEST_ADDRESS, 1, 0);
+            else
+            {
+                uint32 mask = IPv4Address::makeNetmask(it->destPrefixLength).getInt();
+                uint32 prefix = it->destAddr.get4().getInt() & mask;
+                rule.addRange(BitVectorClassifier::DEST_ADDRESS, prefix, prefix | ~mask);
+            }
+        }
+        if (it->protocol >= 0)
+            rule.addRange(BitVectorClassifier::PROTOCOL, it->protocol, it->protocol);
+        if (it->tosMask != 0)
+        {
+            // the accepted TOS values are not contiguous in general: add them as runs
+            for (int tos = 0; tos <= 0xff; )
+            {
+                if ((it->tos & it->tosMask) != (tos & it->tosMask))
+                {
+                    tos++;
+                    continue;
+                }
+                int first = tos;
+                while (tos + 1 <= 0xff && (it->tos & it->tosMask) == ((tos + 1) & it->tosMask))
+                    tos++;
+                rule.addRange(BitVectorClassifier::TOS, first, tos);
+                tos++;
+            }
+        }
+        if (it->srcPortMin >= 0)
+        {
+            rule.addRange(BitVectorClassifier::SRC_PORT, it->srcPortMin, it->srcPortMax);
+            hasPortFilters = true;
+        }
+        if (it->destPortMin >= 0)
+        {
+            rule.addRange(BitVectorClassifier::DEST_PORT, it->destPortMin, it->destPortMax);
+            hasPortFilters = true;
+        }
+        ipv4Classifier.addRule(rule);
+    }
+    ipv4Classifier.build();
+}
+#endif
+
 void MultiFieldClassifier::addFilter(const Filter &filter)
 {
     if (filter.gateIndex < 0 || filter.gateIndex >= numOutGates)
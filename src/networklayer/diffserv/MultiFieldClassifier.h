@@ -22,6 +22,8 @@
 
 #include "INETDefs.h"
 
+#include "BitVectorClassifier.h"
+
 /**
  * Absolute dropper.
  */
@@ -58,6 +60,10 @@ class INET_API MultiFieldClassifier : public cSimpleModule
   protected:
     int numOutGates;
     std::vector<Filter> filters;
+#ifdef WITH_IPv4
+    BitVectorClassifier ipv4Classifier;   // filters compiled for IPv4 datagrams, same indices as in filters
+    bool hasPortFilters;                  // if false, ports of IPv4 datagrams need not be looked up
+#endif
 
     int numRcvd;
 
@@ -66,6 +72,10 @@ class INET_API MultiFieldClassifier : public cSimpleModule
   protected:
     void addFilter(const Filter &filter);
     void configureFilters(cXMLElement *config);
+#ifdef WITH_IPv4
+    void buildIPv4Classifier();
+    int classifyIPv4Datagram(IPv4Datagram *datagram);
+#endif
 
   public:
     MultiFieldClassifier() {}
@@ -19,4 +19,5 @@
 #include "IPv4Datagram.h"
 
 Register_Class(IPv4Datagram);
+Define_ObjectPool(IPv4Datagram);
 
@@ -21,6 +21,7 @@
 
 #include "INETDefs.h"
 #include "IPv4Datagram_m.h"
+#include "ObjectPool.h"
 
 /**
  * Represents an IPv4 datagram. More info in the IPv4Datagram.msg file
@@ -35,6 +36,8 @@ class INET_API IPv4Datagram : public IPv4Datagram_Base
 
     virtual IPv4Datagram *dup() const {return new IPv4Datagram(*this);}
 
+    INET_POOLED_ALLOCATION(IPv4Datagram);
+
     /**
      * Returns bits 0-5 of the Type of Service field, a value in the 0..63 range
      */
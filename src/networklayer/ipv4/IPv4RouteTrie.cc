@@ -0,0 +1,179 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+
+#include "IPv4RouteTrie.h"
+
+#include "IPv4Route.h"
+
+
+IPv4RouteTrie::IPv4RouteTrie()
+{
+    root = NULL;
+}
+
+IPv4RouteTrie::~IPv4RouteTrie()
+{
+    deleteSubtree(root);
+}
+
+void IPv4RouteTrie::deleteSubtree(Node *node)
+{
+    if (node)
+    {
+        deleteSubtree(node->child[0]);
+        deleteSubtree(node->child[1]);
+        delete node;
+    }
+}
+
+void IPv4RouteTrie::clear()
+{
+    deleteSubtree(root);
+    root = NULL;
+    routeToNode.clear();
+}
+
+int IPv4RouteTrie::commonPrefixLength(uint32 a, uint32 b, int maxLength)
+{
+    uint32 diff = a ^ b;
+    int length = 0;
+    while (length < maxLength && !(diff & (0x80000000u >> length)))
+        length++;
+    return length;
+}
+
+// same order as RoutingTable::routeLessThan() for routes of the same prefix
+bool IPv4RouteTrie::routeLessThan(const IPv4Route *a, const IPv4Route *b)
+{
+    if (a->getAdminDist() != b->getAdminDist())
+        return a->getAdminDist() < b->getAdminDist();
+    return a->getMetric() < b->getMetric();
+}
+
+IPv4RouteTrie::Node *IPv4RouteTrie::findOrCreateNode(uint32 prefix, int length)
+{
+    Node *parent = NULL;
+    Node **link = &root;
+    while (*link)
+    {
+        Node *node = *link;
+        int common = commonPrefixLength(prefix, node->prefix, std::min(length, node->length));
+        if (common == node->length)
+        {
+            if (node->length == length)
+                return node;    // exact match
+            // node is a proper prefix of the new one: descend
+            parent = node;
+            link = &node->child[getBit(prefix, node->length)];
+        }
+        else if (common == length)
+        {
+            // the new prefix is a proper prefix of node: insert it above node
+            Node *newNode = new Node(prefix, length, parent);
+            newNode->child[getBit(node->prefix, length)] = node;
+            node->parent = newNode;
+            *link = newNode;
+            return newNode;
+        }
+        else
+        {
+            // the prefixes diverge: insert a glue node at the branching point
+            Node *glue = new Node(prefix & makeMask(common), common, parent);
+            Node *newNode = new Node(prefix, length, glue);
+            glue->child[getBit(node->prefix, common)] = node;
+            glue->child[getBit(prefix, common)] = newNode;
+            node->parent = glue;
+            *link = glue;
+            return newNode;
+        }
+    }
+    *link = new Node(prefix, length, parent);
+    return *link;
+}
+
+void IPv4RouteTrie::replaceChild(Node *parent, Node *oldChild, Node *newChild)
+{
+    if (newChild)
+        newChild->parent = parent;
+    if (!parent)
+        root = newChild;
+    else if (parent->child[0] == oldChild)
+        parent->child[0] = newChild;
+    else
+        parent->child[1] = newChild;
+}
+
+void IPv4RouteTrie::removeNodeIfUnused(Node *node)
+{
+    // nodes without routes are only needed as branching points
+    while (node && node->routes.empty())
+    {
+        if (node->child[0] && node->child[1])
+            return;
+        Node *parent = node->parent;
+        replaceChild(parent, node, node->child[0] ? node->child[0] : node->child[1]);
+        delete node;
+        node = parent;
+    }
+}
+
+void IPv4RouteTrie::addRoute(IPv4Route *route)
+{
+    ASSERT(routeToNode.find(route) == routeToNode.end());
+    int length = route->getNetmask().getNetmaskLength();
+    uint32 prefix = route->getDestination().getInt() & makeMask(length);
+    Node *node = findOrCreateNode(prefix, length);
+    node->routes.insert(std::upper_bound(node->routes.begin(), node->routes.end(), route, routeLessThan), route);
+    routeToNode[route] = node;
+}
+
+bool IPv4RouteTrie::removeRoute(const IPv4Route *route)
+{
+    RouteToNodeMap::iterator it = routeToNode.find(route);
+    if (it == routeToNode.end())
+        return false;
+    Node *node = it->second;
+    routeToNode.erase(it);
+    node->routes.erase(std::find(node->routes.begin(), node->routes.end(), route));
+    removeNodeIfUnused(node);
+    return true;
+}
+
+IPv4Route *IPv4RouteTrie::findBestMatchingRoute(const IPv4Address& dest) const
+{
+    uint32 addr = dest.getInt();
+    IPv4Route *bestRoute = NULL;
+    const Node *node = root;
+    while (node && ((addr ^ node->prefix) & makeMask(node->length)) == 0)
+    {
+        for (RouteVector::const_iterator it = node->routes.begin(); it != node->routes.end(); ++it)
+        {
+            if ((*it)->isValid())
+            {
+                bestRoute = *it;
+                break;
+            }
+        }
+        if (node->length == 32)
+            break;
+        node = node->child[getBit(addr, node->length)];
+    }
+    return bestRoute;
+}
+
@@ -0,0 +1,103 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_IPv4ROUTETRIE_H
+#define __INET_IPv4ROUTETRIE_H
+
+#include <map>
+#include <vector>
+
+#include "INETDefs.h"
+
+#include "IPv4Address.h"
+
+class IPv4Route;
+
+
+/**
+ * Path-compressed binary (Patricia) trie of IPv4 unicast routes, used by
+ * RoutingTable for longest prefix matching. Lookup cost is proportional to
+ * the prefix length, and routes can be added and removed individually, so
+ * route changes do not require flushing a per-destination cache.
+ *
+ * Every node holds the routes of exactly one destination/netmask prefix,
+ * ordered by administrative distance and metric, so findBestMatchingRoute()
+ * returns the same route as a linear scan over the sorted route vector.
+ *
+ * The trie remembers the prefix each route was inserted with, so routes
+ * can be removed even after their destination or netmask has been changed.
+ */
+class INET_API IPv4RouteTrie
+{
+  protected:
+    typedef std::vector<IPv4Route *> RouteVector;
+
+    struct Node
+    {
+        uint32 prefix;
+        int length;
+        Node *parent;
+        Node *child[2];
+        RouteVector routes;  // routes with exactly this prefix, best first
+
+        Node(uint32 prefix, int length, Node *parent) : prefix(prefix), length(length), parent(parent) { child[0] = child[1] = NULL; }
+    };
+
+    typedef std::map<const IPv4Route *, Node *> RouteToNodeMap;
+
+    Node *root;
+    RouteToNodeMap routeToNode;
+
+  protected:
+    static uint32 makeMask(int length) { return length == 0 ? 0 : (0xffffffffu << (32 - length)); }
+    static int getBit(uint32 addr, int pos) { return (addr >> (31 - pos)) & 1; }
+    static int commonPrefixLength(uint32 a, uint32 b, int maxLength);
+    static bool routeLessThan(const IPv4Route *a, const IPv4Route *b);
+    Node *findOrCreateNode(uint32 prefix, int length);
+    void removeNodeIfUnused(Node *node);
+    void replaceChild(Node *parent, Node *oldChild, Node *newChild);
+    void deleteSubtree(Node *node);
+
+  private:
+    // copying not supported: following are private and also left undefined
+    IPv4RouteTrie(const IPv4RouteTrie& other);
+    IPv4RouteTrie& operator=(const IPv4RouteTrie& other);
+
+  public:
+    IPv4RouteTrie();
+    ~IPv4RouteTrie();
+
+    /** Adds the route under its current destination/netmask. The route is not owned by the trie. */
+    void addRoute(IPv4Route *route);
+
+    /** Removes the route; returns false if it was not in the trie */
+    bool removeRoute(const IPv4Route *route);
+
+    /** Removes all routes */
+    void clear();
+
+    /** Returns the number of routes in the trie */
+    int getNumRoutes() const { return routeToNode.size(); }
+
+    /**
+     * Returns the best valid route of the longest matching prefix,
+     * or NULL if there is no matching route.
+     */
+    IPv4Route *findBestMatchingRoute(const IPv4Address& dest) const;
+};
+
+#endif
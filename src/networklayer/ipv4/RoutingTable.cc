@@ -56,6 +56,7 @@ RoutingTable::RoutingTable()
 {
     ift = NULL;
     nb = NULL;
+    useRouteTrie = false;
 }
 
 RoutingTable::~RoutingTable()
@@ -78,6 +79,17 @@ void RoutingTable::initialize(int stage)
         IPForward = par("IPForward").boolValue();
         multicastForward = par("forwardMulticast");
 
+        const char *routeLookup = par("routeLookup").stringValue();
+        if (!strcmp(routeLookup, "linear"))
+            useRouteTrie = false;
+        else if (!strcmp(routeLookup, "trie"))
+            useRouteTrie = true;
+        else
+            throw cRuntimeError("Unknown routeLookup parameter value: '%s'", routeLookup);
+        if (useRouteTrie)
+            for (RouteVector::iterator it = routes.begin(); it != routes.end(); ++it)
+                routeTrie.addRoute(*it);  // routes added by other modules earlier in this stage
+
         nb->subscribe(this, NF_INTERFACE_CREATED);
         nb->subscribe(this, NF_INTERFACE_DELETED);
         nb->subscribe(this, NF_INTERFACE_STATE_CHANGED);
@@ -233,6 +245,8 @@ void RoutingTable::deleteInterfaceRoutes(InterfaceEntry *entry)
         if (route->getInterface() == entry)
         {
             it = routes.erase(it);
+            if (useRouteTrie)
+                routeTrie.removeRoute(route);
             ASSERT(route->getRoutingTable() == this); // still filled in, for the listeners' benefit
             nb->fireChangeNotification(NF_IPv4_ROUTE_DELETED, route);
             delete route;
@@ -467,6 +481,8 @@ void RoutingTable::purge()
         else
         {
             it = routes.erase(it);
+            if (useRouteTrie)
+                routeTrie.removeRoute(route);
             ASSERT(route->getRoutingTable() == this); // still filled in, for the listeners' benefit
             nb->fireChangeNotification(NF_IPv4_ROUTE_DELETED, route);
             delete route;
@@ -501,6 +517,10 @@ IPv4Route *RoutingTable::findBestMatchingRoute(const IPv4Address& dest) const
 {
     Enter_Method("findBestMatchingRoute(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
 
+    // the trie is kept up to date incrementally, so it needs no cache
+    if (useRouteTrie)
+        return routeTrie.findBestMatchingRoute(dest);
+
     RoutingCache::iterator it = routingCache.find(dest);
     if (it != routingCache.end())
     {
@@ -644,6 +664,8 @@ void RoutingTable::internalAddRoute(IPv4Route *entry)
     // stop at the first match when doing the longest netmask matching
     RouteVector::iterator pos = upper_bound(routes.begin(), routes.end(), entry, routeLessThan);
     routes.insert(pos, entry);
+    if (useRouteTrie)
+        routeTrie.addRoute(entry);
 
     entry->setRoutingTable(this);
 }
@@ -666,6 +688,8 @@ IPv4Route *RoutingTable::internalRemoveRoute(IPv4Route *entry)
     if (i!=routes.end())
     {
         routes.erase(i);
+        if (useRouteTrie)
+            routeTrie.removeRoute(entry);
         return entry;
     }
     return NULL;
@@ -858,6 +882,8 @@ void RoutingTable::updateNetmaskRoutes()
             std::vector<IPv4Route *>::iterator it = routes.begin()+(k--);  // '--' is necessary because indices shift down
             IPv4Route *route = *it;
             routes.erase(it);
+            if (useRouteTrie)
+                routeTrie.removeRoute(route);
             ASSERT(route->getRoutingTable() == this); // still filled in, for the listeners' benefit
             nb->fireChangeNotification(NF_IPv4_ROUTE_DELETED, route);
             delete route;
@@ -884,6 +910,8 @@ void RoutingTable::updateNetmaskRoutes()
             route->setRoutingTable(this);
             RouteVector::iterator pos = upper_bound(routes.begin(), routes.end(), route, routeLessThan);
             routes.insert(pos, route);
+            if (useRouteTrie)
+                routeTrie.addRoute(route);
             nb->fireChangeNotification(NF_IPv4_ROUTE_ADDED, route);
         }
     }
@@ -36,6 +36,7 @@
 #include "IPv4Address.h"
 #include "IRoutingTable.h"
 #include "ILifecycle.h"
+#include "IPv4RouteTrie.h"
 
 class IInterfaceTable;
 class NotificationBoard;
@@ -104,6 +105,9 @@ class INET_API RoutingTable: public cSimpleModule, public IRoutingTable, protect
     typedef std::vector<IPv4Route *> RouteVector;
     RouteVector routes;          // Unicast route array, sorted by netmask desc, dest asc, metric asc
 
+    bool useRouteTrie;           // if true, unicast lookups use routeTrie instead of routingCache
+    IPv4RouteTrie routeTrie;     // the same routes as in the 'routes' vector, indexed by prefix
+
     typedef std::vector<IPv4MulticastRoute*> MulticastRouteVector;
     MulticastRouteVector multicastRoutes; // Multicast route array, sorted by netmask desc, origin asc, metric asc
 
@@ -0,0 +1,136 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "IPv6DestCache.h"
+
+#define INITIAL_NUM_SLOTS  16
+
+
+struct IPv6DestCache::MatchesPrefix
+{
+    const IPv6Address& prefix;
+    int prefixLength;
+    MatchesPrefix(const IPv6Address& prefix, int prefixLength) : prefix(prefix), prefixLength(prefixLength) {}
+    bool operator()(const Entry& e) const { return e.dest.matches(prefix, prefixLength); }
+};
+
+struct IPv6DestCache::MatchesNextHop
+{
+    const IPv6Address& nextHopAddr;
+    int interfaceId;
+    MatchesNextHop(const IPv6Address& nextHopAddr, int interfaceId) : nextHopAddr(nextHopAddr), interfaceId(interfaceId) {}
+    bool operator()(const Entry& e) const { return e.interfaceId == interfaceId && e.nextHopAddr == nextHopAddr; }
+};
+
+struct IPv6DestCache::MatchesInterface
+{
+    int interfaceId;
+    MatchesInterface(int interfaceId) : interfaceId(interfaceId) {}
+    bool operator()(const Entry& e) const { return e.interfaceId == interfaceId; }
+};
+
+std::ostream& operator<<(std::ostream& os, const IPv6DestCache::Entry& e)
+{
+    os << e.dest << ": if=" << e.interfaceId << " " << e.nextHopAddr;  //FIXME try printing interface name
+    return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const IPv6DestCache& destCache)
+{
+    std::vector<IPv6DestCache::Entry> entries = destCache.getEntries();
+    os << entries.size() << " entries";
+    for (unsigned int i = 0; i < entries.size(); i++)
+        os << (i == 0 ? ": " : "; ") << entries[i];
+    return os;
+}
+
+IPv6DestCache::IPv6DestCache() : table(INITIAL_NUM_SLOTS)
+{
+}
+
+unsigned int IPv6DestCache::hashAddress(const IPv6Address& addr)
+{
+    // mix all words: destinations often differ only in the interface identifier
+    const uint32 *w = addr.words();
+    uint64 h = ((uint64)w[0] << 32 | w[1]) * 0x9e3779b97f4a7c15ULL;
+    h ^= ((uint64)w[2] << 32 | w[3]);
+    return (unsigned int)mixHash(h);
+}
+
+IPv6DestCache::Entry *IPv6DestCache::find(const IPv6Address& dest)
+{
+    int slot = table.findSlot(hashAddress(dest), MatchesDest(dest));
+    return slot == -1 ? NULL : &table.at(slot);
+}
+
+IPv6DestCache::Entry& IPv6DestCache::insert(const IPv6Address& dest)
+{
+    int slot = table.findSlot(hashAddress(dest), MatchesDest(dest));
+    if (slot == -1)
+    {
+        Entry entry;
+        entry.dest = dest;
+        entry.interfaceId = -1;
+        slot = table.insert(entry);
+    }
+    return table.at(slot);
+}
+
+bool IPv6DestCache::remove(const IPv6Address& dest)
+{
+    int slot = table.findSlot(hashAddress(dest), MatchesDest(dest));
+    if (slot == -1)
+        return false;
+    table.removeSlot(slot);
+    return true;
+}
+
+void IPv6DestCache::clear()
+{
+    table.clear();
+}
+
+int IPv6DestCache::removeEntriesForPrefix(const IPv6Address& prefix, int prefixLength)
+{
+    if (prefixLength == 0)
+    {
+        int n = table.size();
+        clear();
+        return n;
+    }
+    return table.removeIf(MatchesPrefix(prefix, prefixLength));
+}
+
+int IPv6DestCache::removeEntriesToNeighbour(const IPv6Address& nextHopAddr, int interfaceId)
+{
+    return table.removeIf(MatchesNextHop(nextHopAddr, interfaceId));
+}
+
+int IPv6DestCache::removeEntriesForInterface(int interfaceId)
+{
+    return table.removeIf(MatchesInterface(interfaceId));
+}
+
+std::vector<IPv6DestCache::Entry> IPv6DestCache::getEntries() const
+{
+    std::vector<Entry> entries;
+    for (int i = 0; i < table.getNumSlots(); i++)
+        if (table.isUsed(i))
+            entries.push_back(table.at(i));
+    return entries;
+}
+
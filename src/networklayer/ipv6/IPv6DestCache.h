@@ -0,0 +1,105 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_IPv6DESTCACHE_H
+#define __INET_IPv6DESTCACHE_H
+
+#include <vector>
+
+#include "INETDefs.h"
+
+#include "IPv6Address.h"
+#include "OpenHashTable.h"
+
+
+/**
+ * The Destination Cache of RoutingTable6: maps destination addresses to
+ * next hop and interface. It is an OpenHashTable, so lookups take constant
+ * time and do not allocate memory. Entries can be removed one by one or by
+ * prefix, so route changes only invalidate the destinations they may affect.
+ */
+class INET_API IPv6DestCache
+{
+  public:
+    // NOTE: nextHop might be a link-local address from which interfaceId cannot be deduced
+    struct Entry
+    {
+        IPv6Address dest;
+        int interfaceId;
+        IPv6Address nextHopAddr;
+        simtime_t expiryTime;
+        // more destination specific data may be added here, e.g. path MTU
+    };
+
+  protected:
+    struct EntryHash
+    {
+        unsigned int operator()(const Entry& e) const { return hashAddress(e.dest); }
+    };
+
+    struct MatchesDest
+    {
+        const IPv6Address& dest;
+        MatchesDest(const IPv6Address& dest) : dest(dest) {}
+        bool operator()(const Entry& e) const { return e.dest == dest; }
+    };
+
+    typedef OpenHashTable<Entry, EntryHash> EntryTable;
+    EntryTable table;
+
+  protected:
+    static unsigned int hashAddress(const IPv6Address& addr);
+
+    struct MatchesPrefix;
+    struct MatchesNextHop;
+    struct MatchesInterface;
+
+  public:
+    IPv6DestCache();
+
+    /** Returns the number of entries */
+    int size() const { return table.size(); }
+
+    /** Returns the entry of the destination, or NULL */
+    Entry *find(const IPv6Address& dest);
+
+    /** Returns the entry of the destination, creating it if necessary */
+    Entry& insert(const IPv6Address& dest);
+
+    /** Removes the entry of the destination; returns false if there was none */
+    bool remove(const IPv6Address& dest);
+
+    /** Removes all entries */
+    void clear();
+
+    /** Removes the entries of the destinations that match the prefix; returns their number */
+    int removeEntriesForPrefix(const IPv6Address& prefix, int prefixLength);
+
+    /** Removes the entries with the given next hop and interface; returns their number */
+    int removeEntriesToNeighbour(const IPv6Address& nextHopAddr, int interfaceId);
+
+    /** Removes the entries of the given interface; returns their number */
+    int removeEntriesForInterface(int interfaceId);
+
+    /** Returns all entries, in no particular order (for WATCH and debugging) */
+    std::vector<Entry> getEntries() const;
+};
+
+std::ostream& operator<<(std::ostream& os, const IPv6DestCache::Entry& e);
+std::ostream& operator<<(std::ostream& os, const IPv6DestCache& destCache);
+
+#endif
@@ -0,0 +1,193 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+
+#include "IPv6RouteTrie.h"
+
+#include "RoutingTable6.h"
+
+
+IPv6RouteTrie::Node::Node(Node *parent, int index) : parent(parent), index(index), numChildren(0), numPrefixes(0)
+{
+    for (int i = 0; i < FANOUT; i++)
+        child[i] = NULL;
+    for (int i = 0; i < FANOUT - 1; i++)
+        prefixes[i] = NULL;
+}
+
+IPv6RouteTrie::IPv6RouteTrie()
+{
+    root = new Node(NULL, 0);
+    numRoutes = 0;
+}
+
+IPv6RouteTrie::~IPv6RouteTrie()
+{
+    deleteSubtree(root);
+}
+
+void IPv6RouteTrie::deleteSubtree(Node *node)
+{
+    if (node)
+    {
+        for (int i = 0; i < FANOUT; i++)
+            deleteSubtree(node->child[i]);
+        for (int i = 0; i < FANOUT - 1; i++)
+            delete node->prefixes[i];
+        delete node;
+    }
+}
+
+void IPv6RouteTrie::clear()
+{
+    deleteSubtree(root);
+    root = new Node(NULL, 0);
+    numRoutes = 0;
+}
+
+int IPv6RouteTrie::getSlot(const IPv6Address& prefix, int prefixLength)
+{
+    int depth = prefixLength / STRIDE;
+    int localLength = prefixLength % STRIDE;
+    int localBits = localLength == 0 ? 0 : getChunk(prefix, depth) >> (STRIDE - localLength);
+    return (1 << localLength) - 1 + localBits;
+}
+
+// same order as RoutingTable6::routeLessThan() for routes of the same prefix
+bool IPv6RouteTrie::routeLessThan(const IPv6Route *a, const IPv6Route *b)
+{
+    if (a->getAdminDist() != b->getAdminDist())
+        return a->getAdminDist() < b->getAdminDist();
+    return a->getMetric() < b->getMetric();
+}
+
+bool IPv6RouteTrie::isExpired(const IPv6Route *route, simtime_t now)
+{
+    return route->getExpiryTime() != 0 && now > route->getExpiryTime();  // 0 represents infinity
+}
+
+IPv6RouteTrie::Node *IPv6RouteTrie::findNode(const IPv6Address& prefix, int prefixLength, bool create)
+{
+    Node *node = root;
+    for (int depth = 0; depth < prefixLength / STRIDE; depth++)
+    {
+        int chunk = getChunk(prefix, depth);
+        if (!node->child[chunk])
+        {
+            if (!create)
+                return NULL;
+            node->child[chunk] = new Node(node, chunk);
+            node->numChildren++;
+        }
+        node = node->child[chunk];
+    }
+    return node;
+}
+
+void IPv6RouteTrie::removeNodeIfUnused(Node *node)
+{
+    while (node != root && node->numPrefixes == 0 && node->numChildren == 0)
+    {
+        Node *parent = node->parent;
+        parent->child[node->index] = NULL;
+        parent->numChildren--;
+        delete node;
+        node = parent;
+    }
+}
+
+void IPv6RouteTrie::addRoute(IPv6Route *route)
+{
+    int prefixLength = route->getPrefixLength();
+    ASSERT(prefixLength >= 0 && prefixLength <= 128);
+    Node *node = findNode(route->getDestPrefix(), prefixLength, true);
+    RouteVector *&routes = node->prefixes[getSlot(route->getDestPrefix(), prefixLength)];
+    if (!routes)
+    {
+        routes = new RouteVector();
+        node->numPrefixes++;
+    }
+    ASSERT(std::find(routes->begin(), routes->end(), route) == routes->end());
+    routes->insert(std::upper_bound(routes->begin(), routes->end(), route, routeLessThan), route);
+    numRoutes++;
+}
+
+bool IPv6RouteTrie::removeRoute(const IPv6Route *route)
+{
+    int prefixLength = route->getPrefixLength();
+    Node *node = findNode(route->getDestPrefix(), prefixLength, false);
+    if (!node)
+        return false;
+    RouteVector *&routes = node->prefixes[getSlot(route->getDestPrefix(), prefixLength)];
+    if (!routes)
+        return false;
+    RouteVector::iterator it = std::find(routes->begin(), routes->end(), route);
+    if (it == routes->end())
+        return false;
+    routes->erase(it);
+    numRoutes--;
+    if (routes->empty())
+    {
+        delete routes;
+        routes = NULL;
+        node->numPrefixes--;
+        removeNodeIfUnused(node);
+    }
+    return true;
+}
+
+IPv6Route *IPv6RouteTrie::findBestMatchingRoute(const IPv6Address& dest, simtime_t now, RouteVector *expiredRoutes) const
+{
+    // collect the matching prefixes along the path, from the shortest to the longest
+    const RouteVector *matches[128 + 1];
+    int numMatches = 0;
+    const Node *node = root;
+    for (int depth = 0; node; depth++)
+    {
+        if (depth == MAX_DEPTH)
+        {
+            if (node->prefixes[0])
+                matches[numMatches++] = node->prefixes[0];
+            break;
+        }
+        int chunk = getChunk(dest, depth);
+        if (node->numPrefixes > 0)
+        {
+            for (int localLength = 0; localLength < STRIDE; localLength++)
+            {
+                const RouteVector *routes = node->prefixes[(1 << localLength) - 1 + (chunk >> (STRIDE - localLength))];
+                if (routes)
+                    matches[numMatches++] = routes;
+            }
+        }
+        node = node->child[chunk];
+    }
+
+    for (int i = numMatches - 1; i >= 0; i--)
+    {
+        for (RouteVector::const_iterator it = matches[i]->begin(); it != matches[i]->end(); ++it)
+        {
+            if (!isExpired(*it, now))
+                return *it;
+            if (expiredRoutes)
+                expiredRoutes->push_back(*it);
+        }
+    }
+    return NULL;
+}
+
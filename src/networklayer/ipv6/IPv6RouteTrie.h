@@ -0,0 +1,112 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_IPv6ROUTETRIE_H
+#define __INET_IPv6ROUTETRIE_H
+
+#include <vector>
+
+#include "INETDefs.h"
+
+#include "IPv6Address.h"
+
+class IPv6Route;
+
+
+/**
+ * Multibit trie of IPv6 routes, used by RoutingTable6 for longest prefix
+ * matching. Every node consumes 4 bits of the address, so a lookup visits
+ * at most 33 nodes regardless of the number of routes, and routes can be
+ * added and removed individually.
+ *
+ * Each node stores the prefixes that end inside its 4-bit stride in a
+ * small binary tree of 15 slots (1 of local length 0, 2 of length 1,
+ * 4 of length 2, 8 of length 3); prefixes of length 4 belong to the child.
+ * A slot holds the routes with exactly that prefix, ordered by
+ * administrative distance and metric, so findBestMatchingRoute() returns
+ * the same route as a linear scan over RoutingTable6's sorted route list.
+ *
+ * The prefix of an IPv6Route cannot change, so routes are found again
+ * by their prefix when they are removed.
+ */
+class INET_API IPv6RouteTrie
+{
+  public:
+    typedef std::vector<IPv6Route *> RouteVector;
+
+  protected:
+    enum
+    {
+        STRIDE = 4,
+        FANOUT = 1 << STRIDE,
+        MAX_DEPTH = 128 / STRIDE   // depth of the nodes of /128 prefixes
+    };
+
+    struct Node
+    {
+        Node *parent;
+        int index;                         // index in the parent's child array
+        int numChildren;
+        int numPrefixes;
+        Node *child[FANOUT];
+        RouteVector *prefixes[FANOUT - 1]; // slot (1 << localLength) - 1 + localBits
+
+        Node(Node *parent, int index);
+    };
+
+    Node *root;
+    int numRoutes;
+
+  protected:
+    static int getChunk(const IPv6Address& addr, int depth) { return (addr.words()[depth / 8] >> (28 - STRIDE * (depth % 8))) & (FANOUT - 1); }
+    static int getSlot(const IPv6Address& prefix, int prefixLength);
+    static bool routeLessThan(const IPv6Route *a, const IPv6Route *b);
+    static bool isExpired(const IPv6Route *route, simtime_t now);
+    Node *findNode(const IPv6Address& prefix, int prefixLength, bool create);
+    void removeNodeIfUnused(Node *node);
+    void deleteSubtree(Node *node);
+
+  private:
+    // copying not supported: following are private and also left undefined
+    IPv6RouteTrie(const IPv6RouteTrie& other);
+    IPv6RouteTrie& operator=(const IPv6RouteTrie& other);
+
+  public:
+    IPv6RouteTrie();
+    ~IPv6RouteTrie();
+
+    /** Adds the route under its prefix. The route is not owned by the trie. */
+    void addRoute(IPv6Route *route);
+
+    /** Removes the route; returns false if it was not in the trie */
+    bool removeRoute(const IPv6Route *route);
+
+    /** Removes all routes */
+    void clear();
+
+    /** Returns the number of routes in the trie */
+    int getNumRoutes() const { return numRoutes; }
+
+    /**
+     * Returns the first unexpired route of the longest matching prefix, or
+     * NULL if there is no such route. If expiredRoutes is not NULL, the
+     * expired routes that were skipped are appended to it.
+     */
+    IPv6Route *findBestMatchingRoute(const IPv6Address& dest, simtime_t now, RouteVector *expiredRoutes = NULL) const;
+};
+
+#endif
@@ -74,14 +74,16 @@ std::ostream& operator<<(std::ostream& os, const IPv6Route& e)
     return os;
 };
 
-std::ostream& operator<<(std::ostream& os, const RoutingTable6::DestCacheEntry& e)
-{
-    os << "if=" << e.interfaceId << " " << e.nextHopAddr;  //FIXME try printing interface name
-    return os;
-};
+// format and arguments for printing an IPv6 address in Enter_Method() without
+// creating a string (str().c_str() is too slow for methods called per packet)
+#define IPv6_ADDRESS_FORMAT  "%x:%x:%x:%x:%x:%x:%x:%x"
+#define IPv6_ADDRESS_ARGS(a) \
+    (a).words()[0] >> 16, (a).words()[0] & 0xffff, (a).words()[1] >> 16, (a).words()[1] & 0xffff, \
+    (a).words()[2] >> 16, (a).words()[2] & 0xffff, (a).words()[3] >> 16, (a).words()[3] & 0xffff
 
 RoutingTable6::RoutingTable6()
 {
+    useRouteTrie = false;
 }
 
 RoutingTable6::~RoutingTable6()
@@ -111,8 +113,19 @@ void RoutingTable6::initialize(int stage)
         nb->subscribe(this, NF_INTERFACE_IPv6CONFIG_CHANGED);
 
         WATCH_PTRVECTOR(routeList);
-        WATCH_MAP(destCache); // FIXME commented out for now
+        WATCH(destCache);
         isrouter = par("isRouter");
+
+        const char *routeLookup = par("routeLookup").stringValue();
+        if (!strcmp(routeLookup, "linear"))
+            useRouteTrie = false;
+        else if (!strcmp(routeLookup, "trie"))
+            useRouteTrie = true;
+        else
+            throw cRuntimeError("Unknown routeLookup parameter value: '%s'", routeLookup);
+        if (useRouteTrie)
+            for (RouteList::iterator it = routeList.begin(); it != routeList.end(); ++it)
+                routeTrie.addRoute(*it);  // routes added by other modules earlier
         multicastForward = par("forwardMulticast");
         WATCH(isrouter);
 
@@ -262,11 +275,19 @@ void RoutingTable6::routeChanged(IPv6Route *entry, int fieldCode)
 {
     ASSERT(entry != NULL);
 
-    /*XXX: this deletes some cache entries we want to keep, but the node MUST update
-     the Destination Cache in such a way that all entries will use the latest
-     route information.*/
+    // the node MUST update the Destination Cache in such a way that all entries
+    // will use the latest route information
     if (fieldCode==IPv6Route::F_NEXTHOP || fieldCode==IPv6Route::F_IFACE)
-        purgeDestCache();
+        purgeDestCacheEntriesForPrefix(entry->getDestPrefix(), entry->getPrefixLength());
+
+    // keep routes ordered by admin distance and metric
+    if (fieldCode==IPv6Route::F_METRIC || fieldCode==IPv6Route::F_ADMINDIST)
+    {
+        if (std::find(routeList.begin(), routeList.end(), entry) != routeList.end())
+            std::stable_sort(routeList.begin(), routeList.end(), routeLessThan);
+        if (useRouteTrie && routeTrie.removeRoute(entry))
+            routeTrie.addRoute(entry);
+    }
 
     updateDisplayString();
 
@@ -462,7 +483,7 @@ void RoutingTable6::configureTunnelFromXML(cXMLElement* cfg)
 
 InterfaceEntry *RoutingTable6::getInterfaceByAddress(const IPv6Address& addr)
 {
-    Enter_Method("getInterfaceByAddress(%s)=?", addr.str().c_str());
+    Enter_Method("getInterfaceByAddress(" IPv6_ADDRESS_FORMAT ")=?", IPv6_ADDRESS_ARGS(addr));
 
     if (addr.isUnspecified())
         return NULL;
@@ -478,7 +499,7 @@ InterfaceEntry *RoutingTable6::getInterfaceByAddress(const IPv6Address& addr)
 
 bool RoutingTable6::isLocalAddress(const IPv6Address& dest) const
 {
-    Enter_Method("isLocalAddress(%s) y/n", dest.str().c_str());
+    Enter_Method("isLocalAddress(" IPv6_ADDRESS_FORMAT ") y/n", IPv6_ADDRESS_ARGS(dest));
 
     // first, check if we have an interface with this address
     for (int i=0; i<ift->getNumInterfaces(); i++)
@@ -513,29 +534,44 @@ bool RoutingTable6::isLocalAddress(const IPv6Address& dest) const
 
 const IPv6Address& RoutingTable6::lookupDestCache(const IPv6Address& dest, int& outInterfaceId)
 {
-    Enter_Method("lookupDestCache(%s)", dest.str().c_str());
+    Enter_Method("lookupDestCache(" IPv6_ADDRESS_FORMAT ")", IPv6_ADDRESS_ARGS(dest));
 
-    DestCache::iterator it = destCache.find(dest);
-    if (it == destCache.end())
+    DestCacheEntry *entry = destCache.find(dest);
+    if (!entry)
     {
         outInterfaceId = -1;
         return IPv6Address::UNSPECIFIED_ADDRESS;
     }
-    DestCacheEntry &entry = it->second;
-    if (entry.expiryTime > 0 && simTime() > entry.expiryTime)
+    if (entry->expiryTime > 0 && simTime() > entry->expiryTime)
     {
-        destCache.erase(it);
+        destCache.remove(dest);
         outInterfaceId = -1;
         return IPv6Address::UNSPECIFIED_ADDRESS;
     }
 
-    outInterfaceId = entry.interfaceId;
-    return entry.nextHopAddr;
+    outInterfaceId = entry->interfaceId;
+    return entry->nextHopAddr;
 }
 
 const IPv6Route *RoutingTable6::doLongestPrefixMatch(const IPv6Address& dest)
 {
-    Enter_Method("doLongestPrefixMatch(%s)", dest.str().c_str());
+    Enter_Method("doLongestPrefixMatch(" IPv6_ADDRESS_FORMAT ")", IPv6_ADDRESS_ARGS(dest));
+
+    if (useRouteTrie)
+    {
+        IPv6RouteTrie::RouteVector expiredRoutes;
+        const IPv6Route *route = routeTrie.findBestMatchingRoute(dest, simTime(), &expiredRoutes);
+        for (IPv6RouteTrie::RouteVector::iterator it = expiredRoutes.begin(); it != expiredRoutes.end(); ++it)
+        {
+            if ((*it)->getSrc()==IPv6Route::FROM_RA)
+            {
+                EV << "Expired prefix detected!!" << endl;
+                routeList.erase(std::find(routeList.begin(), routeList.end(), *it));
+                routeTrie.removeRoute(*it);
+            }
+        }
+        return route;
+    }
 
     // we'll just stop at the first match, because the table is sorted
     // by prefix lengths and metric (see addRoute())
@@ -555,6 +591,8 @@ const IPv6Route *RoutingTable6::doLongestPrefixMatch(const IPv6Address& dest)
                     //RouteList::iterator oldIt = it++;
                     //removeOnLinkPrefix((*oldIt)->getDestPrefix(), (*oldIt)->getPrefixLength());
                 }
+                else
+                    ++it;
             }
             else
                 return *it;
@@ -576,7 +614,7 @@ bool RoutingTable6::isPrefixPresent(const IPv6Address& prefix) const
 
 void RoutingTable6::updateDestCache(const IPv6Address& dest, const IPv6Address& nextHopAddr, int interfaceId, simtime_t expiryTime)
 {
-    DestCacheEntry &entry = destCache[dest];
+    DestCacheEntry &entry = destCache.insert(dest);
     entry.nextHopAddr = nextHopAddr;
     entry.interfaceId = interfaceId;
     entry.expiryTime = expiryTime;
@@ -590,39 +628,21 @@ void RoutingTable6::purgeDestCache()
     updateDisplayString();
 }
 
-void RoutingTable6::purgeDestCacheEntriesToNeighbour(const IPv6Address& nextHopAddr, int interfaceId)
+void RoutingTable6::purgeDestCacheEntriesForPrefix(const IPv6Address& prefix, int prefixLength)
 {
-    for (DestCache::iterator it=destCache.begin(); it!=destCache.end(); )
-    {
-        if (it->second.interfaceId==interfaceId && it->second.nextHopAddr==nextHopAddr)
-        {
-            // move the iterator past this element before removing it
-            destCache.erase(it++);
-        }
-        else
-        {
-            it++;
-        }
-    }
+    destCache.removeEntriesForPrefix(prefix, prefixLength);
+    updateDisplayString();
+}
 
+void RoutingTable6::purgeDestCacheEntriesToNeighbour(const IPv6Address& nextHopAddr, int interfaceId)
+{
+    destCache.removeEntriesToNeighbour(nextHopAddr, interfaceId);
     updateDisplayString();
 }
 
 void RoutingTable6::purgeDestCacheForInterfaceID(int interfaceId)
 {
-    for (DestCache::iterator it=destCache.begin(); it!=destCache.end(); )
-    {
-        if (it->second.interfaceId==interfaceId)
-        {
-            // move the iterator past this element before removing it
-            destCache.erase(it++);
-        }
-        else
-        {
-            ++it;
-        }
-    }
-
+    destCache.removeEntriesForInterface(interfaceId);
     updateDisplayString();
 }
 
@@ -711,6 +731,8 @@ void RoutingTable6::removeOnLinkPrefix(const IPv6Address& destPrefix, int prefix
     {
         if ((*it)->getSrc()==IPv6Route::FROM_RA && (*it)->getDestPrefix()==destPrefix && (*it)->getPrefixLength()==prefixLength)
         {
+            if (useRouteTrie)
+                routeTrie.removeRoute(*it);
             routeList.erase(it);
             return; // there can be only one such route, addOrUpdateOnLinkPrefix() guarantees that
         }
@@ -779,16 +801,17 @@ bool RoutingTable6::routeLessThan(const IPv6Route *a, const IPv6Route *b)
 void RoutingTable6::addRoute(IPv6Route *route)
 {
     route->setRoutingTable(this);
-    routeList.push_back(route);
 
     // we keep entries sorted by prefix length in routeList, so that we can
-    // stop at the first match when doing the longest prefix matching
-    std::sort(routeList.begin(), routeList.end(), routeLessThan);
+    // stop at the first match when doing the longest prefix matching; equal
+    // routes stay in insertion order, like in the route trie
+    routeList.insert(std::upper_bound(routeList.begin(), routeList.end(), route, routeLessThan), route);
+    if (useRouteTrie)
+        routeTrie.addRoute(route);
 
-    /*XXX: this deletes some cache entries we want to keep, but the node MUST update
-     the Destination Cache in such a way that the latest route information are used.*/
-    purgeDestCache();
-    updateDisplayString();
+    // the node MUST update the Destination Cache in such a way that the latest
+    // route information are used; only destinations within the prefix may change
+    purgeDestCacheEntriesForPrefix(route->getDestPrefix(), route->getPrefixLength());
 
     nb->fireChangeNotification(NF_IPv6_ROUTE_ADDED, route);
 }
@@ -801,14 +824,15 @@ void RoutingTable6::removeRoute(IPv6Route *route)
     nb->fireChangeNotification(NF_IPv6_ROUTE_DELETED, route); // rather: going to be deleted
 
     routeList.erase(it);
+    if (useRouteTrie)
+        routeTrie.removeRoute(route);
+
+    /* the node MUST update the Destination Cache in such a way that all entries
+     using the next-hop from the deleted route perform next-hop determination
+     again rather than continue sending traffic using that deleted route next-hop.
+     Only destinations within the prefix of the route may have used it. */
+    purgeDestCacheEntriesForPrefix(route->getDestPrefix(), route->getPrefixLength());
     delete route;
-
-    /*XXX: this deletes some cache entries we want to keep, but the node MUST update
-     the Destination Cache in such a way that all entries using the next-hop from
-     the deleted route perform next-hop determination again rather than continue
-     sending traffic using that deleted route next-hop.*/
-    purgeDestCache();
-    updateDisplayString();
 }
 
 int RoutingTable6::getNumRoutes() const
@@ -861,7 +885,11 @@ void RoutingTable6::removeDefaultRoutes(int interfaceID)
     {
         // default routes have prefix length 0
         if ( (((*it)->getInterfaceId()) == interfaceID) && ((*it)->getPrefixLength() == 0)  )
+        {
+            if (useRouteTrie)
+                routeTrie.removeRoute(*it);
             it = routeList.erase(it);
+        }
         else
             ++it;
     }
@@ -878,6 +906,7 @@ void RoutingTable6::removeAllRoutes()
         delete routeList[i];
 
     routeList.clear();
+    routeTrie.clear();
 
     updateDisplayString();
 }
@@ -889,7 +918,11 @@ void RoutingTable6::removePrefixes(int interfaceID)
     {
         // "real" prefixes have a length of larger then 0
         if ( (((*it)->getInterfaceId()) == interfaceID) && ((*it)->getPrefixLength() > 0)  )
+        {
+            if (useRouteTrie)
+                routeTrie.removeRoute(*it);
             it = routeList.erase(it);
+        }
         else
             ++it;
     }
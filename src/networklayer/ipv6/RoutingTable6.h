@@ -25,6 +25,8 @@
 #include "IPv6Address.h"
 #include "NotificationBoard.h"
 #include "ILifecycle.h"
+#include "IPv6RouteTrie.h"
+#include "IPv6DestCache.h"
 
 class IInterfaceTable;
 class InterfaceEntry;
@@ -160,23 +162,17 @@ class INET_API RoutingTable6 : public cSimpleModule, protected INotifiable, publ
 #endif /* WITH_xMIPv6 */
 
     // Destination Cache maps dest address to next hop and interfaceId.
-    // NOTE: nextHop might be a link-local address from which interfaceId cannot be deduced
-    struct DestCacheEntry
-    {
-        int interfaceId;
-        IPv6Address nextHopAddr;
-        simtime_t expiryTime;
-        // more destination specific data may be added here, e.g. path MTU
-    };
-    friend std::ostream& operator<<(std::ostream& os, const DestCacheEntry& e);
-    typedef std::map<IPv6Address,DestCacheEntry> DestCache;
-    DestCache destCache;
+    typedef IPv6DestCache::Entry DestCacheEntry;
+    IPv6DestCache destCache;
 
     // RouteList contains local prefixes, and (for routers)
     // static, OSPF, RIP etc routes as well
     typedef std::vector<IPv6Route*> RouteList;
     RouteList routeList;
 
+    bool useRouteTrie;        // if true, doLongestPrefixMatch() uses routeTrie instead of scanning routeList
+    IPv6RouteTrie routeTrie;  // the same routes as in routeList, indexed by prefix
+
   protected:
     // creates a new empty route, factory method overriden in subclasses that use custom routes
     virtual IPv6Route *createNewRoute(IPv6Address destPrefix, int prefixLength, IPv6Route::RouteSrc src);
@@ -317,6 +313,13 @@ class INET_API RoutingTable6 : public cSimpleModule, protected INotifiable, publ
      */
     virtual void purgeDestCache();
 
+    /**
+     * Discard the destination cache entries of the destinations that match
+     * the given prefix. This is called when a route of that prefix is added,
+     * removed or changed, because only those destinations may be affected.
+     */
+    virtual void purgeDestCacheEntriesForPrefix(const IPv6Address& prefix, int prefixLength);
+
     /**
      * Discard all entries in destination cache where next hop is the given
      * address on the given interface. This is typically called when a router
@@ -67,7 +67,7 @@
 #include "aodv-uu/list.h"
 
 #include "ICMPAccess.h"
-#include "Ieee80211Frame_m.h"
+#include "Ieee80211Frame.h"
 
 #include "aodv_msg_struct.h"
 /* Forward declaration needed to be able to reference the class */
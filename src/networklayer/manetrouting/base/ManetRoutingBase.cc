@@ -33,7 +33,7 @@
 #include "InterfaceTableAccess.h"
 #include "Coord.h"
 #include "ControlInfoBreakLink_m.h"
-#include "Ieee80211Frame_m.h"
+#include "Ieee80211Frame.h"
 #include "ICMPAccess.h"
 #include "IMobility.h"
 #include "Ieee80211MgmtAP.h"
@@ -5,7 +5,7 @@
 #include "IPv4ControlInfo.h"
 #include "IPv4InterfaceData.h"
 #include "IPvXAddressResolver.h"
-#include "UDPPacket_m.h"
+#include "UDPPacket.h"
 #include "Ieee802Ctrl_m.h"
 
 Define_Module(Batman);
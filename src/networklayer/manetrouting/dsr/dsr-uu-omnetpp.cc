@@ -28,7 +28,7 @@
 #include "IPSocket.h"
 #include "IPv4Address.h"
 #include "Ieee802Ctrl_m.h"
-#include "Ieee80211Frame_m.h"
+#include "Ieee80211Frame.h"
 #include "ICMPMessage_m.h"
 
 unsigned int DSRUU::confvals[CONFVAL_MAX];
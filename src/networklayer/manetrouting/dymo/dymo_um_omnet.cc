@@ -34,7 +34,7 @@
 #include "ICMPAccess.h"
 #include "NotifierConsts.h"
 #include "Ieee802Ctrl_m.h"
-#include "Ieee80211Frame_m.h"
+#include "Ieee80211Frame.h"
 #include "IPv4InterfaceData.h"
 
 
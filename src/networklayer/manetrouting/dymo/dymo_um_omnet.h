@@ -58,7 +58,7 @@
 /* System-dependent datatypes */
 /* Needed by some network-related datatypes */
 #include "ManetRoutingBase.h"
-#include "Ieee80211Frame_m.h"
+#include "Ieee80211Frame.h"
 #include "dymoum/dlist.h"
 #include "dymo_msg_struct.h"
 #include "IPv4Datagram.h"
@@ -32,6 +32,7 @@
 
 #include <math.h>
 #include <limits.h>
+#include <algorithm>
 
 #include "UDPPacket.h"
 #include "IPv4Datagram.h"
@@ -87,6 +88,7 @@ OLSR_Timer::OLSR_Timer(OLSR* agent) : cOwnedObject("OLSR_Timer")
 {
     agent_ = agent;
     tuple_ = NULL;
+    queued_ = false;
 }
 
 OLSR_Timer::~OLSR_Timer()
@@ -100,25 +102,30 @@ OLSR_Timer::OLSR_Timer() : cOwnedObject("OLSR_Timer")
     if (agent_==NULL)
         opp_error("timer ower is bad");
     tuple_ = NULL;
+    queued_ = false;
+}
+
+void OLSR_Timer::insertQueueTimer(simtime_t time)
+{
+    // a timer is in the queue at most once, so it can be removed without searching
+    if (queued_)
+        agent_->timerQueuePtr->erase(queuePos_);
+    queuePos_ = agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(time, this));
+    queued_ = true;
 }
 
 void OLSR_Timer::removeQueueTimer()
 {
-    TimerQueue::iterator it;
-    for (it=agent_->timerQueuePtr->begin(); it != agent_->timerQueuePtr->end(); it++ )
+    if (queued_)
     {
-        if (it->second==this)
-        {
-            agent_->timerQueuePtr->erase(it);
-            return;
-        }
+        agent_->timerQueuePtr->erase(queuePos_);
+        queued_ = false;
     }
 }
 
 void OLSR_Timer::resched(double time)
 {
-    removeQueueTimer();
-    agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+time, this));
+    insertQueueTimer(simTime()+time);
     //if (this->isScheduled())
     //  agent_->cancelEvent(this);
     // agent_->scheduleAt (simTime()+time,this);
@@ -134,7 +141,7 @@ OLSR_HelloTimer::expire()
 {
     agent_->send_hello();
     // agent_->scheduleAt(simTime()+agent_->hello_ival_- JITTER,this);
-    agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+agent_->hello_ival_- agent_->jitter(), this));
+    insertQueueTimer(simTime()+agent_->hello_ival_- agent_->jitter());
 }
 
 ///
@@ -147,7 +154,7 @@ OLSR_TcTimer::expire()
     if (agent_->mprselset().size() > 0)
         agent_->send_tc();
     // agent_->scheduleAt(simTime()+agent_->tc_ival_- JITTER,this);
-    agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+agent_->tc_ival_- agent_->jitter(), this));
+    insertQueueTimer(simTime()+agent_->tc_ival_- agent_->jitter());
 
 }
 
@@ -164,7 +171,7 @@ OLSR_MidTimer::expire()
         return; // not multi-interface support
     agent_->send_mid();
 //  agent_->scheduleAt(simTime()+agent_->mid_ival_- JITTER,this);
-    agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+agent_->mid_ival_- agent_->jitter(), this));
+    insertQueueTimer(simTime()+agent_->mid_ival_- agent_->jitter());
 #endif
 }
 
@@ -190,7 +197,7 @@ OLSR_DupTupleTimer::expire()
     else
     {
         // agent_->scheduleAt (simTime()+DELAY_T(time),this);
-        agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+DELAY_T(time), this));
+        insertQueueTimer(simTime()+DELAY_T(time));
     }
 }
 
@@ -244,12 +251,12 @@ OLSR_LinkTupleTimer::expire()
         else
             agent_->nb_loss(tuple);
         // agent_->scheduleAt (simTime()+DELAY_T(tuple_->time()),this);
-        agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+DELAY_T(tuple->time()), this));
+        insertQueueTimer(simTime()+DELAY_T(tuple->time()));
     }
     else
     {
         // agent_->scheduleAt (simTime()+DELAY_T(MIN(tuple_->time(), tuple_->sym_time())),this);
-        agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+DELAY_T(MIN(tuple->time(), tuple->sym_time())), this));
+        insertQueueTimer(simTime()+DELAY_T(MIN(tuple->time(), tuple->sym_time())));
     }
 }
 
@@ -288,7 +295,7 @@ OLSR_Nb2hopTupleTimer::expire()
     else
     {
         // agent_->scheduleAt (simTime()+DELAY_T(time),this);
-        agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+DELAY_T(time), this));
+        insertQueueTimer(simTime()+DELAY_T(time));
     }
 }
 
@@ -329,7 +336,7 @@ OLSR_MprSelTupleTimer::expire()
     else
     {
 //      agent_->scheduleAt (simTime()+DELAY_T(time),this);
-        agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+DELAY_T(time), this));
+        insertQueueTimer(simTime()+DELAY_T(time));
     }
 }
 
@@ -369,7 +376,7 @@ OLSR_TopologyTupleTimer::expire()
     else
     {
 //      agent_->scheduleAt (simTime()+DELAY_T(time),this);
-        agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+DELAY_T(time), this));
+        insertQueueTimer(simTime()+DELAY_T(time));
     }
 }
 
@@ -406,7 +413,7 @@ void OLSR_IfaceAssocTupleTimer::expire()
     else
     {
         //  agent_->scheduleAt (simTime()+DELAY_T(time),this);
-        agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+DELAY_T(time), this));
+        insertQueueTimer(simTime()+DELAY_T(time));
     }
 }
 
@@ -557,14 +564,11 @@ void OLSR::handleMessage(cMessage *msg)
         //OLSR_Timer *timer=dynamic_cast<OLSR_Timer*>(msg);
         while (timerQueuePtr->begin()->first<=simTime())
         {
-            OLSR_Timer *timer = timerQueuePtr->begin()->second;
+            OLSR_Timer *timer = dequeueTimer();
             if (timer==NULL)
                 opp_error("timer ower is bad");
             else
-            {
-                timerQueuePtr->erase(timerQueuePtr->begin());
                 timer->expire();
-            }
         }
     }
     else
@@ -766,15 +770,15 @@ OLSR::recv_olsr(cMessage* msg)
             toRemove.insert(twoHopNeigh->nb2hop_addr());
         }
     }
-    // Now remove all matching records from N2
-    for (nb2hopset_t::iterator it = N2.begin(); it != N2.end();)
+    // Now remove all matching records from N2, keeping the order of the others
+    nb2hopset_t::iterator last = N2.begin();
+    for (nb2hopset_t::iterator it = N2.begin(); it != N2.end(); it++)
     {
         OLSR_nb2hop_tuple* twoHopNeigh = *it;
-        if (toRemove.find(twoHopNeigh->nb2hop_addr()) != toRemove.end())
-            it = N2.erase(it);
-        else
-            it++;
+        if (toRemove.find(twoHopNeigh->nb2hop_addr()) == toRemove.end())
+            *last++ = twoHopNeigh;
     }
+    N2.erase(last, N2.end());
 }
 
 ///
@@ -1066,6 +1070,11 @@ OLSR::mpr_computation()
         if ((*it)->getStatus() == OLSR_STATUS_SYM) // I think that we need this check
             N.push_back(*it);
 
+    // first member of N for each main address
+    std::map<nsaddr_t, OLSR_nb_tuple*> N_by_addr;
+    for (nbset_t::iterator it = N.begin(); it != N.end(); it++)
+        N_by_addr.insert(std::make_pair((*it)->nb_main_addr(), *it));
+
     // N2 is the set of 2-hop neighbors reachable from "the interface
     // I", excluding:
     // (i)   the nodes only reachable by members of N with willingness WILL_NEVER
@@ -1082,24 +1091,8 @@ OLSR::mpr_computation()
         }
         // excluding:
         // (i) the nodes only reachable by members of N with willingness WILL_NEVER
-        bool ok = false;
-        for (nbset_t::const_iterator it2 = N.begin(); it2 != N.end(); it2++)
-        {
-            OLSR_nb_tuple* neigh = *it2;
-            if (neigh->nb_main_addr() == nb2hop_tuple->nb_main_addr())
-            {
-                if (neigh->willingness() == OLSR_WILL_NEVER)
-                {
-                    ok = false;
-                    break;
-                }
-                else
-                {
-                    ok = true;
-                    break;
-                }
-            }
-        }
+        std::map<nsaddr_t, OLSR_nb_tuple*>::iterator neigh = N_by_addr.find(nb2hop_tuple->nb_main_addr());
+        bool ok = neigh != N_by_addr.end() && neigh->second->willingness() != OLSR_WILL_NEVER;
         if (!ok)
         {
             continue;
@@ -1108,15 +1101,8 @@ OLSR::mpr_computation()
         // excluding:
         // (iii) all the symmetric neighbors: the nodes for which there exists a symmetric
         //       link to this node on some interface.
-        for (nbset_t::iterator it2 = N.begin(); it2 != N.end(); it2++)
-        {
-            OLSR_nb_tuple* neigh = *it2;
-            if (neigh->nb_main_addr() == nb2hop_tuple->nb2hop_addr())
-            {
-                ok = false;
-                break;
-            }
-        }
+        if (N_by_addr.find(nb2hop_tuple->nb2hop_addr()) != N_by_addr.end())
+            ok = false;
         if (ok)
             N2.push_back(nb2hop_tuple);
     }
@@ -1142,52 +1128,47 @@ OLSR::mpr_computation()
     // nodes to provide reachability to a node in N2. Remove the
     // nodes from N2 which are now covered by a node in the MPR set.
 
+    // for each 2-hop neighbor: the first neighbor reaching it, and whether
+    // another neighbor reaches it too
+    std::map<nsaddr_t, std::pair<nsaddr_t, bool> > reachedBy;
+    // 2-hop neighbors reachable through each neighbor
+    std::multimap<nsaddr_t, nsaddr_t> reachableThrough;
+    for (nb2hopset_t::iterator it = N2.begin(); it != N2.end(); it++)
+    {
+        OLSR_nb2hop_tuple* twoHopNeigh = *it;
+        std::map<nsaddr_t, std::pair<nsaddr_t, bool> >::iterator r = reachedBy.find(twoHopNeigh->nb2hop_addr());
+        if (r == reachedBy.end())
+            reachedBy.insert(std::make_pair(twoHopNeigh->nb2hop_addr(), std::make_pair(twoHopNeigh->nb_main_addr(), false)));
+        else if (r->second.first != twoHopNeigh->nb_main_addr())
+            r->second.second = true;
+        reachableThrough.insert(std::make_pair(twoHopNeigh->nb_main_addr(), twoHopNeigh->nb2hop_addr()));
+    }
+
     std::set<nsaddr_t> coveredTwoHopNeighbors;
     for (nb2hopset_t::iterator it = N2.begin(); it != N2.end(); it++)
     {
         OLSR_nb2hop_tuple* twoHopNeigh = *it;
-        bool onlyOne = true;
-        // try to find another neighbor that can reach twoHopNeigh->twoHopNeighborAddr
-        for (nb2hopset_t::const_iterator it2 = N2.begin(); it2 != N2.end(); it2++)
-        {
-            OLSR_nb2hop_tuple* otherTwoHopNeigh = *it2;
-            if (otherTwoHopNeigh->nb2hop_addr() == twoHopNeigh->nb2hop_addr()
-                    && otherTwoHopNeigh->nb_main_addr() != twoHopNeigh->nb_main_addr())
-            {
-                onlyOne = false;
-                break;
-            }
-        }
+        bool onlyOne = !reachedBy[twoHopNeigh->nb2hop_addr()].second;
         if (onlyOne)
         {
             state_.insert_mpr_addr(twoHopNeigh->nb_main_addr());
 
             // take note of all the 2-hop neighbors reachable by the newly elected MPR
-            for (nb2hopset_t::const_iterator it2 = N2.begin(); it2 != N2.end(); it2++)
-            {
-                OLSR_nb2hop_tuple* otherTwoHopNeigh = *it2;
-                if (otherTwoHopNeigh->nb_main_addr() == twoHopNeigh->nb_main_addr())
-                {
-                    coveredTwoHopNeighbors.insert(otherTwoHopNeigh->nb2hop_addr());
-                }
-            }
+            std::pair<std::multimap<nsaddr_t, nsaddr_t>::iterator, std::multimap<nsaddr_t, nsaddr_t>::iterator> range =
+                reachableThrough.equal_range(twoHopNeigh->nb_main_addr());
+            for (std::multimap<nsaddr_t, nsaddr_t>::iterator it2 = range.first; it2 != range.second; it2++)
+                coveredTwoHopNeighbors.insert(it2->second);
         }
     }
     // Remove the nodes from N2 which are now covered by a node in the MPR set.
-    for (nb2hopset_t::iterator it = N2.begin(); it != N2.end();)
+    nb2hopset_t::iterator last = N2.begin();
+    for (nb2hopset_t::iterator it = N2.begin(); it != N2.end(); it++)
     {
         OLSR_nb2hop_tuple* twoHopNeigh = *it;
-        if (coveredTwoHopNeighbors.find(twoHopNeigh->nb2hop_addr()) != coveredTwoHopNeighbors.end())
-        {
-            // This works correctly only because it is known that twoHopNeigh is reachable by exactly one neighbor,
-            // so only one record in N2 exists for each of them. This record is erased here.
-            it = N2.erase(it);
-        }
-        else
-        {
-            it++;
-        }
+        if (coveredTwoHopNeighbors.find(twoHopNeigh->nb2hop_addr()) == coveredTwoHopNeighbors.end())
+            *last++ = twoHopNeigh;
     }
+    N2.erase(last, N2.end());
     // 4. While there exist nodes in N2 which are not covered by at
     // least one node in the MPR set:
 
@@ -1198,19 +1179,17 @@ OLSR::mpr_computation()
         // number of nodes in N2 which are not yet covered by at
         // least one node in the MPR set, and which are reachable
         // through this 1-hop neighbor
+        std::map<nsaddr_t, int> counts;
+        for (nb2hopset_t::iterator it = N2.begin(); it != N2.end(); it++)
+            counts[(*it)->nb_main_addr()]++;
+
         std::map<int, std::vector<OLSR_nb_tuple*> > reachability;
         std::set<int> rs;
         for (nbset_t::iterator it = N.begin(); it != N.end(); it++)
         {
             OLSR_nb_tuple* nb_tuple = *it;
-            int r = 0;
-            for (nb2hopset_t::iterator it2 = N2.begin(); it2 != N2.end(); it2++)
-            {
-                OLSR_nb2hop_tuple* nb2hop_tuple = *it2;
-
-                if (nb_tuple->nb_main_addr() == nb2hop_tuple->nb_main_addr())
-                    r++;
-            }
+            std::map<nsaddr_t, int>::iterator count = counts.find(nb_tuple->nb_main_addr());
+            int r = count == counts.end() ? 0 : count->second;
             rs.insert(r);
             reachability[r].push_back(nb_tuple);
         }
@@ -1271,57 +1250,46 @@ OLSR::mpr_computation()
 ///
 /// \brief Creates the routing table of the node following RFC 3626 hints.
 ///
+/// The table is computed from the repositories every time, but only the
+/// routes that differ from the previous table are changed in the IP routing
+/// table (see install_rtable_changes()).
+///
 void
 OLSR::rtable_computation()
 {
-    nsaddr_t netmask(IPv4Address::ALLONES_ADDRESS);
     // 1. All the entries from the routing table are removed.
-    //
-
-    if (par("DelOnlyRtEntriesInrtable_").boolValue())
-    {
-        for (rtable_t::const_iterator itRtTable = rtable_.getInternalTable()->begin();itRtTable != rtable_.getInternalTable()->begin();++itRtTable)
-        {
-            nsaddr_t addr = itRtTable->first;
-            omnet_chg_rte(addr, addr,netmask,1, true, addr);
-        }
-    }
-    else
-        omnet_clean_rte(); // clean IP tables
-
-    rtable_.clear();
-
+    // (the previous entries are kept until the new table is installed)
+    rtable_t old_rt;
+    old_rt.swap(rtable_.rt_);
 
     // 2. The new routing entries are added starting with the
     // symmetric neighbors (h=1) as the destination nodes.
 
+    // link tuples by the main address of the neighbor, in Link Set order
+    std::map<nsaddr_t, std::vector<OLSR_link_tuple*> > nb_links;
+    for (linkset_t::iterator it = linkset().begin(); it != linkset().end(); it++)
+        nb_links[get_main_addr((*it)->nb_iface_addr())].push_back(*it);
+
     for (nbset_t::iterator it = nbset().begin(); it != nbset().end(); it++)
     {
         OLSR_nb_tuple* nb_tuple = *it;
         if (nb_tuple->getStatus() == OLSR_STATUS_SYM)
         {
+            std::map<nsaddr_t, std::vector<OLSR_link_tuple*> >::iterator links = nb_links.find(nb_tuple->nb_main_addr());
+            if (links == nb_links.end())
+                continue;
             bool nb_main_addr = false;
             OLSR_link_tuple* lt = NULL;
-            for (linkset_t::iterator it2 = linkset().begin(); it2 != linkset().end(); it2++)
+            for (std::vector<OLSR_link_tuple*>::iterator it2 = links->second.begin(); it2 != links->second.end(); it2++)
             {
                 OLSR_link_tuple* link_tuple = *it2;
-                if (get_main_addr(link_tuple->nb_iface_addr()) == nb_tuple->nb_main_addr() && link_tuple->time() >= CURRENT_TIME)
+                if (link_tuple->time() >= CURRENT_TIME)
                 {
                     lt = link_tuple;
                     rtable_.add_entry(link_tuple->nb_iface_addr(),
                                       link_tuple->nb_iface_addr(),
                                       link_tuple->local_iface_addr(),
                                       1, link_tuple->local_iface_index());
-                    if (!useIndex)
-                        omnet_chg_rte(link_tuple->nb_iface_addr(),
-                                       link_tuple->nb_iface_addr(),
-                                       netmask,
-                                       1, false, link_tuple->local_iface_addr());
-                    else
-                        omnet_chg_rte(link_tuple->nb_iface_addr(),
-                                       link_tuple->nb_iface_addr(),
-                                       netmask,
-                                       1, false, link_tuple->local_iface_index());
 
                     if (link_tuple->nb_iface_addr() == nb_tuple->nb_main_addr())
                         nb_main_addr = true;
@@ -1333,18 +1301,6 @@ OLSR::rtable_computation()
                                   lt->nb_iface_addr(),
                                   lt->local_iface_addr(),
                                   1, lt->local_iface_index());
-
-                if (!useIndex)
-                    omnet_chg_rte(nb_tuple->nb_main_addr(),
-                                   lt->nb_iface_addr(),
-                                   netmask,// Default mask
-                                   1, false, lt->local_iface_addr());
-
-                else
-                    omnet_chg_rte(nb_tuple->nb_main_addr(),
-                                   lt->nb_iface_addr(),
-                                   netmask,// Default mask
-                                   1, false, lt->local_iface_index());
             }
         }
     }
@@ -1383,18 +1339,6 @@ OLSR::rtable_computation()
                               entry->next_addr(),
                               entry->iface_addr(),
                               2, entry->local_iface_index());
-            if (!useIndex)
-                omnet_chg_rte(nb2hop_tuple->nb2hop_addr(),
-                               entry->next_addr(),
-                               netmask,
-                               2, false, entry->iface_addr());
-
-            else
-                omnet_chg_rte(nb2hop_tuple->nb2hop_addr(),
-                               entry->next_addr(),
-                               netmask,
-                               2, false, entry->local_iface_index());
-
         }
     }
 
@@ -1408,11 +1352,23 @@ OLSR::rtable_computation()
         // corresponds to R_dest_addr of a route entry whose R_dist
         // is equal to h, then a new route entry MUST be recorded in
         // the routing table (if it does not already exist)
-        for (topologyset_t::iterator it = topologyset().begin();
-                it != topologyset().end();
-                it++)
+        //
+        // Only the tuples whose T_last_addr has a route of distance h are
+        // taken from the topology index, and visited in Topology Set order.
+        std::vector<topologyindexentry_t> candidates;
+        for (rtable_t::iterator it = rtable_.rt_.begin(); it != rtable_.rt_.end(); it++)
         {
-            OLSR_topology_tuple* topology_tuple = *it;
+            if (it->second->dist() != h)
+                continue;
+            std::pair<topologyindex_t::iterator, topologyindex_t::iterator> range = state_.topologyindex_.equal_range(it->first);
+            for (topologyindex_t::iterator it2 = range.first; it2 != range.second; it2++)
+                candidates.push_back(it2->second);
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        for (std::vector<topologyindexentry_t>::iterator it = candidates.begin(); it != candidates.end(); it++)
+        {
+            OLSR_topology_tuple* topology_tuple = it->second;
             OLSR_rt_entry* entry1 = rtable_.lookup(topology_tuple->dest_addr());
             OLSR_rt_entry* entry2 = rtable_.lookup(topology_tuple->last_addr());
             if (entry1 == NULL && entry2 != NULL && entry2->dist() == h)
@@ -1421,19 +1377,6 @@ OLSR::rtable_computation()
                                   entry2->next_addr(),
                                   entry2->iface_addr(),
                                   h+1, entry2->local_iface_index(), entry2);
-
-                if (!useIndex)
-                    omnet_chg_rte(topology_tuple->dest_addr(),
-                                   entry2->next_addr(),
-                                   netmask,
-                                   h+1, false, entry2->iface_addr());
-
-                else
-                    omnet_chg_rte(topology_tuple->dest_addr(),
-                                   entry2->next_addr(),
-                                   netmask,
-                                   h+1, false, entry2->local_iface_index());
-
                 added = true;
             }
         }
@@ -1457,18 +1400,6 @@ OLSR::rtable_computation()
                                   entry1->next_addr(),
                                   entry1->iface_addr(),
                                   entry1->dist(), entry1->local_iface_index(), entry1);
-
-                if (!useIndex)
-                    omnet_chg_rte(tuple->iface_addr(),
-                                   entry1->next_addr(),
-                                   netmask,
-                                   entry1->dist(), false, entry1->iface_addr());
-
-                else
-                    omnet_chg_rte(tuple->iface_addr(),
-                                   entry1->next_addr(),
-                                   netmask,
-                                   entry1->dist(), false, entry1->local_iface_index());
                 added = true;
             }
         }
@@ -1476,9 +1407,61 @@ OLSR::rtable_computation()
         if (!added)
             break;
     }
+
+    install_rtable_changes(old_rt);
     setTopologyChanged(false);
 }
 
+///
+/// \brief Updates the IP routing table to the routes of rtable_.
+///
+/// Only the routes that were added, removed or changed since the previous
+/// routing table are touched. The entries of the previous table are deleted.
+///
+/// \param old_rt the previous routing table.
+///
+void
+OLSR::install_rtable_changes(rtable_t &old_rt)
+{
+    nsaddr_t netmask(IPv4Address::ALLONES_ADDRESS);
+
+    if (old_rt.empty() && !par("DelOnlyRtEntriesInrtable_").boolValue())
+        omnet_clean_rte(); // clean IP tables
+
+    for (rtable_t::iterator it = old_rt.begin(); it != old_rt.end(); it++)
+    {
+        if (rtable_.lookup(it->first) == NULL)
+            omnet_chg_rte(it->first, it->first, netmask, 1, true, it->first);
+    }
+
+    for (rtable_t::iterator it = rtable_.rt_.begin(); it != rtable_.rt_.end(); it++)
+    {
+        OLSR_rt_entry* entry = it->second;
+        rtable_t::iterator old = old_rt.find(it->first);
+        if (old != old_rt.end()
+                && old->second->next_addr() == entry->next_addr()
+                && old->second->iface_addr() == entry->iface_addr()
+                && old->second->local_iface_index() == entry->local_iface_index()
+                && old->second->dist() == entry->dist())
+            continue;
+
+        if (!useIndex)
+            omnet_chg_rte(entry->dest_addr(),
+                           entry->next_addr(),
+                           netmask,
+                           entry->dist(), false, entry->iface_addr());
+        else
+            omnet_chg_rte(entry->dest_addr(),
+                           entry->next_addr(),
+                           netmask,
+                           entry->dist(), false, entry->local_iface_index());
+    }
+
+    for (rtable_t::iterator it = old_rt.begin(); it != old_rt.end(); it++)
+        delete it->second;
+    old_rt.clear();
+}
+
 ///
 /// \brief Processes a HELLO message following RFC 3626 specification.
 ///
@@ -2677,17 +2660,13 @@ int
 OLSR::degree(OLSR_nb_tuple* tuple)
 {
     int degree = 0;
-    for (nb2hopset_t::iterator it = nb2hopset().begin(); it != nb2hopset().end(); it++)
+    std::pair<nb2hopindex_t::iterator, nb2hopindex_t::iterator> range = state_.nb2hopindex_.equal_range(tuple->nb_main_addr());
+    for (nb2hopindex_t::iterator it = range.first; it != range.second; it++)
     {
-        OLSR_nb2hop_tuple* nb2hop_tuple = *it;
-        if (nb2hop_tuple->nb_main_addr() == tuple->nb_main_addr())
-        {
-            //OLSR_nb_tuple* nb_tuple =
-            //    state_.find_nb_tuple(nb2hop_tuple->nb_main_addr());
-            OLSR_nb_tuple* nb_tuple = state_.find_nb_tuple(nb2hop_tuple->nb2hop_addr());
-            if (nb_tuple == NULL)
-                degree++;
-        }
+        OLSR_nb2hop_tuple* nb2hop_tuple = it->second;
+        OLSR_nb_tuple* nb_tuple = state_.find_nb_tuple(nb2hop_tuple->nb2hop_addr());
+        if (nb_tuple == NULL)
+            degree++;
     }
     return degree;
 }
@@ -2840,8 +2819,7 @@ OLSR::~OLSR()
 
     while (timerQueuePtr && timerQueuePtr->size()>0)
     {
-        OLSR_Timer * timer = timerQueuePtr->begin()->second;
-        timerQueuePtr->erase(timerQueuePtr->begin());
+        OLSR_Timer * timer = dequeueTimer();
         timer->setTuple(NULL);
         if (helloTimer==timer)
             helloTimer = NULL;
@@ -2970,6 +2948,15 @@ bool OLSR::getDestAddress(cPacket *msg, ManetAddress &dest)
     return false;
 }
 
+OLSR_Timer *OLSR::dequeueTimer()
+{
+    OLSR_Timer *timer = timerQueuePtr->begin()->second;
+    timerQueuePtr->erase(timerQueuePtr->begin());
+    if (timer)
+        timer->queued_ = false;
+    return timer;
+}
+
 void OLSR::scheduleNextEvent()
 {
     TimerQueue::iterator e = timerQueuePtr->begin();
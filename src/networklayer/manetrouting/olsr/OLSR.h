@@ -156,6 +156,10 @@
 //#define JITTER            (Random::uniform()*OLSR_MAXJITTER)
 
 class OLSR;         // forward declaration
+class OLSR_Timer;
+
+typedef std::set<OLSR_Timer *> TimerPendingList;
+typedef std::multimap <simtime_t, OLSR_Timer *> TimerQueue;
 
 /********** Timers **********/
 
@@ -163,9 +167,12 @@ class OLSR;         // forward declaration
 
 class OLSR_Timer :  public cOwnedObject /*cMessage*/
 {
+    friend class OLSR;
   protected:
     OLSR*       agent_; ///< OLSR agent which created the timer.
     cObject* tuple_;
+    TimerQueue::iterator queuePos_; ///< Position in the timer queue of the agent, valid if queued_ is set.
+    bool        queued_;
   public:
 
     virtual void removeTimer();
@@ -173,6 +180,7 @@ class OLSR_Timer :  public cOwnedObject /*cMessage*/
     OLSR_Timer();
     ~OLSR_Timer();
     virtual void expire() = 0;
+    virtual void insertQueueTimer(simtime_t time);
     virtual void removeQueueTimer();
     virtual void resched(double time);
     virtual void setTuple(cObject *tuple) {tuple_ = tuple;}
@@ -336,10 +344,6 @@ class OLSR_IfaceAssocTupleTimer : public OLSR_Timer
 /// internal state.
 ///
 
-typedef std::set<OLSR_Timer *> TimerPendingList;
-typedef std::multimap <simtime_t, OLSR_Timer *> TimerQueue;
-
-
 class OLSR : public ManetRoutingBase
 {
   protected:
@@ -382,6 +386,8 @@ class OLSR : public ManetRoutingBase
     virtual void setTopologyChanged(bool p) {topologyChange = p;}
     virtual bool getTopologyChanged() {return topologyChange;}
     TimerQueue *timerQueuePtr;
+    /// Removes the first timer from the timer queue and returns it.
+    OLSR_Timer *dequeueTimer();
 
     cMessage *timerMessage;
 
@@ -471,6 +477,7 @@ class OLSR : public ManetRoutingBase
 
     virtual void        mpr_computation();
     virtual void        rtable_computation();
+    virtual void        install_rtable_changes(rtable_t&);
 
     virtual bool        process_hello(OLSR_msg&, const nsaddr_t &, const nsaddr_t &, const int &);
     virtual bool        process_tc(OLSR_msg&, const nsaddr_t &, const int &);
@@ -271,33 +271,31 @@ OLSROPT::update_topology_tuples(OLSR_msg msg, int index)
      * This shoud achieve the same but with less erase&add.
      *
      */
-    for (std::vector<OLSR_topology_tuple*>::iterator it = topologyset().begin(); it != topologyset().end();)
+    // the tuples passing through this node are found in the index of the Topology Set
+    std::vector<OLSR_topology_tuple*> toErase;
+    std::pair<topologyindex_t::iterator, topologyindex_t::iterator> range = state_.topologyindex_.equal_range(msg.orig_addr());
+    for (topologyindex_t::iterator it = range.first; it != range.second; it++)
     {
+        OLSR_topology_tuple *tuple = it->second.second;
         bool foundTuple = 0;
-        if ((*it)->last_addr_ == msg.orig_addr()){ // for any tuple in the list that is
-            // passing for this node
-            for (int i = 0; i < tc.count; i++)
-            {
-                assert(i >= 0 && i < OLSR_MAX_ADDRS);
-                nsaddr_t addr = tc.nb_main_addr(i);
-                if((*it)->dest_addr() == addr){ // found a tuple to be updated
-                    (*it)->time() = now + OLSROPT::emf_to_seconds(msg.vtime());
-                    (*it)->seq() = tc.ansn();
-                    foundTuple = 1;
-                    tccounter.insert(i);
-                }
-            }
-            if (!foundTuple){ // the tuple was not in present in the TC, erase it
-                changedTuples++;
-                it = topologyset().erase(it); // erase and increment iterator
-                continue;
-            }else{
-                it++;
-                continue;
+        for (int i = 0; i < tc.count; i++)
+        {
+            assert(i >= 0 && i < OLSR_MAX_ADDRS);
+            nsaddr_t addr = tc.nb_main_addr(i);
+            if(tuple->dest_addr() == addr){ // found a tuple to be updated
+                tuple->time() = now + OLSROPT::emf_to_seconds(msg.vtime());
+                tuple->seq() = tc.ansn();
+                foundTuple = 1;
+                tccounter.insert(i);
             }
         }
-        it++; // did not enter the main if, increment iterator
+        if (!foundTuple){ // the tuple was not in present in the TC, erase it
+            changedTuples++;
+            toErase.push_back(tuple);
+        }
     }
+    for (std::vector<OLSR_topology_tuple*>::iterator it = toErase.begin(); it != toErase.end(); it++)
+        state_.erase_topology_tuple(*it);
     for (int i = 0; i < tc.count; i++)
     {
         if(tccounter.find(i) == tccounter.end()){ // we did not update this, let's add it
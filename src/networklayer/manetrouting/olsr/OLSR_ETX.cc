@@ -77,7 +77,7 @@ void OLSR_ETX_LinkQualityTimer::expire()
     OLSR_ETX *agentaux = check_and_cast<OLSR_ETX *>(agent_);
     agentaux->OLSR_ETX::link_quality();
     // agentaux->scheduleAt(simTime()+agentaux->hello_ival_,this);
-    agentaux->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+agentaux->hello_ival_, this));
+    insertQueueTimer(simTime()+agentaux->hello_ival_);
 }
 
 
@@ -2674,8 +2674,7 @@ OLSR_ETX::~OLSR_ETX()
 
     while (timerQueuePtr && timerQueuePtr->size()>0)
     {
-        OLSR_Timer * timer = timerQueuePtr->begin()->second;
-        timerQueuePtr->erase(timerQueuePtr->begin());
+        OLSR_Timer * timer = dequeueTimer();
         timer->setTuple(NULL);
         if (helloTimer==timer)
             helloTimer = NULL;
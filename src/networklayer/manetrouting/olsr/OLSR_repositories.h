@@ -31,6 +31,7 @@
 #define __OLSR_repositories_h__
 
 #include <string.h>
+#include <map>
 #include <set>
 #include <vector>
 
@@ -332,4 +333,16 @@ typedef std::vector<OLSR_topology_tuple*>   topologyset_t;  ///< Topology Set ty
 typedef std::vector<OLSR_dup_tuple*>        dupset_t;   ///< Duplicate Set type.
 typedef std::vector<OLSR_iface_assoc_tuple*>    ifaceassocset_t; ///< Interface Association Set type.
 
+// Indexes of the sets above by the keys they are searched with. Tuples with
+// equal keys are kept in the order of the set, so a lookup returns the same
+// tuple as a linear scan of the set.
+typedef std::multimap<nsaddr_t, OLSR_mprsel_tuple*>  mprselindex_t;  ///< MPR Selector Set by main address.
+typedef std::multimap<nsaddr_t, OLSR_link_tuple*>    linkindex_t;    ///< Link Set by neighbor interface address.
+typedef std::multimap<nsaddr_t, OLSR_nb_tuple*>      nbindex_t;      ///< Neighbor Set by neighbor main address.
+typedef std::multimap<nsaddr_t, OLSR_nb2hop_tuple*>  nb2hopindex_t;  ///< 2-hop Neighbor Set by neighbor main address.
+typedef std::pair<unsigned long, OLSR_topology_tuple*> topologyindexentry_t;  ///< Insertion number (order in the set) and tuple.
+typedef std::multimap<nsaddr_t, topologyindexentry_t> topologyindex_t;  ///< Topology Set by last address.
+typedef std::multimap<std::pair<nsaddr_t, uint16_t>, OLSR_dup_tuple*> dupindex_t;  ///< Duplicate Set by address and sequence number.
+typedef std::multimap<nsaddr_t, OLSR_iface_assoc_tuple*> ifaceassocindex_t; ///< Interface Association Set by interface address.
+
 #endif
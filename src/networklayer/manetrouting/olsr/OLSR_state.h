@@ -45,6 +45,16 @@ class OLSR_state : public cObject
     dupset_t    dupset_;    ///< Duplicate Set (RFC 3626, section 3.4).
     ifaceassocset_t ifaceassocset_; ///< Interface Association Set (RFC 3626, section 4.1).
 
+    // indexes of the sets above, maintained by the insert and erase functions
+    mprselindex_t   mprselindex_;
+    linkindex_t     linkindex_;
+    nbindex_t       nbindex_;
+    nb2hopindex_t   nb2hopindex_;
+    topologyindex_t topologyindex_;
+    unsigned long   topologycount_;   ///< Number of tuples ever inserted into the Topology Set.
+    dupindex_t      dupindex_;
+    ifaceassocindex_t ifaceassocindex_;
+
     inline  linkset_t&      linkset()   { return linkset_; }
     inline  mprset_t&       mprset()    { return mprset_; }
     inline  mprselset_t&        mprselset() { return mprselset_; }
@@ -98,7 +108,7 @@ class OLSR_state : public cObject
     void            insert_ifaceassoc_tuple(OLSR_iface_assoc_tuple*);
     void            clear_all();
 
-    OLSR_state() {}
+    OLSR_state() : topologycount_(0) {}
     ~OLSR_state();
     OLSR_state(OLSR_state *);
     virtual OLSR_state * dup() {return new OLSR_state(this);}
@@ -17,6 +17,7 @@
 #include "LIBTable.h"
 #include "XMLUtils.h"
 #include "RoutingTableAccess.h"
+#include "InterfaceTableAccess.h"
 
 Define_Module(LIBTable);
 
@@ -28,6 +29,7 @@ void LIBTable::initialize(int stage)
     if (stage == 0)
     {
         maxLabel = 0;
+        ift = InterfaceTableAccess().get();
         WATCH_VECTOR(lib);
     }
     else if (stage == 4)
@@ -46,26 +48,75 @@ void LIBTable::handleMessage(cMessage *)
     ASSERT(false);
 }
 
-bool LIBTable::resolveLabel(std::string inInterface, int inLabel,
-        LabelOpVector& outLabel, std::string& outInterface, int& color)
+int LIBTable::getInterfaceId(const std::string& interfaceName)
+{
+    InterfaceEntry *ie = interfaceName.empty() ? NULL : ift->getInterfaceByName(interfaceName.c_str());
+    return ie ? ie->getInterfaceId() : -1;
+}
+
+void LIBTable::addToIndex(unsigned int position)
 {
-    bool any = (inInterface.length() == 0);
+    const LIBEntry& entry = lib[position];
+    // keep the first entry, as a linear search would
+    labelIndex.insert(std::make_pair(entry.inLabel, position));
+    if (entry.inInterfaceId != -1)
+        interfaceLabelIndex.insert(std::make_pair(std::make_pair(entry.inInterfaceId, entry.inLabel), position));
+}
 
+void LIBTable::rebuildIndex()
+{
+    labelIndex.clear();
+    interfaceLabelIndex.clear();
     for (unsigned int i = 0; i < lib.size(); i++)
+        addToIndex(i);
+}
+
+const LIBTable::LIBEntry *LIBTable::findEntry(int inInterfaceId, int inLabel) const
+{
+    if (inInterfaceId == -1)
     {
-        if (!any && lib[i].inInterface != inInterface)
-            continue;
+        LabelIndex::const_iterator it = labelIndex.find(inLabel);
+        return it != labelIndex.end() ? &lib[it->second] : NULL;
+    }
+    else
+    {
+        InterfaceLabelIndex::const_iterator it = interfaceLabelIndex.find(std::make_pair(inInterfaceId, inLabel));
+        return it != interfaceLabelIndex.end() ? &lib[it->second] : NULL;
+    }
+}
 
-        if (lib[i].inLabel != inLabel)
-            continue;
+bool LIBTable::resolveLabel(std::string inInterface, int inLabel,
+        LabelOpVector& outLabel, std::string& outInterface, int& color)
+{
+    int inInterfaceId = -1;
+    if (inInterface.length() != 0)
+    {
+        inInterfaceId = getInterfaceId(inInterface);
+        if (inInterfaceId == -1)
+            return false;
+    }
 
-        outLabel = lib[i].outLabel;
-        outInterface = lib[i].outInterface;
-        color = lib[i].color;
+    const LIBEntry *entry = findEntry(inInterfaceId, inLabel);
+    if (!entry)
+        return false;
 
-        return true;
-    }
-    return false;
+    outLabel = entry->outLabel;
+    outInterface = entry->outInterface;
+    color = entry->color;
+    return true;
+}
+
+bool LIBTable::resolveLabel(int inInterfaceId, int inLabel,
+        LabelOpVector& outLabel, int& outInterfaceId, int& color)
+{
+    const LIBEntry *entry = findEntry(inInterfaceId, inLabel);
+    if (!entry)
+        return false;
+
+    outLabel = entry->outLabel;
+    outInterfaceId = entry->outInterfaceId;
+    color = entry->color;
+    return true;
 }
 
 int LIBTable::installLibEntry(int inLabel, std::string inInterface, const LabelOpVector& outLabel,
@@ -75,42 +126,50 @@ int LIBTable::installLibEntry(int inLabel, std::string inInterface, const LabelO
     {
         LIBEntry newItem;
         newItem.inLabel = ++maxLabel;
+        newItem.inInterfaceId = getInterfaceId(inInterface);
         newItem.inInterface = inInterface;
         newItem.outLabel = outLabel;
+        newItem.outInterfaceId = getInterfaceId(outInterface);
         newItem.outInterface = outInterface;
         newItem.color = color;
         lib.push_back(newItem);
+        addToIndex(lib.size() - 1);
         return newItem.inLabel;
     }
     else
     {
-        for (unsigned int i = 0; i < lib.size(); i++)
+        LabelIndex::iterator it = labelIndex.find(inLabel);
+        if (it == labelIndex.end())
         {
-            if (lib[i].inLabel != inLabel)
-                continue;
-
-            lib[i].inInterface = inInterface;
-            lib[i].outLabel = outLabel;
-            lib[i].outInterface = outInterface;
-            lib[i].color = color;
-            return inLabel;
+            ASSERT(false);
+            return 0; // prevent warning
         }
-        ASSERT(false);
-        return 0; // prevent warning
+        LIBEntry& entry = lib[it->second];
+        int inInterfaceId = getInterfaceId(inInterface);
+        bool interfaceChanged = (entry.inInterfaceId != inInterfaceId);
+
+        entry.inInterfaceId = inInterfaceId;
+        entry.inInterface = inInterface;
+        entry.outLabel = outLabel;
+        entry.outInterfaceId = getInterfaceId(outInterface);
+        entry.outInterface = outInterface;
+        entry.color = color;
+        if (interfaceChanged)
+            rebuildIndex();
+        return inLabel;
     }
 }
 
 void LIBTable::removeLibEntry(int inLabel)
 {
-    for (unsigned int i = 0; i < lib.size(); i++)
+    LabelIndex::iterator it = labelIndex.find(inLabel);
+    if (it == labelIndex.end())
     {
-        if (lib[i].inLabel != inLabel)
-            continue;
-
-        lib.erase(lib.begin() + i);
+        ASSERT(false);
         return;
     }
-    ASSERT(false);
+    lib.erase(lib.begin() + it->second);
+    rebuildIndex();
 }
 
 void LIBTable::readTableFromXML(const cXMLElement* libtable)
@@ -128,7 +187,9 @@ void LIBTable::readTableFromXML(const cXMLElement* libtable)
         LIBEntry newItem;
         newItem.inLabel = getParameterIntValue(&entry, "inLabel");
         newItem.inInterface = getParameterStrValue(&entry, "inInterface");
+        newItem.inInterfaceId = getInterfaceId(newItem.inInterface);
         newItem.outInterface = getParameterStrValue(&entry, "outInterface");
+        newItem.outInterfaceId = getInterfaceId(newItem.outInterface);
         newItem.color = getParameterIntValue(&entry, "color", 0);
 
         cXMLElementList ops = getUniqueChild(&entry, "outLabel")->getChildrenByTagName("op");
@@ -166,6 +227,7 @@ void LIBTable::readTableFromXML(const cXMLElement* libtable)
         }
 
         lib.push_back(newItem);
+        addToIndex(lib.size() - 1);
 
         ASSERT(newItem.inLabel > 0);
 
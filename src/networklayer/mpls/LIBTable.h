@@ -16,6 +16,7 @@
 #ifndef __INET_LIBTABLE_H
 #define __INET_LIBTABLE_H
 
+#include <map>
 #include <vector>
 #include <string>
 
@@ -25,6 +26,8 @@
 #include "IPv4Address.h"
 #include "IPv4Datagram.h"
 
+class IInterfaceTable;
+
 // label operations
 #define PUSH_OPER              0
 #define SWAP_OPER              1
@@ -50,9 +53,11 @@ class INET_API LIBTable: public cSimpleModule
         struct LIBEntry
         {
             int inLabel;
+            int inInterfaceId;          // -1 if no interface with the name inInterface
             std::string inInterface;
 
             LabelOpVector outLabel;
+            int outInterfaceId;         // -1 if no interface with the name outInterface
             std::string outInterface;
 
             // FIXME colors in nam, temporary solution
@@ -60,9 +65,17 @@ class INET_API LIBTable: public cSimpleModule
         };
 
     protected:
+        // lib positions of the entries by (incoming interface id, incoming label), and of
+        // the first entry of each incoming label (for lookups on any interface)
+        typedef std::map<std::pair<int, int>, unsigned int> InterfaceLabelIndex;
+        typedef std::map<int, unsigned int> LabelIndex;
+
         IPv4Address routerId;
         int maxLabel;
         std::vector<LIBEntry> lib;
+        InterfaceLabelIndex interfaceLabelIndex;
+        LabelIndex labelIndex;
+        IInterfaceTable *ift;
 
     protected:
         virtual void initialize(int stage);
@@ -72,11 +85,24 @@ class INET_API LIBTable: public cSimpleModule
         // static configuration
         virtual void readTableFromXML(const cXMLElement* libtable);
 
+        // index maintenance
+        virtual int getInterfaceId(const std::string& interfaceName);
+        virtual void addToIndex(unsigned int position);
+        virtual void rebuildIndex();
+        virtual const LIBEntry *findEntry(int inInterfaceId, int inLabel) const;
+
     public:
         // label management
         virtual bool resolveLabel(std::string inInterface, int inLabel,
                           LabelOpVector& outLabel, std::string& outInterface, int& color);
 
+        /**
+         * Same as above with interface ids, this is what MPLS uses for each
+         * labelled packet. inInterfaceId -1 means any interface.
+         */
+        virtual bool resolveLabel(int inInterfaceId, int inLabel,
+                          LabelOpVector& outLabel, int& outInterfaceId, int& color);
+
         virtual int installLibEntry(int inLabel, std::string inInterface, const LabelOpVector& outLabel,
                             std::string outInterface, int color);
 
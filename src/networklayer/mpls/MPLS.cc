@@ -214,11 +214,10 @@ void MPLS::processMPLSPacketFromL2(MPLSPacket *mplsPacket)
 {
     int gateIndex = mplsPacket->getArrivalGate()->getIndex();
     InterfaceEntry *ie = ift->getInterfaceByNetworkLayerGateIndex(gateIndex);
-    std::string senderInterface = ie->getName();
     ASSERT(mplsPacket->hasLabel());
     int oldLabel = mplsPacket->getTopLabel();
 
-    EV << "Received " << mplsPacket << " from L2, label=" << oldLabel << " inInterface=" << senderInterface << endl;
+    EV << "Received " << mplsPacket << " from L2, label=" << oldLabel << " inInterface=" << ie->getName() << endl;
 
     if (oldLabel==-1)
     {
@@ -233,10 +232,10 @@ void MPLS::processMPLSPacketFromL2(MPLSPacket *mplsPacket)
     }
 
     LabelOpVector outLabel;
-    std::string outInterface;
+    int outInterfaceId;
     int color;
 
-    bool found = lt->resolveLabel(senderInterface, oldLabel, outLabel, outInterface, color);
+    bool found = lt->resolveLabel(ie->getInterfaceId(), oldLabel, outLabel, outInterfaceId, color);
     if (!found)
     {
         EV << "discarding packet, incoming label not resolved" << endl;
@@ -245,7 +244,10 @@ void MPLS::processMPLSPacketFromL2(MPLSPacket *mplsPacket)
         return;
     }
 
-    int outgoingPort = ift->getInterfaceByName(outInterface.c_str())->getNetworkLayerGateIndex();
+    InterfaceEntry *outInterface = ift->getInterfaceById(outInterfaceId);
+    if (!outInterface)
+        error("Outgoing interface of label %d not found", oldLabel);
+    int outgoingPort = outInterface->getNetworkLayerGateIndex();
 
     doStackOps(mplsPacket, outLabel);
 
@@ -253,7 +255,7 @@ void MPLS::processMPLSPacketFromL2(MPLSPacket *mplsPacket)
     {
         // forward labeled packet
 
-        EV << "forwarding packet to " << outInterface << endl;
+        EV << "forwarding packet to " << outInterface->getName() << endl;
 
         if (mplsPacket->hasPar("color"))
         {
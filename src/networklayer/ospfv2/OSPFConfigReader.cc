@@ -164,6 +164,14 @@ bool OSPFConfigReader::getBoolAttrOrPar(const cXMLElement& ifConfig, const char
     return par(name).boolValue();
 }
 
+double OSPFConfigReader::getDoubleAttrOrPar(const cXMLElement& ifConfig, const char *name) const
+{
+    const char* attrStr = ifConfig.getAttribute(name);
+    if (attrStr && *attrStr)
+        return atof(attrStr);
+    return par(name).doubleValue();
+}
+
 const char *OSPFConfigReader::getStrAttrOrPar(const cXMLElement& ifConfig, const char *name) const
 {
     const char* attrStr = ifConfig.getAttribute(name);
@@ -447,6 +455,10 @@ bool OSPFConfigReader::loadConfigFromXML(cXMLElement *asConfig, OSPF::Router *os
     bool rfc1583Compatible = getBoolAttrOrPar(*routerNode, "RFC1583Compatible");
     ospfRouter->setRFC1583Compatibility(rfc1583Compatible);
 
+    ospfRouter->setSPFThrottling(getDoubleAttrOrPar(*routerNode, "spfDelay"),
+            getDoubleAttrOrPar(*routerNode, "spfHoldTime"),
+            getDoubleAttrOrPar(*routerNode, "spfMaxHoldTime"));
+
     std::set<OSPF::AreaID> areaList;
     getAreaListFromXML(*routerNode, areaList);
 
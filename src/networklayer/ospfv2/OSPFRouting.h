@@ -56,6 +56,12 @@ class OSPFRouting :  public cSimpleModule, public ILifecycle
      */
     bool checkExternalRoute(const IPv4Address& route);
 
+    /**
+     * Returns the root object of the OSPF data structure, or NULL if the
+     * router is down.
+     */
+    OSPF::Router *getOspfRouter() const { return ospfRouter; }
+
   protected:
     virtual int numInitStages() const { return 5; }
     virtual void initialize(int stage);
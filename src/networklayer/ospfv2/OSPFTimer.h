@@ -32,6 +32,7 @@ enum OSPFTimerType
     NEIGHBOR_UPDATE_RETRANSMISSION_TIMER = 7,
     NEIGHBOR_REQUEST_RETRANSMISSION_TIMER = 8,
     DATABASE_AGE_TIMER = 9,
+    SPF_TIMER = 10,
 };
 
 #endif
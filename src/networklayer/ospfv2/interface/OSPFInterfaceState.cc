@@ -110,7 +110,7 @@ void OSPF::InterfaceState::changeState(OSPF::Interface* intf, OSPF::InterfaceSta
     }
 
     if (shouldRebuildRoutingTable) {
-        intf->getArea()->getRouter()->rebuildRoutingTable();
+        intf->getArea()->getRouter()->scheduleRoutingTableRebuild();
     }
 }
 
@@ -165,6 +165,12 @@ void OSPF::MessageHandler::handleTimer(cMessage* timer)
                 router->ageDatabase();
             }
             break;
+        case SPF_TIMER:
+            {
+                printEvent("SPF Timer expired");
+                router->rebuildRoutingTable();
+            }
+            break;
         default: break;
     }
 }
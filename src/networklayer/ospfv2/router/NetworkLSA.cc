@@ -19,15 +19,12 @@
 
 bool OSPF::NetworkLSA::update(const OSPFNetworkLSA* lsa)
 {
+    // the routing info (next hops) is kept: the area recalculates it
+    // only if the change affects the shortest path tree
     bool different = differsFrom(lsa);
     (*this) = (*lsa);
     resetInstallTime();
-    if (different) {
-        clearNextHops();
-        return true;
-    } else {
-        return false;
-    }
+    return different;
 }
 
 bool OSPF::NetworkLSA::differsFrom(const OSPFNetworkLSA* networkLSA) const
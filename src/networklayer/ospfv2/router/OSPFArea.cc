@@ -18,6 +18,7 @@
 #include "OSPFArea.h"
 #include "OSPFRouter.h"
 #include <memory.h>
+#include <set>
 
 OSPF::Area::Area(OSPF::AreaID id) :
     areaID(id),
@@ -25,6 +26,7 @@ OSPF::Area::Area(OSPF::AreaID id) :
     externalRoutingCapability(true),
     stubDefaultCost(1),
     spfTreeRoot(NULL),
+    spfTreeValid(false),
     parentRouter(NULL)
 {
 }
@@ -266,6 +268,7 @@ bool OSPF::Area::installRouterLSA(OSPFRouterLSA* lsa)
         removeFromAllRetransmissionLists(lsaKey);
         return lsaIt->second->update(lsa);
     } else {
+        spfTreeValid = false;    // the new LSA may reuse the address of a deleted one
         OSPF::RouterLSA* lsaCopy = new OSPF::RouterLSA(*lsa);
         routerLSAsByID[linkStateID] = lsaCopy;
         routerLSAs.push_back(lsaCopy);
@@ -286,6 +289,7 @@ bool OSPF::Area::installNetworkLSA(OSPFNetworkLSA* lsa)
         removeFromAllRetransmissionLists(lsaKey);
         return lsaIt->second->update(lsa);
     } else {
+        spfTreeValid = false;    // the new LSA may reuse the address of a deleted one
         OSPF::NetworkLSA* lsaCopy = new OSPF::NetworkLSA(*lsa);
         networkLSAsByID[linkStateID] = lsaCopy;
         networkLSAs.push_back(lsaCopy);
@@ -659,7 +663,7 @@ void OSPF::Area::ageDatabase()
     }
 
     if (shouldRebuildRoutingTable) {
-        parentRouter->rebuildRoutingTable();
+        parentRouter->scheduleRoutingTableRebuild();
     }
 }
 
@@ -1349,12 +1353,6 @@ OSPF::SummaryLSA* OSPF::Area::originateSummaryLSA(const OSPF::SummaryLSA* summar
 void OSPF::Area::calculateShortestPathTree(std::vector<OSPF::RoutingTableEntry*>& newRoutingTable)
 {
     OSPF::RouterID routerID = parentRouter->getRouterID();
-    bool finished = false;
-    std::vector<OSPFLSA*> treeVertices;
-    OSPFLSA* justAddedVertex;
-    std::vector<OSPFLSA*> candidateVertices;
-    unsigned long            i, j, k;
-    unsigned long lsaCount;
 
     if (spfTreeRoot == NULL) {
         OSPF::RouterLSA* newLSA = originateRouterLSA();
@@ -1371,6 +1369,111 @@ void OSPF::Area::calculateShortestPathTree(std::vector<OSPF::RoutingTableEntry*>
         return;
     }
 
+    // The tree is only recalculated if its input changed since the last calculation;
+    // otherwise (e.g. only stub links, summary or AS external LSAs changed) the routes
+    // are collected from the previous tree.
+    SPFInput input;
+    getSPFInput(input);
+    if (!spfTreeValid || !(input == spfTreeInput)) {
+        calculateShortestPathTreeVertices();
+        spfTreeInput = input;
+        spfTreeValid = true;
+    } else {
+        EV << "Shortest path tree of area " << areaID.str(false) << " is unchanged.\n";
+    }
+
+    // work on a copy: adding the routes may bring up virtual links, which may trigger a recalculation
+    std::vector<OSPFLSA*> treeVertices = spfTreeVertices;
+    addShortestPathTreeRoutes(treeVertices, newRoutingTable);
+    addStubRoutes(treeVertices, newRoutingTable);
+}
+
+void OSPF::Area::getSPFInput(SPFInput& input) const
+{
+    unsigned long i, j;
+
+    input.objects.push_back(spfTreeRoot);
+    input.data.push_back(parentRouter->getRouterID().getInt());
+
+    // stub links only matter if they lead to a network vertex (see hasLink())
+    std::set<uint32> networkAddresses;
+    unsigned long lsaCount = networkLSAs.size();
+    for (i = 0; i < lsaCount; i++) {
+        const OSPF::NetworkLSA* networkLSA = networkLSAs[i];
+        networkAddresses.insert((networkLSA->getHeader().getLinkStateID() & networkLSA->getNetworkMask()).getInt());
+    }
+
+    lsaCount = routerLSAs.size();
+    for (i = 0; i < lsaCount; i++) {
+        const OSPF::RouterLSA* routerLSA = routerLSAs[i];
+        const OSPFLSAHeader& header = routerLSA->getHeader();
+        input.objects.push_back(routerLSA);
+        input.data.push_back(header.getLinkStateID().getInt());
+        input.data.push_back(header.getAdvertisingRouter().getInt());
+        input.data.push_back(header.getLsAge() == MAX_AGE);
+        input.data.push_back(routerLSA->getV_VirtualLinkEndpoint());
+        unsigned int linkCount = routerLSA->getLinksArraySize();
+        for (j = 0; j < linkCount; j++) {
+            const Link& link = routerLSA->getLinks(j);
+            if ((link.getType() == STUB_LINK) &&
+                (networkAddresses.find((link.getLinkID() & IPv4Address(link.getLinkData())).getInt()) == networkAddresses.end()))
+            {
+                continue;
+            }
+            input.data.push_back(j);
+            input.data.push_back(link.getType());
+            input.data.push_back(link.getLinkID().getInt());
+            input.data.push_back(link.getLinkData());
+            input.data.push_back(link.getLinkCost());
+        }
+    }
+
+    lsaCount = networkLSAs.size();
+    for (i = 0; i < lsaCount; i++) {
+        const OSPF::NetworkLSA* networkLSA = networkLSAs[i];
+        const OSPFLSAHeader& header = networkLSA->getHeader();
+        input.objects.push_back(networkLSA);
+        input.data.push_back(header.getLinkStateID().getInt());
+        input.data.push_back(header.getAdvertisingRouter().getInt());
+        input.data.push_back(header.getLsAge() == MAX_AGE);
+        input.data.push_back(networkLSA->getNetworkMask().getInt());
+        unsigned int routerCount = networkLSA->getAttachedRoutersArraySize();
+        input.data.push_back(routerCount);
+        for (j = 0; j < routerCount; j++) {
+            input.data.push_back(networkLSA->getAttachedRouters(j).getInt());
+        }
+    }
+
+    // the next hops of the vertices next to the root are taken from the interfaces
+    unsigned long interfaceNum = associatedInterfaces.size();
+    for (i = 0; i < interfaceNum; i++) {
+        const OSPF::Interface* intf = associatedInterfaces[i];
+        input.data.push_back(intf->getType());
+        input.data.push_back(intf->getState());
+        input.data.push_back(intf->getIfIndex());
+        input.data.push_back(intf->getAddressRange().address.getInt());
+        input.data.push_back(intf->getAddressRange().mask.getInt());
+        input.data.push_back(intf->getDesignatedRouter().ipInterfaceAddress.getInt());
+        unsigned long neighborCount = intf->getNeighborCount();
+        input.data.push_back(neighborCount);
+        for (j = 0; j < neighborCount; j++) {
+            const OSPF::Neighbor* neighbor = intf->getNeighbor(j);
+            input.data.push_back(neighbor->getNeighborID().getInt());
+            input.data.push_back(neighbor->getAddress().getInt());
+        }
+    }
+}
+
+void OSPF::Area::calculateShortestPathTreeVertices()
+{
+    bool finished = false;
+    std::vector<OSPFLSA*>& treeVertices = spfTreeVertices;
+    OSPFLSA* justAddedVertex;
+    std::vector<OSPFLSA*> candidateVertices;
+    unsigned long            i, j, k;
+    unsigned long lsaCount;
+
+    treeVertices.clear();
     lsaCount = routerLSAs.size();
     for (i = 0; i < lsaCount; i++) {
         routerLSAs[i]->clearNextHops();
@@ -1591,58 +1694,86 @@ void OSPF::Area::calculateShortestPathTree(std::vector<OSPF::RoutingTableEntry*>
                 }
             }
 
-            if (closestVertex->getHeader().getLsType() == ROUTERLSA_TYPE) {
-                OSPF::RouterLSA* routerLSA = check_and_cast<OSPF::RouterLSA*> (closestVertex);
-                if (routerLSA->getB_AreaBorderRouter() || routerLSA->getE_ASBoundaryRouter()) {
-                    OSPF::RoutingTableEntry* entry = new OSPF::RoutingTableEntry;
-                    OSPF::RouterID destinationID = routerLSA->getHeader().getLinkStateID();
-                    unsigned int nextHopCount = routerLSA->getNextHopCount();
-                    OSPF::RoutingTableEntry::RoutingDestinationType destinationType = OSPF::RoutingTableEntry::NETWORK_DESTINATION;
-
-                    entry->setDestination(destinationID);
-                    entry->setLinkStateOrigin(routerLSA);
-                    entry->setArea(areaID);
-                    entry->setPathType(OSPF::RoutingTableEntry::INTRAAREA);
-                    entry->setCost(routerLSA->getDistance());
-                    if (routerLSA->getB_AreaBorderRouter()) {
-                        destinationType |= OSPF::RoutingTableEntry::AREA_BORDER_ROUTER_DESTINATION;
-                    }
-                    if (routerLSA->getE_ASBoundaryRouter()) {
-                        destinationType |= OSPF::RoutingTableEntry::AS_BOUNDARY_ROUTER_DESTINATION;
-                    }
-                    entry->setDestinationType(destinationType);
-                    entry->setOptionalCapabilities(routerLSA->getHeader().getLsOptions());
-                    for (i = 0; i < nextHopCount; i++) {
-                        entry->addNextHop(routerLSA->getNextHop(i));
-                    }
+            justAddedVertex = closestVertex;
+        }
+    } while (!finished);
+}
 
-                    newRoutingTable.push_back(entry);
+void OSPF::Area::addShortestPathTreeRoutes(const std::vector<OSPFLSA*>& treeVertices, std::vector<OSPF::RoutingTableEntry*>& newRoutingTable)
+{
+    unsigned long i;
 
-                    OSPF::Area* backbone;
-                    if (areaID != OSPF::BACKBONE_AREAID) {
-                        backbone = parentRouter->getAreaByID(OSPF::BACKBONE_AREAID);
-                    } else {
-                        backbone = this;
-                    }
-                    if (backbone != NULL) {
-                        OSPF::Interface* virtualIntf = backbone->findVirtualLink(destinationID);
-                        if ((virtualIntf != NULL) && (virtualIntf->getTransitAreaID() == areaID)) {
-                            OSPF::IPv4AddressRange range;
-                            range.address = getInterface(routerLSA->getNextHop(0).ifIndex)->getAddressRange().address;
-                            range.mask = IPv4Address::ALLONES_ADDRESS;
-                            virtualIntf->setAddressRange(range);
-                            virtualIntf->setIfIndex(routerLSA->getNextHop(0).ifIndex);
-                            virtualIntf->setOutputCost(routerLSA->getDistance());
-                            OSPF::Neighbor* virtualNeighbor = virtualIntf->getNeighbor(0);
-                            if (virtualNeighbor != NULL) {
-                                unsigned int linkCount = routerLSA->getLinksArraySize();
-                                OSPF::RouterLSA* toRouterLSA = dynamic_cast<OSPF::RouterLSA*> (justAddedVertex);
-                                if (toRouterLSA != NULL) {
+    for (unsigned long v = 1; v < treeVertices.size(); v++) {
+        OSPFLSA* closestVertex = treeVertices[v];
+        OSPFLSA* justAddedVertex = treeVertices[v - 1];    // the vertex added to the tree before closestVertex
+
+        if (closestVertex->getHeader().getLsType() == ROUTERLSA_TYPE) {
+            OSPF::RouterLSA* routerLSA = check_and_cast<OSPF::RouterLSA*> (closestVertex);
+            if (routerLSA->getB_AreaBorderRouter() || routerLSA->getE_ASBoundaryRouter()) {
+                OSPF::RoutingTableEntry* entry = new OSPF::RoutingTableEntry;
+                OSPF::RouterID destinationID = routerLSA->getHeader().getLinkStateID();
+                unsigned int nextHopCount = routerLSA->getNextHopCount();
+                OSPF::RoutingTableEntry::RoutingDestinationType destinationType = OSPF::RoutingTableEntry::NETWORK_DESTINATION;
+
+                entry->setDestination(destinationID);
+                entry->setLinkStateOrigin(routerLSA);
+                entry->setArea(areaID);
+                entry->setPathType(OSPF::RoutingTableEntry::INTRAAREA);
+                entry->setCost(routerLSA->getDistance());
+                if (routerLSA->getB_AreaBorderRouter()) {
+                    destinationType |= OSPF::RoutingTableEntry::AREA_BORDER_ROUTER_DESTINATION;
+                }
+                if (routerLSA->getE_ASBoundaryRouter()) {
+                    destinationType |= OSPF::RoutingTableEntry::AS_BOUNDARY_ROUTER_DESTINATION;
+                }
+                entry->setDestinationType(destinationType);
+                entry->setOptionalCapabilities(routerLSA->getHeader().getLsOptions());
+                for (i = 0; i < nextHopCount; i++) {
+                    entry->addNextHop(routerLSA->getNextHop(i));
+                }
+
+                newRoutingTable.push_back(entry);
+
+                OSPF::Area* backbone;
+                if (areaID != OSPF::BACKBONE_AREAID) {
+                    backbone = parentRouter->getAreaByID(OSPF::BACKBONE_AREAID);
+                } else {
+                    backbone = this;
+                }
+                if (backbone != NULL) {
+                    OSPF::Interface* virtualIntf = backbone->findVirtualLink(destinationID);
+                    if ((virtualIntf != NULL) && (virtualIntf->getTransitAreaID() == areaID)) {
+                        OSPF::IPv4AddressRange range;
+                        range.address = getInterface(routerLSA->getNextHop(0).ifIndex)->getAddressRange().address;
+                        range.mask = IPv4Address::ALLONES_ADDRESS;
+                        virtualIntf->setAddressRange(range);
+                        virtualIntf->setIfIndex(routerLSA->getNextHop(0).ifIndex);
+                        virtualIntf->setOutputCost(routerLSA->getDistance());
+                        OSPF::Neighbor* virtualNeighbor = virtualIntf->getNeighbor(0);
+                        if (virtualNeighbor != NULL) {
+                            unsigned int linkCount = routerLSA->getLinksArraySize();
+                            OSPF::RouterLSA* toRouterLSA = dynamic_cast<OSPF::RouterLSA*> (justAddedVertex);
+                            if (toRouterLSA != NULL) {
+                                for (i = 0; i < linkCount; i++) {
+                                    Link& link = routerLSA->getLinks(i);
+
+                                    if ((link.getType() == POINTTOPOINT_LINK) &&
+                                        (link.getLinkID() == toRouterLSA->getHeader().getLinkStateID()) &&
+                                        (virtualIntf->getState() < OSPF::Interface::WAITING_STATE))
+                                    {
+                                        virtualNeighbor->setAddress(IPv4Address(link.getLinkData()));
+                                        virtualIntf->processEvent(OSPF::Interface::INTERFACE_UP);
+                                        break;
+                                    }
+                                }
+                            } else {
+                                OSPF::NetworkLSA* toNetworkLSA = dynamic_cast<OSPF::NetworkLSA*> (justAddedVertex);
+                                if (toNetworkLSA != NULL) {
                                     for (i = 0; i < linkCount; i++) {
                                         Link& link = routerLSA->getLinks(i);
 
-                                        if ((link.getType() == POINTTOPOINT_LINK) &&
-                                            (link.getLinkID() == toRouterLSA->getHeader().getLinkStateID()) &&
+                                        if ((link.getType() == TRANSIT_LINK) &&
+                                            (link.getLinkID() == toNetworkLSA->getHeader().getLinkStateID()) &&
                                             (virtualIntf->getState() < OSPF::Interface::WAITING_STATE))
                                         {
                                             virtualNeighbor->setAddress(IPv4Address(link.getLinkData()));
@@ -1650,87 +1781,74 @@ void OSPF::Area::calculateShortestPathTree(std::vector<OSPF::RoutingTableEntry*>
                                             break;
                                         }
                                     }
-                                } else {
-                                    OSPF::NetworkLSA* toNetworkLSA = dynamic_cast<OSPF::NetworkLSA*> (justAddedVertex);
-                                    if (toNetworkLSA != NULL) {
-                                        for (i = 0; i < linkCount; i++) {
-                                            Link& link = routerLSA->getLinks(i);
-
-                                            if ((link.getType() == TRANSIT_LINK) &&
-                                                (link.getLinkID() == toNetworkLSA->getHeader().getLinkStateID()) &&
-                                                (virtualIntf->getState() < OSPF::Interface::WAITING_STATE))
-                                            {
-                                                virtualNeighbor->setAddress(IPv4Address(link.getLinkData()));
-                                                virtualIntf->processEvent(OSPF::Interface::INTERFACE_UP);
-                                                break;
-                                            }
-                                        }
-                                    }
                                 }
                             }
                         }
                     }
                 }
             }
+        }
 
-            if (closestVertex->getHeader().getLsType() == NETWORKLSA_TYPE) {
-                OSPF::NetworkLSA* networkLSA = check_and_cast<OSPF::NetworkLSA*> (closestVertex);
-                IPv4Address destinationID = (networkLSA->getHeader().getLinkStateID() & networkLSA->getNetworkMask());
-                unsigned int nextHopCount = networkLSA->getNextHopCount();
-                bool overWrite = false;
-                OSPF::RoutingTableEntry* entry = NULL;
-                unsigned long routeCount = newRoutingTable.size();
-                IPv4Address longestMatch(0u);
-
-                for (i = 0; i < routeCount; i++) {
-                    if (newRoutingTable[i]->getDestinationType() == OSPF::RoutingTableEntry::NETWORK_DESTINATION) {
-                        OSPF::RoutingTableEntry* routingEntry = newRoutingTable[i];
-                        IPv4Address entryAddress = routingEntry->getDestination();
-                        IPv4Address entryMask = routingEntry->getNetmask();
-
-                        if ((entryAddress & entryMask) == (destinationID & entryMask)) {
-                            if ((destinationID & entryMask) > longestMatch) {
-                                longestMatch = (destinationID & entryMask);
-                                entry = routingEntry;
-                            }
+        if (closestVertex->getHeader().getLsType() == NETWORKLSA_TYPE) {
+            OSPF::NetworkLSA* networkLSA = check_and_cast<OSPF::NetworkLSA*> (closestVertex);
+            IPv4Address destinationID = (networkLSA->getHeader().getLinkStateID() & networkLSA->getNetworkMask());
+            unsigned int nextHopCount = networkLSA->getNextHopCount();
+            bool overWrite = false;
+            OSPF::RoutingTableEntry* entry = NULL;
+            unsigned long routeCount = newRoutingTable.size();
+            IPv4Address longestMatch(0u);
+
+            for (i = 0; i < routeCount; i++) {
+                if (newRoutingTable[i]->getDestinationType() == OSPF::RoutingTableEntry::NETWORK_DESTINATION) {
+                    OSPF::RoutingTableEntry* routingEntry = newRoutingTable[i];
+                    IPv4Address entryAddress = routingEntry->getDestination();
+                    IPv4Address entryMask = routingEntry->getNetmask();
+
+                    if ((entryAddress & entryMask) == (destinationID & entryMask)) {
+                        if ((destinationID & entryMask) > longestMatch) {
+                            longestMatch = (destinationID & entryMask);
+                            entry = routingEntry;
                         }
                     }
                 }
-                if (entry != NULL) {
-                    const OSPFLSA* entryOrigin = entry->getLinkStateOrigin();
-                    if ((entry->getCost() != networkLSA->getDistance()) ||
-                        (entryOrigin->getHeader().getLinkStateID() >= networkLSA->getHeader().getLinkStateID()))
-                    {
-                        overWrite = true;
-                    }
+            }
+            if (entry != NULL) {
+                const OSPFLSA* entryOrigin = entry->getLinkStateOrigin();
+                if ((entry->getCost() != networkLSA->getDistance()) ||
+                    (entryOrigin->getHeader().getLinkStateID() >= networkLSA->getHeader().getLinkStateID()))
+                {
+                    overWrite = true;
                 }
+            }
 
-                if ((entry == NULL) || (overWrite)) {
-                    if (entry == NULL) {
-                        entry = new OSPF::RoutingTableEntry;
-                    }
+            if ((entry == NULL) || (overWrite)) {
+                if (entry == NULL) {
+                    entry = new OSPF::RoutingTableEntry;
+                }
 
-                    entry->setDestination(IPv4Address(destinationID));
-                    entry->setNetmask(networkLSA->getNetworkMask());
-                    entry->setLinkStateOrigin(networkLSA);
-                    entry->setArea(areaID);
-                    entry->setPathType(OSPF::RoutingTableEntry::INTRAAREA);
-                    entry->setCost(networkLSA->getDistance());
-                    entry->setDestinationType(OSPF::RoutingTableEntry::NETWORK_DESTINATION);
-                    entry->setOptionalCapabilities(networkLSA->getHeader().getLsOptions());
-                    for (i = 0; i < nextHopCount; i++) {
-                        entry->addNextHop(networkLSA->getNextHop(i));
-                    }
+                entry->setDestination(IPv4Address(destinationID));
+                entry->setNetmask(networkLSA->getNetworkMask());
+                entry->setLinkStateOrigin(networkLSA);
+                entry->setArea(areaID);
+                entry->setPathType(OSPF::RoutingTableEntry::INTRAAREA);
+                entry->setCost(networkLSA->getDistance());
+                entry->setDestinationType(OSPF::RoutingTableEntry::NETWORK_DESTINATION);
+                entry->setOptionalCapabilities(networkLSA->getHeader().getLsOptions());
+                for (i = 0; i < nextHopCount; i++) {
+                    entry->addNextHop(networkLSA->getNextHop(i));
+                }
 
-                    if (!overWrite) {
-                        newRoutingTable.push_back(entry);
-                    }
+                if (!overWrite) {
+                    newRoutingTable.push_back(entry);
                 }
             }
-
-            justAddedVertex = closestVertex;
         }
-    } while (!finished);
+    }
+}
+
+void OSPF::Area::addStubRoutes(const std::vector<OSPFLSA*>& treeVertices, std::vector<OSPF::RoutingTableEntry*>& newRoutingTable)
+{
+    unsigned long i, j, k;
 
     unsigned int treeSize = treeVertices.size();
     for (i = 0; i < treeSize; i++) {
@@ -33,6 +33,19 @@ class Router;
 
 class Area : public cObject {
 private:
+    /**
+     * Everything the shortest path tree (the router and network vertices,
+     * their distances and next hops) depends on: the transit part of the
+     * router and network LSAs and the state of the interfaces. Stub links,
+     * summary LSAs and AS external LSAs are not included, they only affect
+     * the routes collected from the tree.
+     */
+    struct SPFInput {
+        std::vector<const void*>  objects;   // LSAs and the tree root
+        std::vector<uint32>       data;
+        bool operator==(const SPFInput& other) const  { return objects == other.objects && data == other.data; }
+    };
+
     AreaID                                                  areaID;
     std::map<IPv4AddressRange, bool>                        advertiseAddressRanges;
     std::vector<IPv4AddressRange>                           areaAddressRanges;
@@ -48,6 +61,9 @@ private:
     bool                                                    externalRoutingCapability;
     Metric                                                  stubDefaultCost;
     RouterLSA*                                              spfTreeRoot;
+    std::vector<OSPFLSA*>                                   spfTreeVertices;      ///< The vertices of the last calculated shortest path tree, in the order they were added.
+    SPFInput                                                spfTreeInput;         ///< The input of the last shortest path tree calculation.
+    bool                                                    spfTreeValid;         ///< False if an LSA was added to the database since the last calculation.
 
     Router*                                                 parentRouter;
 public:
@@ -114,6 +130,7 @@ public:
                                           const std::map<LSAKeyType, bool, LSAKeyType_Less>& originatedLSAs,
                                           SummaryLSA*& lsaToReoriginate);
     void              calculateShortestPathTree(std::vector<RoutingTableEntry*>& newRoutingTable);
+    void              invalidateShortestPathTree()  { spfTreeValid = false; }
     void              calculateInterAreaRoutes(std::vector<RoutingTableEntry*>& newRoutingTable);
     void              recheckSummaryLSAs(std::vector<RoutingTableEntry*>& newRoutingTable);
 
@@ -123,6 +140,10 @@ public:
 private:
     SummaryLSA*           originateSummaryLSA(const OSPF::SummaryLSA* summaryLSA);
     bool                  hasLink(OSPFLSA* fromLSA, OSPFLSA* toLSA) const;
+    void                  getSPFInput(SPFInput& input) const;
+    void                  calculateShortestPathTreeVertices();
+    void                  addShortestPathTreeRoutes(const std::vector<OSPFLSA*>& treeVertices, std::vector<RoutingTableEntry*>& newRoutingTable);
+    void                  addStubRoutes(const std::vector<OSPFLSA*>& treeVertices, std::vector<RoutingTableEntry*>& newRoutingTable);
     std::vector<NextHop>* calculateNextHops(OSPFLSA* destination, OSPFLSA* parent) const;
     std::vector<NextHop>* calculateNextHops(Link& destination, OSPFLSA* parent) const;
 
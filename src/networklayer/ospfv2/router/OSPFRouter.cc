@@ -16,6 +16,8 @@
 //
 
 
+#include <algorithm>
+
 #include "OSPFRouter.h"
 
 #include "RoutingTableAccess.h"
@@ -31,6 +33,12 @@ OSPF::Router::Router(OSPF::RouterID id, cSimpleModule* containingModule) :
     ageTimer->setContextPointer(this);
     ageTimer->setName("OSPF::Router::DatabaseAgeTimer");
     messageHandler->startTimer(ageTimer, 1.0);
+    spfTimer = new cMessage();
+    spfTimer->setKind(SPF_TIMER);
+    spfTimer->setContextPointer(this);
+    spfTimer->setName("OSPF::Router::SPFTimer");
+    spfDelay = spfHoldTime = spfMaxHoldTime = spfCurrentHoldTime = 0;
+    lastSPFTime = -1;
 }
 
 
@@ -50,6 +58,8 @@ OSPF::Router::~Router()
     }
     messageHandler->clearTimer(ageTimer);
     delete ageTimer;
+    messageHandler->clearTimer(spfTimer);
+    delete spfTimer;
     delete messageHandler;
 }
 
@@ -63,6 +73,19 @@ void OSPF::Router::addWatches()
 }
 
 
+void OSPF::Router::setSPFThrottling(simtime_t delay, simtime_t holdTime, simtime_t maxHoldTime)
+{
+    if (delay < 0 || holdTime < 0 || maxHoldTime < holdTime) {
+        throw cRuntimeError("Invalid SPF throttling parameters: delay=%s, holdTime=%s, maxHoldTime=%s",
+                SIMTIME_STR(delay), SIMTIME_STR(holdTime), SIMTIME_STR(maxHoldTime));
+    }
+    spfDelay = delay;
+    spfHoldTime = holdTime;
+    spfMaxHoldTime = maxHoldTime;
+    spfCurrentHoldTime = holdTime;
+}
+
+
 void OSPF::Router::addArea(OSPF::Area* area)
 {
 
@@ -396,7 +419,7 @@ void OSPF::Router::ageDatabase()
     messageHandler->startTimer(ageTimer, 1.0);
 
     if (shouldRebuildRoutingTable) {
-        rebuildRoutingTable();
+        scheduleRoutingTableRebuild();
     }
 }
 
@@ -703,6 +726,33 @@ OSPF::RoutingTableEntry* OSPF::Router::lookup(IPv4Address destination, std::vect
 }
 
 
+void OSPF::Router::scheduleRoutingTableRebuild()
+{
+    if ((spfDelay == 0) && (spfHoldTime == 0)) {
+        rebuildRoutingTable();
+        return;
+    }
+    if (spfTimer->isScheduled()) {
+        return;     // the change will be handled by the already scheduled rebuild
+    }
+
+    simtime_t now = simTime();
+    simtime_t rebuildTime = now + spfDelay;
+    if ((lastSPFTime < 0) || (now >= lastSPFTime + spfCurrentHoldTime)) {
+        // quiet since the last rebuild: back to the initial hold time
+        spfCurrentHoldTime = spfHoldTime;
+    } else {
+        // changes keep arriving: wait for the end of the hold time, and back off
+        if (rebuildTime < lastSPFTime + spfCurrentHoldTime) {
+            rebuildTime = lastSPFTime + spfCurrentHoldTime;
+        }
+        spfCurrentHoldTime = std::min(spfCurrentHoldTime * 2, spfMaxHoldTime);
+    }
+    EV << "Scheduling routing table rebuild at t=" << rebuildTime << "\n";
+    messageHandler->startTimer(spfTimer, rebuildTime - now);
+}
+
+
 void OSPF::Router::rebuildRoutingTable()
 {
     unsigned long areaCount = areas.size();
@@ -710,6 +760,11 @@ void OSPF::Router::rebuildRoutingTable()
     std::vector<OSPF::RoutingTableEntry*> newTable;
     unsigned long i;
 
+    if (spfTimer->isScheduled()) {
+        messageHandler->clearTimer(spfTimer);
+    }
+    lastSPFTime = simTime();
+
     EV << "Rebuilding routing table:\n";
 
     for (i = 0; i < areaCount; i++) {
@@ -738,38 +793,14 @@ void OSPF::Router::rebuildRoutingTable()
     calculateASExternalRoutes(newTable);
 
     // backup the routing table
-    unsigned long routeCount = routingTable.size();
+    unsigned long routeCount;
     std::vector<OSPF::RoutingTableEntry*> oldTable;
 
     oldTable.assign(routingTable.begin(), routingTable.end());
     routingTable.clear();
     routingTable.assign(newTable.begin(), newTable.end());
 
-    RoutingTableAccess routingTableAccess;
-    std::vector<IPv4Route*> eraseEntries;
-    IRoutingTable* simRoutingTable = routingTableAccess.get();
-    unsigned long routingEntryNumber = simRoutingTable->getNumRoutes();
-    // remove entries from the IPv4 routing table inserted by the OSPF module
-    for (i = 0; i < routingEntryNumber; i++) {
-        IPv4Route *entry = simRoutingTable->getRoute(i);
-        OSPF::RoutingTableEntry* ospfEntry = dynamic_cast<OSPF::RoutingTableEntry*>(entry);
-        if (ospfEntry != NULL) {
-            eraseEntries.push_back(entry);
-        }
-    }
-
-    unsigned int eraseCount = eraseEntries.size();
-    for (i = 0; i < eraseCount; i++) {
-        simRoutingTable->deleteRoute(eraseEntries[i]);
-    }
-
-    // add the new routing entries
-    routeCount = routingTable.size();
-    for (i = 0; i < routeCount; i++) {
-        if (routingTable[i]->getDestinationType() == OSPF::RoutingTableEntry::NETWORK_DESTINATION) {
-            simRoutingTable->addRoute(new OSPF::RoutingTableEntry(*(routingTable[i])));
-        }
-    }
+    installRoutesInIPTable();
 
     notifyAboutRoutingTableChanges(oldTable);
 
@@ -789,6 +820,72 @@ void OSPF::Router::rebuildRoutingTable()
 }
 
 
+/**
+ * Returns true if the route installed in the IP routing table is an up-to-date
+ * copy of the entry. IPv4Route::equals() cannot be used, because it also compares
+ * the owner routing table, which is only set for installed routes.
+ */
+static bool isSameInstalledRoute(const OSPF::RoutingTableEntry& installed, const OSPF::RoutingTableEntry& entry)
+{
+    return (installed == entry) &&      // OSPF fields and next hops, destination, netmask
+           (installed.getGateway() == entry.getGateway()) &&
+           (installed.getInterface() == entry.getInterface()) &&
+           (installed.getSourceType() == entry.getSourceType()) &&
+           (installed.getMetric() == entry.getMetric()) &&
+           (installed.getAdminDist() == entry.getAdminDist());
+}
+
+void OSPF::Router::installRoutesInIPTable()
+{
+    RoutingTableAccess routingTableAccess;
+    IRoutingTable* simRoutingTable = routingTableAccess.get();
+    unsigned long routingEntryNumber = simRoutingTable->getNumRoutes();
+    unsigned long i;
+
+    // collect the entries inserted by the OSPF module, by destination
+    typedef std::multimap<std::pair<IPv4Address, IPv4Address>, OSPF::RoutingTableEntry*> InstalledEntryMap;
+    InstalledEntryMap installedEntries;
+    for (i = 0; i < routingEntryNumber; i++) {
+        OSPF::RoutingTableEntry* ospfEntry = dynamic_cast<OSPF::RoutingTableEntry*>(simRoutingTable->getRoute(i));
+        if (ospfEntry != NULL) {
+            installedEntries.insert(std::make_pair(std::make_pair(ospfEntry->getDestination(), ospfEntry->getNetmask()), ospfEntry));
+        }
+    }
+
+    // keep the installed entries that are also in the new table, and collect the missing ones
+    std::vector<OSPF::RoutingTableEntry*> addEntries;
+    unsigned long routeCount = routingTable.size();
+    for (i = 0; i < routeCount; i++) {
+        OSPF::RoutingTableEntry* newEntry = routingTable[i];
+        if (newEntry->getDestinationType() != OSPF::RoutingTableEntry::NETWORK_DESTINATION) {
+            continue;
+        }
+        std::pair<InstalledEntryMap::iterator, InstalledEntryMap::iterator> range =
+                installedEntries.equal_range(std::make_pair(newEntry->getDestination(), newEntry->getNetmask()));
+        InstalledEntryMap::iterator it = range.first;
+        while ((it != range.second) && !isSameInstalledRoute(*it->second, *newEntry)) {
+            it++;
+        }
+        if (it != range.second) {
+            installedEntries.erase(it);     // unchanged
+        } else {
+            addEntries.push_back(newEntry);
+        }
+    }
+
+    // remove the entries that are no longer valid, then add the new ones
+    for (InstalledEntryMap::iterator it = installedEntries.begin(); it != installedEntries.end(); it++) {
+        simRoutingTable->deleteRoute(it->second);
+    }
+    unsigned int addCount = addEntries.size();
+    for (i = 0; i < addCount; i++) {
+        simRoutingTable->addRoute(new OSPF::RoutingTableEntry(*(addEntries[i])));
+    }
+
+    EV << "IP routing table updated: " << installedEntries.size() << " routes removed, " << addCount << " routes added.\n";
+}
+
+
 bool OSPF::Router::hasRouteToASBoundaryRouter(const std::vector<OSPF::RoutingTableEntry*>& inRoutingTable, OSPF::RouterID asbrRouterID) const
 {
     long routeCount = inRoutingTable.size();
@@ -1373,7 +1470,7 @@ void OSPF::Router::updateExternalRoute(IPv4Address networkAddress, const OSPFASE
     delete asExternalLSA;
 
     if (rebuild) {
-        rebuildRoutingTable();
+        scheduleRoutingTableRebuild();
     }
 }
 
@@ -47,6 +47,12 @@ private:
     std::vector<ASExternalLSA*>                                        asExternalLSAs;          ///< A list of the ASExternalLSAs advertised by this router.
     std::map<IPv4Address, OSPFASExternalLSAContents>                   externalRoutes;          ///< A map of the external route advertised by this router.
     cMessage*                                                          ageTimer;                ///< Database age timer - fires every second.
+    cMessage*                                                          spfTimer;                ///< Fires when the routing table should be rebuilt after a (throttled) database change.
+    simtime_t                                                          spfDelay;                ///< Delay between a database change and the routing table rebuild.
+    simtime_t                                                          spfHoldTime;             ///< Initial minimum time between two routing table rebuilds.
+    simtime_t                                                          spfMaxHoldTime;          ///< Upper limit of the hold time, which doubles while database changes keep arriving.
+    simtime_t                                                          spfCurrentHoldTime;      ///< The current minimum time between two routing table rebuilds.
+    simtime_t                                                          lastSPFTime;             ///< Time of the last routing table rebuild, or -1.
     std::vector<RoutingTableEntry*>                                    routingTable;            ///< The OSPF routing table - contains more information than the one in the IP layer.
     MessageHandler*                                                    messageHandler;          ///< The message dispatcher class.
     bool                                                               rfc1583Compatibility;    ///< Decides whether to handle the preferred routing table entry to an AS boundary router as defined in RFC1583 or not.
@@ -69,6 +75,7 @@ public:
     void                     setRFC1583Compatibility(bool compatibility)  { rfc1583Compatibility = compatibility; }
     bool                     getRFC1583Compatibility() const  { return rfc1583Compatibility; }
     unsigned long            getAreaCount() const  { return areas.size(); }
+    void                     setSPFThrottling(simtime_t delay, simtime_t holdTime, simtime_t maxHoldTime);
 
     MessageHandler*          getMessageHandler()  { return messageHandler; }
 
@@ -203,11 +210,21 @@ public:
     RoutingTableEntry*   lookup(IPv4Address destination, std::vector<RoutingTableEntry*>* table = NULL) const;
 
     /**
-     * Rebuilds the routing table from scratch(based on the LSA database).
+     * Rebuilds the routing table(based on the LSA database). The shortest path
+     * tree of an area is only recalculated if its input changed, and only the
+     * changed routes are updated in the IP routing table.
      * @sa RFC2328 Section 16.
      */
     void                 rebuildRoutingTable();
 
+    /**
+     * Called when the LSA database changed: rebuilds the routing table
+     * immediately, or if SPF throttling is configured(see setSPFThrottling())
+     * schedules the rebuild so that a burst of changes is handled by a single
+     * rebuild.
+     */
+    void                 scheduleRoutingTableRebuild();
+
     /**
      * Scans through the router's areas' preconfigured address ranges and returns
      * the one containing the input addressRange.
@@ -333,6 +350,13 @@ private:
      */
     void                 notifyAboutRoutingTableChanges(std::vector<RoutingTableEntry*>& oldRoutingTable);
 
+    /**
+     * Updates the IP routing table to contain the network routes of the OSPF
+     * routing table. Routes that did not change are left in place, so
+     * unchanged destinations do not invalidate the routing cache of the IP layer.
+     */
+    void                 installRoutesInIPTable();
+
     /**
      * Returns true if there is a route to the AS Boundary Router identified by
      * asbrRouterID in the input inRoutingTable, false otherwise.
@@ -48,6 +48,7 @@ OSPF::RoutingTableEntry::RoutingTableEntry(const RoutingTableEntry& entry) :
     setInterface(entry.getInterface());
     setSourceType(entry.getSourceType());
     setMetric(entry.getMetric());
+    setAdminDist(entry.getAdminDist());
 }
 
 void OSPF::RoutingTableEntry::setPathType(RoutingPathType type)
@@ -21,15 +21,12 @@
 
 bool OSPF::RouterLSA::update(const OSPFRouterLSA* lsa)
 {
+    // the routing info (next hops) is kept: the area recalculates it
+    // only if the change affects the shortest path tree
     bool different = differsFrom(lsa);
     (*this) = (*lsa);
     resetInstallTime();
-    if (different) {
-        clearNextHops();
-        return true;
-    } else {
-        return false;
-    }
+    return different;
 }
 
 bool OSPF::RouterLSA::differsFrom(const OSPFRouterLSA* routerLSA) const
@@ -20,7 +20,7 @@
 #include "InterfaceTableAccess.h"
 #include "IPSocket.h"
 #include "IPProtocolId_m.h"
-#include "Ieee80211Frame_m.h"
+#include "Ieee80211Frame.h"
 #include "IPvXAddressResolver.h"
 #include "IPv4ControlInfo.h"
 #include "UDPControlInfo.h"
@@ -0,0 +1,271 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_SOCKETPAIRTABLE_H
+#define __INET_SOCKETPAIRTABLE_H
+
+#include <vector>
+
+#include "INETDefs.h"
+
+#include "IPvXAddress.h"
+#include "OpenHashTable.h"
+
+
+/**
+ * Demultiplexing table of a transport protocol: maps socket pairs
+ * (local address, remote address, local port, remote port) to connections
+ * or associations. Used by TCP, SCTP and the TCP_NSC glue instead of a
+ * std::map, which needs O(log n) address comparisons per lookup.
+ *
+ * An unspecified address is IPvXAddress(), an unspecified port is the
+ * value given to the constructor (-1 for TCP, 0 for SCTP). Entries whose
+ * remote address and port are both unspecified are listeners; they are
+ * stored in a separate hash table keyed by local port. All other entries
+ * are stored in a hash table keyed by the whole socket pair. Both tables
+ * are OpenHashTables of entry indices.
+ *
+ * Keys are matched exactly, with the same semantics as a std::map keyed
+ * by the socket pair: findForPacket() performs the lookup sequence of an
+ * incoming packet, not a wildcard match.
+ */
+template<typename T>
+class SocketPairTable
+{
+  public:
+    struct Entry
+    {
+        IPvXAddress localAddr;
+        IPvXAddress remoteAddr;
+        int localPort;
+        int remotePort;
+        T value;
+    };
+
+  protected:
+    // hash table slot: index into entries, with the hash of the entry
+    struct EntryRef
+    {
+        unsigned int hash;
+        int index;
+        EntryRef() : hash(0), index(-1) {}
+        EntryRef(unsigned int hash, int index) : hash(hash), index(index) {}
+    };
+
+    struct EntryRefHash
+    {
+        unsigned int operator()(const EntryRef& ref) const { return ref.hash; }
+    };
+
+    struct MatchesSocketPair
+    {
+        const std::vector<Entry>& entries;
+        const IPvXAddress& localAddr;
+        const IPvXAddress& remoteAddr;
+        int localPort;
+        int remotePort;
+        MatchesSocketPair(const std::vector<Entry>& entries, const IPvXAddress& localAddr, const IPvXAddress& remoteAddr, int localPort, int remotePort) :
+            entries(entries), localAddr(localAddr), remoteAddr(remoteAddr), localPort(localPort), remotePort(remotePort) {}
+        bool operator()(const EntryRef& ref) const
+        {
+            const Entry& e = entries[ref.index];
+            return e.localPort == localPort && e.remotePort == remotePort && e.localAddr == localAddr && e.remoteAddr == remoteAddr;
+        }
+    };
+
+    struct MatchesIndex
+    {
+        int index;
+        MatchesIndex(int index) : index(index) {}
+        bool operator()(const EntryRef& ref) const { return ref.index == index; }
+    };
+
+    typedef OpenHashTable<EntryRef, EntryRefHash> EntryRefTable;
+
+    int anyPort;                    // the "unspecified" port value
+    T notFound;                     // value returned by failed lookups
+    std::vector<Entry> entries;     // all entries, without holes
+    EntryRefTable connTable;        // entries keyed by the socket pair
+    EntryRefTable listenerTable;    // listener entries keyed by the local port
+    int numUnboundConns;            // non-listener entries with unspecified local address
+
+  protected:
+    static uint64 hashAddress(const IPvXAddress& addr)
+    {
+        const uint32 *w = addr.words();
+        if (!addr.isIPv6())
+            return w[0];  // the other words are not initialized for IPv4
+        return mixHash(((uint64)w[0] << 32 | w[1]) ^ mixHash((uint64)w[2] << 32 | w[3]));
+    }
+
+    bool isListener(const IPvXAddress& remoteAddr, int remotePort) const
+    {
+        return remotePort == anyPort && remoteAddr == IPvXAddress();
+    }
+
+    bool isListener(const Entry& e) const { return isListener(e.remoteAddr, e.remotePort); }
+
+    unsigned int hash(const IPvXAddress& localAddr, const IPvXAddress& remoteAddr, int localPort, int remotePort) const
+    {
+        if (isListener(remoteAddr, remotePort))
+            return (unsigned int)mixHash((uint32)localPort);
+        uint64 ports = (uint64)(uint32)localPort << 32 | (uint32)remotePort;
+        return (unsigned int)mixHash(hashAddress(remoteAddr) ^ mixHash(hashAddress(localAddr) ^ mixHash(ports)));
+    }
+
+    EntryRefTable& getTable(const IPvXAddress& remoteAddr, int remotePort)
+    {
+        return isListener(remoteAddr, remotePort) ? listenerTable : connTable;
+    }
+
+    const EntryRefTable& getTable(const IPvXAddress& remoteAddr, int remotePort) const
+    {
+        return isListener(remoteAddr, remotePort) ? listenerTable : connTable;
+    }
+
+    const Entry *lookup(const IPvXAddress& localAddr, const IPvXAddress& remoteAddr, int localPort, int remotePort) const
+    {
+        const EntryRefTable& table = getTable(remoteAddr, remotePort);
+        int slot = table.findSlot(hash(localAddr, remoteAddr, localPort, remotePort),
+                MatchesSocketPair(entries, localAddr, remoteAddr, localPort, remotePort));
+        return slot == -1 ? NULL : &entries[table.at(slot).index];
+    }
+
+  public:
+    SocketPairTable(int anyPort, T notFound) :
+        anyPort(anyPort), notFound(notFound), numUnboundConns(0) {}
+
+    /**
+     * Adds an entry. Returns false (and leaves the table unchanged) if an
+     * entry with the same socket pair already exists.
+     */
+    bool insert(const IPvXAddress& localAddr, const IPvXAddress& remoteAddr, int localPort, int remotePort, T value)
+    {
+        if (lookup(localAddr, remoteAddr, localPort, remotePort))
+            return false;
+        Entry e;
+        e.localAddr = localAddr;
+        e.remoteAddr = remoteAddr;
+        e.localPort = localPort;
+        e.remotePort = remotePort;
+        e.value = value;
+        entries.push_back(e);
+        getTable(remoteAddr, remotePort).insert(EntryRef(hash(localAddr, remoteAddr, localPort, remotePort), entries.size() - 1));
+        if (!isListener(remoteAddr, remotePort) && localAddr == IPvXAddress())
+            numUnboundConns++;
+        return true;
+    }
+
+    /**
+     * Adds an entry, or replaces the value of an existing one.
+     */
+    void set(const IPvXAddress& localAddr, const IPvXAddress& remoteAddr, int localPort, int remotePort, T value)
+    {
+        Entry *e = const_cast<Entry *>(lookup(localAddr, remoteAddr, localPort, remotePort));
+        if (e)
+            e->value = value;
+        else
+            insert(localAddr, remoteAddr, localPort, remotePort, value);
+    }
+
+    /**
+     * Removes the entry of the given socket pair. Returns false if there
+     * was no such entry.
+     */
+    bool remove(const IPvXAddress& localAddr, const IPvXAddress& remoteAddr, int localPort, int remotePort)
+    {
+        EntryRefTable& table = getTable(remoteAddr, remotePort);
+        int slot = table.findSlot(hash(localAddr, remoteAddr, localPort, remotePort),
+                MatchesSocketPair(entries, localAddr, remoteAddr, localPort, remotePort));
+        if (slot == -1)
+            return false;
+        int index = table.at(slot).index;
+        table.removeSlot(slot);
+        if (!isListener(remoteAddr, remotePort) && localAddr == IPvXAddress())
+            numUnboundConns--;
+
+        // move the last entry into the freed position
+        int last = entries.size() - 1;
+        if (index != last)
+        {
+            const Entry& moved = entries[last];
+            EntryRefTable& movedTable = getTable(moved.remoteAddr, moved.remotePort);
+            movedTable.at(movedTable.findSlot(hash(moved.localAddr, moved.remoteAddr, moved.localPort, moved.remotePort), MatchesIndex(last))).index = index;
+            entries[index] = moved;
+        }
+        entries.pop_back();
+        return true;
+    }
+
+    /**
+     * Returns the value stored for exactly the given socket pair, or the
+     * "not found" value.
+     */
+    T find(const IPvXAddress& localAddr, const IPvXAddress& remoteAddr, int localPort, int remotePort) const
+    {
+        const Entry *e = lookup(localAddr, remoteAddr, localPort, remotePort);
+        return e ? e->value : notFound;
+    }
+
+    /**
+     * Finds the entry for an incoming packet: tries the fully specified
+     * socket pair, then unspecified local address, then (if includeListeners
+     * is true) a listener on the local address and port, and finally a
+     * listener on the local port only. Lookups that cannot succeed because
+     * the table has no such entries are skipped.
+     */
+    T findForPacket(const IPvXAddress& localAddr, const IPvXAddress& remoteAddr, int localPort, int remotePort, bool includeListeners = true) const
+    {
+        const Entry *e = lookup(localAddr, remoteAddr, localPort, remotePort);
+        if (!e && numUnboundConns > 0)
+            e = lookup(IPvXAddress(), remoteAddr, localPort, remotePort);
+        if (!e && includeListeners && listenerTable.size() > 0)
+        {
+            e = lookup(localAddr, IPvXAddress(), localPort, anyPort);
+            if (!e)
+                e = lookup(IPvXAddress(), IPvXAddress(), localPort, anyPort);
+        }
+        return e ? e->value : notFound;
+    }
+
+    /** Returns the number of entries, including listeners. */
+    int size() const { return entries.size(); }
+
+    /** Returns the number of listener entries. */
+    int getNumListeners() const { return listenerTable.size(); }
+
+    /** Returns the kth entry; entries are unordered, and removals may move them. */
+    const Entry& getEntry(int k) const { return entries[k]; }
+
+    /** Removes all entries. */
+    void clear()
+    {
+        entries.clear();
+        connTable.clear();
+        listenerTable.clear();
+        numUnboundConns = 0;
+    }
+};
+
+template<typename T>
+std::ostream& operator<<(std::ostream& os, const SocketPairTable<T>& table)
+{
+    return os << table.size() << " entries, " << table.getNumListeners() << " listeners";
+}
+
+#endif
+
@@ -43,14 +43,13 @@ int32 SCTP::nextAssocId = 0;
 void SCTP::printInfoAssocMap()
 {
     SCTPAssociation* assoc;
-    SockPair      key;
     sctpEV3<<"Number of Assocs: "<<sizeAssocMap<<"\n";
     if (sizeAssocMap>0)
     {
-        for (SctpAssocMap::iterator i = sctpAssocMap.begin(); i!=sctpAssocMap.end(); ++i)
+        for (int32 i = 0; i < sctpAssocMap.size(); i++)
         {
-            assoc = i->second;
-            key = i->first;
+            const SctpAssocMap::Entry& key = sctpAssocMap.getEntry(i);
+            assoc = key.value;
 
                 sctpEV3<<"assocId: "<<assoc->assocId<<"  assoc: "<<assoc<<" src: "<<IPvXAddress(key.localAddr)<<" dst: "<<IPvXAddress(key.remoteAddr)<<" lPort: "<<key.localPort<<" rPort: "<<key.remotePort<<"\n";
 
@@ -166,7 +165,6 @@ void SCTP::handleMessage(cMessage *msg)
     else if (msg->arrivedOn("from_ip") || msg->arrivedOn("from_ipv6"))
     {
         sctpEV3<<"Message from IP\n";
-        printInfoAssocMap();
         if (!dynamic_cast<SCTPMessage *>(msg))
         {
             sctpEV3<<"no sctp message, delete it\n";
@@ -491,55 +489,15 @@ SCTPAssociation *SCTP::findAssocWithVTag(uint32 peerVTag, uint32 remotePort, uin
 
 SCTPAssociation *SCTP::findAssocForMessage(IPvXAddress srcAddr, IPvXAddress destAddr, uint32 srcPort, uint32 destPort, bool findListen)
 {
-    SockPair key;
-
-    key.localAddr = destAddr;
-    key.remoteAddr = srcAddr;
-    key.localPort = destPort;
-    key.remotePort = srcPort;
-    SockPair save = key;
     sctpEV3<<"findAssocForMessage: srcAddr="<<destAddr<<" destAddr="<<srcAddr<<" srcPort="<<destPort<<"  destPort="<<srcPort<<"\n";
-    printInfoAssocMap();
-
-    // try with fully qualified SockPair
-    SctpAssocMap::iterator i;
-    i = sctpAssocMap.find(key);
-    if (i!=sctpAssocMap.end())
-        return i->second;
-
-
-    // try with localAddr missing (only localPort specified in passive/active open)
-    key.localAddr.set("0.0.0.0");
-
-    i = sctpAssocMap.find(key);
-    if (i!=sctpAssocMap.end())
-    {
-        // try with localAddr missing (only localPort specified in passive/active open)
-        return i->second;
-    }
 
-    if (findListen==true)
-    {
-        // try fully qualified local socket + blank remote socket (for incoming SYN)
-        key = save;
-        key.remoteAddr.set("0.0.0.0");
-        key.remotePort = 0;
-        i = sctpAssocMap.find(key);
-        if (i!=sctpAssocMap.end())
-        {
-            // try fully qualified local socket + blank remote socket
-            return i->second;
-        }
+    // try with fully qualified SockPair, then with localAddr missing (only localPort
+    // specified in passive/active open); if findListen is set, also try blank remote
+    // socket with and without localAddr (for incoming INIT)
+    SCTPAssociation *assoc = sctpAssocMap.findForPacket(destAddr, srcAddr, destPort, srcPort, findListen);
+    if (assoc)
+        return assoc;
 
-        // try with blank remote socket, and localAddr missing (for incoming SYN)
-        key.localAddr.set("0.0.0.0");
-        i = sctpAssocMap.find(key);
-        if (i!=sctpAssocMap.end())
-        {
-            // try with blank remote socket, and localAddr missing
-            return i->second;
-        }
-    }
     // given up
 
     sctpEV3<<"giving up on trying to find assoc for localAddr="<<srcAddr<<" remoteAddr="<<destAddr<<" localPort="<<srcPort<<" remotePort="<<destPort<<"\n";
@@ -574,18 +532,19 @@ void SCTP::updateSockPair(SCTPAssociation *assoc, IPvXAddress localAddr, IPvXAdd
     key.localPort = assoc->localPort = localPort;
     key.remotePort = assoc->remotePort = remotePort;
 
-    for (SctpAssocMap::iterator i=sctpAssocMap.begin(); i!=sctpAssocMap.end(); i++)
+    for (int32 i = 0; i < sctpAssocMap.size(); i++)
     {
-        if (i->second == assoc)
+        const SctpAssocMap::Entry& entry = sctpAssocMap.getEntry(i);
+        if (entry.value == assoc)
         {
-            sctpAssocMap.erase(i);
+            sctpAssocMap.remove(entry.localAddr, entry.remoteAddr, entry.localPort, entry.remotePort);
             break;
         }
     }
 
     sctpEV3<<"updateSockPair assoc="<<assoc<<"    localAddr="<<key.localAddr<<"            remoteAddr="<<key.remoteAddr<<"     localPort="<<key.localPort<<"  remotePort="<<remotePort<<"\n";
 
-    sctpAssocMap[key] = assoc;
+    sctpAssocMap.set(key.localAddr, key.remoteAddr, key.localPort, key.remotePort, assoc);
     sizeAssocMap = sctpAssocMap.size();
     sctpEV3<<"assoc inserted in sctpAssocMap\n";
     printInfoAssocMap();
@@ -601,20 +560,20 @@ void SCTP::addLocalAddress(SCTPAssociation *assoc, IPvXAddress address)
         key.localPort = assoc->localPort;
         key.remotePort = assoc->remotePort;
 
-        SctpAssocMap::iterator i = sctpAssocMap.find(key);
-        if (i!=sctpAssocMap.end())
+        SCTPAssociation *found = sctpAssocMap.find(key.localAddr, key.remoteAddr, key.localPort, key.remotePort);
+        if (found)
         {
-            ASSERT(i->second==assoc);
+            ASSERT(found==assoc);
             if (key.localAddr.isUnspecified())
             {
-                sctpAssocMap.erase(i);
+                sctpAssocMap.remove(key.localAddr, key.remoteAddr, key.localPort, key.remotePort);
                 sizeAssocMap--;
             }
         }
         else
             sctpEV3<<"no actual sockPair found\n";
         key.localAddr = address;
-        sctpAssocMap[key] = assoc;
+        sctpAssocMap.set(key.localAddr, key.remoteAddr, key.localPort, key.remotePort, assoc);
         sizeAssocMap = sctpAssocMap.size();
         sctpEV3<<"addLocalAddress " << address << " number of connections now="<<sizeAssocMap<<"\n";
 
@@ -634,13 +593,13 @@ void SCTP::addLocalAddressToAllRemoteAddresses(SCTPAssociation *assoc, IPvXAddre
             key.localPort = assoc->localPort;
             key.remotePort = assoc->remotePort;
 
-            SctpAssocMap::iterator j = sctpAssocMap.find(key);
-            if (j!=sctpAssocMap.end())
+            SCTPAssociation *found = sctpAssocMap.find(key.localAddr, key.remoteAddr, key.localPort, key.remotePort);
+            if (found)
             {
-            ASSERT(j->second==assoc);
+            ASSERT(found==assoc);
             if (key.localAddr.isUnspecified())
                     {
-                    sctpAssocMap.erase(j);
+                    sctpAssocMap.remove(key.localAddr, key.remoteAddr, key.localPort, key.remotePort);
                     sizeAssocMap--;
                 }
 
@@ -648,7 +607,7 @@ void SCTP::addLocalAddressToAllRemoteAddresses(SCTPAssociation *assoc, IPvXAddre
             else
                 sctpEV3<<"no actual sockPair found\n";
             key.localAddr = address;
-            sctpAssocMap[key] = assoc;
+            sctpAssocMap.set(key.localAddr, key.remoteAddr, key.localPort, key.remotePort, assoc);
 
             sizeAssocMap++;
             sctpEV3<<"number of connections="<<sctpAssocMap.size()<<"\n";
@@ -669,11 +628,11 @@ void SCTP::removeLocalAddressFromAllRemoteAddresses(SCTPAssociation *assoc, IPvX
             key.localPort = assoc->localPort;
             key.remotePort = assoc->remotePort;
 
-            SctpAssocMap::iterator j = sctpAssocMap.find(key);
-            if (j!=sctpAssocMap.end())
+            SCTPAssociation *found = sctpAssocMap.find(key.localAddr, key.remoteAddr, key.localPort, key.remotePort);
+            if (found)
             {
-                ASSERT(j->second==assoc);
-                sctpAssocMap.erase(j);
+                ASSERT(found==assoc);
+                sctpAssocMap.remove(key.localAddr, key.remoteAddr, key.localPort, key.remotePort);
                 sizeAssocMap--;
             }
             else
@@ -695,11 +654,11 @@ void SCTP::removeRemoteAddressFromAllAssociations(SCTPAssociation *assoc, IPvXAd
             key.localPort = assoc->localPort;
             key.remotePort = assoc->remotePort;
 
-            SctpAssocMap::iterator j = sctpAssocMap.find(key);
-            if (j!=sctpAssocMap.end())
+            SCTPAssociation *found = sctpAssocMap.find(key.localAddr, key.remoteAddr, key.localPort, key.remotePort);
+            if (found)
             {
-                ASSERT(j->second==assoc);
-                sctpAssocMap.erase(j);
+                ASSERT(found==assoc);
+                sctpAssocMap.remove(key.localAddr, key.remoteAddr, key.localPort, key.remotePort);
                 sizeAssocMap--;
             }
             else
@@ -720,15 +679,15 @@ bool SCTP::addRemoteAddress(SCTPAssociation *assoc, IPvXAddress localAddress, IP
     key.localPort = assoc->localPort;
     key.remotePort = assoc->remotePort;
 
-    SctpAssocMap::iterator i = sctpAssocMap.find(key);
-    if (i!=sctpAssocMap.end())
+    SCTPAssociation *found = sctpAssocMap.find(key.localAddr, key.remoteAddr, key.localPort, key.remotePort);
+    if (found)
     {
-        ASSERT(i->second==assoc);
+        ASSERT(found==assoc);
         return false;
     }
     else
     {
-        sctpAssocMap[key] = assoc;
+        sctpAssocMap.insert(key.localAddr, key.remoteAddr, key.localPort, key.remotePort, assoc);
         sizeAssocMap++;
     }
 
@@ -742,9 +701,17 @@ void SCTP::addForkedAssociation(SCTPAssociation *assoc, SCTPAssociation *newAsso
 
     EV<<"addForkedConnection assocId="<<assoc->assocId<<"    newId="<<newAssoc->assocId<<"\n";
 
-    for (SctpAssocMap::iterator j=sctpAssocMap.begin(); j!=sctpAssocMap.end(); ++j)
-        if (assoc->assocId==j->second->assocId)
-            keyAssoc = j->first;
+    for (int32 j = 0; j < sctpAssocMap.size(); j++)
+    {
+        const SctpAssocMap::Entry& entry = sctpAssocMap.getEntry(j);
+        if (assoc->assocId==entry.value->assocId)
+        {
+            keyAssoc.localAddr = entry.localAddr;
+            keyAssoc.remoteAddr = entry.remoteAddr;
+            keyAssoc.localPort = entry.localPort;
+            keyAssoc.remotePort = entry.remotePort;
+        }
+    }
     // update assoc's socket pair, and register newAssoc (which'll keep LISTENing)
     updateSockPair(assoc, localAddr, remoteAddr, localPort, remotePort);
     updateSockPair(newAssoc, keyAssoc.localAddr, keyAssoc.remoteAddr, keyAssoc.localPort, keyAssoc.remotePort);
@@ -769,8 +736,6 @@ void SCTP::addForkedAssociation(SCTPAssociation *assoc, SCTPAssociation *newAsso
 
 void SCTP::removeAssociation(SCTPAssociation *assoc)
 {
-    bool            ok = false;
-    bool            find = false;
     const int32 id = assoc->assocId;
 
     sctpEV3 << "Deleting SCTP connection " << assoc << " id= "<< id << endl;
@@ -783,45 +748,29 @@ void SCTP::removeAssociation(SCTPAssociation *assoc)
             assocStatMapIterator->second.lifeTime = assocStatMapIterator->second.stop - assocStatMapIterator->second.start;
             assocStatMapIterator->second.throughput = assocStatMapIterator->second.ackedBytes*8 / assocStatMapIterator->second.lifeTime.dbl();
         }
-        while (!ok) {
-            if (sizeAssocMap == 0) {
-                ok = true;
-            }
-            else {
-                for (SctpAssocMap::iterator sctpAssocMapIterator = sctpAssocMap.begin();
-                      sctpAssocMapIterator != sctpAssocMap.end(); sctpAssocMapIterator++) {
-                    if (sctpAssocMapIterator->second != NULL) {
-                        SCTPAssociation* myAssoc = sctpAssocMapIterator->second;
-                        if (myAssoc->assocId == assoc->assocId) {
-                            if (myAssoc->T1_InitTimer) {
-                                myAssoc->stopTimer(myAssoc->T1_InitTimer);
-                            }
-                            if (myAssoc->T2_ShutdownTimer) {
-                                myAssoc->stopTimer(myAssoc->T2_ShutdownTimer);
-                            }
-                            if (myAssoc->T5_ShutdownGuardTimer) {
-                                myAssoc->stopTimer(myAssoc->T5_ShutdownGuardTimer);
-                            }
-                            if (myAssoc->SackTimer) {
-                                myAssoc->stopTimer(myAssoc->SackTimer);
-                            }
-                            if (myAssoc->StartAddIP) {
-                                myAssoc->stopTimer(myAssoc->StartAddIP);
-                            }
-                            sctpAssocMap.erase(sctpAssocMapIterator);
-                            sizeAssocMap--;
-                            find = true;
-                            break;
-                        }
-                    }
+        // entries are moved from the end of the table into removed ones,
+        // so scanning backwards visits every entry once
+        for (int32 i = sctpAssocMap.size() - 1; i >= 0; i--) {
+            const SctpAssocMap::Entry& entry = sctpAssocMap.getEntry(i);
+            SCTPAssociation* myAssoc = entry.value;
+            if (myAssoc != NULL && myAssoc->assocId == assoc->assocId) {
+                if (myAssoc->T1_InitTimer) {
+                    myAssoc->stopTimer(myAssoc->T1_InitTimer);
                 }
-            }
-
-            if (!find) {
-                ok = true;
-            }
-            else {
-                find = false;
+                if (myAssoc->T2_ShutdownTimer) {
+                    myAssoc->stopTimer(myAssoc->T2_ShutdownTimer);
+                }
+                if (myAssoc->T5_ShutdownGuardTimer) {
+                    myAssoc->stopTimer(myAssoc->T5_ShutdownGuardTimer);
+                }
+                if (myAssoc->SackTimer) {
+                    myAssoc->stopTimer(myAssoc->SackTimer);
+                }
+                if (myAssoc->StartAddIP) {
+                    myAssoc->stopTimer(myAssoc->StartAddIP);
+                }
+                sctpAssocMap.remove(entry.localAddr, entry.remoteAddr, entry.localPort, entry.remotePort);
+                sizeAssocMap--;
             }
         }
     }
@@ -899,11 +848,8 @@ SCTPAssociation* SCTP::getAssoc(int32 assocId)
 
 void SCTP::finish()
 {
-    SctpAssocMap::iterator assocMapIterator = sctpAssocMap.begin();
-    while (assocMapIterator != sctpAssocMap.end()) {
-        removeAssociation(assocMapIterator->second);
-        assocMapIterator = sctpAssocMap.begin();
-    }
+    while (sctpAssocMap.size() > 0)
+        removeAssociation(sctpAssocMap.getEntry(0).value);
     EV << getFullPath() << ": finishing SCTP with "
         << sctpAssocMap.size() << " connections open." << endl;
 
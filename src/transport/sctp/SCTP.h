@@ -28,6 +28,7 @@
 #include "INETDefs.h"
 
 #include "IPvXAddress.h"
+#include "SocketPairTable.h"
 #include "UDPSocket.h"
 
 #define SCTP_UDP_PORT  9899
@@ -172,7 +173,7 @@ class INET_API SCTP : public cSimpleModule
 
 
         typedef std::map<AppAssocKey,SCTPAssociation*> SctpAppAssocMap;
-        typedef std::map<SockPair,SCTPAssociation*> SctpAssocMap;
+        typedef SocketPairTable<SCTPAssociation*> SctpAssocMap;  // hashed; unspecified port is 0
 
         SctpAppAssocMap sctpAppAssocMap;
         SctpAssocMap sctpAssocMap;
@@ -210,6 +211,7 @@ class INET_API SCTP : public cSimpleModule
         uint64 numPktDropReports;
 
     public:
+        SCTP() : sctpAssocMap(0, NULL) {}
         virtual ~SCTP();
         virtual void initialize();
         virtual void handleMessage(cMessage *msg);
@@ -93,10 +93,14 @@ void TCP::initialize(int stage)
         lastEphemeralPort = EPHEMERAL_PORTRANGE_START;
         WATCH(lastEphemeralPort);
 
-        WATCH_PTRMAP(tcpConnMap);
+        WATCH(tcpConnMap);
         WATCH_PTRMAP(tcpAppConnMap);
 
         recordStatistics = par("recordStats");
+        useLazyTimers = par("lazyTimers");
+        recordTimerStatistics = par("recordTimerStats");
+        numTimerInsertions = numTimerRemovals = 0;
+        numBytesAcked = 0;
 
         cModule *netw = simulation.getSystemModule();
         testing = netw->hasPar("testing") && netw->par("testing").boolValue();
@@ -302,45 +306,10 @@ void TCP::updateDisplayString()
 
 TCPConnection *TCP::findConnForSegment(TCPSegment *tcpseg, IPvXAddress srcAddr, IPvXAddress destAddr)
 {
-    SockPair key;
-    key.localAddr = destAddr;
-    key.remoteAddr = srcAddr;
-    key.localPort = tcpseg->getDestPort();
-    key.remotePort = tcpseg->getSrcPort();
-    SockPair save = key;
-
-    // try with fully qualified SockPair
-    TcpConnMap::iterator i;
-    i = tcpConnMap.find(key);
-
-    if (i != tcpConnMap.end())
-        return i->second;
-
-    // try with localAddr missing (only localPort specified in passive/active open)
-    key.localAddr = IPvXAddress();
-    i = tcpConnMap.find(key);
-
-    if (i != tcpConnMap.end())
-        return i->second;
-
-    // try fully qualified local socket + blank remote socket (for incoming SYN)
-    key = save;
-    key.remoteAddr = IPvXAddress();
-    key.remotePort = -1;
-    i = tcpConnMap.find(key);
-
-    if (i != tcpConnMap.end())
-        return i->second;
-
-    // try with blank remote socket, and localAddr missing (for incoming SYN)
-    key.localAddr = IPvXAddress();
-    i = tcpConnMap.find(key);
-
-    if (i != tcpConnMap.end())
-        return i->second;
-
-    // given up
-    return NULL;
+    // tries the fully qualified socket pair, then localAddr missing (only localPort
+    // specified in passive/active open), then blank remote socket with and without
+    // localAddr (listening connections, for incoming SYN)
+    return tcpConnMap.findForPacket(destAddr, srcAddr, tcpseg->getDestPort(), tcpseg->getSrcPort());
 }
 
 TCPConnection *TCP::findConnForApp(int appGateIndex, int connId)
@@ -378,15 +347,13 @@ ushort TCP::getEphemeralPort()
 void TCP::addSockPair(TCPConnection *conn, IPvXAddress localAddr, IPvXAddress remoteAddr, int localPort, int remotePort)
 {
     // update addresses/ports in TCPConnection
-    SockPair key;
-    key.localAddr = conn->localAddr = localAddr;
-    key.remoteAddr = conn->remoteAddr = remoteAddr;
-    key.localPort = conn->localPort = localPort;
-    key.remotePort = conn->remotePort = remotePort;
-
-    // make sure connection is unique
-    TcpConnMap::iterator it = tcpConnMap.find(key);
-    if (it != tcpConnMap.end())
+    conn->localAddr = localAddr;
+    conn->remoteAddr = remoteAddr;
+    conn->localPort = localPort;
+    conn->remotePort = remotePort;
+
+    // insert it into tcpConnMap, making sure connection is unique
+    if (!tcpConnMap.insert(localAddr, remoteAddr, localPort, remotePort, conn))
     {
         // throw "address already in use" error
         if (remoteAddr.isUnspecified() && remotePort == -1)
@@ -397,9 +364,6 @@ void TCP::addSockPair(TCPConnection *conn, IPvXAddress localAddr, IPvXAddress re
                   localAddr.str().c_str(), localPort, remoteAddr.str().c_str(), remotePort);
     }
 
-    // then insert it into tcpConnMap
-    tcpConnMap[key] = conn;
-
     // mark port as used
     if (localPort >= EPHEMERAL_PORTRANGE_START && localPort < EPHEMERAL_PORTRANGE_END)
         usedEphemeralPorts.insert(localPort);
@@ -408,24 +372,17 @@ void TCP::addSockPair(TCPConnection *conn, IPvXAddress localAddr, IPvXAddress re
 void TCP::updateSockPair(TCPConnection *conn, IPvXAddress localAddr, IPvXAddress remoteAddr, int localPort, int remotePort)
 {
     // find with existing address/port pair...
-    SockPair key;
-    key.localAddr = conn->localAddr;
-    key.remoteAddr = conn->remoteAddr;
-    key.localPort = conn->localPort;
-    key.remotePort = conn->remotePort;
-    TcpConnMap::iterator it = tcpConnMap.find(key);
-
-    ASSERT(it != tcpConnMap.end() && it->second == conn);
+    ASSERT(tcpConnMap.find(conn->localAddr, conn->remoteAddr, conn->localPort, conn->remotePort) == conn);
 
     // ...and remove from the old place in tcpConnMap
-    tcpConnMap.erase(it);
+    tcpConnMap.remove(conn->localAddr, conn->remoteAddr, conn->localPort, conn->remotePort);
 
     // then update addresses/ports, and re-insert it with new key into tcpConnMap
-    key.localAddr = conn->localAddr = localAddr;
-    key.remoteAddr = conn->remoteAddr = remoteAddr;
+    conn->localAddr = localAddr;
+    conn->remoteAddr = remoteAddr;
     ASSERT(conn->localPort == localPort);
-    key.remotePort = conn->remotePort = remotePort;
-    tcpConnMap[key] = conn;
+    conn->remotePort = remotePort;
+    tcpConnMap.set(localAddr, remoteAddr, localPort, remotePort, conn);
 
     // localPort doesn't change (see ASSERT above), so there's no need to update usedEphemeralPorts[].
 }
@@ -459,12 +416,7 @@ void TCP::removeConnection(TCPConnection *conn)
     key.connId = conn->connId;
     tcpAppConnMap.erase(key);
 
-    SockPair key2;
-    key2.localAddr = conn->localAddr;
-    key2.remoteAddr = conn->remoteAddr;
-    key2.localPort = conn->localPort;
-    key2.remotePort = conn->remotePort;
-    tcpConnMap.erase(key2);
+    tcpConnMap.remove(conn->localAddr, conn->remoteAddr, conn->localPort, conn->remotePort);
 
     // IMPORTANT: usedEphemeralPorts.erase(conn->localPort) is NOT GOOD because it
     // deletes ALL occurrences of the port from the multiset.
@@ -479,6 +431,13 @@ void TCP::removeConnection(TCPConnection *conn)
 void TCP::finish()
 {
     tcpEV << getFullPath() << ": finishing with " << tcpConnMap.size() << " connections open.\n";
+
+    if (recordTimerStatistics && numBytesAcked > 0)
+    {
+        recordScalar("timer FES insertions", numTimerInsertions);
+        recordScalar("timer FES removals", numTimerRemovals);
+        recordScalar("timer FES operations per MB", (numTimerInsertions + numTimerRemovals) / (numBytesAcked / 1e6));
+    }
 }
 
 TCPSendQueue* TCP::createSendQueue(TCPDataTransferMode transferModeP)
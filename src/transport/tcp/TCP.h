@@ -26,6 +26,7 @@
 
 #include "ILifecycle.h"
 #include "IPvXAddress.h"
+#include "SocketPairTable.h"
 #include "TCPCommand_m.h"
 
 // Forward declarations:
@@ -139,7 +140,7 @@ class INET_API TCP : public cSimpleModule, public ILifecycle
 
   protected:
     typedef std::map<AppConnKey, TCPConnection*> TcpAppConnMap;
-    typedef std::map<SockPair, TCPConnection*> TcpConnMap;
+    typedef SocketPairTable<TCPConnection*> TcpConnMap;  // hashed; unspecified port is -1
 
     TcpAppConnMap tcpAppConnMap;
     TcpConnMap tcpConnMap;
@@ -163,10 +164,17 @@ class INET_API TCP : public cSimpleModule, public ILifecycle
     static bool logverbose; // if !testing, turns on more verbose logging
 
     bool recordStatistics;  // output vectors on/off
+    bool useLazyTimers;     // see TCPBaseAlg::startTimer()
+    bool recordTimerStatistics; // timer FES operation scalars on/off
+
+    // future event set operations of the TCPBaseAlg timers, for comparing lazy and eager timers
+    long numTimerInsertions;
+    long numTimerRemovals;
+    uint64 numBytesAcked;
     bool isOperational;     // lifecycle: node is up/down
 
   public:
-    TCP() {}
+    TCP() : tcpConnMap(-1, NULL) {}
     virtual ~TCP();
 
   protected:
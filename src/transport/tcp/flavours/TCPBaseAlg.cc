@@ -96,6 +96,7 @@ TCPBaseAlg::TCPBaseAlg() : TCPAlgorithm(),
         state((TCPBaseAlgStateVariables *&)TCPAlgorithm::state)
 {
     rexmitTimer = persistTimer = delayedAckTimer = keepAliveTimer = NULL;
+    rexmitDeadline = persistDeadline = delayedAckDeadline = -1;
     cwndVector = ssthreshVector = rttVector = srttVector = rttvarVector = rtoVector = numRtosVector = NULL;
 }
 
@@ -208,16 +209,71 @@ void TCPBaseAlg::connectionClosed()
     cancelEvent(persistTimer);
     cancelEvent(delayedAckTimer);
     cancelEvent(keepAliveTimer);
+    rexmitDeadline = persistDeadline = delayedAckDeadline = -1;
+}
+
+void TCPBaseAlg::startTimer(cMessage *timer, simtime_t& deadline, simtime_t timeout)
+{
+    TCP *tcpMain = conn->getTcpMain();
+    deadline = simTime() + timeout;
+    if (timer->isScheduled())
+    {
+        if (tcpMain->useLazyTimers && timer->getArrivalTime() <= deadline)
+            return;  // will be moved to the deadline when it fires
+        cancelEvent(timer);
+        tcpMain->numTimerRemovals++;
+    }
+    tcpMain->scheduleAt(deadline, timer);
+    tcpMain->numTimerInsertions++;
+}
+
+void TCPBaseAlg::stopTimer(cMessage *timer, simtime_t& deadline)
+{
+    TCP *tcpMain = conn->getTcpMain();
+    deadline = -1;
+    if (timer->isScheduled() && !tcpMain->useLazyTimers)
+    {
+        cancelEvent(timer);
+        tcpMain->numTimerRemovals++;
+    }
+}
+
+bool TCPBaseAlg::checkTimerExpired(cMessage *timer, simtime_t& deadline)
+{
+    if (!isTimerRunning(deadline))
+    {
+        tcpEV << timer->getName() << " timer was stopped, ignoring it\n";
+        return false;
+    }
+    if (deadline > simTime())
+    {
+        tcpEV << timer->getName() << " timer was restarted, moving it to t=" << deadline << "\n";
+        TCP *tcpMain = conn->getTcpMain();
+        tcpMain->scheduleAt(deadline, timer);
+        tcpMain->numTimerInsertions++;
+        return false;
+    }
+    deadline = -1;
+    return true;
 }
 
 void TCPBaseAlg::processTimer(cMessage *timer, TCPEventCode& event)
 {
     if (timer == rexmitTimer)
-        processRexmitTimer(event);
+    {
+        if (checkTimerExpired(rexmitTimer, rexmitDeadline))
+            processRexmitTimer(event);
+    }
     else if (timer == persistTimer)
-        processPersistTimer(event);
+    {
+        if (checkTimerExpired(persistTimer, persistDeadline))
+            processPersistTimer(event);
+    }
     else if (timer == delayedAckTimer)
-        processDelayedAckTimer(event);
+    {
+        if (checkTimerExpired(delayedAckTimer, delayedAckDeadline))
+            processDelayedAckTimer(event);
+    }
     else if (timer == keepAliveTimer)
         processKeepAliveTimer(event);
     else
@@ -261,7 +317,7 @@ void TCPBaseAlg::processRexmitTimer(TCPEventCode& event)
     if (state->rexmit_timeout > MAX_REXMIT_TIMEOUT)
         state->rexmit_timeout = MAX_REXMIT_TIMEOUT;
 
-    conn->scheduleTimeout(rexmitTimer, state->rexmit_timeout);
+    startTimer(rexmitTimer, rexmitDeadline, state->rexmit_timeout);
 
     tcpEV << " to " << state->rexmit_timeout << "s, and cancelling RTT measurement\n";
 
@@ -327,7 +383,7 @@ void TCPBaseAlg::processPersistTimer(TCPEventCode& event)
     if (state->persist_timeout > MAX_PERSIST_TIMEOUT)
         state->rexmit_timeout = MAX_PERSIST_TIMEOUT;
 
-    conn->scheduleTimeout(persistTimer, state->persist_timeout);
+    startTimer(persistTimer, persistDeadline, state->persist_timeout);
 
     // sending persist probe
     conn->sendProbe();
@@ -362,7 +418,7 @@ void TCPBaseAlg::startRexmitTimer()
     state->rexmit_count = 0;
 
     // schedule timer
-    conn->scheduleTimeout(rexmitTimer, state->rexmit_timeout);
+    startTimer(rexmitTimer, rexmitDeadline, state->rexmit_timeout);
 }
 
 void TCPBaseAlg::rttMeasurementComplete(simtime_t tSent, simtime_t tAcked)
@@ -491,7 +547,7 @@ void TCPBaseAlg::receivedOutOfOrderSegment()
 void TCPBaseAlg::receiveSeqChanged()
 {
     // If we send a data segment already (with the updated seqNo) there is no need to send an additional ACK
-    if (state->full_sized_segment_counter == 0 && !state->ack_now && state->last_ack_sent == state->rcv_nxt && !delayedAckTimer->isScheduled()) // ackSent?
+    if (state->full_sized_segment_counter == 0 && !state->ack_now && state->last_ack_sent == state->rcv_nxt && !isTimerRunning(delayedAckDeadline)) // ackSent?
     {
         // tcpEV << "ACK has already been sent (possibly piggybacked on data)\n";
     }
@@ -527,8 +583,8 @@ void TCPBaseAlg::receiveSeqChanged()
             else
             {
                 tcpEV << "rcv_nxt changed to " << state->rcv_nxt << ", (delayed ACK enabled and full_sized_segment_counter=" << state->full_sized_segment_counter << ") scheduling ACK\n";
-                if (!delayedAckTimer->isScheduled()) // schedule delayed ACK timer if not already running
-                    conn->scheduleTimeout(delayedAckTimer, DELAYED_ACK_TIMEOUT);
+                if (!isTimerRunning(delayedAckDeadline)) // schedule delayed ACK timer if not already running
+                    startTimer(delayedAckTimer, delayedAckDeadline, DELAYED_ACK_TIMEOUT);
             }
         }
     }
@@ -536,6 +592,8 @@ void TCPBaseAlg::receiveSeqChanged()
 
 void TCPBaseAlg::receivedDataAck(uint32 firstSeqAcked)
 {
+    conn->getTcpMain()->numBytesAcked += state->snd_una - firstSeqAcked;
+
     if (!state->ts_enabled)
     {
         // if round-trip time measurement is running, check if rtseq has been acked
@@ -559,10 +617,10 @@ void TCPBaseAlg::receivedDataAck(uint32 firstSeqAcked)
     //
     if (state->snd_una == state->snd_max)
     {
-        if (rexmitTimer->isScheduled())
+        if (isTimerRunning(rexmitDeadline))
         {
             tcpEV << "ACK acks all outstanding segments, cancel REXMIT timer\n";
-            cancelEvent(rexmitTimer);
+            stopTimer(rexmitTimer, rexmitDeadline);
         }
         else
             tcpEV << "There were no outstanding segments, nothing new in this ACK.\n";
@@ -572,7 +630,6 @@ void TCPBaseAlg::receivedDataAck(uint32 firstSeqAcked)
         tcpEV << "ACK acks some but not all outstanding segments ("
               << (state->snd_max - state->snd_una) << " bytes outstanding), "
               << "restarting REXMIT timer\n";
-        cancelEvent(rexmitTimer);
         startRexmitTimer();
     }
 
@@ -587,12 +644,12 @@ void TCPBaseAlg::receivedDataAck(uint32 firstSeqAcked)
     //
     if (state->snd_wnd == 0) // received zero-sized window?
     {
-        if (rexmitTimer->isScheduled())
+        if (isTimerRunning(rexmitDeadline))
         {
-            if (persistTimer->isScheduled())
+            if (isTimerRunning(persistDeadline))
             {
                 tcpEV << "Received zero-sized window and REXMIT timer is running therefore PERSIST timer is canceled.\n";
-                cancelEvent(persistTimer);
+                stopTimer(persistTimer, persistDeadline);
                 state->persist_factor = 0;
             }
             else
@@ -600,10 +657,10 @@ void TCPBaseAlg::receivedDataAck(uint32 firstSeqAcked)
         }
         else
         {
-            if (!persistTimer->isScheduled())
+            if (!isTimerRunning(persistDeadline))
             {
                 tcpEV << "Received zero-sized window therefore PERSIST timer is started.\n";
-                conn->scheduleTimeout(persistTimer, state->persist_timeout);
+                startTimer(persistTimer, persistDeadline, state->persist_timeout);
             }
             else
                 tcpEV << "Received zero-sized window and PERSIST timer is already running.\n";
@@ -611,10 +668,10 @@ void TCPBaseAlg::receivedDataAck(uint32 firstSeqAcked)
     }
     else // received non zero-sized window?
     {
-        if (persistTimer->isScheduled())
+        if (isTimerRunning(persistDeadline))
         {
             tcpEV << "Received non zero-sized window therefore PERSIST timer is canceled.\n";
-            cancelEvent(persistTimer);
+            stopTimer(persistTimer, persistDeadline);
             state->persist_factor = 0;
         }
     }
@@ -662,14 +719,14 @@ void TCPBaseAlg::ackSent()
     state->ack_now = false; // reset flag
     state->last_ack_sent = state->rcv_nxt; // update last_ack_sent, needed for TS option
     // if delayed ACK timer is running, cancel it
-    if (delayedAckTimer->isScheduled())
-        cancelEvent(delayedAckTimer);
+    if (isTimerRunning(delayedAckDeadline))
+        stopTimer(delayedAckTimer, delayedAckDeadline);
 }
 
 void TCPBaseAlg::dataSent(uint32 fromseq)
 {
     // if retransmission timer not running, schedule it
-    if (!rexmitTimer->isScheduled())
+    if (!isTimerRunning(rexmitDeadline))
     {
         tcpEV << "Starting REXMIT timer\n";
         startRexmitTimer();
@@ -696,8 +753,5 @@ void TCPBaseAlg::segmentRetransmitted(uint32 fromseq, uint32 toseq)
 
 void TCPBaseAlg::restartRexmitTimer()
 {
-    if (rexmitTimer->isScheduled())
-        cancelEvent(rexmitTimer);
-
     startRexmitTimer();
 }
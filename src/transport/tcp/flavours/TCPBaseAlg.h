@@ -110,6 +110,11 @@ class INET_API TCPBaseAlg : public TCPAlgorithm
     cMessage *delayedAckTimer;
     cMessage *keepAliveTimer;
 
+    // expiry times of the REXMIT, PERSIST and DELAYED-ACK timers; -1 if not running
+    simtime_t rexmitDeadline;
+    simtime_t persistDeadline;
+    simtime_t delayedAckDeadline;
+
     cOutVector *cwndVector;  // will record changes to snd_cwnd
     cOutVector *ssthreshVector; // will record changes to ssthresh
     cOutVector *rttVector;   // will record measured RTT
@@ -153,6 +158,33 @@ class INET_API TCPBaseAlg : public TCPAlgorithm
     /** Utility function */
     cMessage *cancelEvent(cMessage *msg) {return conn->getTcpMain()->cancelEvent(msg);}
 
+    /** @name Timers with deadlines (REXMIT, PERSIST, DELAYED-ACK) */
+    //@{
+    /**
+     * Starts or restarts the timer to expire after the given timeout. With
+     * lazy timers (the "lazyTimers" parameter of TCP), a timer that is already
+     * scheduled to expire not later than the new deadline is left in the
+     * future event set; checkTimerExpired() moves it when it fires early.
+     */
+    virtual void startTimer(cMessage *timer, simtime_t& deadline, simtime_t timeout);
+
+    /**
+     * Stops the timer. Lazy timers are only marked as stopped, and are
+     * ignored when they fire.
+     */
+    virtual void stopTimer(cMessage *timer, simtime_t& deadline);
+
+    /** Returns true if the timer is running, i.e. it has a deadline */
+    bool isTimerRunning(const simtime_t& deadline) const {return deadline >= SIMTIME_ZERO;}
+
+    /**
+     * To be called when the timer fires. Returns true if the timer has really
+     * expired; otherwise it was stopped or restarted lazily, and it is
+     * rescheduled for its deadline if needed.
+     */
+    virtual bool checkTimerExpired(cMessage *timer, simtime_t& deadline);
+    //@}
+
   public:
     /**
      * Ctor.
@@ -43,19 +43,20 @@ bool TCPByteStreamRcvQueue::Region::merge(const TCPVirtualDataRcvQueue::Region*
 
     if (nbegin != begin || nend != end)
     {
-        char *buff = new char[nend-nbegin];
+        // concatenate slices of the byte arrays, without copying the bytes
+        ByteArray ndata;
 
         if (nbegin != begin)
-            other->data.copyDataToBuffer(buff, begin - nbegin);
+            ndata.addDataFromByteArray(other->data, 0, begin - nbegin);
 
-        data.copyDataToBuffer(buff + begin - nbegin, end - begin);
+        ndata.addDataFromByteArray(data, 0, end - begin);
 
         if (nend != end)
-            other->data.copyDataToBuffer(buff + end - nbegin, nend - end);
+            ndata.addDataFromByteArray(other->data, end - other->begin, nend - end);
 
         begin = nbegin;
         end = nend;
-        data.assignBuffer(buff, end - begin);
+        data = ndata;
     }
 
     return true;
@@ -51,6 +51,7 @@ std::string Sack::str() const
 }
 
 Register_Class(TCPSegment);
+Define_ObjectPool(TCPSegment);
 
 
 uint32_t TCPSegment::getSegLen()
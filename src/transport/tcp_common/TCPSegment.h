@@ -22,6 +22,7 @@
 #include <list>
 #include "INETDefs.h"
 #include "TCPSegment_m.h"
+#include "ObjectPool.h"
 
 
 /** @name Comparing sequence numbers */
@@ -73,6 +74,7 @@ class INET_API TCPSegment : public TCPSegment_Base
     virtual TCPSegment *dup() const {return new TCPSegment(*this);}
     virtual void parsimPack(cCommBuffer *b);
     virtual void parsimUnpack(cCommBuffer *b);
+    INET_POOLED_ALLOCATION(TCPSegment);
 
     /** Generated but unused method, should not be called. */
     virtual void setPayloadArraySize(unsigned int size);
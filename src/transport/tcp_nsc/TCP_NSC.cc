@@ -148,7 +148,9 @@ static std::ostream& operator<<(std::ostream& osP, const TCP_NSC_Connection::Soc
 }
 
 TCP_NSC::TCP_NSC()
-  : pStackM(NULL),
+  : inetSockPair2ConnIdMapM((unsigned short)-1, -1),
+    nscSockPair2ConnIdMapM((unsigned short)-1, -1),
+    pStackM(NULL),
     pNsiTimerM(NULL),
     isAliveM(false),
     curAddrCounterM(0),
@@ -299,20 +301,20 @@ void TCP_NSC::changeAddresses(TCP_NSC_Connection &connP,
     if (!(connP.inetSockPairM == inetSockPairP))
     {
         tcpEV << "conn:" << connP << " change inetMap from " << connP.inetSockPairM << " to " << inetSockPairP << "\n";
-        inetSockPair2ConnIdMapM.erase(connP.inetSockPairM);
+        removeSockPair(inetSockPair2ConnIdMapM, connP.inetSockPairM);
         connP.inetSockPairM = inetSockPairP;
-        inetSockPair2ConnIdMapM[connP.inetSockPairM] = connP.connIdM;
+        setSockPair(inetSockPair2ConnIdMapM, connP.inetSockPairM, connP.connIdM);
     }
 
     if (!(connP.nscSockPairM == nscSockPairP))
     {
         tcpEV << "conn:" << connP << " change nscMap from " << connP.nscSockPairM << " to " << nscSockPairP << "\n";
         // remove old from map:
-        nscSockPair2ConnIdMapM.erase(connP.nscSockPairM);
+        removeSockPair(nscSockPair2ConnIdMapM, connP.nscSockPairM);
         // change addresses:
         connP.nscSockPairM = nscSockPairP;
         // and add to map:
-        nscSockPair2ConnIdMapM[connP.nscSockPairM] = connP.connIdM;
+        setSockPair(nscSockPair2ConnIdMapM, connP.nscSockPairM, connP.connIdM);
     }
 }
 
@@ -713,16 +715,30 @@ TCP_NSC_Connection *TCP_NSC::findAppConn(int connIdP)
     return i == tcpAppConnMapM.end() ? NULL : &(i->second);
 }
 
+void TCP_NSC::setSockPair(SockPair2ConnIdMap& mapP, TCP_NSC_Connection::SockPair const & sockPairP, int connIdP)
+{
+    mapP.set(sockPairP.localM.ipAddrM, sockPairP.remoteM.ipAddrM, sockPairP.localM.portM, sockPairP.remoteM.portM, connIdP);
+}
+
+void TCP_NSC::removeSockPair(SockPair2ConnIdMap& mapP, TCP_NSC_Connection::SockPair const & sockPairP)
+{
+    mapP.remove(sockPairP.localM.ipAddrM, sockPairP.remoteM.ipAddrM, sockPairP.localM.portM, sockPairP.remoteM.portM);
+}
+
+TCP_NSC_Connection *TCP_NSC::findConnBySockPair(SockPair2ConnIdMap& mapP, TCP_NSC_Connection::SockPair const & sockPairP)
+{
+    int connId = mapP.find(sockPairP.localM.ipAddrM, sockPairP.remoteM.ipAddrM, sockPairP.localM.portM, sockPairP.remoteM.portM);
+    return connId == -1 ? NULL : findAppConn(connId);
+}
+
 TCP_NSC_Connection *TCP_NSC::findConnByInetSockPair(TCP_NSC_Connection::SockPair const & sockPairP)
 {
-    SockPair2ConnIdMap::iterator i = inetSockPair2ConnIdMapM.find(sockPairP);
-    return i == inetSockPair2ConnIdMapM.end() ? NULL : findAppConn(i->second);
+    return findConnBySockPair(inetSockPair2ConnIdMapM, sockPairP);
 }
 
 TCP_NSC_Connection *TCP_NSC::findConnByNscSockPair(TCP_NSC_Connection::SockPair const & sockPairP)
 {
-    SockPair2ConnIdMap::iterator i = nscSockPair2ConnIdMapM.find(sockPairP);
-    return i == nscSockPair2ConnIdMapM.end() ? NULL : findAppConn(i->second);
+    return findConnBySockPair(nscSockPair2ConnIdMapM, sockPairP);
 }
 
 void TCP_NSC::finish()
@@ -34,6 +34,7 @@
 
 #include "ILifecycle.h"
 #include "IPvXAddress.h"
+#include "SocketPairTable.h"
 #include "TCPCommand_m.h"
 #include "TCP_NSC_Connection.h"
 
@@ -145,13 +146,19 @@ class INET_API TCP_NSC : public cSimpleModule, ISendCallback, IInterruptCallback
     typedef std::map<int,TCP_NSC_Connection> TcpAppConnMap; // connId-to-TCP_NSC_Connection
     typedef std::map<u_int32_t, IPvXAddress> Nsc2RemoteMap;
     typedef std::map<IPvXAddress, u_int32_t> Remote2NscMap;
-    typedef std::map<TCP_NSC_Connection::SockPair, int> SockPair2ConnIdMap;
+    typedef SocketPairTable<int> SockPair2ConnIdMap;  // hashed; unspecified port is (unsigned short)-1
 
     // Maps:
     TcpAppConnMap tcpAppConnMapM;
+    // socket pair to connId; -1: not found
     SockPair2ConnIdMap inetSockPair2ConnIdMapM;
     SockPair2ConnIdMap nscSockPair2ConnIdMapM;
 
+    // add/replace, remove and look up a SockPair in one of the maps above
+    void setSockPair(SockPair2ConnIdMap& mapP, TCP_NSC_Connection::SockPair const & sockPairP, int connIdP);
+    void removeSockPair(SockPair2ConnIdMap& mapP, TCP_NSC_Connection::SockPair const & sockPairP);
+    TCP_NSC_Connection *findConnBySockPair(SockPair2ConnIdMap& mapP, TCP_NSC_Connection::SockPair const & sockPairP);
+
     Nsc2RemoteMap nsc2RemoteMapM;
     Remote2NscMap remote2NscMapM;
 
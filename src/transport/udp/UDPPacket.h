@@ -15,5 +15,27 @@
 // along with this program; if not, see <http://www.gnu.org/licenses/>.
 //
 
+#ifndef __INET_UDPPACKET_H
+#define __INET_UDPPACKET_H
+
 #include "UDPPacket_m.h"
+#include "ObjectPool.h"
+
+/**
+ * Represents an UDP packet. More info in the UDPPacket.msg file
+ * (and the documentation generated from it).
+ */
+class INET_API UDPPacket : public UDPPacket_Base
+{
+  public:
+    UDPPacket(const char *name = NULL, int kind = 0) : UDPPacket_Base(name, kind) {}
+    UDPPacket(const UDPPacket& other) : UDPPacket_Base(other) {}
+    UDPPacket& operator=(const UDPPacket& other) {UDPPacket_Base::operator=(other); return *this;}
+
+    virtual UDPPacket *dup() const {return new UDPPacket(*this);}
+
+    INET_POOLED_ALLOCATION(UDPPacket);
+};
+
+#endif
 
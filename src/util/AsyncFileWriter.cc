@@ -0,0 +1,210 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include <errno.h>
+#include <exception>
+
+#include "AsyncFileWriter.h"
+
+
+AsyncFileWriter::AsyncFileWriter()
+{
+    file = NULL;
+    bufferSize = 0;
+#ifdef HAVE_PTHREAD
+    useThread = false;
+    backBufferFull = false;
+    shutdown = false;
+#endif
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (std::exception& e)
+    {
+        // destructors must not throw
+    }
+}
+
+void AsyncFileWriter::open(const char *fileName, bool useThread, size_t bufferSize)
+{
+    if (file)
+        throw cRuntimeError("Cannot open file [%s]: file [%s] is still open", fileName, this->fileName.c_str());
+
+    file = fopen(fileName, "wb");
+    if (!file)
+        throw cRuntimeError("Cannot open file [%s] for writing: %s", fileName, strerror(errno));
+
+    this->fileName = fileName;
+    this->bufferSize = bufferSize;
+    frontBuffer.clear();
+    frontBuffer.reserve(bufferSize);
+    backBuffer.clear();
+    backBuffer.reserve(bufferSize);
+    errorMessage.clear();
+
+#ifdef HAVE_PTHREAD
+    this->useThread = useThread;
+    backBufferFull = false;
+    shutdown = false;
+    if (useThread)
+    {
+        pthread_mutex_init(&mutex, NULL);
+        pthread_cond_init(&condition, NULL);
+        if (pthread_create(&thread, NULL, writerMain, this) != 0)
+        {
+            // write from the caller instead
+            pthread_cond_destroy(&condition);
+            pthread_mutex_destroy(&mutex);
+            this->useThread = false;
+        }
+    }
+#endif
+}
+
+#ifdef HAVE_PTHREAD
+void *AsyncFileWriter::writerMain(void *arg)
+{
+    static_cast<AsyncFileWriter *>(arg)->writerLoop();
+    return NULL;
+}
+
+void AsyncFileWriter::writerLoop()
+{
+    pthread_mutex_lock(&mutex);
+    while (true)
+    {
+        while (!backBufferFull && !shutdown)
+            pthread_cond_wait(&condition, &mutex);
+        if (!backBufferFull)
+            break;  // shut down, and everything is written
+        pthread_mutex_unlock(&mutex);
+
+        writeToFile(backBuffer);
+
+        pthread_mutex_lock(&mutex);
+        backBufferFull = false;
+        pthread_cond_broadcast(&condition);
+    }
+    pthread_mutex_unlock(&mutex);
+}
+#endif
+
+void AsyncFileWriter::writeToFile(const std::vector<uint8>& buffer)
+{
+    // called by the writer thread only while the caller does not touch the buffer or errorMessage
+    if (!buffer.empty() && fwrite(&buffer[0], 1, buffer.size(), file) != buffer.size() && errorMessage.empty())
+        errorMessage = strerror(errno);
+}
+
+std::string AsyncFileWriter::handOver()
+{
+    std::string error;
+#ifdef HAVE_PTHREAD
+    if (useThread)
+    {
+        pthread_mutex_lock(&mutex);
+        while (backBufferFull)
+            pthread_cond_wait(&condition, &mutex);
+        error = errorMessage;
+        frontBuffer.swap(backBuffer);
+        backBufferFull = true;
+        pthread_cond_broadcast(&condition);
+        pthread_mutex_unlock(&mutex);
+    }
+    else
+#endif
+    {
+        writeToFile(frontBuffer);
+        error = errorMessage;
+    }
+    frontBuffer.clear();
+    return error;
+}
+
+std::string AsyncFileWriter::waitForWriter()
+{
+#ifdef HAVE_PTHREAD
+    if (useThread)
+    {
+        pthread_mutex_lock(&mutex);
+        while (backBufferFull)
+            pthread_cond_wait(&condition, &mutex);
+        std::string error = errorMessage;
+        pthread_mutex_unlock(&mutex);
+        return error;
+    }
+#endif
+    return errorMessage;
+}
+
+void AsyncFileWriter::swapBuffers()
+{
+    std::string error = handOver();
+    if (!error.empty())
+        throw cRuntimeError("Cannot write file [%s]: %s", fileName.c_str(), error.c_str());
+}
+
+void AsyncFileWriter::flush()
+{
+    if (!file)
+        return;
+    if (!frontBuffer.empty())
+        handOver();
+    std::string error = waitForWriter();
+    if (error.empty() && fflush(file) != 0)
+        error = strerror(errno);
+    if (!error.empty())
+        throw cRuntimeError("Cannot write file [%s]: %s", fileName.c_str(), error.c_str());
+}
+
+void AsyncFileWriter::close()
+{
+    if (!file)
+        return;
+
+    if (!frontBuffer.empty())
+        handOver();
+#ifdef HAVE_PTHREAD
+    if (useThread)
+    {
+        // the thread writes the back buffer before exiting
+        pthread_mutex_lock(&mutex);
+        shutdown = true;
+        pthread_cond_broadcast(&condition);
+        pthread_mutex_unlock(&mutex);
+        pthread_join(thread, NULL);
+        pthread_cond_destroy(&condition);
+        pthread_mutex_destroy(&mutex);
+        useThread = false;
+    }
+#endif
+    if (fclose(file) != 0 && errorMessage.empty())
+        errorMessage = strerror(errno);
+    file = NULL;
+    std::vector<uint8>().swap(frontBuffer);
+    std::vector<uint8>().swap(backBuffer);
+
+    if (!errorMessage.empty())
+        throw cRuntimeError("Cannot write file [%s]: %s", fileName.c_str(), errorMessage.c_str());
+}
+
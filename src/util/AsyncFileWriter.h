@@ -0,0 +1,118 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef __INET_ASYNCFILEWRITER_H
+#define __INET_ASYNCFILEWRITER_H
+
+#include <string.h>
+#include <vector>
+
+#include "INETDefs.h"
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+
+/**
+ * Writes a file through two memory buffers: the caller appends data to one
+ * of them, while a background thread writes the other one to the file with
+ * a single fwrite() call. When the caller's buffer is full, the buffers are
+ * swapped (waiting only if the thread is still busy with the previous one).
+ * Used by PcapDump, so that recording a packet costs the simulation only a
+ * copy into memory.
+ *
+ * If INET was built without pthreads (HAVE_PTHREAD undefined), or the thread
+ * is not requested, full buffers are written by the caller. The contents of
+ * the file are the same in both cases. Write errors are reported by the next
+ * write(), flush() or close() call that swaps buffers.
+ */
+class INET_API AsyncFileWriter
+{
+  protected:
+    FILE *file;
+    std::string fileName;
+    std::vector<uint8> frontBuffer;  // filled by the caller
+    std::vector<uint8> backBuffer;   // written to the file by the thread
+    size_t bufferSize;
+    std::string errorMessage;        // first write error
+#ifdef HAVE_PTHREAD
+    bool useThread;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;        // signalled when backBufferFull or shutdown changes
+    bool backBufferFull;             // true while the thread has to write the back buffer
+    bool shutdown;
+#endif
+
+  protected:
+#ifdef HAVE_PTHREAD
+    static void *writerMain(void *arg);
+    void writerLoop();
+#endif
+    void writeToFile(const std::vector<uint8>& buffer);
+    std::string handOver();       // passes the front buffer to the writer, returns the error so far
+    std::string waitForWriter();  // waits until the back buffer is written, returns the error so far
+    void swapBuffers();
+
+  private:
+    // copying not supported: following are private and also left undefined
+    AsyncFileWriter(const AsyncFileWriter& other);
+    AsyncFileWriter& operator=(const AsyncFileWriter& other);
+
+  public:
+    AsyncFileWriter();
+
+    /**
+     * Closes the file if it is open; write errors are ignored here.
+     */
+    ~AsyncFileWriter();
+
+    /**
+     * Creates the file, and starts the background thread if useThread is true.
+     * Data is passed to the file in blocks of about bufferSize bytes. Throws
+     * an exception if the file cannot be opened.
+     */
+    void open(const char *fileName, bool useThread, size_t bufferSize = 1048576);
+
+    /** Returns true if the file is open */
+    bool isOpen() const { return file != NULL; }
+
+    /** Appends data to the file */
+    void write(const void *data, size_t length)
+    {
+        const uint8 *p = (const uint8 *)data;
+        frontBuffer.insert(frontBuffer.end(), p, p + length);
+        if (frontBuffer.size() >= bufferSize)
+            swapBuffers();
+    }
+
+    /**
+     * Passes the buffered data to the file, and waits until it is written.
+     */
+    void flush();
+
+    /**
+     * Writes the buffered data, stops the thread and closes the file.
+     * Throws an exception if a write failed.
+     */
+    void close();
+};
+
+#endif
+
@@ -0,0 +1,94 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <iostream>
+
+#include "ObjectPool.h"
+
+Register_PerRunConfigOption(CFGID_INET_OBJECT_POOLS, "inet-object-pools", CFG_BOOL, "false", "Keep deleted packets and control info objects of frequently used INET classes in per-class freelists, and reuse them instead of allocating from the heap. Pool statistics are printed at exit.");
+
+ObjectPool *ObjectPool::firstPool = NULL;
+int ObjectPool::enabled = -1;
+cModule *ObjectPool::enabledNetwork = NULL;
+eventnumber_t ObjectPool::lastEventNumber = 0;
+
+ObjectPool::ObjectPool(const char *className, size_t objectSize)
+{
+    this->className = className;
+    this->objectSize = objectSize;
+    numLive = numAllocated = numReused = 0;
+    next = firstPool;
+    firstPool = this;
+}
+
+void ObjectPool::clear()
+{
+    for (size_t i = 0; i < freeList.size(); i++)
+        ::operator delete(freeList[i]);
+    freeList.clear();
+}
+
+bool ObjectPool::readEnabled()
+{
+    // the configuration is not available during static initialization
+    cConfiguration *config = ev.getConfig();
+    if (!config)
+        return false;
+    setEnabled(config->getAsBool(CFGID_INET_OBJECT_POOLS));
+    return enabled == 1;
+}
+
+void ObjectPool::setEnabled(bool value)
+{
+    enabled = value ? 1 : 0;
+    enabledNetwork = simulation.getSystemModule();
+    lastEventNumber = simulation.getEventNumber();
+    if (!value)
+        for (ObjectPool *pool = firstPool; pool; pool = pool->next)
+            pool->clear();
+}
+
+void ObjectPool::printStatistics(std::ostream& out)
+{
+    out << "Object pools:\n";
+    for (ObjectPool *pool = firstPool; pool; pool = pool->next)
+    {
+        if (pool->numAllocated == 0)
+            continue;
+        out << "  " << pool->className << ": " << pool->numLive << " live, "
+            << pool->getNumPooled() << " pooled, " << pool->numAllocated << " allocated, "
+            << pool->numReused << " reused\n";
+    }
+}
+
+/**
+ * Prints the pool statistics at exit if pooling was enabled. The pools
+ * themselves are never destroyed, so they are still valid at that time.
+ */
+class ObjectPoolStatisticsPrinter
+{
+  public:
+    ~ObjectPoolStatisticsPrinter()
+    {
+        // do not read the configuration here, it may no longer exist
+        if (ObjectPool::enabled == 1)
+            ObjectPool::printStatistics(std::cout);
+    }
+};
+
+static ObjectPoolStatisticsPrinter statisticsPrinter;
+
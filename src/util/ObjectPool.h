@@ -0,0 +1,160 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_OBJECTPOOL_H
+#define __INET_OBJECTPOOL_H
+
+#include <vector>
+
+#include "INETDefs.h"
+
+
+/**
+ * Freelist of memory blocks of one class, used to avoid the global heap
+ * for frequently created and deleted objects (packets, control info).
+ *
+ * A class opts in by putting INET_POOLED_ALLOCATION(CLASS) into the public
+ * part of its class body, and Define_ObjectPool(CLASS) into its .cc file.
+ * This defines class-specific operator new and delete (used by dup() too)
+ * that take blocks from and return them to the pool of the class. Objects
+ * of subclasses with a different size bypass the pool.
+ *
+ * Pooling is only done if the "inet-object-pools" configuration option is
+ * true; otherwise the pools only count the live objects. Blocks are always
+ * allocated with the global operator new, so objects can be deleted
+ * regardless of the setting. Pools are not thread-safe.
+ */
+class INET_API ObjectPool
+{
+  protected:
+    const char *className;
+    size_t objectSize;
+    std::vector<void *> freeList;
+    ObjectPool *next;  // next pool in the list of all pools
+
+    // statistics
+    long numLive;       // objects allocated and not yet deleted
+    long numAllocated;  // all allocations
+    long numReused;     // allocations served from the freelist
+
+    static ObjectPool *firstPool;
+    static int enabled;  // -1 until read from the configuration
+    static cModule *enabledNetwork;  // the network of the run the option was read for
+    static eventnumber_t lastEventNumber;  // the event number at the last isEnabled() call
+    static bool readEnabled();
+
+    friend class ObjectPoolStatisticsPrinter;
+
+  private:
+    // copying not supported: following are private and also left undefined
+    ObjectPool(const ObjectPool& other);
+    ObjectPool& operator=(const ObjectPool& other);
+
+  public:
+    /** The maximum number of free blocks kept in a pool */
+    static const size_t MAX_POOLED_OBJECTS = 65536;
+
+    ObjectPool(const char *className, size_t objectSize);
+
+    void *allocate(size_t size)
+    {
+        if (size != objectSize)
+            return ::operator new(size);
+        numLive++;
+        numAllocated++;
+        if (!freeList.empty())
+        {
+            void *p = freeList.back();
+            freeList.pop_back();
+            numReused++;
+            return p;
+        }
+        return ::operator new(size);
+    }
+
+    void release(void *p, size_t size)
+    {
+        if (!p)
+            return;
+        if (size == objectSize)
+        {
+            numLive--;
+            if (isEnabled() && freeList.size() < MAX_POOLED_OBJECTS)
+            {
+                freeList.push_back(p);
+                return;
+            }
+        }
+        ::operator delete(p);
+    }
+
+    const char *getClassName() const { return className; }
+    long getNumLive() const { return numLive; }
+    long getNumPooled() const { return freeList.size(); }
+    long getNumAllocated() const { return numAllocated; }
+    long getNumReused() const { return numReused; }
+
+    /** Returns the memory of the free blocks to the heap. */
+    void clear();
+
+    /**
+     * Whether pooling is enabled (the "inet-object-pools" option). The option
+     * is re-read at the start of each run: when a new network has been set up,
+     * or the event number went backwards (a rebuilt network at the same address).
+     */
+    static bool isEnabled()
+    {
+        eventnumber_t eventNumber = simulation.getEventNumber();
+        if (enabled == -1 || simulation.getSystemModule() != enabledNetwork || eventNumber < lastEventNumber)
+            readEnabled();
+        lastEventNumber = eventNumber;
+        return enabled == 1;
+    }
+
+    /** Overrides the "inet-object-pools" option for the current run. */
+    static void setEnabled(bool value);
+
+    /** Returns the pool list, for iterating with getNext(). */
+    static ObjectPool *getFirst() { return firstPool; }
+    ObjectPool *getNext() const { return next; }
+
+    /** Prints the counters of all pools that have been used. */
+    static void printStatistics(std::ostream& out);
+};
+
+/**
+ * Declares pooled allocation for the class; see ObjectPool. Must be put
+ * into a public section of the class.
+ */
+#define INET_POOLED_ALLOCATION(CLASSNAME) \
+    static ObjectPool& objectPool(); \
+    static void *operator new(size_t size) { return objectPool().allocate(size); } \
+    static void operator delete(void *p, size_t size) { objectPool().release(p, size); }
+
+/**
+ * Defines the pool of a class declared with INET_POOLED_ALLOCATION().
+ * The pool is never deleted, so objects may be deleted at any time.
+ */
+#define Define_ObjectPool(CLASSNAME) \
+    ObjectPool& CLASSNAME::objectPool() \
+    { \
+        static ObjectPool *pool = new ObjectPool(#CLASSNAME, sizeof(CLASSNAME)); \
+        return *pool; \
+    }
+
+#endif
+
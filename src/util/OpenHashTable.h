@@ -0,0 +1,185 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_OPENHASHTABLE_H
+#define __INET_OPENHASHTABLE_H
+
+#include <vector>
+
+#include "INETDefs.h"
+
+
+/**
+ * The 64-bit finalizer of MurmurHash3: spreads keys that differ in a few
+ * bits only (consecutive addresses, ports) over the whole hash table.
+ */
+inline uint64 mixHash(uint64 key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+/**
+ * Hash table with open addressing and linear probing, used by lookup tables
+ * on the per-packet path (MAC address table, IPv6 destination cache, socket
+ * pair tables). Lookups take constant time and do not allocate memory.
+ *
+ * The table stores values of type T in its slots. HASH is a function object
+ * type that returns the hash of a stored value; it is needed to move values
+ * when the table grows or a value is removed. The table is kept at most half
+ * full, and values are removed with backward shift deletion, so lookups never
+ * have to skip deleted slots.
+ *
+ * Values are looked up by their hash and a predicate that tells whether a
+ * stored value is the one being looked for; see findSlot(). Slot indices are
+ * valid until the next insertion or removal.
+ */
+template<typename T, typename HASH>
+class OpenHashTable
+{
+  protected:
+    struct Slot
+    {
+        bool used;
+        T value;
+        Slot() : used(false), value() {}
+    };
+
+    std::vector<Slot> slots;  // size is a power of 2
+    int numEntries;
+    unsigned int initialNumSlots;
+
+  protected:
+    int insertSlot(const T& value)
+    {
+        unsigned int mask = slots.size() - 1;
+        unsigned int i = HASH()(value) & mask;
+        while (slots[i].used)
+            i = (i + 1) & mask;
+        slots[i].used = true;
+        slots[i].value = value;
+        return i;
+    }
+
+    void resize(unsigned int numSlots)
+    {
+        std::vector<Slot> oldSlots(numSlots);
+        oldSlots.swap(slots);
+        for (unsigned int j = 0; j < oldSlots.size(); j++)
+            if (oldSlots[j].used)
+                insertSlot(oldSlots[j].value);
+    }
+
+  public:
+    /** The number of slots must be a power of 2. */
+    OpenHashTable(unsigned int initialNumSlots = 16) :
+        slots(initialNumSlots), numEntries(0), initialNumSlots(initialNumSlots) {}
+
+    /** Returns the number of values. */
+    int size() const { return numEntries; }
+
+    /** Returns the number of slots, for iterating over them with isUsed() and at(). */
+    int getNumSlots() const { return slots.size(); }
+
+    bool isUsed(int slot) const { return slots[slot].used; }
+    T& at(int slot) { return slots[slot].value; }
+    const T& at(int slot) const { return slots[slot].value; }
+
+    /**
+     * Returns the slot of the first value in the probe sequence of the hash
+     * for which matches(value) is true, or -1.
+     */
+    template<typename MATCH>
+    int findSlot(unsigned int hash, const MATCH& matches) const
+    {
+        unsigned int mask = slots.size() - 1;
+        for (unsigned int i = hash & mask; slots[i].used; i = (i + 1) & mask)
+            if (matches(slots[i].value))
+                return i;
+        return -1;
+    }
+
+    /**
+     * Adds a value, which must not be in the table yet, and returns its slot.
+     */
+    int insert(const T& value)
+    {
+        if (2 * (numEntries + 1) > (int)slots.size())
+            resize(2 * slots.size());
+        numEntries++;
+        return insertSlot(value);
+    }
+
+    /**
+     * Removes the value in the given slot.
+     */
+    void removeSlot(int slot)
+    {
+        numEntries--;
+
+        // backward shift deletion: move later members of the probe sequence into the hole
+        unsigned int mask = slots.size() - 1;
+        unsigned int hole = slot;
+        for (unsigned int i = (hole + 1) & mask; slots[i].used; i = (i + 1) & mask)
+        {
+            unsigned int home = HASH()(slots[i].value) & mask;
+            // the value may fill the hole unless its home lies cyclically in (hole, i]
+            if (((i - home) & mask) >= ((i - hole) & mask))
+            {
+                slots[hole].value = slots[i].value;
+                hole = i;
+            }
+        }
+        slots[hole].used = false;
+        slots[hole].value = T();
+    }
+
+    /**
+     * Removes the values for which pred(value) is true; returns their number.
+     */
+    template<typename PREDICATE>
+    int removeIf(const PREDICATE& pred)
+    {
+        std::vector<Slot> oldSlots(slots.size());
+        oldSlots.swap(slots);
+        int oldNumEntries = numEntries;
+        numEntries = 0;
+        for (unsigned int j = 0; j < oldSlots.size(); j++)
+        {
+            if (oldSlots[j].used && !pred(oldSlots[j].value))
+            {
+                insertSlot(oldSlots[j].value);
+                numEntries++;
+            }
+        }
+        return oldNumEntries - numEntries;
+    }
+
+    /** Removes all values. */
+    void clear()
+    {
+        slots.assign(initialNumSlots, Slot());
+        numEntries = 0;
+    }
+};
+
+#endif
+
@@ -25,7 +25,7 @@
 #include "PacketDump.h"
 
 #ifdef WITH_UDP
-#include "UDPPacket_m.h"
+#include "UDPPacket.h"
 #endif
 
 #ifdef WITH_SCTP
@@ -20,6 +20,7 @@
 //
 
 
+#include <algorithm>
 #include <errno.h>
 
 #include "PcapDump.h"
@@ -27,7 +28,7 @@
 #include "IPProtocolId_m.h"
 
 #ifdef WITH_UDP
-#include "UDPPacket_m.h"
+#include "UDPPacket.h"
 #endif
 
 #ifdef WITH_IPv4
@@ -43,6 +44,9 @@
 
 #define MAXBUFLENGTH 65536
 
+// serializers always write complete headers, so never ask for less
+#define MIN_SERIALIZED_LENGTH 256
+
 #define PCAP_MAGIC           0xa1b2c3d4
 
 /* "libpcap" file header (minus magic number). */
@@ -64,93 +68,202 @@ struct pcaprec_hdr {
      uint32 orig_len;   /* actual length of packet */
 };
 
+/* pcapng block types, options and constants */
+#define PCAPNG_SECTION_HEADER_BLOCK    0x0a0d0d0a
+#define PCAPNG_INTERFACE_BLOCK         0x00000001
+#define PCAPNG_ENHANCED_PACKET_BLOCK   0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC        0x1a2b3c4d
+#define PCAPNG_OPT_ENDOFOPT            0
+#define PCAPNG_OPT_IF_NAME             2
+#define PCAPNG_OPT_IF_TSRESOL          9
+#define PCAPNG_LINKTYPE_RAW            101
+
+/* pcapng section header block, without options */
+struct pcapng_shb {
+     uint32 block_type;
+     uint32 block_length;
+     uint32 byte_order_magic;
+     uint16 version_major;
+     uint16 version_minor;
+     uint32 section_length[2];  /* 64 bits, -1: not specified */
+     uint32 block_length_trailer;
+};
+
+/* pcapng enhanced packet block, up to the packet data */
+struct pcapng_epb_hdr {
+     uint32 block_type;
+     uint32 block_length;
+     uint32 interface_id;
+     uint32 ts_high;            /* timestamp, in units of if_tsresol (ns) */
+     uint32 ts_low;
+     uint32 captured_len;
+     uint32 orig_len;
+};
+
 
+PcapDump::SharedDumpMap PcapDump::sharedDumps;
 
 PcapDump::PcapDump()
 {
-     dumpfile = NULL;
+    snaplen = 0;
+    pcapng = false;
+    numInterfaces = 0;
 }
 
 PcapDump::~PcapDump()
 {
-    closePcap();
+    // the writer closes the file
 }
 
-void PcapDump::openPcap(const char* filename, unsigned int snaplen_par)
+void PcapDump::openPcap(const char* filename, unsigned int snaplen_par, bool pcapng_par, bool writerThread)
 {
-    struct pcap_hdr fh;
-
     if (!filename || !filename[0])
         throw cRuntimeError("Cannot open pcap file: file name is empty");
 
-    dumpfile = fopen(filename, "wb");
-
-    if (!dumpfile)
-        throw cRuntimeError("Cannot open pcap file [%s] for writing: %s", filename, strerror(errno));
+    writer.open(filename, writerThread);
 
     snaplen = snaplen_par;
+    pcapng = pcapng_par;
+    numInterfaces = 0;
+    buf.resize(MAXBUFLENGTH);
+
+    if (pcapng)
+    {
+        struct pcapng_shb shb;
+        shb.block_type = PCAPNG_SECTION_HEADER_BLOCK;
+        shb.block_length = shb.block_length_trailer = sizeof(shb);
+        shb.byte_order_magic = PCAPNG_BYTE_ORDER_MAGIC;
+        shb.version_major = 1;
+        shb.version_minor = 0;
+        shb.section_length[0] = shb.section_length[1] = 0xffffffff;
+        writer.write(&shb, sizeof(shb));
+    }
+    else
+    {
+        struct pcap_hdr fh;
+        fh.magic = PCAP_MAGIC;
+        fh.version_major = 2;
+        fh.version_minor = 4;
+        fh.thiszone = 0;
+        fh.sigfigs = 0;
+        fh.snaplen = snaplen;
+        fh.network = 0;
+        writer.write(&fh, sizeof(fh));
+    }
+}
+
+void PcapDump::writeOption(uint16 code, const void *value, uint16 length)
+{
+    static const uint8 padding[4] = {0, 0, 0, 0};
+    writer.write(&code, sizeof(code));
+    writer.write(&length, sizeof(length));
+    writer.write(value, length);
+    writer.write(padding, (4 - length % 4) % 4);
+}
+
+int PcapDump::addInterface(const char *name)
+{
+    if (!isOpen())
+        throw cRuntimeError("Cannot add interface: pcap output file is not open");
+    if (!pcapng)
+        return 0;
+
+    uint16 nameLength = strlen(name);
+    uint8 tsresol = 9;  // nanoseconds
+    uint32 blockType = PCAPNG_INTERFACE_BLOCK;
+    uint32 blockLength = 16 + (4 + ((nameLength + 3) & ~3)) + (4 + 4) + 4 + 4;
+    uint16 linkType = PCAPNG_LINKTYPE_RAW;
+    uint16 reserved = 0;
+    writer.write(&blockType, sizeof(blockType));
+    writer.write(&blockLength, sizeof(blockLength));
+    writer.write(&linkType, sizeof(linkType));
+    writer.write(&reserved, sizeof(reserved));
+    writer.write(&snaplen, sizeof(snaplen));
+    writeOption(PCAPNG_OPT_IF_NAME, name, nameLength);
+    writeOption(PCAPNG_OPT_IF_TSRESOL, &tsresol, 1);
+    writeOption(PCAPNG_OPT_ENDOFOPT, NULL, 0);
+    writer.write(&blockLength, sizeof(blockLength));
+    return numInterfaces++;
+}
 
-    fh.magic = PCAP_MAGIC;
-    fh.version_major = 2;
-    fh.version_minor = 4;
-    fh.thiszone = 0;
-    fh.sigfigs = 0;
-    fh.snaplen = snaplen;
-    fh.network = 0;
-    fwrite(&fh, sizeof(fh), 1, dumpfile);
+unsigned int PcapDump::prepareBuffer(int64 byteLength)
+{
+    // serialize only the part that will be stored
+    unsigned int limit = std::min(std::max(snaplen, (unsigned int)MIN_SERIALIZED_LENGTH), (unsigned int)MAXBUFLENGTH);
+    memset(&buf[0], 0, std::min((int64)limit, byteLength));
+    return limit;
 }
 
-void PcapDump::writeFrame(simtime_t stime, const IPv4Datagram *ipPacket)
+void PcapDump::writeRecord(simtime_t stime, uint32 length, int interfaceId)
 {
-    if (!dumpfile)
+    if (pcapng)
+    {
+        if (interfaceId < 0 || interfaceId >= numInterfaces)
+            throw cRuntimeError("Cannot write frame: invalid pcapng interface id %d", interfaceId);
+
+        // timestamp in nanoseconds, computed exactly from the raw simulation time
+        int64 ts = stime.raw();
+        for (int exp = SimTime::getScaleExp(); exp < -9; exp++)
+            ts /= 10;
+        for (int exp = SimTime::getScaleExp(); exp > -9; exp--)
+            ts *= 10;
+
+        static const uint8 padding[4] = {0, 0, 0, 0};
+        struct pcapng_epb_hdr eh;
+        eh.block_type = PCAPNG_ENHANCED_PACKET_BLOCK;
+        eh.interface_id = interfaceId;
+        eh.ts_high = (uint32)((uint64)ts >> 32);
+        eh.ts_low = (uint32)ts;
+        eh.captured_len = length > snaplen ? snaplen : length;
+        eh.orig_len = length;
+        uint32 paddingLength = (4 - eh.captured_len % 4) % 4;
+        eh.block_length = sizeof(eh) + eh.captured_len + paddingLength + sizeof(uint32);
+        writer.write(&eh, sizeof(eh));
+        writer.write(&buf[0], eh.captured_len);
+        writer.write(padding, paddingLength);
+        writer.write(&eh.block_length, sizeof(uint32));
+    }
+    else
+    {
+        struct pcaprec_hdr ph;
+        ph.ts_sec = (int32)stime.dbl();
+        ph.ts_usec = (uint32)((stime.dbl() - ph.ts_sec) * 1000000);
+         // Write Ethernet header
+        uint32 hdr = 2; //AF_INET
+
+        ph.orig_len = length + sizeof(uint32);
+
+        ph.incl_len = ph.orig_len > snaplen ? snaplen : ph.orig_len;
+        writer.write(&ph, sizeof(ph));
+        writer.write(&hdr, sizeof(uint32));
+        writer.write(&buf[0], ph.incl_len - sizeof(uint32));
+    }
+}
+
+void PcapDump::writeFrame(simtime_t stime, const IPv4Datagram *ipPacket, int interfaceId)
+{
+    if (!isOpen())
         throw cRuntimeError("Cannot write frame: pcap output file is not open");
 
 #ifdef WITH_IPv4
-    uint8 buf[MAXBUFLENGTH];
-    memset((void*)&buf, 0, sizeof(buf));
-
-    struct pcaprec_hdr ph;
-    ph.ts_sec = (int32)stime.dbl();
-    ph.ts_usec = (uint32)((stime.dbl() - ph.ts_sec) * 1000000);
-     // Write Ethernet header
-    uint32 hdr = 2; //AF_INET
-
-    int32 serialized_ip = IPv4Serializer().serialize(ipPacket, buf, sizeof(buf), true);
-    ph.orig_len = serialized_ip + sizeof(uint32);
-
-    ph.incl_len = ph.orig_len > snaplen ? snaplen : ph.orig_len;
-    fwrite(&ph, sizeof(ph), 1, dumpfile);
-    fwrite(&hdr, sizeof(uint32), 1, dumpfile);
-    fwrite(buf, ph.incl_len - sizeof(uint32), 1, dumpfile);
+    unsigned int limit = prepareBuffer(ipPacket->getByteLength());
+    int32 serialized_ip = IPv4Serializer().serialize(ipPacket, &buf[0], limit, true);
+    writeRecord(stime, serialized_ip, interfaceId);
 #else
     throw cRuntimeError("Cannot write frame: INET compiled without IPv4 feature");
 #endif
 }
 
-void PcapDump::writeIPv6Frame(simtime_t stime, const IPv6Datagram *ipPacket)
+void PcapDump::writeIPv6Frame(simtime_t stime, const IPv6Datagram *ipPacket, int interfaceId)
 {
-    if (!dumpfile)
+    if (!isOpen())
         throw cRuntimeError("Cannot write frame: pcap output file is not open");
 
 #ifdef WITH_IPv6
-    uint8 buf[MAXBUFLENGTH];
-    memset((void*)&buf, 0, sizeof(buf));
-
-    struct pcaprec_hdr ph;
-    ph.ts_sec = (int32)stime.dbl();
-    ph.ts_usec = (uint32)((stime.dbl() - ph.ts_sec) * 1000000);
-     // Write Ethernet header
-    uint32 hdr = 2; //AF_INET
-
-    int32 serialized_ip = IPv6Serializer().serialize(ipPacket, buf, sizeof(buf));
-    if (serialized_ip > 0) {
-        ph.orig_len = serialized_ip + sizeof(uint32);
-
-        ph.incl_len = ph.orig_len > snaplen ? snaplen : ph.orig_len;
-        fwrite(&ph, sizeof(ph), 1, dumpfile);
-        fwrite(&hdr, sizeof(uint32), 1, dumpfile);
-        fwrite(buf, ph.incl_len - sizeof(uint32), 1, dumpfile);
-    }
+    unsigned int limit = prepareBuffer(ipPacket->getByteLength());
+    int32 serialized_ip = IPv6Serializer().serialize(ipPacket, &buf[0], limit);
+    if (serialized_ip > 0)
+        writeRecord(stime, serialized_ip, interfaceId);
 #else
     throw cRuntimeError("Cannot write frame: INET compiled without IPv6 feature");
 #endif
@@ -158,10 +271,59 @@ void PcapDump::writeIPv6Frame(simtime_t stime, const IPv6Datagram *ipPacket)
 
 void PcapDump::closePcap()
 {
-    if (dumpfile)
+    writer.close();
+}
+
+PcapDump *PcapDump::openShared(const char *filename, unsigned int snaplen, bool pcapng, bool writerThread)
+{
+    SharedDumpMap::iterator it = sharedDumps.find(filename);
+    if (it != sharedDumps.end())
+    {
+        PcapDump *dump = it->second.dump;
+        if (dump->snaplen != snaplen || dump->pcapng != pcapng)
+            throw cRuntimeError("Pcap file [%s] is already open with a different snaplen or format", filename);
+        it->second.numUsers++;
+        return dump;
+    }
+
+    PcapDump *dump = new PcapDump();
+    try
     {
-        fclose(dumpfile);
-        dumpfile = NULL;
+        dump->openPcap(filename, snaplen, pcapng, writerThread);
     }
+    catch (std::exception& e)
+    {
+        delete dump;
+        throw;
+    }
+    SharedDump& shared = sharedDumps[filename];
+    shared.dump = dump;
+    shared.numUsers = 1;
+    return dump;
 }
 
+void PcapDump::releaseShared(PcapDump *dump)
+{
+    for (SharedDumpMap::iterator it = sharedDumps.begin(); it != sharedDumps.end(); ++it)
+    {
+        if (it->second.dump == dump)
+        {
+            if (--it->second.numUsers == 0)
+            {
+                sharedDumps.erase(it);
+                try
+                {
+                    dump->closePcap();
+                }
+                catch (std::exception& e)
+                {
+                    delete dump;
+                    throw;
+                }
+                delete dump;
+            }
+            return;
+        }
+    }
+    throw cRuntimeError("PcapDump::releaseShared(): not a shared dump");
+}
@@ -22,8 +22,13 @@
 #define __INET_PCAPDUMP_H
 
 
+#include <map>
+#include <vector>
+
 #include "INETDefs.h"
 
+#include "AsyncFileWriter.h"
+
 // Foreign declarations:
 class IPv4Datagram;
 class IPv6Datagram;
@@ -32,14 +37,40 @@ class IPv6Datagram;
 /**
  * Dumps packets into a PCAP file; see the "pcap-savefile" man page or
  * http://www.tcpdump.org/ for details on the file format.
- * Note: The file is currently recorded in the "classic" format,
- * not in the "Next Generation" file format also on tcpdump.org.
+ *
+ * The file is either recorded in the "classic" format (one link type, and
+ * no interface information), or in the "Next Generation" (pcapng) format.
+ * In pcapng files, packets are stored in Enhanced Packet Blocks with
+ * nanosecond timestamps, and each packet refers to an interface added with
+ * addInterface(), so one file can hold the interfaces of many nodes; see
+ * openShared(). Packets are stored as raw IP (LINKTYPE_RAW) in pcapng files;
+ * classic files use the BSD loopback link type (network 0), which prefixes
+ * each packet with a 4-byte address family.
+ *
+ * Packets are serialized only as far as they are stored (see snaplen), and
+ * the file is written through an AsyncFileWriter.
  */
-class PcapDump
+class INET_API PcapDump
 {
     protected:
-        FILE *dumpfile;         // pcap file
+        AsyncFileWriter writer; // pcap file
         unsigned int snaplen;   // max. length of packets in pcap file
+        bool pcapng;            // whether the file is in pcapng format
+        int numInterfaces;      // interfaces added to the pcapng file
+        std::vector<uint8> buf; // serialization buffer
+
+        struct SharedDump
+        {
+            PcapDump *dump;
+            int numUsers;
+        };
+        typedef std::map<std::string,SharedDump> SharedDumpMap;
+        static SharedDumpMap sharedDumps;
+
+    protected:
+        unsigned int prepareBuffer(int64 byteLength);
+        void writeRecord(simtime_t stime, uint32 length, int interfaceId);
+        void writeOption(uint16 code, const void *value, uint16 length);
 
     public:
         /**
@@ -54,29 +85,56 @@ class PcapDump
 
         /**
          * Opens a PCAP file with the given file name. The snaplen parameter
-         * is the length that packets will be truncated to. Throws an exception
-         * if the file cannot be opened.
+         * is the length that packets will be truncated to. If pcapng is true,
+         * the file is written in the pcapng format. If writerThread is true,
+         * the file is written by a background thread. Throws an exception if
+         * the file cannot be opened.
          */
-        void openPcap(const char *filename, unsigned int snaplen);
+        void openPcap(const char *filename, unsigned int snaplen, bool pcapng = false, bool writerThread = false);
 
         /**
          * Returns true if the pcap file is currently open.
          */
-        bool isOpen() const { return dumpfile != NULL; }
+        bool isOpen() const { return writer.isOpen(); }
+
+        /**
+         * Returns true if the file is in the pcapng format.
+         */
+        bool isPcapng() const { return pcapng; }
+
+        /**
+         * Adds an interface with the given name to a pcapng file, and returns
+         * its id to be passed to writeFrame(). Classic pcap files do not store
+         * interfaces; for them, 0 is returned.
+         */
+        int addInterface(const char *name);
 
         /**
          * Records the given packet into the output file if it is open,
-         * and throws an exception otherwise.
+         * and throws an exception otherwise. The interface id is only used
+         * in pcapng files.
          */
-        void writeFrame(simtime_t time, const IPv4Datagram *ipPacket);
-        void writeIPv6Frame(simtime_t stime, const IPv6Datagram *ipPacket);
+        void writeFrame(simtime_t time, const IPv4Datagram *ipPacket, int interfaceId = 0);
+        void writeIPv6Frame(simtime_t stime, const IPv6Datagram *ipPacket, int interfaceId = 0);
 
         /**
          * Closes the output file if it is open.
          */
         void closePcap();
+
+        /**
+         * Returns the PcapDump that writes the given file, opening the file
+         * with the given parameters if it is not in use yet. The parameters
+         * must be the same for all users. Each call must be paired with a
+         * releaseShared() call, which closes the file after the last user.
+         */
+        static PcapDump *openShared(const char *filename, unsigned int snaplen, bool pcapng, bool writerThread);
+
+        /**
+         * Releases a PcapDump obtained from openShared().
+         */
+        static void releaseShared(PcapDump *dump);
 };
 
 
 #endif // __INET_PCAPDUMP_H
-
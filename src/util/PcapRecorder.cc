@@ -37,9 +37,20 @@ Define_Module(PcapRecorder);
 
 PcapRecorder::~PcapRecorder()
 {
+    if (pcapDumper)
+    {
+        try
+        {
+            PcapDump::releaseShared(pcapDumper);
+        }
+        catch (std::exception& e)
+        {
+            // destructors must not throw
+        }
+    }
 }
 
-PcapRecorder::PcapRecorder() : cSimpleModule(), pcapDumper()
+PcapRecorder::PcapRecorder() : cSimpleModule(), pcapDumper(NULL)
 {
 }
 
@@ -51,6 +62,15 @@ void PcapRecorder::initialize()
     packetDumper.setVerbose(par("verbose").boolValue());
     packetDumper.setOutStream(EVSTREAM);
     signalList.clear();
+    interfaceIds.clear();
+
+    if (*file)
+    {
+        const char *fileFormat = par("fileFormat");
+        if (strcmp(fileFormat, "pcap") && strcmp(fileFormat, "pcapng"))
+            throw cRuntimeError("Invalid fileFormat parameter value: '%s'", fileFormat);
+        pcapDumper = PcapDump::openShared(file, snaplen, !strcmp(fileFormat, "pcapng"), par("writerThread").boolValue());
+    }
 
     {
         cStringTokenizer signalTokenizer(par("sendingSignalNames"));
@@ -85,6 +105,9 @@ void PcapRecorder::initialize()
             {
                 found = true;
 
+                if (pcapDumper && interfaceIds.find(submod) == interfaceIds.end())
+                    interfaceIds[submod] = pcapDumper->addInterface(submod->getFullPath().c_str());
+
                 for (SignalList::iterator s = signalList.begin(); s != signalList.end(); s++)
                 {
                     if (!submod->isSubscribed(s->first, this))
@@ -103,9 +126,6 @@ void PcapRecorder::initialize()
                     << " not found for PcapRecorder " << getFullPath() << endl;
         }
     }
-
-    if (*file)
-        pcapDumper.openPcap(file, snaplen);
 }
 
 void PcapRecorder::handleMessage(cMessage *msg)
@@ -122,11 +142,23 @@ void PcapRecorder::receiveSignal(cComponent *source, simsignal_t signalID, cObje
     {
         SignalList::const_iterator i = signalList.find(signalID);
         bool l2r = (i != signalList.end()) ? i->second : true;
-        recordPacket(packet, l2r);
+        recordPacket(packet, l2r, findInterfaceId(source));
+    }
+}
+
+int PcapRecorder::findInterfaceId(cComponent *source)
+{
+    // the signal may come from a submodule of the recorded module
+    for (cModule *module = dynamic_cast<cModule *>(source); module; module = module->getParentModule())
+    {
+        InterfaceIdMap::const_iterator it = interfaceIds.find(module);
+        if (it != interfaceIds.end())
+            return it->second;
     }
+    return 0;
 }
 
-void PcapRecorder::recordPacket(cPacket *msg, bool l2r)
+void PcapRecorder::recordPacket(cPacket *msg, bool l2r, int interfaceId)
 {
     if (!ev.isDisabled())
     {
@@ -135,7 +167,7 @@ void PcapRecorder::recordPacket(cPacket *msg, bool l2r)
     }
 
 #if defined(WITH_IPv4) || defined(WITH_IPv6)
-    if (!pcapDumper.isOpen())
+    if (!pcapDumper)
         return;
 
     bool hasBitError = false;
@@ -168,14 +200,14 @@ void PcapRecorder::recordPacket(cPacket *msg, bool l2r)
     if (ip4Packet && (dumpBadFrames || !hasBitError))
     {
         const simtime_t stime = simulation.getSimTime();
-        pcapDumper.writeFrame(stime, ip4Packet);
+        pcapDumper->writeFrame(stime, ip4Packet, interfaceId);
     }
 #endif
 #ifdef WITH_IPv6
     if (ip6Packet && (dumpBadFrames || !hasBitError))
     {
         const simtime_t stime = simulation.getSimTime();
-        pcapDumper.writeIPv6Frame(stime, ip6Packet);
+        pcapDumper->writeIPv6Frame(stime, ip6Packet, interfaceId);
     }
 #endif
 }
@@ -183,6 +215,11 @@ void PcapRecorder::recordPacket(cPacket *msg, bool l2r)
 void PcapRecorder::finish()
 {
      packetDumper.dump("", "pcapRecorder finished");
-     pcapDumper.closePcap();
+     if (pcapDumper)
+     {
+         PcapDump *dumper = pcapDumper;
+         pcapDumper = NULL;
+         PcapDump::releaseShared(dumper);
+     }
 }
 
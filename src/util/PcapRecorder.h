@@ -29,15 +29,19 @@
 
 
 /**
- * Dumps every packet using the PcapDump and PacketDump classes
+ * Dumps every packet using the PcapDump and PacketDump classes.
+ * PcapRecorders writing the same file share one PcapDump; in pcapng files,
+ * each recorded module is a separate interface.
  */
 class INET_API PcapRecorder : public cSimpleModule, protected cListener
 {
     protected:
         typedef std::map<simsignal_t,bool> SignalList;
+        typedef std::map<cModule *,int> InterfaceIdMap;
         SignalList signalList;
         PacketDump packetDumper;
-        PcapDump pcapDumper;
+        PcapDump *pcapDumper;           // shared with other PcapRecorders writing the same file
+        InterfaceIdMap interfaceIds;    // pcapng interface ids of the recorded modules
         unsigned int snaplen;
         unsigned long first, last, space;
         bool dumpBadFrames;
@@ -49,7 +53,8 @@ class INET_API PcapRecorder : public cSimpleModule, protected cListener
         virtual void handleMessage(cMessage *msg);
         virtual void finish();
         virtual void receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj);
-        virtual void recordPacket(cPacket *msg, bool l2r);
+        virtual void recordPacket(cPacket *msg, bool l2r, int interfaceId);
+        virtual int findInterfaceId(cComponent *source);
 };
 
 #endif
@@ -0,0 +1,196 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+#include <exception>
+
+#include "ThreadPool.h"
+
+
+Mutex::Mutex()
+{
+#ifdef HAVE_PTHREAD
+    pthread_mutex_init(&mutex, NULL);
+#endif
+}
+
+Mutex::~Mutex()
+{
+#ifdef HAVE_PTHREAD
+    pthread_mutex_destroy(&mutex);
+#endif
+}
+
+void Mutex::lock()
+{
+#ifdef HAVE_PTHREAD
+    pthread_mutex_lock(&mutex);
+#endif
+}
+
+void Mutex::unlock()
+{
+#ifdef HAVE_PTHREAD
+    pthread_mutex_unlock(&mutex);
+#endif
+}
+
+ThreadPool::ThreadPool(int numThreads)
+{
+    if (numThreads < 1)
+        throw cRuntimeError("ThreadPool: number of threads must be at least 1, got %d", numThreads);
+    task = NULL;
+    numItems = nextItem = 0;
+    chunkSize = 1;
+#ifdef HAVE_PTHREAD
+    this->numThreads = numThreads;
+    generation = 0;
+    shutdown = false;
+    numBusyWorkers = 0;
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&workCondition, NULL);
+    pthread_cond_init(&doneCondition, NULL);
+    for (int i = 0; i < numThreads - 1; i++)
+    {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, workerMain, this) != 0)
+            break;  // continue with fewer threads
+        workers.push_back(thread);
+    }
+    this->numThreads = workers.size() + 1;
+#else
+    this->numThreads = 1;
+#endif
+}
+
+ThreadPool::~ThreadPool()
+{
+#ifdef HAVE_PTHREAD
+    pthread_mutex_lock(&mutex);
+    shutdown = true;
+    pthread_cond_broadcast(&workCondition);
+    pthread_mutex_unlock(&mutex);
+    for (unsigned int i = 0; i < workers.size(); i++)
+        pthread_join(workers[i], NULL);
+    pthread_cond_destroy(&doneCondition);
+    pthread_cond_destroy(&workCondition);
+    pthread_mutex_destroy(&mutex);
+#endif
+}
+
+#ifdef HAVE_PTHREAD
+void *ThreadPool::workerMain(void *arg)
+{
+    static_cast<ThreadPool *>(arg)->workerLoop();
+    return NULL;
+}
+
+void ThreadPool::workerLoop()
+{
+    unsigned long seenGeneration = 0;
+    pthread_mutex_lock(&mutex);
+    while (true)
+    {
+        while (!shutdown && generation == seenGeneration)
+            pthread_cond_wait(&workCondition, &mutex);
+        if (shutdown)
+            break;
+        seenGeneration = generation;
+        pthread_mutex_unlock(&mutex);
+
+        processItems();
+
+        pthread_mutex_lock(&mutex);
+        if (--numBusyWorkers == 0)
+            pthread_cond_signal(&doneCondition);
+    }
+    pthread_mutex_unlock(&mutex);
+}
+#endif
+
+void ThreadPool::processItems()
+{
+    while (true)
+    {
+#ifdef HAVE_PTHREAD
+        pthread_mutex_lock(&mutex);
+#endif
+        int from = nextItem;
+        nextItem += chunkSize;
+#ifdef HAVE_PTHREAD
+        pthread_mutex_unlock(&mutex);
+#endif
+        if (from >= numItems)
+            break;
+        int to = std::min(from + chunkSize, numItems);
+        for (int i = from; i < to; i++)
+        {
+            try
+            {
+                task->run(i);
+            }
+            catch (std::exception& e)
+            {
+#ifdef HAVE_PTHREAD
+                pthread_mutex_lock(&mutex);
+#endif
+                if (errorMessage.empty())
+                    errorMessage = e.what();
+#ifdef HAVE_PTHREAD
+                pthread_mutex_unlock(&mutex);
+#endif
+            }
+        }
+    }
+}
+
+void ThreadPool::runAll(Task *task, int n)
+{
+    if (n <= 0)
+        return;
+    this->task = task;
+    numItems = n;
+    nextItem = 0;
+    // a few chunks per thread: balances the load but keeps locking rare
+    chunkSize = std::max(1, n / (4 * numThreads));
+    errorMessage.clear();
+
+#ifdef HAVE_PTHREAD
+    if (!workers.empty())
+    {
+        pthread_mutex_lock(&mutex);
+        numBusyWorkers = workers.size();
+        generation++;
+        pthread_cond_broadcast(&workCondition);
+        pthread_mutex_unlock(&mutex);
+
+        processItems();
+
+        pthread_mutex_lock(&mutex);
+        while (numBusyWorkers > 0)
+            pthread_cond_wait(&doneCondition, &mutex);
+        pthread_mutex_unlock(&mutex);
+    }
+    else
+#endif
+        processItems();
+
+    this->task = NULL;
+    if (!errorMessage.empty())
+        throw cRuntimeError("ThreadPool: %s", errorMessage.c_str());
+}
+
@@ -0,0 +1,139 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_THREADPOOL_H
+#define __INET_THREADPOOL_H
+
+#include <string>
+#include <vector>
+
+#include "INETDefs.h"
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+
+/**
+ * Mutual exclusion lock. Does nothing if INET was built without pthreads.
+ */
+class INET_API Mutex
+{
+  protected:
+#ifdef HAVE_PTHREAD
+    pthread_mutex_t mutex;
+#endif
+
+  private:
+    // copying not supported: following are private and also left undefined
+    Mutex(const Mutex& other);
+    Mutex& operator=(const Mutex& other);
+
+  public:
+    Mutex();
+    ~Mutex();
+    void lock();
+    void unlock();
+};
+
+/**
+ * Locks the mutex for the lifetime of the object.
+ */
+class INET_API MutexLocker
+{
+  protected:
+    Mutex& mutex;
+  public:
+    MutexLocker(Mutex& mutex) : mutex(mutex) { mutex.lock(); }
+    ~MutexLocker() { mutex.unlock(); }
+};
+
+/**
+ * A fixed set of worker threads for evaluating independent computations
+ * in parallel, within a single event. The simulation itself stays
+ * sequential: runAll() returns only when every item has been processed,
+ * and tasks must not access simulation state (modules, messages being
+ * sent, RNGs, the event queue). To stay reproducible, tasks should write
+ * their results into per-item slots which the caller then processes in
+ * index order.
+ *
+ * If INET was built without pthreads (HAVE_PTHREAD undefined), or the pool
+ * has a single thread, items are evaluated sequentially in the caller.
+ */
+class INET_API ThreadPool
+{
+  public:
+    /**
+     * A computation to be run for each item index.
+     */
+    class Task
+    {
+      public:
+        virtual ~Task() {}
+        virtual void run(int index) = 0;
+    };
+
+  protected:
+    int numThreads;
+
+#ifdef HAVE_PTHREAD
+    std::vector<pthread_t> workers;
+    pthread_mutex_t mutex;
+    pthread_cond_t workCondition;  // signalled when a new batch is available
+    pthread_cond_t doneCondition;  // signalled when the last worker finished the batch
+    unsigned long generation;      // incremented for each batch
+    bool shutdown;
+    int numBusyWorkers;
+#endif
+    Task *task;
+    int numItems;
+    int nextItem;
+    int chunkSize;
+    std::string errorMessage;      // first error thrown by a task in the current batch
+
+  protected:
+#ifdef HAVE_PTHREAD
+    static void *workerMain(void *arg);
+    void workerLoop();
+#endif
+    void processItems();
+
+  private:
+    // copying not supported: following are private and also left undefined
+    ThreadPool(const ThreadPool& other);
+    ThreadPool& operator=(const ThreadPool& other);
+
+  public:
+    /**
+     * Creates a pool with the given number of threads, including the caller
+     * of runAll(); that is, numThreads-1 worker threads are started.
+     */
+    ThreadPool(int numThreads);
+    ~ThreadPool();
+
+    /** Returns the number of threads, including the caller of runAll() */
+    int getNumThreads() const { return numThreads; }
+
+    /**
+     * Calls task->run(i) for every i in [0, n), and returns when all calls
+     * have completed. The calling thread also processes items. If a task
+     * throws, the first error is rethrown here as cRuntimeError.
+     */
+    void runAll(Task *task, int n);
+};
+
+#endif
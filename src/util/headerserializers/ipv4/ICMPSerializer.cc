@@ -100,7 +100,9 @@ int ICMPSerializer::serialize(const ICMPMessage *pkt, unsigned char *buf, unsign
             break;
         }
     }
-    icmp->icmp_cksum = TCPIPchecksum::checksum(buf, packetLength);
+    icmp->icmp_cksum = 0;
+    if ((unsigned int)packetLength <= bufsize)
+        icmp->icmp_cksum = TCPIPchecksum::checksum(buf, packetLength);
     return packetLength;
 }
 
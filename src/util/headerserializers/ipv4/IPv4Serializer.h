@@ -34,7 +34,10 @@ class IPv4Serializer
          * The checksum is set to 0 when hasCalcChkSum is false. (The kernel does that when sending
          * the frame over a raw socket.)
          * When hasCalcChkSum is true, then calculating checksum.
-         * Returns the length of data written into buffer.
+         * Returns the length of the datagram. Headers are always written,
+         * but TCP data is only written as far as it fits into bufsize bytes
+         * (see TCPSerializer), so a small bufsize can be used when only the
+         * beginning of the datagram is needed.
          */
         int serialize(const IPv4Datagram *dgram, unsigned char *buf, unsigned int bufsize, bool hasCalcChkSum = false);
 
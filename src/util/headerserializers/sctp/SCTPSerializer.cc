@@ -1063,8 +1063,10 @@ int32 SCTPSerializer::serialize(const SCTPMessage *msg, unsigned char *buf, uint
             auth->hmac[k] = result[k];
     }
     // finally, set the CRC32 checksum field in the SCTP common header
-
-    ch->checksum = checksum((unsigned char*)ch, writtenbytes);
+    // (left 0 if the packet is truncated to bufsize)
+    ch->checksum = 0;
+    if (writtenbytes <= bufsize)
+        ch->checksum = checksum((unsigned char*)ch, writtenbytes);
     return writtenbytes;
 }
 
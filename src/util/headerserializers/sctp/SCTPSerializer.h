@@ -30,8 +30,8 @@ class SCTPSerializer
 
         /**
          * Serializes an SCTPMessage for transmission on the wire.
-         * The checksum is NOT filled in. (The kernel does that when sending
-         * the frame over a raw socket.)
+         * The checksum is only filled in if the packet fits into bufsize
+         * bytes; otherwise it is left 0.
          * Returns the length of data written into buffer.
          */
         int32 serialize(const SCTPMessage *msg, uint8 *buf, uint32 bufsize);
@@ -122,19 +122,21 @@ int TCPSerializer::serialize(const TCPSegment *tcpseg,
         tcp->th_offs = (TCP_HEADER_OCTETS+lengthCounter)/4; // TCP_HEADER_OCTETS = 20
     } // if options present
 
-    // write data
+    // write data, as much of it as fits into the buffer
     if (tcpseg->getByteLength() > tcpseg->getHeaderLength()) // data present? FIXME TODO: || tcpseg->getEncapsulatedPacket()!=NULL
     {
         unsigned int dataLength = tcpseg->getByteLength() - tcpseg->getHeaderLength();
+        unsigned int headerLength = TCP_HEADER_OCTETS + lengthCounter;
+        unsigned int copyLength = bufsize > headerLength ? std::min(dataLength, bufsize - headerLength) : 0;
         char *tcpData = (char *)options+lengthCounter;
 
         if (tcpseg->getByteArray().getDataArraySize() > 0)
         {
             ASSERT(tcpseg->getByteArray().getDataArraySize() == dataLength);
-            tcpseg->getByteArray().copyDataToBuffer(tcpData, dataLength);
+            tcpseg->getByteArray().copyDataToBuffer(tcpData, copyLength);
         }
         else
-            memset(tcpData, 't', dataLength); // fill data part with 't'
+            memset(tcpData, 't', copyLength); // fill data part with 't'
     }
     return writtenbytes;
 }
@@ -145,7 +147,8 @@ int TCPSerializer::serialize(const TCPSegment *tcpseg,
 {
     int writtenbytes = serialize(tcpseg, buf, bufsize);
     struct tcphdr *tcp = (struct tcphdr*) (buf);
-    tcp->th_sum = checksum(tcp, writtenbytes, srcIp, destIp);
+    if ((unsigned int)writtenbytes <= bufsize)
+        tcp->th_sum = checksum(tcp, writtenbytes, srcIp, destIp);
 
     return writtenbytes;
 }
@@ -40,16 +40,17 @@ class TCPSerializer
         /**
          * Serializes a TCPSegment for transmission on the wire.
          * The checksum is NOT filled in.
-         * Returns the length of data written into buffer.
+         * Returns the length of the segment. The header is always written;
+         * of the data, only what fits into bufsize bytes is written.
          * TODO msg why not a const reference?
          */
         int serialize(const TCPSegment *source, unsigned char *destbuf, unsigned int bufsize);
 
         /**
          * Serializes a TCPSegment for transmission on the wire.
-         * The checksum is NOT filled in. (The kernel does that when sending
-         * the frame over a raw socket.)
-         * Returns the length of data written into buffer.
+         * The checksum is filled in, unless the segment does not fit into
+         * bufsize bytes and is therefore truncated; then it is left 0.
+         * Returns the length of the segment.
          * TODO msg why not a const reference?
          * TODO pseudoheader vs IPv6, pseudoheder.len should calculated by the serialize(), etc
          */
@@ -49,7 +49,9 @@ int UDPSerializer::serialize(const UDPPacket *pkt, unsigned char *buf, unsigned
     udphdr->uh_sport = htons(pkt->getSourcePort());
     udphdr->uh_dport = htons(pkt->getDestinationPort());
     udphdr->uh_ulen = htons(packetLength);
-    udphdr->uh_sum = TCPIPchecksum::checksum(buf, packetLength);
+    udphdr->uh_sum = 0;
+    if ((unsigned int)packetLength <= bufsize)
+        udphdr->uh_sum = TCPIPchecksum::checksum(buf, packetLength);
     return packetLength;
 }
 
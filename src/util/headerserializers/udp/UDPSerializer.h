@@ -32,7 +32,8 @@ class UDPSerializer
 
         /**
          * Serializes an UDPPacket for transmission on the wire.
-         * Returns the length of data written into buffer.
+         * Returns the length of the packet. The checksum is left 0 if the
+         * packet does not fit into bufsize bytes.
          */
         int serialize(const UDPPacket *pkt, unsigned char *buf, unsigned int bufsize);
 
@@ -42,6 +42,7 @@ class Obstacle {
         double calculateReceivedPower(double pSend, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) const;
 
         AnnotationManager::Annotation* visualRepresentation;
+        mutable unsigned int visitStamp; /**< lets ObstacleControl visit each obstacle once per grid traversal */
 
     protected:
         std::string id;
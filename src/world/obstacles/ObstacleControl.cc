@@ -18,8 +18,10 @@
 //
 
 #include <sstream>
-#include <map>
-#include <set>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
 
 #include "world/obstacles/ObstacleControl.h"
 
@@ -36,9 +38,15 @@ void ObstacleControl::initialize(int stage)
     if (stage == 0)
     {
         obstacles.clear();
-        cacheEntries.clear();
+        cache.setCapacity(par("cacheSize").longValue());
+        cachePositionTolerance = par("cachePositionTolerance");
+        visitStamp = 0;
+        numCacheHits = numCacheMisses = 0;
 
         obstaclesXml = par("obstacles");
+
+        WATCH(numCacheHits);
+        WATCH(numCacheMisses);
     }
     else if (stage == 1)
     {
@@ -51,6 +59,9 @@ void ObstacleControl::initialize(int stage)
 }
 
 void ObstacleControl::finish() {
+    recordScalar("attenuation cache hits", numCacheHits);
+    recordScalar("attenuation cache misses", numCacheMisses);
+
     for (Obstacles::iterator i = obstacles.begin(); i != obstacles.end(); ++i) {
         for (ObstacleGridRow::iterator j = i->begin(); j != i->end(); ++j) {
             while (j->begin() != j->end()) erase(*j->begin());
@@ -130,7 +141,7 @@ void ObstacleControl::add(Obstacle obstacle) {
     // visualize using AnnotationManager
     if (annotations) o->visualRepresentation = annotations->drawPolygon(o->getShape(), "red", annotationGroup);
 
-    cacheEntries.clear();
+    cache.clear();
 }
 
 void ObstacleControl::erase(const Obstacle* obstacle) {
@@ -150,62 +161,211 @@ void ObstacleControl::erase(const Obstacle* obstacle) {
     if (annotations && obstacle->visualRepresentation) annotations->erase(obstacle->visualRepresentation);
     delete obstacle;
 
-    cacheEntries.clear();
+    cache.clear();
 }
 
-double ObstacleControl::calculateReceivedPower(double pSend, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) const {
-    Enter_Method_Silent();
+size_t ObstacleControl::CacheKey::hash() const {
+    const double fields[] = { senderPos.x, senderPos.y, senderPos.z, receiverPos.x, receiverPos.y, receiverPos.z, senderAngle, receiverAngle, carrierFrequency };
+    size_t h = 0;
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        uint64 bits;
+        memcpy(&bits, &fields[i], sizeof(bits));
+        h = h * 31 + (size_t)(bits ^ (bits >> 32));
+    }
+    return h;
+}
 
-    // return cached result, if available
-    CacheKey cacheKey(pSend, carrierFrequency, senderPos, senderAngle, receiverPos, receiverAngle);
-    CacheEntries::const_iterator cacheEntryIter = cacheEntries.find(cacheKey);
-    if (cacheEntryIter != cacheEntries.end()) return cacheEntryIter->second;
+void ObstacleControl::AttenuationCache::setCapacity(size_t capacity) {
+    this->capacity = capacity;
+    clear();
+}
+
+void ObstacleControl::AttenuationCache::clear() {
+    entries.clear();
+    buckets.clear();
+    buckets.resize(std::max(capacity, (size_t)1));
+}
+
+bool ObstacleControl::AttenuationCache::lookup(const CacheKey& key, double& value) {
+    if (capacity == 0) return false;
+    Bucket& bucket = getBucket(key);
+    for (Bucket::iterator it = bucket.begin(); it != bucket.end(); ++it) {
+        if ((*it)->first == key) {
+            // move to front: the list iterators (and thus the bucket) stay valid
+            entries.splice(entries.begin(), entries, *it);
+            value = (*it)->second;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ObstacleControl::AttenuationCache::insert(const CacheKey& key, double value) {
+    if (capacity == 0) return;
+    if (entries.size() >= capacity) {
+        // evict the least recently used entry
+        EntryList::iterator victim = --entries.end();
+        Bucket& victimBucket = getBucket(victim->first);
+        victimBucket.erase(std::find(victimBucket.begin(), victimBucket.end(), victim));
+        entries.erase(victim);
+    }
+    entries.push_front(Entry(key, value));
+    getBucket(key).push_back(entries.begin());
+}
 
-    // calculate bounding box of transmission
+Coord ObstacleControl::quantize(const Coord& pos) const {
+    if (cachePositionTolerance <= 0) return pos;
+    return Coord(floor(pos.x / cachePositionTolerance + 0.5) * cachePositionTolerance,
+                 floor(pos.y / cachePositionTolerance + 0.5) * cachePositionTolerance,
+                 floor(pos.z / cachePositionTolerance + 0.5) * cachePositionTolerance);
+}
+
+void ObstacleControl::resetVisitStamps() const {
+    for (Obstacles::const_iterator i = obstacles.begin(); i != obstacles.end(); ++i)
+        for (ObstacleGridRow::const_iterator j = i->begin(); j != i->end(); ++j)
+            for (ObstacleGridCell::const_iterator k = j->begin(); k != j->end(); ++k)
+                (*k)->visitStamp = 0;
+}
+
+bool ObstacleControl::attenuateInCell(long row, long col, double& factor, VisitedObstacles *visited, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) const {
+    // obstacles at negative coordinates are stored in the first row/column, see add()
+    size_t r = std::max(0L, row);
+    size_t c = std::max(0L, col);
+    if (c >= obstacles.size()) return true;
+    if (r >= obstacles[c].size()) return true;
+
+    // bounding box of transmission
     Coord bboxP1 = Coord(std::min(senderPos.x, receiverPos.x), std::min(senderPos.y, receiverPos.y));
     Coord bboxP2 = Coord(std::max(senderPos.x, receiverPos.x), std::max(senderPos.y, receiverPos.y));
 
-    size_t fromRow = std::max(0, int(bboxP1.x / GRIDCELL_SIZE));
-    size_t toRow = std::max(0, int(bboxP2.x / GRIDCELL_SIZE));
-    size_t fromCol = std::max(0, int(bboxP1.y / GRIDCELL_SIZE));
-    size_t toCol = std::max(0, int(bboxP2.y / GRIDCELL_SIZE));
+    const ObstacleGridCell& cell = (obstacles[c])[r];
+    for (ObstacleGridCell::const_iterator k = cell.begin(); k != cell.end(); ++k) {
+        Obstacle* o = *k;
+
+        if (visited) {
+            if (std::find(visited->begin(), visited->end(), o) != visited->end()) continue;
+            visited->push_back(o);
+        }
+        else {
+            if (o->visitStamp == visitStamp) continue;
+            o->visitStamp = visitStamp;
+        }
 
-    std::set<Obstacle*> processedObstacles;
-    for (size_t col = fromCol; col <= toCol; ++col) {
-        if (col >= obstacles.size()) break;
-        for (size_t row = fromRow; row <= toRow; ++row) {
-            if (row >= obstacles[col].size()) break;
-            const ObstacleGridCell& cell = (obstacles[col])[row];
-            for (ObstacleGridCell::const_iterator k = cell.begin(); k != cell.end(); ++k) {
+        // bail if bounding boxes cannot overlap
+        if (o->getBboxP2().x < bboxP1.x) continue;
+        if (o->getBboxP1().x > bboxP2.x) continue;
+        if (o->getBboxP2().y < bboxP1.y) continue;
+        if (o->getBboxP1().y > bboxP2.y) continue;
 
-                Obstacle* o = *k;
+        double factorOld = factor;
 
-                if (processedObstacles.find(o) != processedObstacles.end()) continue;
-                processedObstacles.insert(o);
+        factor = o->calculateReceivedPower(factor, carrierFrequency, senderPos, senderAngle, receiverPos, receiverAngle);
 
-                // bail if bounding boxes cannot overlap
-                if (o->getBboxP2().x < bboxP1.x) continue;
-                if (o->getBboxP1().x > bboxP2.x) continue;
-                if (o->getBboxP2().y < bboxP1.y) continue;
-                if (o->getBboxP1().y > bboxP2.y) continue;
+        // draw a "hit!" bubble
+        if (annotations && !visited && (factor < factorOld)) annotations->drawBubble(o->getBboxP1(), "hit");
 
-                double pSendOld = pSend;
+        // bail if attenuation is already extremely high
+        if (factor < 1e-30) return false;
+    }
+    return true;
+}
 
-                pSend = o->calculateReceivedPower(pSend, carrierFrequency, senderPos, senderAngle, receiverPos, receiverAngle);
+double ObstacleControl::calculateAttenuation(VisitedObstacles *visited, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) const {
+    if (!visited && ++visitStamp == 0) {
+        resetVisitStamps();
+        visitStamp = 1;
+    }
 
-                // draw a "hit!" bubble
-                if (annotations && (pSend < pSendOld)) annotations->drawBubble(o->getBboxP1(), "hit");
+    // walk the grid cells crossed by the line from sender to receiver (Amanatides-Woo traversal)
+    double x0 = senderPos.x / GRIDCELL_SIZE, y0 = senderPos.y / GRIDCELL_SIZE;
+    double x1 = receiverPos.x / GRIDCELL_SIZE, y1 = receiverPos.y / GRIDCELL_SIZE;
+    long row = (long)floor(x0), col = (long)floor(y0);
+    long lastRow = (long)floor(x1), lastCol = (long)floor(y1);
+    double dx = x1 - x0, dy = y1 - y0;
+    int stepRow = dx > 0 ? 1 : -1;
+    int stepCol = dy > 0 ? 1 : -1;
+    double tDeltaX = dx != 0 ? fabs(1.0 / dx) : HUGE_VAL;
+    double tDeltaY = dy != 0 ? fabs(1.0 / dy) : HUGE_VAL;
+    double tMaxX = dx > 0 ? (row + 1 - x0) / dx : dx < 0 ? (x0 - row) / -dx : HUGE_VAL;
+    double tMaxY = dy > 0 ? (col + 1 - y0) / dy : dy < 0 ? (y0 - col) / -dy : HUGE_VAL;
+    long numSteps = labs(lastRow - row) + labs(lastCol - col);
+
+    double factor = 1.0;
+    if (!attenuateInCell(row, col, factor, visited, carrierFrequency, senderPos, senderAngle, receiverPos, receiverAngle)) return factor;
+    for (long i = 0; i < numSteps && (row != lastRow || col != lastCol); i++) {
+        if (tMaxX < tMaxY) {
+            row += stepRow;
+            tMaxX += tDeltaX;
+        }
+        else if (tMaxY < tMaxX) {
+            col += stepCol;
+            tMaxY += tDeltaY;
+        }
+        else {
+            // the line crosses a cell corner: also visit the two cells touching it
+            if (!attenuateInCell(row + stepRow, col, factor, visited, carrierFrequency, senderPos, senderAngle, receiverPos, receiverAngle)) return factor;
+            if (!attenuateInCell(row, col + stepCol, factor, visited, carrierFrequency, senderPos, senderAngle, receiverPos, receiverAngle)) return factor;
+            row += stepRow;
+            col += stepCol;
+            tMaxX += tDeltaX;
+            tMaxY += tDeltaY;
+            i++;
+        }
+        if (!attenuateInCell(row, col, factor, visited, carrierFrequency, senderPos, senderAngle, receiverPos, receiverAngle)) return factor;
+    }
+    return factor;
+}
+
+double ObstacleControl::calculateReceivedPower(double pSend, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) const {
+    Enter_Method_Silent();
 
-                // bail if attenuation is already extremely high
-                if (pSend < 1e-30) break;
+    Coord sPos = quantize(senderPos);
+    Coord rPos = quantize(receiverPos);
 
-            }
+    // return cached result, if available
+    CacheKey cacheKey(carrierFrequency, sPos, senderAngle, rPos, receiverAngle);
+    double factor;
+    if (cache.lookup(cacheKey, factor)) {
+        numCacheHits++;
+        return pSend * factor;
+    }
+    numCacheMisses++;
+
+    factor = calculateAttenuation(NULL, carrierFrequency, sPos, senderAngle, rPos, receiverAngle);
+
+    // cache result
+    cache.insert(cacheKey, factor);
+
+    return pSend * factor;
+}
+
+double ObstacleControl::calculateReceivedPowerConcurrently(double pSend, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) const {
+    // NOTE: no Enter_Method()! This may run outside of the simulation thread
+
+    Coord sPos = quantize(senderPos);
+    Coord rPos = quantize(receiverPos);
+
+    // return cached result, if available; the result does not depend on the
+    // cache contents, so the order of the calls does not affect it either
+    CacheKey cacheKey(carrierFrequency, sPos, senderAngle, rPos, receiverAngle);
+    double factor;
+    {
+        MutexLocker locker(cacheMutex);
+        if (cache.lookup(cacheKey, factor)) {
+            numCacheHits++;
+            return pSend * factor;
         }
+        numCacheMisses++;
     }
 
+    VisitedObstacles visited;
+    factor = calculateAttenuation(&visited, carrierFrequency, sPos, senderAngle, rPos, receiverAngle);
+
     // cache result
-    if (cacheEntries.size() >= 1000) cacheEntries.clear();
-    cacheEntries[cacheKey] = pSend;
+    {
+        MutexLocker locker(cacheMutex);
+        cache.insert(cacheKey, factor);
+    }
 
-    return pSend;
+    return pSend * factor;
 }
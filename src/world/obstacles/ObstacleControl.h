@@ -22,6 +22,7 @@
 #define WORLD_OBSTACLE_OBSTACLECONTROL_H
 
 #include <list>
+#include <vector>
 
 #include "INETDefs.h"
 
@@ -29,6 +30,7 @@
 #include "Coord.h"
 #include "world/obstacles/Obstacle.h"
 #include "world/annotations/AnnotationManager.h"
+#include "ThreadPool.h"
 
 /**
  * ObstacleControl models obstacles that block radio transmissions.
@@ -56,42 +58,63 @@ class INET_API ObstacleControl : public cSimpleModule
          */
         double calculateReceivedPower(double pSend, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) const;
 
+        /**
+         * same as calculateReceivedPower(), but may be called from worker threads (see ThreadPool);
+         * does not draw annotations
+         */
+        double calculateReceivedPowerConcurrently(double pSend, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) const;
+
     protected:
+        /**
+         * Key of the attenuation cache. The sent power is not part of the key,
+         * because obstacles attenuate by a factor independent of it.
+         */
         struct CacheKey {
-            const double pSend;
-            const double carrierFrequency;
-            const Coord senderPos;
-            const double senderAngle;
-            const Coord receiverPos;
-            const double receiverAngle;
-
-            CacheKey(double pSend, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) :
-                pSend(pSend),
+            double carrierFrequency;
+            Coord senderPos;
+            double senderAngle;
+            Coord receiverPos;
+            double receiverAngle;
+
+            CacheKey(double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) :
                 carrierFrequency(carrierFrequency),
                 senderPos(senderPos),
                 senderAngle(senderAngle),
                 receiverPos(receiverPos),
                 receiverAngle(receiverAngle) {
             }
-            bool operator<(const CacheKey& o) const {
-                if (senderPos.x < o.senderPos.x) return true;
-                if (senderPos.x > o.senderPos.x) return false;
-                if (senderPos.y < o.senderPos.y) return true;
-                if (senderPos.y > o.senderPos.y) return false;
-                if (receiverPos.x < o.receiverPos.x) return true;
-                if (receiverPos.x > o.receiverPos.x) return false;
-                if (receiverPos.y < o.receiverPos.y) return true;
-                if (receiverPos.y > o.receiverPos.y) return false;
-                if (pSend < o.pSend) return true;
-                if (pSend > o.pSend) return false;
-                if (senderAngle < o.senderAngle) return true;
-                if (senderAngle > o.senderAngle) return false;
-                if (receiverAngle < o.receiverAngle) return true;
-                if (receiverAngle > o.receiverAngle) return false;
-                if (carrierFrequency < o.carrierFrequency) return true;
-                if (carrierFrequency > o.carrierFrequency) return false;
-                return false;
+            bool operator==(const CacheKey& o) const {
+                return senderPos.x == o.senderPos.x && senderPos.y == o.senderPos.y && senderPos.z == o.senderPos.z &&
+                       receiverPos.x == o.receiverPos.x && receiverPos.y == o.receiverPos.y && receiverPos.z == o.receiverPos.z &&
+                       senderAngle == o.senderAngle && receiverAngle == o.receiverAngle && carrierFrequency == o.carrierFrequency;
             }
+            size_t hash() const;
+        };
+
+        /**
+         * Hashed, size-bounded cache of attenuation factors with least recently
+         * used eviction.
+         */
+        class AttenuationCache {
+            protected:
+                typedef std::pair<CacheKey, double> Entry;
+                typedef std::list<Entry> EntryList;
+                typedef std::vector<EntryList::iterator> Bucket;
+
+                EntryList entries; /**< most recently used first */
+                std::vector<Bucket> buckets;
+                size_t capacity;
+
+                Bucket& getBucket(const CacheKey& key) { return buckets[key.hash() % buckets.size()]; }
+
+            public:
+                AttenuationCache() : capacity(0) {}
+                void setCapacity(size_t capacity);
+                size_t size() const { return entries.size(); }
+                void clear();
+                /** Returns true and stores the factor into value if the key is cached */
+                bool lookup(const CacheKey& key, double& value);
+                void insert(const CacheKey& key, double value);
         };
 
         enum { GRIDCELL_SIZE = 1024 };
@@ -99,14 +122,32 @@ class INET_API ObstacleControl : public cSimpleModule
         typedef std::list<Obstacle*> ObstacleGridCell;
         typedef std::vector<ObstacleGridCell> ObstacleGridRow;
         typedef std::vector<ObstacleGridRow> Obstacles;
-        typedef std::map<CacheKey, double> CacheEntries;
 
         cXMLElement* obstaclesXml; /**< obstacles to add at startup */
 
         Obstacles obstacles;
         AnnotationManager* annotations;
         AnnotationManager::Group* annotationGroup;
-        mutable CacheEntries cacheEntries;
+        mutable AttenuationCache cache;
+        double cachePositionTolerance; /**< positions are snapped to a grid of this size (in m) before calculation; 0 means exact positions */
+        mutable unsigned int visitStamp; /**< incremented for each grid traversal, see Obstacle::visitStamp */
+        mutable Mutex cacheMutex; /**< protects the cache and the statistics in calculateReceivedPowerConcurrently() */
+
+        mutable unsigned long numCacheHits;
+        mutable unsigned long numCacheMisses;
+
+    protected:
+        typedef std::vector<const Obstacle*> VisitedObstacles;
+
+        Coord quantize(const Coord& pos) const;
+        void resetVisitStamps() const;
+        /**
+         * attenuates factor by the not yet visited obstacles of the grid cell; returns false if the signal is already negligible.
+         * Visited obstacles are tracked in visited if given (thread-safe), otherwise by visit stamps.
+         */
+        bool attenuateInCell(long row, long col, double& factor, VisitedObstacles *visited, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) const;
+        /** returns the attenuation factor of the obstacles along the line, walking the grid cells it crosses */
+        double calculateAttenuation(VisitedObstacles *visited, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) const;
 };
 
 class ObstacleControlAccess
@@ -20,6 +20,7 @@
 #include <cassert>
 
 #include "AirFrame_m.h"
+#include "IReceivedPowerCalculator.h"
 
 #define coreEV (ev.isDisabled()||!coreDebug) ? EV : EV << "ChannelControl: "
 
@@ -42,10 +43,12 @@ std::ostream& operator<<(std::ostream& os, const ChannelControl::TransmissionLis
 
 ChannelControl::ChannelControl()
 {
+    threadPool = NULL;
 }
 
 ChannelControl::~ChannelControl()
 {
+    delete threadPool;
     for (unsigned int i = 0; i < transmissions.size(); i++)
         for (TransmissionList::iterator it = transmissions[i].begin(); it != transmissions[i].end(); it++)
             delete *it;
@@ -69,6 +72,15 @@ void ChannelControl::initialize()
 
     maxInterferenceDistance = calcInterfDist();
 
+    useSpatialGrid = par("useSpatialGrid");
+    if (useSpatialGrid && maxInterferenceDistance > 0)
+        radioGrid.setCellSize(maxInterferenceDistance);
+
+    int numThreads = par("numThreads");
+    if (numThreads > 1)
+        threadPool = new ThreadPool(numThreads);
+    parallelReceptionThreshold = par("parallelReceptionThreshold");
+
     WATCH(maxInterferenceDistance);
     WATCH_LIST(radios);
     WATCH_VECTOR(transmissions);
@@ -122,11 +134,15 @@ ChannelControl::RadioRef ChannelControl::registerRadio(cModule *radio, cGate *ra
     RadioEntry re;
     re.radioModule = radio;
     re.radioInGate = radioInGate->getPathStartGate();
+    re.powerCalculator = dynamic_cast<IReceivedPowerCalculator *>(radio);
     re.isNeighborListValid = false;
     re.channel = 0;  // for now
     re.isActive = true;
     radios.push_back(re);
-    return &radios.back(); // last element
+    RadioRef newRadio = &radios.back(); // last element
+    if (useSpatialGrid)
+        radioGrid.insert(newRadio, newRadio->pos);
+    return newRadio;
 }
 
 void ChannelControl::unregisterRadio(RadioRef r)
@@ -137,16 +153,17 @@ void ChannelControl::unregisterRadio(RadioRef r)
         if (it->radioModule == r->radioModule)
         {
             RadioRef radioToRemove = &*it;
-            // erase radio from all registered radios' neighbor list
-            for (RadioList::iterator i2 = radios.begin(); i2 != radios.end(); ++i2)
+            // erase radio from its neighbors' neighbor list (the relation is symmetric)
+            for (std::set<RadioRef,RadioEntry::Compare>::iterator i2 = radioToRemove->neighbors.begin(); i2 != radioToRemove->neighbors.end(); ++i2)
             {
-                RadioRef otherRadio = &*i2;
+                RadioRef otherRadio = *i2;
                 otherRadio->neighbors.erase(radioToRemove);
                 otherRadio->isNeighborListValid = false;
-                radioToRemove->isNeighborListValid = false;
             }
 
             // erase radio from registered radios
+            if (useSpatialGrid)
+                radioGrid.remove(radioToRemove, radioToRemove->pos);
             radios.erase(it);
             return;
         }
@@ -181,6 +198,38 @@ void ChannelControl::updateConnections(RadioRef h)
 {
     Coord& hpos = h->pos;
     double maxDistSquared = maxInterferenceDistance * maxInterferenceDistance;
+
+    if (useSpatialGrid)
+    {
+        // out of range: disconnect (only current neighbors can be affected)
+        for (std::set<RadioRef,RadioEntry::Compare>::iterator it = h->neighbors.begin(); it != h->neighbors.end(); )
+        {
+            RadioRef hi = *it;
+            if (hpos.sqrdist(hi->pos) < maxDistSquared)
+                ++it;
+            else
+            {
+                h->neighbors.erase(it++);
+                hi->neighbors.erase(h);
+                h->isNeighborListValid = hi->isNeighborListValid = false;
+            }
+        }
+
+        // nodes within communication range: connect (only radios in adjacent grid cells are candidates)
+        gridCandidates.clear();
+        radioGrid.collect(hpos, maxInterferenceDistance, gridCandidates);
+        for (RadioRefVector::iterator it = gridCandidates.begin(); it != gridCandidates.end(); ++it)
+        {
+            RadioRef hi = *it;
+            if (hi != h && hpos.sqrdist(hi->pos) < maxDistSquared && h->neighbors.insert(hi).second == true)
+            {
+                hi->neighbors.insert(h);
+                h->isNeighborListValid = hi->isNeighborListValid = false;
+            }
+        }
+        return;
+    }
+
     for (RadioList::iterator it = radios.begin(); it != radios.end(); ++it)
     {
         RadioEntry *hi = &(*it);
@@ -221,6 +270,8 @@ void ChannelControl::checkChannel(int channel)
 void ChannelControl::setRadioPosition(RadioRef r, const Coord& pos)
 {
     Enter_Method_Silent();
+    if (useSpatialGrid)
+        radioGrid.move(r, r->pos, pos);
     r->pos = pos;
     updateConnections(r);
 }
@@ -287,6 +338,32 @@ void ChannelControl::purgeOngoingTransmissions()
     }
 }
 
+void ChannelControl::ReceptionTask::run(int index)
+{
+    RadioRef r = receivers[index];
+    receivedPowers[index] = r->powerCalculator->calculateReceivedPowerConcurrently(airFrame, r->pos);
+}
+
+void ChannelControl::calculateReceivedPowers(RadioRef srcRadio, AirFrame *airFrame, const RadioRefVector& neighbors)
+{
+    int n = neighbors.size();
+    int channel = airFrame->getChannelNumber();
+    receptionTask.airFrame = airFrame;
+    receptionTask.receivers.clear();
+    receptionTaskIndices.assign(n, -1);
+    for (int i=0; i<n; i++)
+    {
+        RadioRef r = neighbors[i];
+        if (r->isActive && r->channel == channel && r->powerCalculator && r->powerCalculator->canCalculateReceivedPowerConcurrently(airFrame))
+        {
+            receptionTaskIndices[i] = receptionTask.receivers.size();
+            receptionTask.receivers.push_back(r);
+        }
+    }
+    receptionTask.receivedPowers.resize(receptionTask.receivers.size());
+    threadPool->runAll(&receptionTask, receptionTask.receivers.size());
+}
+
 void ChannelControl::sendToChannel(RadioRef srcRadio, AirFrame *airFrame)
 {
     // NOTE: no Enter_Method()! We pretend this method is part of ChannelAccess
@@ -295,6 +372,12 @@ void ChannelControl::sendToChannel(RadioRef srcRadio, AirFrame *airFrame)
     const RadioRefVector& neighbors = getNeighbors(srcRadio);
     int n = neighbors.size();
     int channel = airFrame->getChannelNumber();
+
+    // calculate the received powers in parallel; the copies are still sent below in the usual order
+    bool isCalculatedInParallel = threadPool && n >= parallelReceptionThreshold;
+    if (isCalculatedInParallel)
+        calculateReceivedPowers(srcRadio, airFrame, neighbors);
+
     for (int i=0; i<n; i++)
     {
         RadioRef r = neighbors[i];
@@ -309,7 +392,16 @@ void ChannelControl::sendToChannel(RadioRef srcRadio, AirFrame *airFrame)
             // account for propagation delay, based on distance in meters
             // Over 300m, dt=1us=10 bit times @ 10Mbps
             simtime_t delay = srcRadio->pos.distance(r->pos) / SPEED_OF_LIGHT;
-            check_and_cast<cSimpleModule*>(srcRadio->radioModule)->sendDirect(airFrame->dup(), delay, airFrame->getDuration(), r->radioInGate);
+            // only the AirFrame itself is copied: the encapsulated packet is shared by
+            // all copies (reference counted), and each receiver gets its own copy of it
+            // only when it decapsulates or modifies it
+            AirFrame *copy = airFrame->dup();
+            if (isCalculatedInParallel && receptionTaskIndices[i] != -1)
+            {
+                copy->setPowRec(receptionTask.receivedPowers[receptionTaskIndices[i]]);
+                copy->setPowRecPrecomputed(true);
+            }
+            check_and_cast<cSimpleModule*>(srcRadio->radioModule)->sendDirect(copy, delay, airFrame->getDuration(), r->radioInGate);
         }
         else
             coreEV << "skipping radio listening on a different channel\n";
@@ -24,9 +24,12 @@
 #include "INETDefs.h"
 #include "Coord.h"
 #include "IChannelControl.h"
+#include "SpatialGrid.h"
+#include "ThreadPool.h"
 
 // Forward declarations
 class AirFrame;
+class IReceivedPowerCalculator;
 
 #define TRANSMISSION_PURGE_INTERVAL 1.0
 
@@ -38,6 +41,7 @@ class AirFrame;
 struct IChannelControl::RadioEntry {
     cModule *radioModule;  // the module that registered this radio interface
     cGate *radioInGate;  // gate on host module used to receive airframes
+    IReceivedPowerCalculator *powerCalculator; // radioModule, if it supports parallel reception, or NULL
     int channel;
     Coord pos; // cached radio position
 
@@ -69,6 +73,11 @@ class INET_API ChannelControl : public cSimpleModule, public IChannelControl
 
     RadioList radios;
 
+    /** spatial index of the registered radios, cell size is maxInterferenceDistance */
+    SpatialGrid<RadioRef> radioGrid;
+    bool useSpatialGrid;
+    RadioRefVector gridCandidates; // scratch buffer for updateConnections()
+
     /** keeps track of ongoing transmissions; this is needed when a radio
      * switches to another channel (then it needs to know whether the target channel
      * is empty or busy)
@@ -91,6 +100,26 @@ class INET_API ChannelControl : public cSimpleModule, public IChannelControl
     /** the number of controlled channels */
     int numChannels;
 
+    /**
+     * Calculates the received power of one transmission for several
+     * receivers, see the numThreads parameter.
+     */
+    class ReceptionTask : public ThreadPool::Task
+    {
+      public:
+        const AirFrame *airFrame;
+        std::vector<RadioRef> receivers;
+        std::vector<double> receivedPowers;  // indexed like receivers
+        virtual void run(int index);
+    };
+
+    /** used for calculating the received power of transmissions in parallel, or NULL */
+    ThreadPool *threadPool;
+    /** parallel calculation is only used if the sender has at least this many neighbors */
+    int parallelReceptionThreshold;
+    ReceptionTask receptionTask;
+    std::vector<int> receptionTaskIndices; // indexed like the neighbors of the sender, -1 if not calculated in parallel
+
   protected:
     virtual void updateConnections(RadioRef h);
 
@@ -115,6 +144,9 @@ class INET_API ChannelControl : public cSimpleModule, public IChannelControl
     /** Returns the "handle" of a previously registered radio. The pointer to the registering (radio) module must be provided */
     virtual RadioRef lookupRadio(cModule *radioModule);
 
+    /** Calculates the received power of the frame at the neighbors on the thread pool; fills in receptionTask and receptionTaskIndices */
+    virtual void calculateReceivedPowers(RadioRef srcRadio, AirFrame *airFrame, const RadioRefVector& neighbors);
+
   public:
     ChannelControl();
     virtual ~ChannelControl();
@@ -0,0 +1,52 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_IRECEIVEDPOWERCALCULATOR_H
+#define __INET_IRECEIVEDPOWERCALCULATOR_H
+
+#include "INETDefs.h"
+
+#include "Coord.h"
+
+class AirFrame;
+
+
+/**
+ * Interface for radio modules whose received power can be calculated by
+ * ChannelControl at transmission time, on worker threads (see the numThreads
+ * parameter of ChannelControl). The result is passed to the receiver in the
+ * powRec field of the AirFrame copy, with powRecPrecomputed set to true.
+ */
+class INET_API IReceivedPowerCalculator
+{
+  public:
+    virtual ~IReceivedPowerCalculator() {}
+
+    /**
+     * Returns true if calculateReceivedPowerConcurrently() may be used for
+     * this frame. Called from the simulation thread.
+     */
+    virtual bool canCalculateReceivedPowerConcurrently(const AirFrame *airframe) = 0;
+
+    /**
+     * Calculates the power of the frame received at the given position.
+     * Called from worker threads: must not modify simulation state.
+     */
+    virtual double calculateReceivedPowerConcurrently(const AirFrame *airframe, const Coord& receiverPos) = 0;
+};
+
+#endif
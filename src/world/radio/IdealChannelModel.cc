@@ -21,6 +21,16 @@
 
 #include "IdealRadio.h"
 
+namespace {
+struct RadioModuleIdLess
+{
+    bool operator()(const IdealChannelModel::RadioEntry *lhs, const IdealChannelModel::RadioEntry *rhs) const
+    {
+        return lhs->radioModule->getId() < rhs->radioModule->getId();
+    }
+};
+}
+
 
 Define_Module(IdealChannelModel);
 
@@ -44,6 +54,7 @@ void IdealChannelModel::initialize()
     EV << "initializing IdealChannelModel" << endl;
 
     maxTransmissionRange = 0;
+    useSpatialGrid = par("useSpatialGrid");
 
     WATCH_LIST(radios);
 }
@@ -73,7 +84,10 @@ IdealChannelModel::RadioEntry *IdealChannelModel::registerRadio(cModule *radio,
     re.radioInGate = radioInGate->getPathStartGate();
     re.isActive = true;
     radios.push_back(re);
-    return &radios.back(); // last element
+    RadioEntry *newRadio = &radios.back(); // last element
+    if (useSpatialGrid)
+        radioGrid.insert(newRadio, newRadio->pos);
+    return newRadio;
 }
 
 void IdealChannelModel::recalculateMaxTransmissionRange()
@@ -97,6 +111,8 @@ void IdealChannelModel::unregisterRadio(RadioEntry *r)
         if (it->radioModule == r->radioModule)
         {
             // erase radio from registered radios
+            if (useSpatialGrid)
+                radioGrid.remove(&*it, it->pos);
             radios.erase(it);
             maxTransmissionRange = -1.0;    // invalidate the value
             return;
@@ -116,6 +132,8 @@ IdealChannelModel::RadioEntry *IdealChannelModel::lookupRadio(cModule *radio)
 
 void IdealChannelModel::setRadioPosition(RadioEntry *r, const Coord& pos)
 {
+    if (useSpatialGrid)
+        radioGrid.move(r, r->pos, pos);
     r->pos = pos;
 }
 
@@ -128,6 +146,33 @@ void IdealChannelModel::sendToChannel(RadioEntry *srcRadio, IdealAirFrame *airFr
 
     double sqrTransmissionRange = airFrame->getTransmissionRange()*airFrame->getTransmissionRange();
 
+    if (useSpatialGrid)
+    {
+        // keep the cells about as large as the largest transmission range
+        if (maxTransmissionRange > 0.0 && radioGrid.getCellSize() != maxTransmissionRange)
+            radioGrid.setCellSize(maxTransmissionRange);
+
+        gridCandidates.clear();
+        radioGrid.collect(srcRadio->pos, airFrame->getTransmissionRange(), gridCandidates);
+        // send in a deterministic order that does not depend on the grid layout
+        std::sort(gridCandidates.begin(), gridCandidates.end(), RadioModuleIdLess());
+        for (RadioEntryVector::iterator it = gridCandidates.begin(); it != gridCandidates.end(); ++it)
+        {
+            RadioEntry *r = *it;
+            if (r == srcRadio || !r->isActive)
+                continue;   // skip sender radio and disabled radio interfaces
+
+            double sqrdist = srcRadio->pos.sqrdist(r->pos);
+            if (sqrdist <= sqrTransmissionRange)
+            {
+                simtime_t delay = sqrt(sqrdist) / SPEED_OF_LIGHT;
+                check_and_cast<cSimpleModule*>(srcRadio->radioModule)->sendDirect(airFrame->dup(), delay, airFrame->getDuration(), r->radioInGate);
+            }
+        }
+        delete airFrame;
+        return;
+    }
+
     // loop through all radios
     for (RadioList::iterator it=radios.begin(); it !=radios.end(); ++it)
     {
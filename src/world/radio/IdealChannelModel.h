@@ -24,6 +24,7 @@
 #include "INETDefs.h"
 
 #include "Coord.h"
+#include "SpatialGrid.h"
 
 // Forward declarations
 class IdealAirFrame;
@@ -51,6 +52,11 @@ class INET_API IdealChannelModel : public cSimpleModule
     typedef std::list<RadioEntry> RadioList;
     RadioList radios;    // list of registered radios
 
+    typedef std::vector<RadioEntry *> RadioEntryVector;
+    SpatialGrid<RadioEntry *> radioGrid;    // spatial index of radios, cell size is maxTransmissionRange
+    bool useSpatialGrid;
+    RadioEntryVector gridCandidates;        // scratch buffer for sendToChannel()
+
     friend std::ostream& operator<<(std::ostream&, const RadioEntry&);
 
     /** the biggest transmission range in the network.*/
@@ -0,0 +1,244 @@
+//
+// Copyright (C) 2014 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_SPATIALGRID_H
+#define __INET_SPATIALGRID_H
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "INETDefs.h"
+
+#include "Coord.h"
+
+
+/**
+ * Uniform grid spatial index used by the channel controllers to find the
+ * radios that may be in range of a given position without walking every
+ * registered radio.
+ *
+ * Space is divided into cubic cells of size cellSize; cells are mapped into
+ * a hash table of buckets, so the playground does not need to be bounded.
+ * Different cells may share a bucket, therefore collect() returns a superset
+ * of the items within range: the caller is expected to do the exact distance
+ * check. The cell size should be chosen close to the typical query range,
+ * then a query only visits the 3x3(x3) cells around the position.
+ */
+template<typename T>
+class SpatialGrid
+{
+  protected:
+    struct Item
+    {
+        T value;
+        double x, y, z;
+    };
+    typedef std::vector<Item> Bucket;
+
+    std::vector<Bucket> buckets;
+    double cellSize;
+    unsigned int numItems;
+
+    // bounding box of the cell indices of all items inserted since the last rebuild;
+    // queries are clamped to it, so e.g. 2D scenarios do not visit empty z layers
+    bool isEmptyBox;
+    long minIndex[3];
+    long maxIndex[3];
+
+  protected:
+    long cellIndex(double v) const { return (long)floor(v / cellSize); }
+
+    unsigned int bucketIndex(long ix, long iy, long iz) const
+    {
+        unsigned long h = ((unsigned long)ix * 73856093UL) ^ ((unsigned long)iy * 19349663UL) ^ ((unsigned long)iz * 83492791UL);
+        return (unsigned int)(h % buckets.size());
+    }
+
+    unsigned int bucketIndex(double x, double y, double z) const
+    {
+        return bucketIndex(cellIndex(x), cellIndex(y), cellIndex(z));
+    }
+
+    void extendBox(double x, double y, double z)
+    {
+        long idx[3] = { cellIndex(x), cellIndex(y), cellIndex(z) };
+        for (int i = 0; i < 3; i++)
+        {
+            if (isEmptyBox || idx[i] < minIndex[i])
+                minIndex[i] = idx[i];
+            if (isEmptyBox || idx[i] > maxIndex[i])
+                maxIndex[i] = idx[i];
+        }
+        isEmptyBox = false;
+    }
+
+    void rebuild(double newCellSize, unsigned int newNumBuckets)
+    {
+        std::vector<Bucket> oldBuckets;
+        oldBuckets.swap(buckets);
+        buckets.resize(newNumBuckets);
+        cellSize = newCellSize;
+        isEmptyBox = true;
+        for (typename std::vector<Bucket>::iterator b = oldBuckets.begin(); b != oldBuckets.end(); ++b)
+        {
+            for (typename Bucket::iterator it = b->begin(); it != b->end(); ++it)
+            {
+                buckets[bucketIndex(it->x, it->y, it->z)].push_back(*it);
+                extendBox(it->x, it->y, it->z);
+            }
+        }
+    }
+
+    bool removeFromBucket(Bucket& bucket, T value)
+    {
+        for (typename Bucket::iterator it = bucket.begin(); it != bucket.end(); ++it)
+        {
+            if (it->value == value)
+            {
+                *it = bucket.back();
+                bucket.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+  public:
+    SpatialGrid(double cellSize = 1.0) : buckets(64), cellSize(cellSize), numItems(0), isEmptyBox(true) {}
+
+    /** Returns the edge length of the grid cells */
+    double getCellSize() const { return cellSize; }
+
+    /** Changes the cell size; all items are redistributed */
+    void setCellSize(double size)
+    {
+        if (size <= 0)
+            throw cRuntimeError("SpatialGrid: invalid cell size %g", size);
+        if (size != cellSize)
+            rebuild(size, buckets.size());
+    }
+
+    /** Returns the number of stored items */
+    unsigned int size() const { return numItems; }
+
+    /** Stores the item at the given position */
+    void insert(T value, const Coord& pos)
+    {
+        if (numItems >= 2 * buckets.size())
+            rebuild(cellSize, 2 * buckets.size());
+        Item item;
+        item.value = value;
+        item.x = pos.x;
+        item.y = pos.y;
+        item.z = pos.z;
+        buckets[bucketIndex(pos.x, pos.y, pos.z)].push_back(item);
+        extendBox(pos.x, pos.y, pos.z);
+        numItems++;
+    }
+
+    /** Removes the item; pos must be the position it was last stored with */
+    void remove(T value, const Coord& pos)
+    {
+        if (!removeFromBucket(buckets[bucketIndex(pos.x, pos.y, pos.z)], value))
+            throw cRuntimeError("SpatialGrid: item not found at (%g,%g,%g)", pos.x, pos.y, pos.z);
+        numItems--;
+    }
+
+    /** Moves the item from oldPos (its last stored position) to newPos */
+    void move(T value, const Coord& oldPos, const Coord& newPos)
+    {
+        unsigned int oldIndex = bucketIndex(oldPos.x, oldPos.y, oldPos.z);
+        unsigned int newIndex = bucketIndex(newPos.x, newPos.y, newPos.z);
+        if (oldIndex == newIndex)
+        {
+            Bucket& bucket = buckets[oldIndex];
+            for (typename Bucket::iterator it = bucket.begin(); it != bucket.end(); ++it)
+            {
+                if (it->value == value)
+                {
+                    it->x = newPos.x;
+                    it->y = newPos.y;
+                    it->z = newPos.z;
+                    extendBox(newPos.x, newPos.y, newPos.z);
+                    return;
+                }
+            }
+            throw cRuntimeError("SpatialGrid: item not found at (%g,%g,%g)", oldPos.x, oldPos.y, oldPos.z);
+        }
+        remove(value, oldPos);
+        insert(value, newPos);
+    }
+
+    /**
+     * Appends to result the items stored in the cells that intersect the
+     * axis-aligned cube of half-size range around pos. The result may contain
+     * items farther than range; each item is returned at most once.
+     */
+    void collect(const Coord& pos, double range, std::vector<T>& result) const
+    {
+        if (isEmptyBox)
+            return;
+        double p[3] = { pos.x, pos.y, pos.z };
+        long from[3], to[3];
+        double numCells = 1;
+        for (int i = 0; i < 3; i++)
+        {
+            from[i] = std::max(cellIndex(p[i] - range), minIndex[i]);
+            to[i] = std::min(cellIndex(p[i] + range), maxIndex[i]);
+            if (from[i] > to[i])
+                return;
+            numCells *= (double)(to[i] - from[i] + 1);
+        }
+
+        if (numCells >= buckets.size())
+        {
+            // the query box covers more cells than we have buckets: scan everything
+            for (typename std::vector<Bucket>::const_iterator b = buckets.begin(); b != buckets.end(); ++b)
+                for (typename Bucket::const_iterator it = b->begin(); it != b->end(); ++it)
+                    result.push_back(it->value);
+            return;
+        }
+
+        // several cells may map to the same bucket, visit each bucket once
+        unsigned int indices[27];
+        std::vector<unsigned int> indexVector;
+        unsigned int *visited = indices;
+        if (numCells > 27)
+        {
+            indexVector.resize((size_t)numCells);
+            visited = &indexVector[0];
+        }
+        unsigned int numVisited = 0;
+        for (long ix = from[0]; ix <= to[0]; ix++)
+            for (long iy = from[1]; iy <= to[1]; iy++)
+                for (long iz = from[2]; iz <= to[2]; iz++)
+                    visited[numVisited++] = bucketIndex(ix, iy, iz);
+        std::sort(visited, visited + numVisited);
+        unsigned int *end = std::unique(visited, visited + numVisited);
+
+        for (unsigned int *b = visited; b != end; ++b)
+        {
+            const Bucket& bucket = buckets[*b];
+            for (typename Bucket::const_iterator it = bucket.begin(); it != bucket.end(); ++it)
+                result.push_back(it->value);
+        }
+    }
+};
+
+#endif  // __INET_SPATIALGRID_H
+
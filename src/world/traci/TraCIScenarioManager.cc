@@ -62,6 +62,8 @@ void TraCIScenarioManager::initialize(int stage)
         moduleName = par("moduleName").stdstringValue();
         moduleDisplayString = par("moduleDisplayString").stdstringValue();
         penetrationRate = par("penetrationRate").doubleValue();
+        batchCommands = par("batchCommands");
+        subscribeLaneVariables = par("subscribeLaneVariables");
         host = par("host").stdstringValue();
         port = par("port");
         autoShutdown = par("autoShutdown");
@@ -96,6 +98,9 @@ void TraCIScenarioManager::initialize(int stage)
         nextNodeVectorIndex = 0;
         hosts.clear();
         subscribedVehicles.clear();
+        vehicleLanes.clear();
+        queuedCommands.clear();
+        queuedCommandInfo.clear();
         activeVehicleCount = 0;
         autoShutdownTriggered = false;
 
@@ -198,10 +203,7 @@ std::string TraCIScenarioManager::makeTraCICommand(uint8_t commandId, TraCIBuffe
     return (TraCIBuffer() << len << commandId).str() + buf.str();
 }
 
-TraCIScenarioManager::TraCIBuffer TraCIScenarioManager::queryTraCI(uint8_t commandId, const TraCIBuffer& buf) {
-    sendTraCIMessage(makeTraCICommand(commandId, buf));
-
-    TraCIBuffer obuf(receiveTraCIMessage());
+void TraCIScenarioManager::checkTraCIStatus(uint8_t commandId, TraCIBuffer& obuf) {
     uint8_t cmdLength; obuf >> cmdLength;
     uint8_t commandResp; obuf >> commandResp;
     ASSERT(commandResp == commandId);
@@ -210,13 +212,16 @@ TraCIScenarioManager::TraCIBuffer TraCIScenarioManager::queryTraCI(uint8_t comma
     if (result == RTYPE_NOTIMPLEMENTED) error("TraCI server reported command 0x%2x not implemented (\"%s\"). Might need newer version.", commandId, description.c_str());
     if (result == RTYPE_ERR) error("TraCI server reported error executing command 0x%2x (\"%s\").", commandId, description.c_str());
     ASSERT(result == RTYPE_OK);
+}
+
+TraCIScenarioManager::TraCIBuffer TraCIScenarioManager::queryTraCI(uint8_t commandId, const TraCIBuffer& buf) {
+    TraCIBuffer obuf = sendWithQueuedTraCICommands(commandId, buf);
+    checkTraCIStatus(commandId, obuf);
     return obuf;
 }
 
 TraCIScenarioManager::TraCIBuffer TraCIScenarioManager::queryTraCIOptional(uint8_t commandId, const TraCIBuffer& buf, bool& success, std::string* errorMsg) {
-    sendTraCIMessage(makeTraCICommand(commandId, buf));
-
-    TraCIBuffer obuf(receiveTraCIMessage());
+    TraCIBuffer obuf = sendWithQueuedTraCICommands(commandId, buf);
     uint8_t cmdLength; obuf >> cmdLength;
     uint8_t commandResp; obuf >> commandResp;
     ASSERT(commandResp == commandId);
@@ -227,6 +232,60 @@ TraCIScenarioManager::TraCIBuffer TraCIScenarioManager::queryTraCIOptional(uint8
     return obuf;
 }
 
+void TraCIScenarioManager::queueTraCICommand(uint8_t commandId, const TraCIBuffer& buf, bool expectSubscriptionResult) {
+    if (!batchCommands) {
+        TraCIBuffer obuf = queryTraCI(commandId, buf);
+        if (expectSubscriptionResult) processSubcriptionResult(obuf);
+        ASSERT(obuf.eof());
+        return;
+    }
+
+    queuedCommands += makeTraCICommand(commandId, buf);
+    queuedCommandInfo.push_back(std::make_pair(commandId, expectSubscriptionResult));
+}
+
+void TraCIScenarioManager::flushTraCICommands() {
+    // processing the results may queue new commands (e.g. when modules are created), send these too
+    while (!queuedCommandInfo.empty()) {
+        std::string commands;
+        commands.swap(queuedCommands);
+        std::vector<std::pair<uint8_t, bool> > info;
+        info.swap(queuedCommandInfo);
+
+        EV_DEBUG << "Sending " << info.size() << " queued TraCI commands" << endl;
+        sendTraCIMessage(commands);
+        TraCIBuffer obuf(receiveTraCIMessage());
+        processQueuedCommandResults(info, obuf);
+        ASSERT(obuf.eof());
+    }
+}
+
+TraCIScenarioManager::TraCIBuffer TraCIScenarioManager::sendWithQueuedTraCICommands(uint8_t commandId, const TraCIBuffer& buf) {
+    if (queuedCommandInfo.empty()) {
+        sendTraCIMessage(makeTraCICommand(commandId, buf));
+        return TraCIBuffer(receiveTraCIMessage());
+    }
+
+    // the queue is emptied before processing the results, which may queue or send new commands
+    std::string commands;
+    commands.swap(queuedCommands);
+    std::vector<std::pair<uint8_t, bool> > info;
+    info.swap(queuedCommandInfo);
+
+    EV_DEBUG << "Sending " << info.size() << " queued TraCI commands with command 0x" << std::hex << (int)commandId << std::dec << endl;
+    sendTraCIMessage(commands + makeTraCICommand(commandId, buf));
+    TraCIBuffer obuf(receiveTraCIMessage());
+    processQueuedCommandResults(info, obuf);
+    return obuf;
+}
+
+void TraCIScenarioManager::processQueuedCommandResults(const std::vector<std::pair<uint8_t, bool> >& commands, TraCIBuffer& buf) {
+    for (std::vector<std::pair<uint8_t, bool> >::const_iterator i = commands.begin(); i != commands.end(); ++i) {
+        checkTraCIStatus(i->first, buf);
+        if (i->second) processSubcriptionResult(buf);
+    }
+}
+
 void TraCIScenarioManager::connect() {
     EV_DEBUG << "TraCIScenarioManager connecting to TraCI server" << endl;
 
@@ -329,6 +388,9 @@ void TraCIScenarioManager::init_traci() {
 }
 
 void TraCIScenarioManager::finish() {
+    // commands still queued are not sent, the simulation is over
+    queuedCommands.clear();
+    queuedCommandInfo.clear();
     cancelAndDelete(executeOneTimestepTrigger);
     executeOneTimestepTrigger = NULL;
     cancelAndDelete(connectAndStartTrigger);
@@ -387,30 +449,26 @@ std::pair<uint32_t, std::string> TraCIScenarioManager::commandGetVersion() {
 void TraCIScenarioManager::commandSetSpeedMode(std::string nodeId, int32_t bitset) {
     uint8_t variableId = VAR_SPEEDSETMODE;
     uint8_t variableType = TYPE_INTEGER;
-    TraCIBuffer buf = queryTraCI(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << variableType << bitset);
-    ASSERT(buf.eof());
+    queueTraCICommand(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << variableType << bitset);
 }
 
 void TraCIScenarioManager::commandSetSpeed(std::string nodeId, double speed) {
     uint8_t variableId = VAR_SPEED;
     uint8_t variableType = TYPE_DOUBLE;
-    TraCIBuffer buf = queryTraCI(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << variableType << speed);
-    ASSERT(buf.eof());
+    queueTraCICommand(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << variableType << speed);
 }
 
 void TraCIScenarioManager::commandNewRoute(std::string nodeId, std::string roadId) {
     uint8_t variableId = LANE_EDGE_ID;
     uint8_t variableType = TYPE_STRING;
-    TraCIBuffer buf = queryTraCI(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << variableType << roadId);
-    ASSERT(buf.eof());
+    queueTraCICommand(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << variableType << roadId);
 }
 
 void TraCIScenarioManager::commandSetVehicleParking(std::string nodeId) {
     uint8_t variableId = REMOVE;
     uint8_t variableType = TYPE_BYTE;
     uint8_t value = NOTIFICATION_PARKING;
-    TraCIBuffer buf = queryTraCI(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << variableType << value);
-    ASSERT(buf.eof());
+    queueTraCICommand(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << variableType << value);
 }
 
 std::string TraCIScenarioManager::commandGetEdgeId(std::string nodeId) {
@@ -422,10 +480,14 @@ std::string TraCIScenarioManager::commandGetCurrentEdgeOnRoute(std::string nodeI
 }
 
 std::string TraCIScenarioManager::commandGetLaneId(std::string nodeId) {
+    std::map<std::string, std::pair<std::string, double> >::const_iterator i = vehicleLanes.find(nodeId);
+    if (i != vehicleLanes.end()) return i->second.first;
     return genericGetString(CMD_GET_VEHICLE_VARIABLE, nodeId, VAR_LANE_ID, RESPONSE_GET_VEHICLE_VARIABLE);
 }
 
 double TraCIScenarioManager::commandGetLanePosition(std::string nodeId) {
+    std::map<std::string, std::pair<std::string, double> >::const_iterator i = vehicleLanes.find(nodeId);
+    if (i != vehicleLanes.end()) return i->second.second;
     return genericGetDouble(CMD_GET_VEHICLE_VARIABLE, nodeId, VAR_LANEPOSITION, RESPONSE_GET_VEHICLE_VARIABLE);
 }
 
@@ -450,23 +512,20 @@ void TraCIScenarioManager::commandChangeRoute(std::string nodeId, std::string ro
         std::string edgeId = roadId;
         uint8_t newTimeT = TYPE_DOUBLE;
         double newTime = travelTime;
-        TraCIBuffer buf = queryTraCI(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << variableType << count << edgeIdT << edgeId << newTimeT << newTime);
-        ASSERT(buf.eof());
+        queueTraCICommand(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << variableType << count << edgeIdT << edgeId << newTimeT << newTime);
     } else {
         uint8_t variableId = VAR_EDGE_TRAVELTIME;
         uint8_t variableType = TYPE_COMPOUND;
         int32_t count = 1;
         uint8_t edgeIdT = TYPE_STRING;
         std::string edgeId = roadId;
-        TraCIBuffer buf = queryTraCI(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << variableType << count << edgeIdT << edgeId);
-        ASSERT(buf.eof());
+        queueTraCICommand(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << variableType << count << edgeIdT << edgeId);
     }
     {
         uint8_t variableId = CMD_REROUTE_TRAVELTIME;
         uint8_t variableType = TYPE_COMPOUND;
         int32_t count = 0;
-        TraCIBuffer buf = queryTraCI(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << variableType << count);
-        ASSERT(buf.eof());
+        queueTraCICommand(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << variableType << count);
     }
 }
 
@@ -502,18 +561,15 @@ void TraCIScenarioManager::commandStopNode(std::string nodeId, std::string roadI
     uint8_t durationT = TYPE_INTEGER;
     uint32_t duration = waittime * 1000;
 
-    TraCIBuffer buf = queryTraCI(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << variableType << count << edgeIdT << edgeId << stopPosT << stopPos << stopLaneT << stopLane << durationT << duration);
-    ASSERT(buf.eof());
+    queueTraCICommand(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << variableType << count << edgeIdT << edgeId << stopPosT << stopPos << stopLaneT << stopLane << durationT << duration);
 }
 
 void TraCIScenarioManager::commandSetTrafficLightProgram(std::string trafficLightId, std::string program) {
-    TraCIBuffer buf = queryTraCI(CMD_SET_TL_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(TL_PROGRAM) << trafficLightId << static_cast<uint8_t>(TYPE_STRING) << program);
-    ASSERT(buf.eof());
+    queueTraCICommand(CMD_SET_TL_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(TL_PROGRAM) << trafficLightId << static_cast<uint8_t>(TYPE_STRING) << program);
 }
 
 void TraCIScenarioManager::commandSetTrafficLightPhaseIndex(std::string trafficLightId, int32_t index) {
-    TraCIBuffer buf = queryTraCI(CMD_SET_TL_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(TL_PHASE_INDEX) << trafficLightId << static_cast<uint8_t>(TYPE_INTEGER) << index);
-    ASSERT(buf.eof());
+    queueTraCICommand(CMD_SET_TL_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(TL_PHASE_INDEX) << trafficLightId << static_cast<uint8_t>(TYPE_INTEGER) << index);
 }
 
 std::list<std::string> TraCIScenarioManager::commandGetPolygonIds() {
@@ -536,8 +592,7 @@ void TraCIScenarioManager::commandSetPolygonShape(std::string polyId, std::list<
         TraCICoord pos = omnet2traci(*i);
         buf << static_cast<double>(pos.x) << static_cast<double>(pos.y);
     }
-    TraCIBuffer obuf = queryTraCI(CMD_SET_POLYGON_VARIABLE, buf);
-    ASSERT(obuf.eof());
+    queueTraCICommand(CMD_SET_POLYGON_VARIABLE, buf);
 }
 
 void TraCIScenarioManager::commandAddPolygon(std::string polyId, std::string polyType, const TraCIScenarioManager::Color& color, bool filled, int32_t layer, std::list<Coord> points) {
@@ -555,8 +610,7 @@ void TraCIScenarioManager::commandAddPolygon(std::string polyId, std::string pol
         p << static_cast<double>(pos.x) << static_cast<double>(pos.y);
     }
 
-    TraCIBuffer buf = queryTraCI(CMD_SET_POLYGON_VARIABLE, p);
-    ASSERT(buf.eof());
+    queueTraCICommand(CMD_SET_POLYGON_VARIABLE, p);
 }
 
 std::list<std::string> TraCIScenarioManager::commandGetLaneIds() {
@@ -692,6 +746,9 @@ void TraCIScenarioManager::executeOneTimestep() {
         for (uint32_t i = 0; i < count; ++i) {
             processSubcriptionResult(buf);
         }
+
+        // subscribe to new vehicles now, so that their modules are created in this time step
+        flushTraCICommands();
     }
 
     if (!autoShutdownTriggered) scheduleAt(simTime()+updateInterval, executeOneTimestepTrigger);
@@ -889,16 +946,21 @@ void TraCIScenarioManager::subscribeToVehicleVariables(std::string vehicleId) {
     uint32_t beginTime = 0;
     uint32_t endTime = 0x7FFFFFFF;
     std::string objectId = vehicleId;
-    uint8_t variableNumber = 5;
+    uint8_t variableNumber = subscribeLaneVariables ? 7 : 5;
     uint8_t variable1 = VAR_POSITION;
     uint8_t variable2 = VAR_ROAD_ID;
     uint8_t variable3 = VAR_SPEED;
     uint8_t variable4 = VAR_ANGLE;
     uint8_t variable5 = VAR_SIGNALS;
 
-    TraCIBuffer buf = queryTraCI(CMD_SUBSCRIBE_VEHICLE_VARIABLE, TraCIBuffer() << beginTime << endTime << objectId << variableNumber << variable1 << variable2 << variable3 << variable4 << variable5);
-    processSubcriptionResult(buf);
-    ASSERT(buf.eof());
+    TraCIBuffer buf;
+    buf << beginTime << endTime << objectId << variableNumber << variable1 << variable2 << variable3 << variable4 << variable5;
+    if (subscribeLaneVariables) {
+        uint8_t variable6 = VAR_LANE_ID;
+        uint8_t variable7 = VAR_LANEPOSITION;
+        buf << variable6 << variable7;
+    }
+    queueTraCICommand(CMD_SUBSCRIBE_VEHICLE_VARIABLE, buf, true);
 }
 
 void TraCIScenarioManager::unsubscribeFromVehicleVariables(std::string vehicleId) {
@@ -908,8 +970,8 @@ void TraCIScenarioManager::unsubscribeFromVehicleVariables(std::string vehicleId
     std::string objectId = vehicleId;
     uint8_t variableNumber = 0;
 
-    TraCIBuffer buf = queryTraCI(CMD_SUBSCRIBE_VEHICLE_VARIABLE, TraCIBuffer() << beginTime << endTime << objectId << variableNumber);
-    ASSERT(buf.eof());
+    vehicleLanes.erase(vehicleId);
+    queueTraCICommand(CMD_SUBSCRIBE_VEHICLE_VARIABLE, TraCIBuffer() << beginTime << endTime << objectId << variableNumber);
 }
 
 void TraCIScenarioManager::processSimSubscription(std::string objectId, TraCIBuffer& buf) {
@@ -986,6 +1048,9 @@ void TraCIScenarioManager::processVehicleSubscription(std::string objectId, TraC
     double angle_traci;
     int signals;
     int numRead = 0;
+    std::string laneId;
+    double lanePosition;
+    int numLaneRead = 0;
 
     uint8_t variableNumber_resp; buf >> variableNumber_resp;
     for (uint8_t j = 0; j < variableNumber_resp; ++j) {
@@ -1053,6 +1118,16 @@ void TraCIScenarioManager::processVehicleSubscription(std::string objectId, TraC
             ASSERT(varType == TYPE_INTEGER);
             buf >> signals;
             numRead++;
+        } else if (variable1_resp == VAR_LANE_ID) {
+            uint8_t varType; buf >> varType;
+            ASSERT(varType == TYPE_STRING);
+            buf >> laneId;
+            numLaneRead++;
+        } else if (variable1_resp == VAR_LANEPOSITION) {
+            uint8_t varType; buf >> varType;
+            ASSERT(varType == TYPE_DOUBLE);
+            buf >> lanePosition;
+            numLaneRead++;
         } else {
             error("Received unhandled vehicle subscription result");
         }
@@ -1061,6 +1136,8 @@ void TraCIScenarioManager::processVehicleSubscription(std::string objectId, TraC
     // bail out if we didn't want to receive these subscription results
     if (!isSubscribed) return;
 
+    if (numLaneRead == 2) vehicleLanes[objectId] = std::make_pair(laneId, lanePosition);
+
     // make sure we got updates for all attributes
     if (numRead != 5) return;
 
@@ -24,6 +24,7 @@
 #include <utility>
 #include <map>
 #include <list>
+#include <vector>
 #include <sstream>
 #include <iomanip>
 
@@ -246,6 +247,8 @@ class INET_API TraCIScenarioManager : public cSimpleModule
         bool autoShutdown; /**< Shutdown module as soon as no more vehicles are in the simulation */
         int margin;
         double penetrationRate;
+        bool batchCommands; /**< queue commands that return no results and send them together with the next query or simulation step */
+        bool subscribeLaneVariables; /**< also subscribe to lane and lane position of vehicles, so they can be answered without a query */
         std::list<std::string> roiRoads; /**< which roads (e.g. "hwy1 hwy2") are considered to consitute the region of interest, if not empty */
         std::list<std::pair<TraCICoord, TraCICoord> > roiRects; /**< which rectangles (e.g. "0,0-10,10 20,20-30,30) are considered to consitute the region of interest, if not empty */
 
@@ -257,6 +260,9 @@ class INET_API TraCIScenarioManager : public cSimpleModule
         std::map<std::string, cModule*> hosts; /**< vector of all hosts managed by us */
         std::set<std::string> unEquippedHosts;
         std::set<std::string> subscribedVehicles; /**< all vehicles we have already subscribed to */
+        std::map<std::string, std::pair<std::string, double> > vehicleLanes; /**< lane id and lane position of subscribed vehicles, if subscribeLaneVariables is set */
+        std::string queuedCommands; /**< commands waiting to be sent, if batchCommands is set */
+        std::vector<std::pair<uint8_t, bool> > queuedCommandInfo; /**< id of each queued command, and whether a subscription result is expected for it */
         uint32_t activeVehicleCount; /**< number of vehicles reported as active by TraCI server */
         bool autoShutdownTriggered;
         cMessage* connectAndStartTrigger; /**< self-message scheduled for when to connect to TraCI server and start running */
@@ -286,6 +292,33 @@ class INET_API TraCIScenarioManager : public cSimpleModule
          */
         TraCIBuffer queryTraCI(uint8_t commandId, const TraCIBuffer& buf = TraCIBuffer());
 
+        /**
+         * sends a command via TraCI that returns no results other than an optional subscription result,
+         * or queues it if batchCommands is set
+         */
+        void queueTraCICommand(uint8_t commandId, const TraCIBuffer& buf, bool expectSubscriptionResult = false);
+
+        /**
+         * sends all queued commands via TraCI in one message and processes their responses
+         */
+        void flushTraCICommands();
+
+        /**
+         * sends the queued commands followed by a single command in one message, processes the responses
+         * to the queued commands, and returns the response to the single command
+         */
+        TraCIBuffer sendWithQueuedTraCICommands(uint8_t commandId, const TraCIBuffer& buf);
+
+        /**
+         * reads the status response of a command, throws an error if the command failed
+         */
+        void checkTraCIStatus(uint8_t commandId, TraCIBuffer& buf);
+
+        /**
+         * checks the status responses of queued commands and processes their subscription results
+         */
+        void processQueuedCommandResults(const std::vector<std::pair<uint8_t, bool> >& commands, TraCIBuffer& buf);
+
         /**
          * sends a single command via TraCI, expects no reply, returns true if successful
          */
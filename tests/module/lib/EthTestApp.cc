@@ -19,7 +19,7 @@
 
 #include "INETDefs.h"
 
-#include "EtherFrame_m.h"
+#include "EtherFrame.h"
 #include "MACAddress.h"
 
 
@@ -21,7 +21,7 @@
 
 #include "INETDefs.h"
 
-#include "EtherFrame_m.h"
+#include "EtherFrame.h"
 #include "MACAddress.h"
 
 
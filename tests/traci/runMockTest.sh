@@ -0,0 +1,23 @@
+#!/bin/sh
+
+# Runs mock.ini against etc/traci-mockd.py, with and without batched commands,
+# and checks that all runs record the same scalars as the first one.
+
+../../etc/traci-mockd.py -p 9998 -n 200 &
+MOCKD=$!
+trap "kill $MOCKD" EXIT
+sleep 1
+
+mkdir -p results
+for RUN in 0 1 2 3; do
+    opp_run -l../../src/inet -n"../../src;." -u Cmdenv -f mock.ini -r $RUN | egrep -i "^(Pass|FAIL)"
+    grep "^scalar" results/General-$RUN.sca > results/General-$RUN.scalars
+done
+
+for RUN in 1 2 3; do
+    if cmp -s results/General-0.scalars results/General-$RUN.scalars; then
+        echo "Passed: (run $RUN) same scalars as run 0"
+    else
+        echo "FAILED: (run $RUN) same scalars as run 0"
+    fi
+done